@@ -1,4 +1,5 @@
 import os.path
+import brainfunction
 from numpy import array, matrix, vstack, zeros, ones
 from lazy import Lazy
 
@@ -124,7 +125,7 @@ class BrainFunction:
                 "Invalid brain function file: %s" % self.filename
 
         # Open brain function, clean lines
-        f = open(filename)
+        f = brainfunction.open_text(filename)
         lines = [ x.strip() for x in f.readlines()]
         f.close()
        
@@ -198,8 +199,8 @@ class BrainFunction:
         print "calculating activations"
         
         # Open brain function, clean lines
-        f = open(self.filename)
-        lines = [ x.strip() for x in f.xreadlines()]
+        f = brainfunction.open_text(self.filename)
+        lines = [ x.strip() for x in f.readlines()]
         lines = lines[2:-1]
         f.close()
 
@@ -0,0 +1,29 @@
+#!/usr/bin/env python
+
+import argparse
+import brainfunction
+import gzip
+import sys
+
+def parseArgs():
+    parser = argparse.ArgumentParser(description = "Converts binary brain function files to the text format.")
+    parser.add_argument("input", metavar = "INPUT", help = "binary brain function file")
+    parser.add_argument("output", metavar = "OUTPUT", nargs = "?", help = "text output file (default: standard output)")
+    parser.add_argument("--gzip", action = "store_true", help = "gzip the output file")
+    return parser.parse_args()
+
+args = parseArgs()
+if not brainfunction.is_binary(args.input):
+    sys.stderr.write("{0} is not a binary brain function file\n".format(args.input))
+    sys.exit(1)
+func = brainfunction.BinaryBrainFunction(args.input)
+if args.output is None:
+    output = sys.stdout
+elif args.gzip:
+    output = gzip.open(args.output, "wb")
+else:
+    output = open(args.output, "w")
+for line in func.text_lines():
+    output.write(line)
+if output is not sys.stdout:
+    output.close()
@@ -0,0 +1,143 @@
+import gzip
+import struct
+from StringIO import StringIO
+
+# Reads brainFunction files in either the text or the binary ("PWBF") format.
+# See src/library/brain/BrainFunctionFile.h for the binary layout.
+
+MAGIC = 'PWBF'
+VERSION = 1
+FORMAT_FLOAT32 = 1
+FORMAT_FLOAT16 = 2
+HEADER = struct.Struct('<4sBBHqiiiiqq')
+
+####################################################################################
+###
+### FUNCTION read_raw()
+###
+### Returns the file's bytes, or its first size bytes, decompressing it if
+### it's gzipped.
+###
+####################################################################################
+def read_raw(path, size = -1):
+	f = open(path, 'rb')
+	gzipped = f.read(2) == '\x1f\x8b'
+	f.close()
+
+	if gzipped:
+		f = gzip.open(path, 'rb')
+	else:
+		f = open(path, 'rb')
+	data = f.read(size)
+	f.close()
+
+	return data
+
+####################################################################################
+###
+### FUNCTION is_binary()
+###
+####################################################################################
+def is_binary(path):
+	return read_raw(path, len(MAGIC)) == MAGIC
+
+####################################################################################
+###
+### FUNCTION half_to_float()
+###
+####################################################################################
+def half_to_float(h):
+	sign = -1.0 if h & 0x8000 else 1.0
+	exp = (h >> 10) & 0x1f
+	mant = h & 0x3ff
+
+	if exp == 0x1f:
+		if mant:
+			return float('nan')
+		return sign * float('inf')
+	if exp == 0:
+		return sign * mant * 2.0 ** -24
+
+	return sign * (1024 + mant) * 2.0 ** (exp - 25)
+
+####################################################################################
+###
+### CLASS BinaryBrainFunction
+###
+### frames holds one list of activations per step. fitness is None if the
+### agent hadn't died when the file was written.
+###
+####################################################################################
+class BinaryBrainFunction:
+	def __init__(self, path):
+		data = read_raw(path)
+
+		if len(data) < HEADER.size or data[:4] != MAGIC:
+			raise ValueError, "%s is not a binary brainFunction file" % path
+
+		(magic, version, format, reserved,
+		 self.agent_number, self.num_neurons, self.num_inputneurons, self.num_outputneurons,
+		 organs_length, self.num_synapses, self.birth_step) = HEADER.unpack_from(data)
+
+		if version != VERSION:
+			raise ValueError, "%s has unsupported version %d" % (path, version)
+		if format == FORMAT_FLOAT32:
+			valfmt = 'f'
+		elif format == FORMAT_FLOAT16:
+			valfmt = 'H'
+		else:
+			raise ValueError, "%s has unknown format %d" % (path, format)
+
+		pos = HEADER.size
+		self.organs = data[pos : pos + organs_length]
+		pos += organs_length
+
+		record = struct.Struct('<' + valfmt * self.num_neurons)
+		self.frames = []
+		self.fitness = None
+
+		while pos < len(data):
+			tag = data[pos]
+			pos += 1
+			if tag == 'E':
+				if pos + 4 <= len(data):
+					self.fitness = struct.unpack_from('<f', data, pos)[0]
+				break
+			if tag != 'F' or pos + record.size > len(data):
+				break
+
+			values = record.unpack_from(data, pos)
+			if format == FORMAT_FLOAT16:
+				values = map(half_to_float, values)
+			self.frames.append(list(values))
+			pos += record.size
+
+	def text_lines(self):
+		'''yields the lines of the equivalent text format file'''
+		yield 'version 1\n'
+		yield 'brainFunction %d %d %d %d %d %d%s\n' % (self.agent_number,
+													  self.num_neurons,
+													  self.num_inputneurons,
+													  self.num_outputneurons,
+													  self.num_synapses,
+													  self.birth_step,
+													  self.organs)
+		for frame in self.frames:
+			for neuron, activation in enumerate(frame):
+				yield '%d %g\n' % (neuron, activation)
+		if self.fitness is not None:
+			yield 'end fitness = %g\n' % self.fitness
+
+####################################################################################
+###
+### FUNCTION open_text()
+###
+### Opens a brainFunction file as text lines, converting it if it's binary.
+### Text files are opened with opener.
+###
+####################################################################################
+def open_text(path, opener = open):
+	if is_binary(path):
+		return StringIO(''.join(BinaryBrainFunction(path).text_lines()))
+
+	return opener(path)
@@ -2,6 +2,7 @@ import glob
 import os
 
 import abstractfile
+import brainfunction
 import common_functions
 import datalib
 
@@ -186,8 +187,10 @@ def read_anatomy(anatomy_file):
 			agent_id = anatomy_file.split('_')[-2]
 			function_filename = brain_dir + 'function/brainFunction_' + agent_id + '.txt'
 			# don't bother with abstractfile since this is an old format
-			function_file = open(function_filename, 'r')
+			function_file = brainfunction.open_text(function_filename)
 			function_header = function_file.readline()
+			if function_header.startswith('version'):
+				function_header = function_file.readline()
 			function_file.close()
 			return int(function_header.split(' ')[-2])
 
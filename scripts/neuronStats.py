@@ -5,6 +5,7 @@
 # Prints to screen and writes to a comma-separated-values file, "neuronStats.csv"
 
 import sys, getopt, os.path, re, os
+import brainfunction
 
 c = ","
 n = "\n"
@@ -41,8 +42,10 @@ for root, dirs, files in os.walk("."):
 			for name in files2:
 				if name[0:13] == "brainFunction":
 					numBrainFiles += 1
-					file = open(dir+"/"+name, "r")
+					file = brainfunction.open_text(dir+"/"+name)
 					line = file.readline()
+					if line.startswith("version"):
+						line = file.readline()
 					words = line.split()
 					numNeurons = int(words[2])
 					if numNeurons > numNeuronsDirMax:
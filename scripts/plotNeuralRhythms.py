@@ -9,6 +9,7 @@ from matplotlib.collections import LineCollection
 from matplotlib.colors import colorConverter
 import getopt
 import sys
+import brainfunction
 
 ALT_COLOR_MAX = 0.75
 
@@ -26,7 +27,7 @@ def choose_file():
 def open_file(file_name, mode):
 	"""Open a file."""
 	try:			
-		the_file = open(file_name, mode)
+		the_file = brainfunction.open_text(file_name, lambda path: open(path, mode))
 	except(IOError), e:
 		print "Unable to open the file", file_name, "Ending program.\n", e
 		raw_input("\n\nPress the enter key to exit.")
@@ -34,6 +35,10 @@ def open_file(file_name, mode):
 	except(NameError):
 		print "Unable to open the file", file_name, "because it does not exist.	 \nEnding program.\n"
 	else:
+		# skip the "version" line, if any, so the header comes first
+		start = the_file.tell()
+		if not the_file.readline().startswith("version"):
+			the_file.seek(start)
 		return the_file
 
 def next_line(the_file):
@@ -1,5 +1,6 @@
 #!/usr/bin/env python
 import gzip
+import brainfunction
 import os.path
 import pw_brainAnatomy, pw_brainFunction
 from numpy import sum
@@ -18,7 +19,7 @@ class pw_agent:
 		assert filename2 is None or os.path.isfile( filename2), "filename2 was specified but wasn't a valid file"
 
 
-		f1 = gzip.open(filename1)
+		f1 = brainfunction.open_text(filename1, gzip.open)
 		header1 = f1.readline()
 		if header1.startswith('version 1'):
 			header1 = f1.readline()
@@ -34,7 +35,7 @@ class pw_agent:
 		f1.close()
 
 		if filename2:
-			f2 = gzip.open(filename2)
+			f2 = brainfunction.open_text(filename2, gzip.open)
 			header2 = f2.readline()
 			if header2.startswith('version 1'):
 				header2 = f2.readline()
@@ -1,5 +1,6 @@
 #!/usr/bin/env python
 import gzip
+import brainfunction
 from numpy import array, matrix, exp, pi, sqrt, mean, round, random, ones
 import numpy
 #from pprint import pprint
@@ -25,7 +26,7 @@ class pw_brainFunction:
 		if not input_filename:
 			return None
 
-		lines = [ x.strip() for x in gzip.open( input_filename ).readlines() ]
+		lines = [ x.strip() for x in brainfunction.open_text( input_filename, gzip.open ).readlines() ]
 		if lines[0] == "version 1":
 			lines.pop(0)
 
@@ -27,7 +27,7 @@ using namespace std;
 //===========================================================================
 void usage( const char* format, ... )
 {
-	printf( "Usage:  Polyworld [--ui gui|term] [--key value]... worldfile\n" );
+	printf( "Usage:  Polyworld [--ui gui|term] [--restore checkpoint] [--key value]... worldfile\n" );
 
 	if( format )
 	{
@@ -54,6 +54,7 @@ int main( int argc, char** argv )
 {
 	const char *worldfilePath = NULL;
 	string ui = "gui";
+	string restorePath;
 	proplib::ParameterMap parameters;
 
 	for( int argi = 1; argi < argc; argi++ )
@@ -72,6 +73,8 @@ int main( int argc, char** argv )
 			string value( argv[argi] );
 			if( key == "ui" )
 				ui = value;
+			else if( key == "restore" )
+				restorePath = value;
 			else
 				parameters[key] = value;
 		}
@@ -139,7 +142,7 @@ int main( int argc, char** argv )
 
 	proplib::Interpreter::init();
 
-	TSimulation *simulation = new TSimulation( worldfilePath, parameters );
+	TSimulation *simulation = new TSimulation( worldfilePath, parameters, restorePath );
     MonitorManager *monitorManager = new MonitorManager(simulation, monitorPath);
 	SimulationController *simulationController = new SimulationController( simulation,
                                                                            monitorManager);
@@ -23,6 +23,7 @@
 #include "agent/agent.h"
 #include "monitor/Monitor.h"
 #include "monitor/MonitorManager.h"
+#include "renderer/qt/QtAgentPovRenderer.h"
 #include "sim/globals.h"
 #include "sim/Simulation.h"
 #include "ui/SimulationController.h"
@@ -127,7 +128,9 @@ void MainWindow::createMonitorViews()
 		case Monitor::POV:
 			{
 				PovMonitor *monitor = dynamic_cast<PovMonitor *>( _monitor );
-				view = new PovMonitorView( monitor );
+				// Only the GL renderer has a buffer we can display.
+				if( dynamic_cast<QtAgentPovRenderer *>(monitor->getRenderer()) )
+					view = new PovMonitorView( monitor );
 			}
 			break;
 		case Monitor::STATUS_TEXT:
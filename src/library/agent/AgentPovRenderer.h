@@ -8,7 +8,17 @@ class AgentPovRenderer
     AgentPovRenderer() {}
 
  public:
-    static AgentPovRenderer *create( int maxAgents,
+	enum Type
+	{
+		OpenGL,
+		Software,
+		RayCast
+	};
+
+    static AgentPovRenderer *create( Type type,
+                                     class gstage *stage,
+                                     bool staticTimestepGeometry,
+                                     int maxAgents,
                                      int retinaWidth,
                                      int retinaHeight );
 	virtual ~AgentPovRenderer() {}
@@ -20,5 +30,9 @@ class AgentPovRenderer
 	virtual void render( class agent *a ) = 0;
 	virtual void endStep() = 0;
 
+	// True if render() may be invoked for multiple agents concurrently
+	// (between beginStep() and endStep()).
+	virtual bool isThreadSafe() { return false; }
+
     util::Signal<> renderComplete;
 };
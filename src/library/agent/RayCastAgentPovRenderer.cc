@@ -0,0 +1,471 @@
+// Self
+#include "RayCastAgentPovRenderer.h"
+
+// System
+#include <algorithm>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+// Local
+#include "agent/agent.h"
+#include "agent/Retina.h"
+#include "environment/barrier.h"
+#include "graphics/gcamera.h"
+#include "graphics/gmisc.h"
+#include "graphics/gpolygon.h"
+#include "graphics/gsquare.h"
+#include "graphics/gstage.h"
+#include "graphics/gxform.h"
+#include "utils/misc.h"
+
+using namespace std;
+
+namespace
+{
+	// Fraction of the agent body (agent.obj) that is the nose, and the
+	// body's half-width at its front relative to its back.
+	const float NoseFraction = 0.125;
+	const float FrontWidthFraction = 0.5;
+
+	// Per-thread scratch, so render() can run concurrently.
+	thread_local vector<int> tlsVisibleObjects;
+
+	inline float angleXZ( const float *dir )
+	{
+		// Same convention as frustumXZ and gobject yaw
+		return atan2( -dir[0], -dir[2] );
+	}
+}
+
+//===========================================================================
+// RayCastAgentPovRenderer
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::RayCastAgentPovRenderer
+//---------------------------------------------------------------------------
+RayCastAgentPovRenderer::RayCastAgentPovRenderer( gstage *stage,
+                                                  bool staticTimestepGeometry,
+                                                  int retinaWidth,
+                                                  int retinaHeight )
+: fStage( stage )
+, fStaticTimestepGeometry( staticTimestepGeometry )
+, fRetinaWidth( retinaWidth )
+, fRetinaHeight( retinaHeight )
+{
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::~RayCastAgentPovRenderer
+//---------------------------------------------------------------------------
+RayCastAgentPovRenderer::~RayCastAgentPovRenderer()
+{
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::add
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::add( agent *a )
+{
+	// no per-agent state
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::remove
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::remove( agent *a )
+{
+	// no per-agent state
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::beginStep
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::beginStep()
+{
+	if( fStaticTimestepGeometry )
+		compile( fWorld );
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::render
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::render( agent *a )
+{
+	if( fStaticTimestepGeometry )
+	{
+		cast( a, fWorld );
+	}
+	else
+	{
+		// The world changes as each agent is processed.
+		thread_local World world;
+		compile( world );
+		cast( a, world );
+	}
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::endStep
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::endStep()
+{
+	fWorld.clear();
+
+	renderComplete();
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::isThreadSafe
+//---------------------------------------------------------------------------
+bool RayCastAgentPovRenderer::isThreadSafe()
+{
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::World::clear
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::World::clear()
+{
+	objects.clear();
+	maxRadius = 0.0;
+	walls.clear();
+	grounds.clear();
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::compile
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::compile( World &world )
+{
+	world.clear();
+
+	// ---
+	// --- Agents, food, and bricks
+	// ---
+	// These are the same objects as in objectxsortedlist::gXSortedObjects,
+	// but we can't use its cursor, since render() may be invoked from
+	// within a loop over that list (see TSimulation::UpdateAgents()).
+	for( gobject *obj : *fStage->GetCast() )
+	{
+		World::Object object;
+		float lx, ly, lz;
+
+		object.agentShape = obj->getType() == AGENTTYPE;
+		object.color[0] = object.noseColor[0] = obj->GetRed();
+		object.color[1] = object.noseColor[1] = obj->GetGreen();
+		object.color[2] = object.noseColor[2] = obj->GetBlue();
+
+		if( object.agentShape )
+		{
+			agent *a = dynamic_cast<agent *>( obj );
+			lx = a->lx();
+			ly = a->ly();
+			lz = a->lz();
+			if( agent::config.noseColor != agent::NC_BODY )
+			{
+				for( int i = 0; i < 3; i++ )
+					object.noseColor[i] = a->GetNoseColor()[i];
+			}
+		}
+		else
+		{
+			gbox *box = dynamic_cast<gbox *>( obj );
+			assert( box );
+			lx = box->lx();
+			ly = box->ly();
+			lz = box->lz();
+		}
+
+		object.x = obj->x();
+		object.z = obj->z();
+		object.ymin = obj->y() - 0.5 * ly * obj->scale();
+		object.ymax = obj->y() + 0.5 * ly * obj->scale();
+		object.cosYaw = cos( obj->yaw() * DEGTORAD );
+		object.sinYaw = sin( obj->yaw() * DEGTORAD );
+		object.halfLengthX = 0.5 * lx * obj->scale();
+		object.halfLengthZ = 0.5 * lz * obj->scale();
+		object.radius = sqrt( object.halfLengthX * object.halfLengthX + object.halfLengthZ * object.halfLengthZ );
+
+		world.maxRadius = fmax( world.maxRadius, object.radius );
+		world.objects.push_back( object );
+	}
+
+	// Sort by x, like gXSortedObjects, so we can find nearby objects quickly.
+	stable_sort( world.objects.begin(), world.objects.end(),
+				 []( const World::Object &a, const World::Object &b ) { return a.x < b.x; } );
+
+	// ---
+	// --- Barriers and ground
+	// ---
+	if( fStage->GetSet() )
+	{
+		for( gobject *obj : *fStage->GetSet() )
+		{
+			gxform xform;
+			xform.position( obj );
+			xform.scale( obj->scale(), obj->scale(), obj->scale() );
+
+			if( barrier *b = dynamic_cast<barrier *>(obj) )
+			{
+				// See barrier::updateVertices()
+				const float *v = b->vertices();
+				float va[3], vb[3];
+				xform.apply( v + 0, va );
+				xform.apply( v + 6, vb );
+
+				World::Wall wall;
+				wall.xa = va[0];
+				wall.za = va[2];
+				wall.xb = vb[0];
+				wall.zb = vb[2];
+				wall.ymin = fmin( va[1], vb[1] );
+				wall.ymax = fmax( va[1], vb[1] );
+				wall.color[0] = b->GetRed();
+				wall.color[1] = b->GetGreen();
+				wall.color[2] = b->GetBlue();
+				world.walls.push_back( wall );
+			}
+			else if( gpolyobj *polyobj = dynamic_cast<gpolyobj *>(obj) )
+			{
+				// The ground is made of horizontal rectangles.
+				for( long i = 0; i < polyobj->numPolygons(); i++ )
+				{
+					const opoly *p = polyobj->polygon( i );
+					World::Ground ground;
+					ground.xmin = ground.zmin = FLT_MAX;
+					ground.xmax = ground.zmax = -FLT_MAX;
+					for( long j = 0; j < p->fNumPoints; j++ )
+					{
+						float v[3];
+						xform.apply( p->fVertices + j * 3, v );
+						ground.y = v[1];
+						ground.xmin = fmin( ground.xmin, v[0] );
+						ground.xmax = fmax( ground.xmax, v[0] );
+						ground.zmin = fmin( ground.zmin, v[2] );
+						ground.zmax = fmax( ground.zmax, v[2] );
+					}
+					ground.color[0] = obj->GetRed();
+					ground.color[1] = obj->GetGreen();
+					ground.color[2] = obj->GetBlue();
+					world.grounds.push_back( ground );
+				}
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// RayCastAgentPovRenderer::cast
+//
+// The ray for each column passes through the center of the pixel that
+// Retina::updateBuffer() would have read back. Its parameter is scaled so
+// that it measures eye depth, like the GL depth and fog computations.
+//---------------------------------------------------------------------------
+void RayCastAgentPovRenderer::cast( agent *a, const World &world )
+{
+	gcamera &camera = a->getCamera();
+
+	gxform view;
+	view.view( &camera, a );
+	gxform eyeToWorld = view.inverse();
+	const float eye[3] = { eyeToWorld.m[0][3], eyeToWorld.m[1][3], eyeToWorld.m[2][3] };
+
+	// gluPerspective()
+	const float fy = 1.0f / tan( 0.5f * camera.GetFOV() * DEGTORAD );
+	const float fx = fy / camera.GetAspect();
+	const float zNear = camera.GetNear();
+	const float maxDepth = camera.GetVisibleDistance();
+
+	const int width = fRetinaWidth;
+	const float row = 2.0f * ((fRetinaHeight / 2) + 0.5f) / fRetinaHeight - 1.0f;
+
+	auto rayDir = [&]( float xndc, float *dir )
+		{
+			const float d[3] = { xndc / fx, row / fy, -1.0f };
+			eyeToWorld.applyrotation( d, dir );
+		};
+
+	// ---
+	// --- Find candidate objects
+	// ---
+	// The agent's own frustum is centered on its body and doesn't account
+	// for the vision yaw/pitch outputs, so build one for the actual rays.
+	vector<int> &visible = tlsVisibleObjects;
+	visible.clear();
+	{
+		float left[3], center[3], right[3];
+		rayDir( -1.0f, left );
+		rayDir( 0.0f, center );
+		rayDir( 1.0f, right );
+
+		const float angCenter = angleXZ( center );
+		auto angDiff = [angCenter]( float ang )
+			{
+				float diff = fmod( ang - angCenter, TWOPI );
+				if( diff > PI ) diff -= TWOPI;
+				if( diff < -PI ) diff += TWOPI;
+				return fabs( diff );
+			};
+		const float halfFov = fmax( angDiff(angleXZ(left)), angDiff(angleXZ(right)) );
+		const bool useFrustum = (halfFov > 0.0f) && (halfFov < 0.5 * PI)
+			&& (center[0] * center[0] + center[2] * center[2] > 0.0f);
+
+		frustumXZ frustum;
+		if( useFrustum )
+			frustum.Set( eye[0], eye[2], angCenter * RADTODEG, 2.0f * halfFov * RADTODEG, world.maxRadius );
+
+		const float reach = maxDepth * sqrt( 1.0f + 1.0f / (fx * fx) + (row * row) / (fy * fy) ) + world.maxRadius;
+		World::Object key;
+		key.x = eye[0] - reach;
+		auto it = lower_bound( world.objects.begin(), world.objects.end(), key,
+							   []( const World::Object &a, const World::Object &b ) { return a.x < b.x; } );
+		for( ; (it != world.objects.end()) && (it->x <= eye[0] + reach); ++it )
+		{
+			const float dx = it->x - eye[0];
+			const float dz = it->z - eye[2];
+			if( sqrt(dx * dx + dz * dz) - it->radius > reach )
+				continue;
+
+			float p[3] = { it->x, 0.0f, it->z };
+			if( useFrustum && !frustum.Inside(p) )
+				continue;
+
+			visible.push_back( int(it - world.objects.begin()) );
+		}
+	}
+
+	// ---
+	// --- Cast a ray for each column
+	// ---
+	unsigned char *buf = a->GetRetina()->getWritableBuffer();
+
+	for( int col = 0; col < width; col++ )
+	{
+		float dir[3];
+		rayDir( 2.0f * (col + 0.5f) / width - 1.0f, dir );
+
+		float tbest = maxDepth;
+		const float *color = NULL;
+
+		// Agents, food, and bricks, as vertical prisms.
+		for( int index : visible )
+		{
+			const World::Object &object = world.objects[index];
+
+			// Into the object's frame (undo its yaw)
+			const float px = eye[0] - object.x;
+			const float pz = eye[2] - object.z;
+			const float o[3] = { object.cosYaw * px - object.sinYaw * pz,
+								 eye[1],
+								 object.sinYaw * px + object.cosYaw * pz };
+			const float d[3] = { object.cosYaw * dir[0] - object.sinYaw * dir[2],
+								 dir[1],
+								 object.sinYaw * dir[0] + object.cosYaw * dir[2] };
+
+			const float hx = object.halfLengthX;
+			const float hz = object.halfLengthZ;
+			// For agents the half-width tapers from hx at the back (+z) to
+			// FrontWidthFraction * hx at the front (-z).
+			const float taper = object.agentShape ? 0.5f * (1.0f - FrontWidthFraction) * hx / hz : 0.0f;
+			const float hxmid = object.agentShape ? 0.5f * (1.0f + FrontWidthFraction) * hx : hx;
+
+			// Half-spaces a.p <= b
+			const float planes[6][4] = { {  1.0f,  0.0f,  -taper, hxmid },
+										 { -1.0f,  0.0f,  -taper, hxmid },
+										 {  0.0f,  0.0f,   1.0f,  hz },
+										 {  0.0f,  0.0f,  -1.0f,  hz },
+										 {  0.0f,  1.0f,   0.0f,  object.ymax },
+										 {  0.0f, -1.0f,   0.0f,  -object.ymin } };
+
+			float tenter = -FLT_MAX;
+			float texit = FLT_MAX;
+			bool miss = false;
+			for( int i = 0; i < 6; i++ )
+			{
+				const float *pl = planes[i];
+				const float num = pl[3] - (pl[0] * o[0] + pl[1] * o[1] + pl[2] * o[2]);
+				const float den = pl[0] * d[0] + pl[1] * d[1] + pl[2] * d[2];
+				if( den == 0.0f )
+				{
+					if( num < 0.0f )
+					{
+						miss = true;
+						break;
+					}
+				}
+				else if( den < 0.0f )
+					tenter = fmax( tenter, num / den );
+				else
+					texit = fmin( texit, num / den );
+			}
+			if( miss || (tenter > texit) )
+				continue;
+
+			// If the eye is inside the object, we see its far side
+			const float t = tenter >= zNear ? tenter : texit;
+			if( (t < zNear) || (t >= tbest) )
+				continue;
+
+			tbest = t;
+			color = object.color;
+			if( object.agentShape && (o[2] + t * d[2] < -(1.0f - 2.0f * NoseFraction) * hz) )
+				color = object.noseColor;
+		}
+
+		// Barriers
+		for( const World::Wall &wall : world.walls )
+		{
+			const float ex = wall.xb - wall.xa;
+			const float ez = wall.zb - wall.za;
+			const float den = dir[0] * ez - dir[2] * ex;
+			if( den == 0.0f )
+				continue;
+			const float wx = wall.xa - eye[0];
+			const float wz = wall.za - eye[2];
+			const float t = (wx * ez - wz * ex) / den;
+			const float u = (wx * dir[2] - wz * dir[0]) / den;
+			if( (u < 0.0f) || (u > 1.0f) || (t < zNear) || (t >= tbest) )
+				continue;
+			const float y = eye[1] + t * dir[1];
+			if( (y < wall.ymin) || (y > wall.ymax) )
+				continue;
+
+			tbest = t;
+			color = wall.color;
+		}
+
+		// Ground
+		if( dir[1] != 0.0f )
+		{
+			for( const World::Ground &ground : world.grounds )
+			{
+				const float t = (ground.y - eye[1]) / dir[1];
+				if( (t < zNear) || (t >= tbest) )
+					continue;
+				const float x = eye[0] + t * dir[0];
+				const float z = eye[2] + t * dir[2];
+				if( (x < ground.xmin) || (x > ground.xmax) || (z < ground.zmin) || (z > ground.zmax) )
+					continue;
+
+				tbest = t;
+				color = ground.color;
+			}
+		}
+
+		unsigned char *pixel = buf + col * 4;
+		if( color )
+		{
+			const float f = camera.GetFogFactor( tbest );
+			for( int j = 0; j < 3; j++ )
+				pixel[j] = (unsigned char)(clamp(color[j] * f, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+		else
+		{
+			pixel[0] = pixel[1] = pixel[2] = 0;
+		}
+		pixel[3] = 255;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+#include "agent/AgentPovRenderer.h"
+
+//===========================================================================
+// RayCastAgentPovRenderer
+//
+// Computes each retina column analytically, by casting one ray per column
+// against the objects near the agent, rather than rasterizing the stage.
+// Objects are modeled as vertical prisms: boxes for food and bricks, the
+// tapered agent body (with its nose) for agents, and walls for barriers.
+// Nearby objects are found from an x-sorted snapshot of the stage cast (as
+// in objectxsortedlist) and culled with a frustumXZ.
+//
+// Cost is O(visible objects x retinaWidth) per agent, and render() may be
+// invoked concurrently for different agents.
+//===========================================================================
+class RayCastAgentPovRenderer : public AgentPovRenderer
+{
+ public:
+	RayCastAgentPovRenderer( class gstage *stage,
+	                         bool staticTimestepGeometry,
+	                         int retinaWidth,
+	                         int retinaHeight );
+	virtual ~RayCastAgentPovRenderer();
+
+	virtual void add( class agent *a ) override;
+	virtual void remove( class agent *a ) override;
+
+	virtual void beginStep() override;
+	virtual void render( class agent *a ) override;
+	virtual void endStep() override;
+
+	virtual bool isThreadSafe() override;
+
+ private:
+	struct World
+	{
+		struct Object
+		{
+			float x;
+			float z;
+			float ymin;
+			float ymax;
+			float cosYaw;
+			float sinYaw;
+			float halfLengthX;
+			float halfLengthZ;
+			float radius;
+			bool agentShape;
+			float color[3];
+			float noseColor[3];
+		};
+		struct Wall
+		{
+			float xa, za;
+			float xb, zb;
+			float ymin;
+			float ymax;
+			float color[3];
+		};
+		struct Ground
+		{
+			float y;
+			float xmin, xmax;
+			float zmin, zmax;
+			float color[3];
+		};
+
+		// sorted by x
+		std::vector<Object> objects;
+		float maxRadius;
+		std::vector<Wall> walls;
+		std::vector<Ground> grounds;
+
+		void clear();
+	};
+
+	void compile( World &world );
+	void cast( class agent *a, const World &world );
+
+	class gstage *fStage;
+	bool fStaticTimestepGeometry;
+	int fRetinaWidth;
+	int fRetinaHeight;
+	// Only valid during a step when fStaticTimestepGeometry.
+	World fWorld;
+};
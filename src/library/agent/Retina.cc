@@ -89,11 +89,11 @@ void Retina::sensor_update( bool bprint )
 	)
 }
 
-void Retina::sensor_start_functional( AbstractFile *f )
+void Retina::sensor_start_functional( std::string &organs )
 {
 	for( int i = 0; i < 3; i++ )
 	{
-		channels[i].start_functional( f );
+		channels[i].start_functional( organs );
 	}
 }
 
@@ -150,6 +150,11 @@ const unsigned char *Retina::getBuffer()
 	return buf;
 }
 
+unsigned char *Retina::getWritableBuffer()
+{
+	return buf;
+}
+
 void Retina::Channel::init( Retina *retina,
 							NervousSystem *cns,
 							int index,
@@ -250,11 +255,13 @@ void Retina::Channel::update( bool bprint )
 #endif
 }
 
-void Retina::Channel::start_functional( AbstractFile *f )
+void Retina::Channel::start_functional( std::string &organs )
 {
 	int i = nerve->getIndex();
 
-	f->printf( " %d-%d", i, i + numneurons - 1 );
+	char buf[64];
+	sprintf( buf, " %d-%d", i, i + numneurons - 1 );
+	organs += buf;
 }
 
 void Retina::Channel::dump_anatomical( AbstractFile *f )
@@ -16,12 +16,14 @@ class Retina : public Sensor
 	virtual void sensor_grow( NervousSystem *cns );
 	virtual void sensor_prebirth_signal( RandomNumberGenerator *rng );
 	virtual void sensor_update( bool print );
-	virtual void sensor_start_functional( AbstractFile *f );
+	virtual void sensor_start_functional( std::string &organs );
 	virtual void sensor_dump_anatomical( AbstractFile *f );
 
 	void updateBuffer( short x, short y, short width, short height );
 
 	const unsigned char *getBuffer();
+	// For renderers that fill the buffer directly rather than via updateBuffer()
+	unsigned char *getWritableBuffer();
 
  private:
 	int width;
@@ -49,7 +51,7 @@ class Retina : public Sensor
 
 		void update( bool print );
 
-		void start_functional( AbstractFile *f );
+		void start_functional( std::string &organs );
 		void dump_anatomical( AbstractFile *f );
 
 	} channels[3];
@@ -0,0 +1,391 @@
+// Self
+#include "SoftwareAgentPovRenderer.h"
+
+// System
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Local
+#include "agent/agent.h"
+#include "agent/Retina.h"
+#include "graphics/gcamera.h"
+#include "graphics/gpolygon.h"
+#include "graphics/gsquare.h"
+#include "graphics/gstage.h"
+#include "graphics/gxform.h"
+#include "utils/misc.h"
+
+using namespace std;
+
+namespace
+{
+	// Same as drawunitcube() in gmisc.cc
+	const float UnitCube[8][3] = { {-0.5, -0.5, -0.5},
+	                               {-0.5, -0.5,  0.5},
+	                               {-0.5,  0.5, -0.5},
+	                               {-0.5,  0.5,  0.5},
+	                               { 0.5, -0.5, -0.5},
+	                               { 0.5, -0.5,  0.5},
+	                               { 0.5,  0.5, -0.5},
+	                               { 0.5,  0.5,  0.5} };
+	const int UnitCubeFaces[6][4] = { {0, 1, 3, 2},
+	                                  {0, 4, 5, 1},
+	                                  {4, 6, 7, 5},
+	                                  {2, 3, 7, 6},
+	                                  {5, 7, 3, 1},
+	                                  {0, 2, 6, 4} };
+
+	// Per-thread scratch, so render() can run concurrently.
+	thread_local vector<float> tlsDepth;
+	thread_local vector<float> tlsEyeVertices;
+}
+
+//===========================================================================
+// SoftwareAgentPovRenderer
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::SoftwareAgentPovRenderer
+//---------------------------------------------------------------------------
+SoftwareAgentPovRenderer::SoftwareAgentPovRenderer( gstage *stage,
+                                                    bool staticTimestepGeometry,
+                                                    int retinaWidth,
+                                                    int retinaHeight )
+: fStage( stage )
+, fStaticTimestepGeometry( staticTimestepGeometry )
+, fRetinaWidth( retinaWidth )
+, fRetinaHeight( retinaHeight )
+{
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::~SoftwareAgentPovRenderer
+//---------------------------------------------------------------------------
+SoftwareAgentPovRenderer::~SoftwareAgentPovRenderer()
+{
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::add
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::add( agent *a )
+{
+	// no per-agent state
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::remove
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::remove( agent *a )
+{
+	// no per-agent state
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::beginStep
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::beginStep()
+{
+	// With static timestep geometry nothing moves until all agents have
+	// seen the world, so we can snapshot it once for the whole step, which
+	// plays the role of gstage::Compile() for the GL renderer.
+	if( fStaticTimestepGeometry )
+		compile( fGeometry );
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::render
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::render( agent *a )
+{
+	if( fStaticTimestepGeometry )
+	{
+		rasterize( a, fGeometry );
+	}
+	else
+	{
+		// The world changes as each agent is processed, so we have to
+		// look at it fresh every time.
+		thread_local Geometry geom;
+		compile( geom );
+		rasterize( a, geom );
+	}
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::endStep
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::endStep()
+{
+	fGeometry.clear();
+
+	renderComplete();
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::isThreadSafe
+//---------------------------------------------------------------------------
+bool SoftwareAgentPovRenderer::isThreadSafe()
+{
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::Geometry::clear
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::Geometry::clear()
+{
+	vertices.clear();
+	polygons.clear();
+	objects.clear();
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::compile
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::compile( Geometry &geom )
+{
+	geom.clear();
+
+	// Same order as gstage::Draw(), which matters for depth ties.
+	if( fStage->GetSet() )
+	{
+		for( gobject *obj : *fStage->GetSet() )
+			compileObject( geom, obj );
+	}
+	if( fStage->GetCast() )
+	{
+		for( gobject *obj : *fStage->GetCast() )
+			compileObject( geom, obj );
+	}
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::compileObject
+//
+// Mirrors the draw() methods of the object classes that can be on stage.
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::compileObject( Geometry &geom, gobject *obj )
+{
+	Geometry::Object object;
+	object.firstPolygon = (int)geom.polygons.size();
+
+	int firstVertex = (int)geom.vertices.size();
+	gxform xform;
+	xform.position( obj );
+
+	const float color[3] = { obj->GetRed(), obj->GetGreen(), obj->GetBlue() };
+
+	auto addPolygon = [&geom, &xform]( const float *color, const float *vertices, long numVertices, const int *indices )
+		{
+			Geometry::Polygon poly;
+			poly.color[0] = color[0];
+			poly.color[1] = color[1];
+			poly.color[2] = color[2];
+			poly.firstVertex = (int)geom.vertices.size() / 3;
+			poly.numVertices = (int)numVertices;
+			for( long i = 0; i < numVertices; i++ )
+			{
+				float v[3];
+				xform.apply( vertices + 3 * (indices ? indices[i] : i), v );
+				geom.vertices.push_back( v[0] );
+				geom.vertices.push_back( v[1] );
+				geom.vertices.push_back( v[2] );
+			}
+			geom.polygons.push_back( poly );
+		};
+
+	if( gpolyobj *polyobj = dynamic_cast<gpolyobj *>(obj) )
+	{
+		xform.scale( obj->scale(), obj->scale(), obj->scale() );
+
+		const float *noseColor = color;
+		agent *a = dynamic_cast<agent *>( obj );
+		if( a && (agent::config.noseColor != agent::NC_BODY) )
+			noseColor = a->GetNoseColor();
+
+		for( long i = 0; i < polyobj->numPolygons(); i++ )
+		{
+			const opoly *p = polyobj->polygon( i );
+			addPolygon( (a && i < 5) ? noseColor : color, p->fVertices, p->fNumPoints, NULL );
+		}
+	}
+	else if( gbox *box = dynamic_cast<gbox *>(obj) )
+	{
+		xform.scale( obj->scale() * box->lx(), obj->scale() * box->ly(), obj->scale() * box->lz() );
+
+		for( int i = 0; i < 6; i++ )
+			addPolygon( color, &UnitCube[0][0], 4, UnitCubeFaces[i] );
+	}
+	else if( gpoly *poly = dynamic_cast<gpoly *>(obj) )
+	{
+		xform.scale( obj->scale(), obj->scale(), obj->scale() );
+
+		addPolygon( color, poly->vertices(), poly->numPoints(), NULL );
+	}
+	else
+	{
+		assert( false );
+	}
+
+	object.numPolygons = (int)geom.polygons.size() - object.firstPolygon;
+	if( object.numPolygons == 0 )
+		return;
+
+	// Bounding sphere, for culling.
+	int endVertex = (int)geom.vertices.size();
+	float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for( int i = firstVertex; i < endVertex; i += 3 )
+	{
+		for( int j = 0; j < 3; j++ )
+		{
+			lo[j] = fmin( lo[j], geom.vertices[i + j] );
+			hi[j] = fmax( hi[j], geom.vertices[i + j] );
+		}
+	}
+	for( int j = 0; j < 3; j++ )
+		object.center[j] = 0.5f * (lo[j] + hi[j]);
+	object.radius = 0.5f * sqrt( (hi[0] - lo[0]) * (hi[0] - lo[0])
+	                             + (hi[1] - lo[1]) * (hi[1] - lo[1])
+	                             + (hi[2] - lo[2]) * (hi[2] - lo[2]) );
+
+	geom.objects.push_back( object );
+}
+
+//---------------------------------------------------------------------------
+// SoftwareAgentPovRenderer::rasterize
+//
+// Retina::updateBuffer() only reads back the middle row of the viewport,
+// so that's the only row we produce. The plane through the eye and that
+// row of pixel centers cuts each (convex) polygon in a segment, which is
+// then projected and scan converted with perspective-correct depth.
+//---------------------------------------------------------------------------
+void SoftwareAgentPovRenderer::rasterize( agent *a, const Geometry &geom )
+{
+	gcamera &camera = a->getCamera();
+
+	gxform view;
+	view.view( &camera, a );
+
+	// gluPerspective()
+	const float fy = 1.0f / tan( 0.5f * camera.GetFOV() * DEGTORAD );
+	const float fx = fy / camera.GetAspect();
+	const float zNear = camera.GetNear();
+	const float zFar = camera.GetFar();
+
+	// y of the sampled row's pixel centers in normalized device coordinates
+	const int width = fRetinaWidth;
+	const float row = 2.0f * ((fRetinaHeight / 2) + 0.5f) / fRetinaHeight - 1.0f;
+
+	// Culling planes through the eye, as (y,z) and (x,z) normals
+	const float rowNorm = sqrt( fy * fy + row * row );
+	const float sideNorm = sqrt( fx * fx + 1.0f );
+
+	vector<float> &depth = tlsDepth;
+	vector<float> &eye = tlsEyeVertices;
+	depth.assign( width, FLT_MAX );
+
+	// glClearColor( 0, 0, 0, 1 )
+	unsigned char *buf = a->GetRetina()->getWritableBuffer();
+	for( int i = 0; i < width; i++ )
+	{
+		buf[i * 4 + 0] = 0;
+		buf[i * 4 + 1] = 0;
+		buf[i * 4 + 2] = 0;
+		buf[i * 4 + 3] = 255;
+	}
+
+	for( const Geometry::Object &object : geom.objects )
+	{
+		float c[3];
+		view.apply( object.center, c );
+		float r = object.radius;
+
+		if( (c[2] - r > -zNear)
+			|| (-c[2] - r > zFar)
+			|| (fabs(fy * c[1] + row * c[2]) > r * rowNorm)
+			|| (fx * c[0] + c[2] > r * sideNorm)
+			|| (-fx * c[0] + c[2] > r * sideNorm) )
+		{
+			continue;
+		}
+
+		for( int ipoly = object.firstPolygon; ipoly < object.firstPolygon + object.numPolygons; ipoly++ )
+		{
+			const Geometry::Polygon &poly = geom.polygons[ipoly];
+			const int n = poly.numVertices;
+
+			eye.resize( n * 4 );
+			for( int i = 0; i < n; i++ )
+			{
+				float *v = &eye[i * 4];
+				view.apply( &geom.vertices[(poly.firstVertex + i) * 3], v );
+				// signed distance from the row plane
+				v[3] = fy * v[1] + row * v[2];
+			}
+
+			// Find where the polygon crosses the row plane.
+			float seg[2][3];
+			int ncross = 0;
+			for( int i = 0; (i < n) && (ncross < 2); i++ )
+			{
+				const float *v0 = &eye[i * 4];
+				const float *v1 = &eye[((i + 1) % n) * 4];
+				if( (v0[3] >= 0.0f) == (v1[3] >= 0.0f) )
+					continue;
+				float t = v0[3] / (v0[3] - v1[3]);
+				for( int j = 0; j < 3; j++ )
+					seg[ncross][j] = v0[j] + t * (v1[j] - v0[j]);
+				ncross++;
+			}
+			if( ncross < 2 )
+				continue;
+
+			// Clip to the near plane.
+			float *p0 = seg[0];
+			float *p1 = seg[1];
+			if( p0[2] > -zNear && p1[2] > -zNear )
+				continue;
+			if( p0[2] > -zNear || p1[2] > -zNear )
+			{
+				float *pin = p0[2] > -zNear ? p1 : p0;
+				float *pout = p0[2] > -zNear ? p0 : p1;
+				float t = (-zNear - pin[2]) / (pout[2] - pin[2]);
+				for( int j = 0; j < 3; j++ )
+					pout[j] = pin[j] + t * (pout[j] - pin[j]);
+			}
+
+			// Project to window x, keeping 1/w for perspective-correct depth.
+			float w0 = 1.0f / -p0[2];
+			float w1 = 1.0f / -p1[2];
+			float x0 = 0.5f * width * (fx * p0[0] * w0 + 1.0f);
+			float x1 = 0.5f * width * (fx * p1[0] * w1 + 1.0f);
+			if( x0 > x1 )
+			{
+				swap( x0, x1 );
+				swap( w0, w1 );
+			}
+			if( x1 - x0 <= 0.0f )
+				continue;
+
+			int ibegin = max( 0, (int)ceil(x0 - 0.5f) );
+			int iend = min( width, (int)ceil(x1 - 0.5f) );
+			for( int i = ibegin; i < iend; i++ )
+			{
+				float t = (i + 0.5f - x0) / (x1 - x0);
+				float d = 1.0f / (w0 + t * (w1 - w0));
+				if( (d >= depth[i]) || (d > zFar) )
+					continue;
+				depth[i] = d;
+
+				float f = camera.GetFogFactor( d );
+
+				for( int j = 0; j < 3; j++ )
+					buf[i * 4 + j] = (unsigned char)(clamp(poly.color[j] * f, 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "agent/AgentPovRenderer.h"
+
+//===========================================================================
+// SoftwareAgentPovRenderer
+//
+// Renders agent POVs on the CPU, without any GL context, so that headless
+// runs don't require a GPU. Only the single row of pixels that the retina
+// actually samples is rasterized. The output matches the GL renderer: flat
+// colored polygons, depth tested, with the camera's fog applied.
+//
+// Since no shared GL state is involved, render() may be invoked
+// concurrently for different agents.
+//===========================================================================
+class SoftwareAgentPovRenderer : public AgentPovRenderer
+{
+ public:
+	SoftwareAgentPovRenderer( class gstage *stage,
+	                          bool staticTimestepGeometry,
+	                          int retinaWidth,
+	                          int retinaHeight );
+	virtual ~SoftwareAgentPovRenderer();
+
+	virtual void add( class agent *a ) override;
+	virtual void remove( class agent *a ) override;
+
+	virtual void beginStep() override;
+	virtual void render( class agent *a ) override;
+	virtual void endStep() override;
+
+	virtual bool isThreadSafe() override;
+
+ private:
+	// World-space snapshot of everything on the stage.
+	struct Geometry
+	{
+		struct Polygon
+		{
+			float color[3];
+			int firstVertex;
+			int numVertices;
+		};
+		struct Object
+		{
+			float center[3];
+			float radius;
+			int firstPolygon;
+			int numPolygons;
+		};
+
+		std::vector<float> vertices;
+		std::vector<Polygon> polygons;
+		std::vector<Object> objects;
+
+		void clear();
+	};
+
+	void compile( Geometry &geom );
+	void compileObject( Geometry &geom, class gobject *obj );
+	void rasterize( class agent *a, const Geometry &geom );
+
+	class gstage *fStage;
+	bool fStaticTimestepGeometry;
+	int fRetinaWidth;
+	int fRetinaHeight;
+	// Only valid during a step when fStaticTimestepGeometry.
+	Geometry fGeometry;
+};
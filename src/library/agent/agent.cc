@@ -33,10 +33,12 @@
 #include "sim/globals.h"
 #include "sim/Simulation.h"
 #include "utils/AbstractFile.h"
+#include "utils/CheckPoint.h"
 #include "utils/datalib.h"
 #include "utils/graybin.h"
 #include "utils/misc.h"
 #include "utils/RandomNumberGenerator.h"
+#include "utils/RandomStream.h"
 #include "utils/Resources.h"
 
 using namespace genome;
@@ -265,6 +267,8 @@ agent::agent(TSimulation* sim, gstage* stage)
 	fVelocity[1] = 0.0;
 	fVelocity[2] = 0.0;
 
+	fBody.pending = false;
+
 	fSpeed = 0.0;
 	fMaxSpeed = 0.0;
 	fLastEat = 0;
@@ -413,6 +417,27 @@ void agent::agentload(istream&)
 }
 
 
+//---------------------------------------------------------------------------
+// agent::agentdump
+//---------------------------------------------------------------------------
+void agent::agentdump(CheckPointWriter& out)
+{
+	out.put( agent::agentsEver );
+}
+
+
+//---------------------------------------------------------------------------
+// agent::agentload
+//
+// Agents restored before this is called are numbered from their own saved
+// state, not from agentsEver.
+//---------------------------------------------------------------------------
+void agent::agentload(CheckPointReader& in)
+{
+	in.get( agent::agentsEver );
+}
+
+
 //---------------------------------------------------------------------------
 // agent::dump
 //---------------------------------------------------------------------------
@@ -489,6 +514,101 @@ void agent::load(istream& in)
     fDomain = fSimulation->WhichDomain(fPosition[0], fPosition[2], 0);
 }
 
+//---------------------------------------------------------------------------
+// agent::dump
+//
+// The agent is saved as its genome plus everything that has changed since it
+// was grown from it, so load() can grow it again and then overwrite that
+// state.
+//---------------------------------------------------------------------------
+void agent::dump(CheckPointWriter& out)
+{
+	out.put( getTypeNumber() );
+	out.put( fIsSeed );
+	fGenome->dump( out );
+	out.put( (int32_t)fMetabolism->index );
+
+	gobject::dump( out );
+	out.put( (int64_t)fAge );
+	out.put( (int64_t)fLastMate );
+	out.put( (int64_t)fLastEat );
+	out.putArray( fLastEatPosition, 3 );
+	out.put( fLastEatEnergy );
+	out.put( fLastEatEnergyRaw );
+	out.put( fLifeSpan );
+	out.put( fDeathByPatch );
+	out.put( fEnergy );
+	out.put( fFoodEnergy );
+	out.put( fMaxEnergy );
+	out.put( fStarvationFoodEnergy );
+	out.put( fSpeed2Energy );
+	out.put( fYaw2Energy );
+	out.put( fSizeAdvantage );
+	out.put( fMass );
+	out.putArray( fLastPosition, 3 );
+	out.putArray( fVelocity, 3 );
+	out.putArray( fNoseColor, 3 );
+	out.put( fSpeed );
+	out.put( fMaxSpeed );
+	out.put( fHeuristicFitness );
+	out.put( fComplexity );
+	out.put( fDomain );
+	out.put( fCarryRadius );
+
+	fCns->getBrain()->dumpState( out );
+	fCns->getRNG()->dump( out );
+}
+
+
+//---------------------------------------------------------------------------
+// agent::load
+//
+// For an agent fresh from getfreeagent().
+//---------------------------------------------------------------------------
+void agent::load(CheckPointReader& in, long mateWait)
+{
+	setTypeNumber( in.get<unsigned long>() );
+	bool isSeed = in.get<bool>();
+	fGenome->load( in );
+	setGenomeReady();
+	fMetabolism = Metabolism::get( in.get<int32_t>() );
+
+	grow( mateWait, isSeed );
+
+	gobject::load( in );
+	fAge = in.get<int64_t>();
+	fLastMate = in.get<int64_t>();
+	fLastEat = in.get<int64_t>();
+	in.getArray( fLastEatPosition, 3 );
+	in.get( fLastEatEnergy );
+	in.get( fLastEatEnergyRaw );
+	in.get( fLifeSpan );
+	in.get( fDeathByPatch );
+	in.get( fEnergy );
+	in.get( fFoodEnergy );
+	in.get( fMaxEnergy );
+	in.get( fStarvationFoodEnergy );
+	in.get( fSpeed2Energy );
+	in.get( fYaw2Energy );
+	in.get( fSizeAdvantage );
+	in.get( fMass );
+	in.getArray( fLastPosition, 3 );
+	in.getArray( fVelocity, 3 );
+	in.getArray( fNoseColor, 3 );
+	in.get( fSpeed );
+	in.get( fMaxSpeed );
+	in.get( fHeuristicFitness );
+	in.get( fComplexity );
+	in.get( fDomain );
+	in.get( fCarryRadius );
+
+	fCns->getBrain()->loadState( in );
+	fCns->getRNG()->load( in );
+
+	SetGraphics();
+}
+
+
 //---------------------------------------------------------------------------
 // agent::setGenomeReady
 //---------------------------------------------------------------------------
@@ -515,6 +635,9 @@ void agent::setGenomeReady()
 //---------------------------------------------------------------------------
 void agent::grow( long mateWait, bool seeding )
 {
+	// Agents are grown in parallel, so they mustn't share a random stream
+	RandomStream::Scope randomScope( Number(), fSimulation->getStep(), RandomStream::GROW );
+
 	InitGeneCache();
 
 	// ---
@@ -623,7 +746,7 @@ void agent::grow( long mateWait, bool seeding )
 	switch(agent::config.bodyGreenChannel)
 	{
 	case BGC_ID:
-		fColor[1] = fGenome->get( "ID" );
+		fColor[1] = fGenome->get( fGenome->genes().id );
 		break;
 	case BGC_CONST:
 		fColor[1] = agent::config.bodyGreenChannelConstValue;
@@ -755,6 +878,8 @@ void agent::grow( long mateWait, bool seeding )
 
     fAlive = true;
 
+	fCns->getBrain()->startActivityStatistics( Number() );
+
 	logs->postEvent( AgentGrownEvent(this) );
 }
 
@@ -899,7 +1024,7 @@ Energy agent::mating( float mateFitnessParam, long mateWait, bool lockstep )
 	if( mateWait <= 0 )
 		mateWait = 1;
 
-	Energy mymateenergy = fGenome->get( "MateEnergyFraction" ) * fEnergy;
+	Energy mymateenergy = geneCache.mateEnergyFraction * fEnergy;
 
 	if( !lockstep )
 	{
@@ -971,6 +1096,7 @@ void agent::Die()
     {
         gobject* o = *it;
         o->Dropped();
+        objectxsortedlist::gXSortedObjects.moved( o );
     }
     fCarries.clear();
 
@@ -1039,11 +1165,14 @@ void agent::SetGraphics()
 //---------------------------------------------------------------------------
 void agent::InitGeneCache()
 {
-	geneCache.maxSpeed = fGenome->get("MaxSpeed");
-	geneCache.strength = fGenome->get("Strength");
-	geneCache.size = fGenome->get("Size");
+	const genome::GenomeSchema::Accessors &genes = fGenome->genes();
+
+	geneCache.maxSpeed = fGenome->get( genes.maxSpeed );
+	geneCache.strength = fGenome->get( genes.strength );
+	geneCache.size = fGenome->get( genes.size );
+	geneCache.mateEnergyFraction = fGenome->get( genes.mateEnergyFraction );
 	if( agent::config.dieAtMaxAge )
-		geneCache.lifespan = fGenome->get("LifeSpan");
+		geneCache.lifespan = fGenome->get( genes.lifeSpan );
 	else
 		geneCache.lifespan = INT_MAX;
 }
@@ -1098,7 +1227,42 @@ void agent::UpdateVision()
 //---------------------------------------------------------------------------
 void agent::UpdateBrain()
 {
+	RandomStream::Scope randomScope( Number(), fSimulation->getStep(), RandomStream::BRAIN );
+
 	fCns->update( false );
+	fCns->getBrain()->recordActivity();
+
+	logs->postEvent( BrainUpdatedEvent(this) );
+}
+
+//---------------------------------------------------------------------------
+// agent::BeginUpdateBrain
+//---------------------------------------------------------------------------
+bool agent::BeginUpdateBrain()
+{
+	RandomStream::Scope randomScope( Number(), fSimulation->getStep(), RandomStream::BRAIN );
+
+	if( !fCns->getBrain()->getNeuronModel()->enqueueUpdate() )
+	{
+		fCns->update( false );
+		fCns->getBrain()->recordActivity();
+
+		logs->postEvent( BrainUpdatedEvent(this) );
+
+		return false;
+	}
+
+	fCns->updateSensors( false );
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// agent::EndUpdateBrain
+//---------------------------------------------------------------------------
+void agent::EndUpdateBrain()
+{
+	fCns->getBrain()->recordActivity();
 
 	logs->postEvent( BrainUpdatedEvent(this) );
 }
@@ -1108,15 +1272,31 @@ void agent::UpdateBrain()
 //
 // Return energy consumed
 //---------------------------------------------------------------------------
-const float FF = 1.01;
-
 float agent::UpdateBody( float moveFitnessParam,
 						 float speed2dpos,
 						 int solidObjects,
 						 agent* carrier )
+{
+	BeginUpdateBody();
+
+	return EndUpdateBody( moveFitnessParam, speed2dpos, solidObjects, carrier );
+}
+
+
+//---------------------------------------------------------------------------
+// agent::BeginUpdateBody
+//
+// The first half of UpdateBody(): everything that depends only on this agent
+// (and the barriers), so it may be done for all agents concurrently.  Energy,
+// age, yaw and color are updated, and the position we will move to (if not
+// being carried) is proposed, but not yet taken.  Posts no events.
+//---------------------------------------------------------------------------
+const float FF = 1.01;
+
+void agent::BeginUpdateBody()
 {
     debugcheck( "%lu", Number() );
-	assert( lxor( !BeingCarried(), carrier ) );
+	assert( !fBody.pending );
 
 	// In some simulations, we use a dynamic energy delta to shape difficulty.
 	if( !fMetabolism->energyDelta.isZero() )
@@ -1125,21 +1305,13 @@ float agent::UpdateBody( float moveFitnessParam,
 		fEnergy.constrain( 0, fMaxEnergy );
 	}
 
-	float dx;
-	float dz;
-	float energyUsed = 0;
+	float dx = 0.0;
+	float dz = 0.0;
 
 	// just do x & z dimensions in this version
     SaveLastPosition();
 
-	if( BeingCarried() )  // the agent carrying this agent initiated the update
-	{
-		setx( carrier->x() );
-		setz( carrier->z() );
-		dx = x() - LastX();
-		dz = z() - LastZ();
-	}
-	else  // this is a normal update (the agent is not being carried)
+	if( ! BeingCarried() )  // otherwise the agent carrying this agent moves it
 	{
 	#if TestWorld
 		dx = dz = 0.0;
@@ -1221,15 +1393,18 @@ float agent::UpdateBody( float moveFitnessParam,
     fEnergy -= denergy;
     fFoodEnergy -= denergy;
 
-	energyUsed = denergy;
+	fBody.denergy = denergy;
+	fBody.energyused = energyused;
 
 	UpdateColor();
 
     fAge++;
 
-	bool skipDomainCheck = false;
+	fBody.dx = dx;
+	fBody.dz = dz;
+	fBody.barrierCollisions = 0;
 
-	// Do collision detection for barriers, edges, and solid objects, if not being carried
+	// Do collision detection for barriers, if not being carried
 	if( ! BeingCarried() )
 	{
 		// Do barrier overrun testing here...
@@ -1242,10 +1417,11 @@ float agent::UpdateBody( float moveFitnessParam,
 		// it on the other side or let the carried agent mate with an agent on the
 		// other side.
 
-		barrier* b = NULL;
-		barrier::gXSortedBarriers.reset();
-		while( barrier::gXSortedBarriers.next(b) )
+		// (Don't use the list's cursor, as other agents may be doing this concurrently.)
+		for( gdlink<barrier*> *link = barrier::gXSortedBarriers.firstLink(); link; link = barrier::gXSortedBarriers.nextLink(link) )
 		{
+			barrier* b = link->e;
+
 			if( (b->xmax() > (    x() - FF * CarryRadius())) ||
 				(b->xmax() > (LastX() - FF * CarryRadius())) )
 			{
@@ -1308,11 +1484,73 @@ float agent::UpdateBody( float moveFitnessParam,
 							}
 						}
 
-						logs->postEvent( CollisionEvent(this, OT_BARRIER) );
+						fBody.barrierCollisions++;	// posted by EndUpdateBody()
 					} // overlap in z
 				} // beginning of barrier comes after end of agent
 			} // end of barrier comes after beginning of agent
-		} // while( barrier::gXSortedBarriers.next(b) )
+		} // for each barrier
+	}
+
+	// Propose the new position, but leave everyone where they were at the
+	// start of the step until EndUpdateBody(), so it sees the same world
+	// it would have if we had done the whole update serially.
+	fBody.position[0] = fPosition[0];
+	fBody.position[2] = fPosition[2];
+	fPosition[0] = fLastPosition[0];
+	fPosition[2] = fLastPosition[2];
+
+	fBody.pending = true;
+}
+
+
+//---------------------------------------------------------------------------
+// agent::EndUpdateBody
+//
+// The second half of UpdateBody(): takes the proposed position and resolves
+// collisions with solid objects and edges against the other agents as they
+// are now, so it must be called for one agent at a time, in list order.
+//
+// Return energy consumed
+//---------------------------------------------------------------------------
+float agent::EndUpdateBody( float moveFitnessParam,
+							float speed2dpos,
+							int solidObjects,
+							agent* carrier )
+{
+    debugcheck( "%lu", Number() );
+	assert( lxor( !BeingCarried(), carrier ) );
+	assert( fBody.pending );
+
+	fBody.pending = false;
+
+	float dx;
+	float dz;
+	float energyUsed = fBody.denergy;
+	float denergy = fBody.denergy;
+	float energyused = fBody.energyused;
+
+	if( BeingCarried() )  // the agent carrying this agent initiated the update
+	{
+		setx( carrier->x() );
+		setz( carrier->z() );
+		dx = x() - LastX();
+		dz = z() - LastZ();
+	}
+	else  // this is a normal update (the agent is not being carried)
+	{
+		setx( fBody.position[0] );
+		setz( fBody.position[2] );
+		dx = fBody.dx;
+		dz = fBody.dz;
+	}
+
+	bool skipDomainCheck = false;
+
+	// Do collision detection for edges and solid objects, if not being carried
+	if( ! BeingCarried() )
+	{
+		for( int i = 0; i < fBody.barrierCollisions; i++ )
+			logs->postEvent( CollisionEvent(this, OT_BARRIER) );
 
 		// If there are solid objects besides bricks, or
 		// if only bricks are solid and bricks are present in the simulation...
@@ -1424,6 +1662,9 @@ float agent::UpdateBody( float moveFitnessParam,
         }
     }
 
+	// Keep the grid (if any) up to date with our final position
+	objectxsortedlist::gXSortedObjects.moved( this );
+
 #ifdef OF1
     if( fDomain == 0 )
         myt0++;
@@ -1447,16 +1688,20 @@ float agent::UpdateBody( float moveFitnessParam,
 		switch( carried->getType() )
 		{
 			case AGENTTYPE:
-				energyUsed += ((agent*)carried)->UpdateBody( moveFitnessParam,
-															speed2dpos,
-															solidObjects,
-															this );
+				// carried agents may or may not have begun their update already
+				if( !((agent*)carried)->fBody.pending )
+					((agent*)carried)->BeginUpdateBody();
+				energyUsed += ((agent*)carried)->EndUpdateBody( moveFitnessParam,
+																speed2dpos,
+																solidObjects,
+																this );
 				// carried agent's domain will be taken care of in its UpdateBody() call
 				break;
 
 			case FOODTYPE:
 				carried->setx( x() );
 				carried->setz( z() );
+				objectxsortedlist::gXSortedObjects.moved( carried );
 				fSimulation->SwitchDomain( Domain(), ((food*)carried)->domain(), FOODTYPE );
 				((food*)carried)->domain( Domain() );
 				break;
@@ -1464,6 +1709,7 @@ float agent::UpdateBody( float moveFitnessParam,
 			case BRICKTYPE:
 				carried->setx( x() );
 				carried->setz( z() );
+				objectxsortedlist::gXSortedObjects.moved( carried );
 				// bricks do not currently identify their domain, nor are they counted in domains
 				break;
 
@@ -1521,8 +1767,26 @@ void agent::UpdateColor()
 }
 
 
+#define CollisionRadiusReductionFactor 0.90
+
 void agent::AvoidCollisions( int solidObjects )
 {
+	if( objectxsortedlist::gXSortedObjects.getSpatialIndex() == objectxsortedlist::Grid )
+	{
+		AvoidCollisionDirectional_Grid( PREV, solidObjects );
+		AvoidCollisionDirectional_Grid( NEXT, solidObjects );
+		return;
+	}
+
+	if( objectxsortedlist::gXSortedObjects.getSpatialIndex() == objectxsortedlist::Verify )
+	{
+		vector<gobject *> listCandidates;
+		vector<gobject *> gridCandidates;
+		GetCollisionCandidates( solidObjects, false, listCandidates );
+		GetCollisionCandidates( solidObjects, true, gridCandidates );
+		objectxsortedlist::gXSortedObjects.verifyNeighbors( "AvoidCollisions", fSimulation->getStep(), this, listCandidates, gridCandidates );
+	}
+
 	// Save the current agent pointer in the master x-sorted list before we mess with it, so we can restore it later
 	objectxsortedlist::gXSortedObjects.setMark( AGENTTYPE );
 
@@ -1545,8 +1809,6 @@ void agent::AvoidCollisions( int solidObjects )
 // in Update() before calling AvoidCollisions().
 void agent::AvoidCollisionDirectional( int direction, int solidObjects )
 {
-	#define CollisionRadiusReductionFactor 0.90
-
 	gobject* obj;
 
 	float dx = x() - LastX();
@@ -1572,70 +1834,160 @@ void agent::AvoidCollisionDirectional( int direction, int solidObjects )
 				break;
 		}
 
-		// Test to see if we're too far away in z; if so, we're done with this object
-		if( obj->z() - objRadius > max( z(), LastZ() ) + agtRadius  ||
-			obj->z() + objRadius < min( z(), LastZ() ) - agtRadius )
-			continue;
+		AvoidCollision( obj, dx, dz, agtRadius );
+	}
+}
+
+
+// Like AvoidCollisionDirectional, but only visits the objects near our path,
+// in the same (list) order.  Since the grid isn't sorted by x, objects too far
+// away in x are skipped rather than ending the search.
+void agent::AvoidCollisionDirectional_Grid( int direction, int solidObjects )
+{
+	gobject* obj;
+
+	float dx = x() - LastX();
+	float dz = z() - LastZ();
+	float agtRadius = radius() * CollisionRadiusReductionFactor;
+
+	// Our path only gets shorter as collisions are fixed, so this box stays large enough
+	SpatialGrid::Query query = objectxsortedlist::gXSortedObjects.nearQuery( this, solidObjects,
+																			 min( x(), LastX() ) - agtRadius, max( x(), LastX() ) + agtRadius,
+																			 min( z(), LastZ() ) - agtRadius, max( z(), LastZ() ) + agtRadius );
+
+	while( objectxsortedlist::gXSortedObjects.nearObj( direction, query, &obj ) )
+	{
+		float objRadius = obj->radius() * CollisionRadiusReductionFactor;
 
-		// If we're carrying the object, then there's nothing to be done
-		if( Carrying( obj ) )
+		if( obj->x() - objRadius > max( x(), LastX() ) + agtRadius  ||
+			obj->x() + objRadius < min( x(), LastX() ) - agtRadius )
 			continue;
 
-		// If we reach here, then the two objects appear to have had contact this time step
-		// and we're not carrying the other object
-
-		// We only want to adjust the position of our agent if it was traveling in the
-		// direction of the object it is touching, so take a small step from the start
-		// position towards the end position and see whether the distance to the potential
-		// collision object decreases.  ("Small" because we want to avoid the case where
-		// the agent's velocity is great enough to step past the collision object and end
-		// up farther away than it started, after going completely through the collision
-		// object.  Dividing by worldsize should take care of that in any situation.)
-		float xs, zs;
-		float dosquared = (obj->x()-LastX())*(obj->x()-LastX()) + (obj->z()-LastZ())*(obj->z()-LastZ());
-		if( fabs( dx ) > fabs( dz ) )
+		AvoidCollision( obj, dx, dz, agtRadius );
+	}
+}
+
+
+// Adjust our position if our path this step (from LastX(),LastZ() by dx,dz)
+// runs into obj, which has already been found to be close enough in x.
+void agent::AvoidCollision( gobject *obj, float dx, float dz, float agtRadius )
+{
+	float objRadius = obj->radius() * CollisionRadiusReductionFactor;
+
+	// Test to see if we're too far away in z; if so, we're done with this object
+	if( obj->z() - objRadius > max( z(), LastZ() ) + agtRadius  ||
+		obj->z() + objRadius < min( z(), LastZ() ) - agtRadius )
+		return;
+
+	// If we're carrying the object, then there's nothing to be done
+	if( Carrying( obj ) )
+		return;
+
+	// If we reach here, then the two objects appear to have had contact this time step
+	// and we're not carrying the other object
+
+	// We only want to adjust the position of our agent if it was traveling in the
+	// direction of the object it is touching, so take a small step from the start
+	// position towards the end position and see whether the distance to the potential
+	// collision object decreases.  ("Small" because we want to avoid the case where
+	// the agent's velocity is great enough to step past the collision object and end
+	// up farther away than it started, after going completely through the collision
+	// object.  Dividing by worldsize should take care of that in any situation.)
+	float xs, zs;
+	float dosquared = (obj->x()-LastX())*(obj->x()-LastX()) + (obj->z()-LastZ())*(obj->z()-LastZ());
+	if( fabs( dx ) > fabs( dz ) )
+	{
+		float s = dz / dx;
+		xs = LastX()  +  dx / globals::worldsize;
+		zs = LastZ()  +  s * (xs - LastX());
+	}
+	else
+	{
+		float s = dx / dz;
+		zs = LastZ()  +  dz / globals::worldsize;
+		xs = LastX()  +  s * (zs - LastZ());
+	}
+	float dssquared = (obj->x()-xs)*(obj->x()-xs) + (obj->z()-zs)*(obj->z()-zs);
+
+	// Test to see if the agent is approaching the potential collision object
+	if( dssquared < dosquared )
+	{
+		// If we reach here, then there was a collision
+		// So calculate where along our path we had to stop in order to avoid it
+		float xf, zf;	// the "fixed" coordinates so as to avoid penetrating the brick
+		GetCollisionFixedCoordinates( LastX(), LastZ(), x(), z(), obj->x(), obj->z(), agtRadius, objRadius, &xf, &zf );
+		setx( xf );
+		setz( zf );
+
+		ObjectType ot;
+		switch(obj->getType())
 		{
-			float s = dz / dx;
-			xs = LastX()  +  dx / globals::worldsize;
-			zs = LastZ()  +  s * (xs - LastX());
+		case AGENTTYPE:
+			ot = OT_AGENT;
+			break;
+		case FOODTYPE:
+			ot = OT_FOOD;
+			break;
+		case BRICKTYPE:
+			ot = OT_BRICK;
+			break;
+		default:
+			assert(false);
+			break;
 		}
-		else
+
+		logs->postEvent( CollisionEvent(this, ot) );
+		//break;	// can only hit one
+	}
+}
+
+
+// Collect the objects whose extent overlaps our path this step, as found by
+// scanning the x-sorted list or by the grid, in list order.  Used to verify
+// the grid; doesn't move us or the list.
+void agent::GetCollisionCandidates( int solidObjects, bool useGrid, vector<gobject *> &candidates )
+{
+	gobject* obj;
+	float agtRadius = radius() * CollisionRadiusReductionFactor;
+	float xmin = min( x(), LastX() ) - agtRadius;
+	float xmax = max( x(), LastX() ) + agtRadius;
+	float zmin = min( z(), LastZ() ) - agtRadius;
+	float zmax = max( z(), LastZ() ) + agtRadius;
+
+	for( int direction : {PREV, NEXT} )
+	{
+		vector<gobject *> found;
+
+		if( useGrid )
 		{
-			float s = dx / dz;
-			zs = LastZ()  +  dz / globals::worldsize;
-			xs = LastX()  +  s * (zs - LastZ());
+			SpatialGrid::Query query = objectxsortedlist::gXSortedObjects.nearQuery( this, solidObjects, xmin, xmax, zmin, zmax );
+			while( objectxsortedlist::gXSortedObjects.nearObj( direction, query, &obj ) )
+				found.push_back( obj );
 		}
-		float dssquared = (obj->x()-xs)*(obj->x()-xs) + (obj->z()-zs)*(obj->z()-zs);
-
-		// Test to see if the agent is approaching the potential collision object
-		if( dssquared < dosquared )
+		else
 		{
-			// If we reach here, then there was a collision
-			// So calculate where along our path we had to stop in order to avoid it
-			float xf, zf;	// the "fixed" coordinates so as to avoid penetrating the brick
-			GetCollisionFixedCoordinates( LastX(), LastZ(), x(), z(), obj->x(), obj->z(), agtRadius, objRadius, &xf, &zf );
-			setx( xf );
-			setz( zf );
-
-			ObjectType ot;
-			switch(obj->getType())
+			gdlink<gobject*> *saveCurr = objectxsortedlist::gXSortedObjects.getcurr();
+			while( objectxsortedlist::gXSortedObjects.anotherObj( direction, solidObjects, &obj ) )
 			{
-			case AGENTTYPE:
-				ot = OT_AGENT;
-				break;
-			case FOODTYPE:
-				ot = OT_FOOD;
-				break;
-			case BRICKTYPE:
-				ot = OT_BRICK;
-				break;
-			default:
-				assert(false);
-				break;
+				float objRadius = obj->radius() * CollisionRadiusReductionFactor;
+				if( (direction == NEXT) ? (obj->x() - objRadius > xmax) : (obj->x() + objRadius < xmin) )
+					break;
+				found.push_back( obj );
 			}
+			objectxsortedlist::gXSortedObjects.setcurr( saveCurr );
+		}
 
-			logs->postEvent( CollisionEvent(this, ot) );
-			//break;	// can only hit one
+		if( direction == PREV )
+			reverse( found.begin(), found.end() );	// into list order
+
+		for( gobject *o : found )
+		{
+			float objRadius = o->radius() * CollisionRadiusReductionFactor;
+			if( o->x() - objRadius > xmax  ||  o->x() + objRadius < xmin  ||
+				o->z() - objRadius > zmax  ||  o->z() + objRadius < zmin  ||
+				Carrying( o ) )
+				continue;
+			candidates.push_back( o );
 		}
 	}
 }
@@ -1746,6 +2098,7 @@ void agent::PickupObject( gobject* o )
     debugcheck( "%lu", Number() );
 
 	o->PickedUp( (gobject*)this, ly() );
+	objectxsortedlist::gXSortedObjects.moved( o );
 	fCarries.push_back( o );
 	if( o->radius() > fCarryRadius )
 		fCarryRadius = o->radius();
@@ -1765,6 +2118,7 @@ void agent::DropMostRecent( void )
 
 	gobject* o = fCarries.back();
 	o->Dropped();
+	objectxsortedlist::gXSortedObjects.moved( o );
 	fCarries.pop_back();
 
 	if( o->radius() == fCarryRadius )
@@ -1786,6 +2140,7 @@ void agent::DropObject( gobject* o )
     debugcheck( "agent # %lu (carrying %d) dropping %s # %lu (carrying %d)", Number(), NumCarries(), OBJECTTYPE( o ), o->getTypeNumber(), o->NumCarries() );
 
 	o->Dropped();
+	objectxsortedlist::gXSortedObjects.moved( o );
 	fCarries.remove( o );
 	if( o->radius() == fCarryRadius )
 	{
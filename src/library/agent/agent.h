@@ -139,21 +139,38 @@ public:
 	static void agentload(std::istream& in);
 	static void agentdestruct();
 	static void agentdump(std::ostream& out);
+	static void agentdump(CheckPointWriter& out);
+	static void agentload(CheckPointReader& in);
 
     agent(TSimulation* simulation, gstage* stage);
     ~agent();
 
     void dump(std::ostream& out);
     void load(std::istream& in);
+	void dump(CheckPointWriter& out);
+	void load(CheckPointReader& in, long mateWait);
 	void UpdateVision();
 	void UpdateBrain();
+	// UpdateBrain() in two halves, so firing-rate networks can be updated
+	// together by FiringRateArena::update() in between. Returns false if the
+	// network couldn't be queued, in which case the whole update was done.
+	bool BeginUpdateBrain();
+	void EndUpdateBrain();
     float UpdateBody( float moveFitnessParam,
 					  float speed2dpos,
 					  int solidObjects,
 					  agent* carrier );
+	void BeginUpdateBody();
+	float EndUpdateBody( float moveFitnessParam,
+						 float speed2dpos,
+						 int solidObjects,
+						 agent* carrier );
 	void UpdateColor();
 	void AvoidCollisions( int solidObjects );
 	void AvoidCollisionDirectional( int direction, int solidObjects );
+	void AvoidCollisionDirectional_Grid( int direction, int solidObjects );
+	void AvoidCollision( gobject *obj, float dx, float dz, float agtRadius );
+	void GetCollisionCandidates( int solidObjects, bool useGrid, std::vector<gobject *> &candidates );
 	void GetCollisionFixedCoordinates( float xo, float zo, float xn, float zn, float xb, float zb, float rc, float rb, float *xf, float *zf );
 
     void SetVelocity(float x, float y, float z);
@@ -248,6 +265,7 @@ public:
 	Retina* GetRetina();
 	gscene& GetScene();
 	gcamera &getCamera();
+	const float* GetNoseColor();
 	frustumXZ& GetFrustum();
 	static gpolyobj* GetAgentObj();
 
@@ -316,6 +334,18 @@ protected:
 
     float fLastPosition[3];
     float fVelocity[3];
+
+	// State carried from BeginUpdateBody() to EndUpdateBody()
+	struct
+	{
+		bool pending;
+		float position[3];	// proposed
+		float dx;
+		float dz;
+		int barrierCollisions;
+		float denergy;
+		float energyused;
+	} fBody;
     float fNoseColor[3];
 
 	float fSpeed;
@@ -330,6 +360,7 @@ protected:
 		float maxSpeed;
 		float strength;
 		float size;
+		float mateEnergyFraction;
 		long lifespan;
 	} geneCache;
 
@@ -440,6 +471,7 @@ inline Brain* agent::GetBrain() { return fCns->getBrain(); }
 inline Retina* agent::GetRetina() { return fRetina; }
 inline gscene& agent::GetScene() { return fScene; }
 inline gcamera &agent::getCamera() { return fCamera; }
+inline const float* agent::GetNoseColor() { return fNoseColor; }
 inline frustumXZ& agent::GetFrustum() { return fFrustum; }
 inline gpolyobj* agent::GetAgentObj() { return agentobj; }
 //inline gdlink<agent*>* agent::GetListLink() { return listLink; }
@@ -11,6 +11,7 @@
 #include "NeuronModel.h"
 #include "sim/globals.h"
 #include "utils/AbstractFile.h"
+#include "utils/CheckPoint.h"
 #include "utils/misc.h"
 
 template <typename T_neuron, typename T_neuronattrs, typename T_synapse>
@@ -56,6 +57,8 @@ class BaseNeuronModel : public NeuronModel
 
 #undef __ALLOC
 
+		synapses_changed();
+
 		citfor( NervousSystem::NerveList, cns->getNerves(), it )
 		{
 			Nerve *nerve = *it;
@@ -71,6 +74,8 @@ class BaseNeuronModel : public NeuronModel
 							 int startsynapses,
 							 int endsynapses )
 	{
+		sync_synapses();
+
 		T_neuron &n = neuron[index];
 		T_neuronattrs *attrs = (T_neuronattrs *)attributes;
 
@@ -80,6 +85,8 @@ class BaseNeuronModel : public NeuronModel
 		n.startsynapses = startsynapses;
 		n.endsynapses = endsynapses;
 
+		synapses_changed();
+
 #if DebugBrainGrow
 		if( DebugBrainGrowPrint )
 		{
@@ -92,9 +99,13 @@ class BaseNeuronModel : public NeuronModel
 	virtual void set_neuron_endsynapses( int index,
 										 int endsynapses )
 	{
+		sync_synapses();
+
 		T_neuron &n = neuron[index];
 
 		n.endsynapses = endsynapses;
+
+		synapses_changed();
 	}
 
 	virtual void get_synapse( int index,
@@ -103,6 +114,8 @@ class BaseNeuronModel : public NeuronModel
 							  float &efficacy,
 							  float &lrate )
 	{
+		sync_synapses();
+
 		T_synapse &s = synapse[index];
 
 		from = s.fromneuron;
@@ -117,6 +130,8 @@ class BaseNeuronModel : public NeuronModel
 							  float efficacy,
 							  float lrate )
 	{
+		sync_synapses();
+
 		T_synapse &s = synapse[index];
 
 		assert( !isnan(efficacy) );
@@ -127,6 +142,8 @@ class BaseNeuronModel : public NeuronModel
 		s.efficacy = efficacy;
 		s.lrate = lrate;
 
+		synapses_changed();
+
 #if DebugBrainGrow
 		if( DebugBrainGrowPrint )
 		{
@@ -173,6 +190,8 @@ class BaseNeuronModel : public NeuronModel
 		long imin = 10000;
 		long imax = -10000;
 
+		sync_synapses();
+
 		dimCM = (dims->numNeurons+1) * (dims->numNeurons+1);	// +1 for bias neuron
 		connectionMatrix = (float*) calloc( sizeof( *connectionMatrix ), dimCM );
 		if( !connectionMatrix )
@@ -249,6 +268,8 @@ class BaseNeuronModel : public NeuronModel
 
 	virtual void dumpSynapses( AbstractFile *file )
 	{
+		sync_synapses();
+
 		for( long i = 0; i < dims->numSynapses; i++ )
 		{
 			T_synapse &s = synapse[i];
@@ -299,13 +320,81 @@ class BaseNeuronModel : public NeuronModel
 
 	virtual void scaleSynapses( float factor )
 	{
+		sync_synapses();
+
 		for( long i = 0; i < dims->numSynapses; i++ )
 		{
 			T_synapse &s = synapse[i];
 			s.efficacy *= factor;
 		}
+
+		synapses_changed();
 	}
 
+	virtual void getGrowth( std::string &neurons, std::string &synapses )
+	{
+		sync_synapses();
+
+		neurons.assign( (const char *)neuron, dims->numNeurons * sizeof(T_neuron) );
+		synapses.assign( (const char *)synapse, dims->numSynapses * sizeof(T_synapse) );
+	}
+
+	virtual void setGrowth( const std::string &neurons, const std::string &synapses )
+	{
+		assert( neurons.size() == dims->numNeurons * sizeof(T_neuron) );
+		assert( synapses.size() == dims->numSynapses * sizeof(T_synapse) );
+
+		memcpy( neuron, neurons.data(), neurons.size() );
+		memcpy( synapse, synapses.data(), synapses.size() );
+
+		synapses_changed();
+	}
+
+	virtual void dumpState( CheckPointWriter &out )
+	{
+		sync_synapses();
+
+		out.put( (int32_t)dims->numNeurons );
+		out.put( (int64_t)dims->numSynapses );
+
+		out.putArray( neuron, dims->numNeurons );
+		out.putArray( neuronactivation, dims->numNeurons );
+		out.putArray( newneuronactivation, dims->numNeurons );
+		out.putArray( synapse, dims->numSynapses );
+	}
+
+	virtual void loadState( CheckPointReader &in )
+	{
+		if( in.get<int32_t>() != dims->numNeurons )
+			in.fail( "brain neuron count mismatch" );
+
+		// The saved synapses replace whatever growth produced, even if it
+		// produced a different number of them.
+		long numSynapses = in.get<int64_t>();
+		if( numSynapses != dims->numSynapses )
+		{
+			dims->numSynapses = numSynapses;
+			free( synapse );
+			synapse = (T_synapse *)calloc( numSynapses, sizeof(T_synapse) );
+			assert( synapse || (numSynapses == 0) );
+		}
+
+		in.getArray( neuron, dims->numNeurons );
+		in.getArray( neuronactivation, dims->numNeurons );
+		in.getArray( newneuronactivation, dims->numNeurons );
+		in.getArray( synapse, dims->numSynapses );
+
+		synapses_changed();
+	}
+
+	// A model that keeps its own copy of the synapses for update() brings
+	// synapse[] up to date in sync_synapses(), which is called before
+	// synapse[] or the neurons' ranges of it are read or modified, and
+	// discards its copy in synapses_changed(), which is called after they
+	// are modified or replaced.
+	virtual void sync_synapses() {}
+	virtual void synapses_changed() {}
+
 	//protected:
 	NervousSystem *cns;
 	Dimensions *dims;
@@ -18,10 +18,12 @@
 #include "agent/agent.h"
 #include "brain/groups/GroupsBrain.h"
 #include "brain/sheets/SheetsBrain.h"
+#include "complexity/ActivityStatistics.h"
 #include "sim/debug.h"
 #include "sim/globals.h"
 #include "sim/Simulation.h"
 #include "utils/AbstractFile.h"
+#include "utils/CheckPoint.h"
 #include "utils/misc.h"
 
 using namespace genome;
@@ -63,6 +65,24 @@ void Brain::processWorldfile( proplib::Document &doc )
 		else
 			assert( false );
 	}
+	{
+		string val = doc.get( "FiringRateKernel" );
+		if( val == "Reference" )
+			Brain::config.firingRateKernel = Brain::Configuration::KERNEL_REFERENCE;
+		else if( val == "Simd" )
+			Brain::config.firingRateKernel = Brain::Configuration::KERNEL_SIMD;
+		else
+			assert( false );
+	}
+	{
+		string val = doc.get( "SpikingEngine" );
+		if( val == "Reference" )
+			Brain::config.spikingEngine = Brain::Configuration::SPIKING_REFERENCE;
+		else if( val == "EventDriven" )
+			Brain::config.spikingEngine = Brain::Configuration::SPIKING_EVENT_DRIVEN;
+		else
+			assert( false );
+	}
 	{
 		string val = doc.get( "LearningMode" );
 		if( val == "None" )
@@ -113,6 +133,7 @@ void Brain::processWorldfile( proplib::Document &doc )
 
     Brain::config.maxsynapse2energy = doc.get( "EnergyUseSynapses" );
     Brain::config.decayRate = doc.get( "SynapseWeightDecayRate" );
+	Brain::config.growthCacheSize = doc.get( "BrainGrowthCacheSize" );
 
  	// Set up retina values
 	Brain::config.minWin = doc.get( "RetinaWidth" );
@@ -149,6 +170,8 @@ Brain::Brain( NervousSystem *cns )
 , _renderer(NULL)
 , _energyUse(0)
 , _frozen(false)
+, _functionWriter(NULL)
+, _activityStatistics(NULL)
 {
 }
 
@@ -160,6 +183,8 @@ Brain::~Brain()
 {
 	delete _neuralnet;
 	delete _renderer;
+	delete _functionWriter;
+	delete _activityStatistics;
 }
 
 //---------------------------------------------------------------------------
@@ -180,8 +205,30 @@ void Brain::dumpAnatomical( AbstractFile *file, long index, float fitness )
 //---------------------------------------------------------------------------
 // Brain::startFunctional
 //---------------------------------------------------------------------------
-void Brain::startFunctional( AbstractFile *file, long index )
+void Brain::startFunctional( AbstractFile *file, long index, BrainFunctionFile::Format format )
 {
+	// sensor organ neuron ranges
+	std::string organs;
+	_cns->startFunctional( organs );
+
+	if( format != BrainFunctionFile::TEXT )
+	{
+		BrainFunctionFile::Header header;
+		header.format = format;
+		header.agentNumber = index;
+		header.numNeurons = _dims.numNeurons;
+		header.numInputNeurons = _dims.numInputNeurons;
+		header.numOutputNeurons = _dims.numOutputNeurons;
+		header.numSynapses = _dims.numSynapses;
+		header.birthStep = TSimulation::fStep;
+		header.organs = organs;
+
+		delete _functionWriter;
+		_functionWriter = new BrainFunctionFile::Writer( file, header );
+		_functionActivations.resize( _dims.numNeurons );
+		return;
+	}
+
 	file->printf( "version 1\n" );
 
 	// print the header, with index (agent number)
@@ -194,7 +241,7 @@ void Brain::startFunctional( AbstractFile *file, long index )
 	file->printf( " %ld", TSimulation::fStep );
 
 	// print organs portion
-	_cns->startFunctional( file );
+	file->printf( "%s", organs.c_str() );
 
 	file->printf( "\n" );
 }
@@ -204,6 +251,14 @@ void Brain::startFunctional( AbstractFile *file, long index )
 //---------------------------------------------------------------------------
 void Brain::endFunctional( AbstractFile *file, float fitness )
 {
+	if( _functionWriter )
+	{
+		_functionWriter->writeEnd( fitness );
+		delete _functionWriter;
+		_functionWriter = NULL;
+		return;
+	}
+
 	file->printf( "end fitness = %g\n", fitness );
 }
 
@@ -212,9 +267,48 @@ void Brain::endFunctional( AbstractFile *file, float fitness )
 //---------------------------------------------------------------------------
 void Brain::writeFunctional( AbstractFile *file )
 {
+	if( _functionWriter )
+	{
+		_neuralnet->getActivations( _functionActivations.data(), 0, _dims.numNeurons );
+		_functionWriter->writeFrame( _functionActivations.data() );
+		return;
+	}
+
 	_neuralnet->writeFunctional( file );
 }
 
+//---------------------------------------------------------------------------
+// Brain::startActivityStatistics
+//---------------------------------------------------------------------------
+void Brain::startActivityStatistics( long index )
+{
+	if( Brain::config.activityStatistics == Brain::Configuration::STATISTICS_NONE )
+		return;
+
+	delete _activityStatistics;
+	_activityStatistics = new ActivityStatistics( Brain::config.activityStatistics == Brain::Configuration::STATISTICS_WINDOW
+												  ? ActivityStatistics::WINDOW
+												  : ActivityStatistics::COVARIANCE,
+												  index,
+												  TSimulation::fStep,
+												  _dims.numNeurons,
+												  _dims.numInputNeurons,
+												  _dims.numOutputNeurons );
+	_functionActivations.resize( _dims.numNeurons );
+}
+
+//---------------------------------------------------------------------------
+// Brain::recordActivity
+//---------------------------------------------------------------------------
+void Brain::recordActivity()
+{
+	if( _activityStatistics )
+	{
+		_neuralnet->getActivations( _functionActivations.data(), 0, _dims.numNeurons );
+		_activityStatistics->add( _functionActivations.data() );
+	}
+}
+
 //---------------------------------------------------------------------------
 // Brain::dumpSynapses
 //---------------------------------------------------------------------------
@@ -260,6 +354,30 @@ void Brain::copySynapses( Brain *other )
 	_neuralnet->copySynapses( other->_neuralnet );
 }
 
+//---------------------------------------------------------------------------
+// Brain::dumpState
+//---------------------------------------------------------------------------
+void Brain::dumpState( CheckPointWriter &out )
+{
+	out.put( _frozen );
+	out.put( _energyUse );
+	_neuralnet->dumpState( out );
+	if( _activityStatistics )
+		_activityStatistics->dumpState( out );
+}
+
+//---------------------------------------------------------------------------
+// Brain::loadState
+//---------------------------------------------------------------------------
+void Brain::loadState( CheckPointReader &in )
+{
+	in.get( _frozen );
+	in.get( _energyUse );
+	_neuralnet->loadState( in );
+	if( _activityStatistics )
+		_activityStatistics->loadState( in );
+}
+
 //---------------------------------------------------------------------------
 // Brain::prebirth
 //---------------------------------------------------------------------------
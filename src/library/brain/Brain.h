@@ -6,6 +6,7 @@
 #include <string>
 
 // Local
+#include "BrainFunctionFile.h"
 #include "NeuralNetRenderer.h"
 #include "NeuronModel.h"
 #include "proplib/proplib.h"
@@ -37,7 +38,10 @@
 
 // Forward declarations
 class AbstractFile;
+class ActivityStatistics;
 class agent;
+class CheckPointReader;
+class CheckPointWriter;
 namespace genome { class Genome; }
 class NervousSystem;
 class NeuronModel;
@@ -62,11 +66,27 @@ public:
 			SPIKING
 		} neuronModel;
 		enum
+		{
+			KERNEL_REFERENCE,
+			KERNEL_SIMD
+		} firingRateKernel;
+		enum
+		{
+			SPIKING_REFERENCE,
+			SPIKING_EVENT_DRIVEN
+		} spikingEngine;
+		enum
 		{
 			LEARN_NONE,
 			LEARN_PREBIRTH,
 			LEARN_ALL
 		} learningMode;
+		enum
+		{
+			STATISTICS_NONE,
+			STATISTICS_COVARIANCE,
+			STATISTICS_WINDOW
+		} activityStatistics;	// set by the simulation when it calculates complexity from them
 		struct
 		{
 			float minVal;
@@ -111,6 +131,7 @@ public:
 		short retinaHeight;
 		float maxsynapse2energy; // (amount if all synapses usable)
 		float maxneuron2energy;
+		int growthCacheSize;	// brains, see BrainGrowthCache
 	} config;
 
 	static void processWorldfile( proplib::Document &doc );
@@ -140,14 +161,23 @@ public:
 
 	void dumpAnatomical( AbstractFile *file, long index, float fitness );
 
-	void startFunctional( AbstractFile *file, long index );
+	void startFunctional( AbstractFile *file, long index, BrainFunctionFile::Format format );
 	void endFunctional( AbstractFile* file, float fitness );
 	void writeFunctional( AbstractFile* file );
 
+	// Starts keeping the activity statistics configured for the simulation,
+	// if any, to which recordActivity() then adds each step.
+	void startActivityStatistics( long index );
+	void recordActivity();
+	ActivityStatistics *getActivityStatistics();
+
 	void dumpSynapses( AbstractFile *file, long index );
 	void loadSynapses( AbstractFile *file, float maxWeight = -1.0f );
 	void copySynapses( Brain *other );
 
+	void dumpState( CheckPointWriter &out );
+	void loadState( CheckPointReader &in );
+
 protected:
 	friend class agent;
 
@@ -157,6 +187,9 @@ protected:
 	NeuralNetRenderer *_renderer;
 	float _energyUse;
 	bool _frozen;
+	BrainFunctionFile::Writer *_functionWriter;	// NULL when recording text
+	std::vector<double> _functionActivations;
+	ActivityStatistics *_activityStatistics;
 };
 
 //===========================================================================
@@ -167,6 +200,7 @@ inline short Brain::getNumNeurons() { return _dims.numNeurons; }
 inline long Brain::getNumSynapses() { return _dims.numSynapses; }
 inline NeuronModel::Dimensions Brain::getDimensions() { return _dims; }
 inline NeuronModel *Brain::getNeuronModel() { return _neuralnet; }
+inline ActivityStatistics *Brain::getActivityStatistics() { return _activityStatistics; }
 inline void Brain::getActivations( double *activations, int start, int count ) { _neuralnet->getActivations( activations, start, count ); }
 inline void Brain::setActivations( double *activations, int start, int count ) { _neuralnet->setActivations( activations, start, count ); }
 inline void Brain::randomizeActivations() { _neuralnet->randomizeActivations(); }
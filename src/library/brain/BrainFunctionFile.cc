@@ -0,0 +1,302 @@
+#include "BrainFunctionFile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <iostream>
+
+#include "utils/AbstractFile.h"
+
+using namespace std;
+using namespace BrainFunctionFile;
+
+#define VERSION 1
+#define HEADER_SIZE 48
+#define FRAME_TAG 'F'
+#define END_TAG 'E'
+
+//===========================================================================
+// Encoding
+//===========================================================================
+
+static void put16( uint8_t *p, uint16_t x )
+{
+	p[0] = x;
+	p[1] = x >> 8;
+}
+
+static void put32( uint8_t *p, uint32_t x )
+{
+	for( int i = 0; i < 4; i++ )
+		p[i] = x >> (8 * i);
+}
+
+static void put64( uint8_t *p, uint64_t x )
+{
+	for( int i = 0; i < 8; i++ )
+		p[i] = x >> (8 * i);
+}
+
+static uint16_t get16( const uint8_t *p )
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32( const uint8_t *p )
+{
+	uint32_t x = 0;
+	for( int i = 0; i < 4; i++ )
+		x |= (uint32_t)p[i] << (8 * i);
+	return x;
+}
+
+static uint64_t get64( const uint8_t *p )
+{
+	uint64_t x = 0;
+	for( int i = 0; i < 8; i++ )
+		x |= (uint64_t)p[i] << (8 * i);
+	return x;
+}
+
+static uint32_t floatBits( float f )
+{
+	uint32_t x;
+	memcpy( &x, &f, 4 );
+	return x;
+}
+
+static float bitsFloat( uint32_t x )
+{
+	float f;
+	memcpy( &f, &x, 4 );
+	return f;
+}
+
+// Rounds to the nearest half, ties to even, as numpy's float16 does.
+static uint16_t floatToHalf( float f )
+{
+	uint32_t x = floatBits( f );
+	uint16_t sign = (x >> 16) & 0x8000;
+	int exp = (x >> 23) & 0xff;
+	uint32_t mant = x & 0x7fffff;
+
+	if( exp == 0xff )
+		return sign | 0x7c00 | (mant ? 0x200 : 0);
+
+	int e = exp - 127 + 15;
+	if( e >= 0x1f )
+		return sign | 0x7c00;
+
+	uint32_t h;
+	uint32_t rem;
+	uint32_t halfway;
+	if( e <= 0 )
+	{
+		if( e < -10 )
+			return sign;
+
+		int shift = 14 - e;
+		mant |= 0x800000;
+		h = mant >> shift;
+		rem = mant & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else
+	{
+		h = (e << 10) | (mant >> 13);
+		rem = mant & 0x1fff;
+		halfway = 0x1000;
+	}
+
+	if( (rem > halfway) || ((rem == halfway) && (h & 1)) )
+		h++;
+
+	return sign | h;
+}
+
+static float halfToFloat( uint16_t h )
+{
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	int exp = (h >> 10) & 0x1f;
+	uint32_t mant = h & 0x3ff;
+
+	if( exp == 0x1f )
+		return bitsFloat( sign | 0x7f800000 | (mant << 13) );
+	if( exp == 0 )
+	{
+		float f = mant * (1.0f / 16777216.0f);
+		return sign ? -f : f;
+	}
+	return bitsFloat( sign | ((exp - 15 + 127) << 23) | (mant << 13) );
+}
+
+static int valueSize( Format format )
+{
+	return format == FLOAT16 ? 2 : 4;
+}
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::isBinary
+//---------------------------------------------------------------------------
+bool BrainFunctionFile::isBinary( AbstractFile *file )
+{
+	char magic[4];
+	bool binary = (file->read(magic, 1, 4) == 4) && (memcmp(magic, "PWBF", 4) == 0);
+	file->seek( 0, SEEK_SET );
+
+	return binary;
+}
+
+//===========================================================================
+// Writer
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::Writer::Writer
+//---------------------------------------------------------------------------
+Writer::Writer( AbstractFile *file_, const Header &header )
+: file( file_ )
+, format( header.format )
+, numNeurons( header.numNeurons )
+, record( 1 + header.numNeurons * valueSize(header.format) )
+{
+	uint8_t buf[HEADER_SIZE];
+	memcpy( buf, "PWBF", 4 );
+	buf[4] = VERSION;
+	buf[5] = format;
+	put16( buf + 6, 0 );
+	put64( buf + 8, header.agentNumber );
+	put32( buf + 16, header.numNeurons );
+	put32( buf + 20, header.numInputNeurons );
+	put32( buf + 24, header.numOutputNeurons );
+	put32( buf + 28, header.organs.size() );
+	put64( buf + 32, header.numSynapses );
+	put64( buf + 40, header.birthStep );
+
+	file->write( buf, 1, HEADER_SIZE );
+	file->write( header.organs.data(), 1, header.organs.size() );
+
+	record[0] = FRAME_TAG;
+}
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::Writer::writeFrame
+//---------------------------------------------------------------------------
+void Writer::writeFrame( const double *activations )
+{
+	uint8_t *p = record.data() + 1;
+
+	if( format == FLOAT16 )
+	{
+		for( int i = 0; i < numNeurons; i++, p += 2 )
+			put16( p, floatToHalf(activations[i]) );
+	}
+	else
+	{
+		for( int i = 0; i < numNeurons; i++, p += 4 )
+			put32( p, floatBits(activations[i]) );
+	}
+
+	file->write( record.data(), 1, record.size() );
+}
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::Writer::writeEnd
+//---------------------------------------------------------------------------
+void Writer::writeEnd( float fitness )
+{
+	uint8_t buf[5];
+	buf[0] = END_TAG;
+	put32( buf + 1, floatBits(fitness) );
+
+	file->write( buf, 1, sizeof(buf) );
+}
+
+//===========================================================================
+// Reader
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::Reader::Reader
+//---------------------------------------------------------------------------
+Reader::Reader()
+: numFrames( 0 )
+, complete( false )
+, fitness( 0.0f )
+{
+}
+
+//---------------------------------------------------------------------------
+// BrainFunctionFile::Reader::read
+//---------------------------------------------------------------------------
+bool Reader::read( AbstractFile *file, const char *path )
+{
+	uint8_t buf[HEADER_SIZE];
+	if( (file->read(buf, 1, HEADER_SIZE) != HEADER_SIZE) || (memcmp(buf, "PWBF", 4) != 0) )
+	{
+		cerr << "brainFunction file '" << path << "' has no binary header." << endl;
+		return false;
+	}
+	if( buf[4] != VERSION )
+	{
+		cerr << "brainFunction file '" << path << "' has unsupported version " << (int)buf[4] << "." << endl;
+		return false;
+	}
+	if( (buf[5] != FLOAT32) && (buf[5] != FLOAT16) )
+	{
+		cerr << "brainFunction file '" << path << "' has unknown format " << (int)buf[5] << "." << endl;
+		return false;
+	}
+
+	header.format = (Format)buf[5];
+	header.agentNumber = (int64_t)get64( buf + 8 );
+	header.numNeurons = (int32_t)get32( buf + 16 );
+	header.numInputNeurons = (int32_t)get32( buf + 20 );
+	header.numOutputNeurons = (int32_t)get32( buf + 24 );
+	uint32_t organsLength = get32( buf + 28 );
+	header.numSynapses = (int64_t)get64( buf + 32 );
+	header.birthStep = (int64_t)get64( buf + 40 );
+
+	if( (header.numNeurons <= 0) || (organsLength > 4096) )
+	{
+		cerr << "brainFunction file '" << path << "' has a corrupt header." << endl;
+		return false;
+	}
+
+	header.organs.resize( organsLength );
+	if( file->read(&header.organs[0], 1, organsLength) != organsLength )
+	{
+		cerr << "brainFunction file '" << path << "' has a corrupt header." << endl;
+		return false;
+	}
+
+	int valsize = valueSize( header.format );
+	size_t recordSize = 1 + header.numNeurons * valsize;
+	vector<uint8_t> record( recordSize );
+
+	numFrames = 0;
+	frames.clear();
+	complete = false;
+
+	while( file->read(record.data(), 1, 1) == 1 )
+	{
+		if( record[0] == END_TAG )
+		{
+			if( file->read(record.data() + 1, 1, 4) == 4 )
+			{
+				fitness = bitsFloat( get32(record.data() + 1) );
+				complete = true;
+			}
+			break;
+		}
+		if( (record[0] != FRAME_TAG) || (file->read(record.data() + 1, 1, recordSize - 1) != recordSize - 1) )
+			break;
+
+		const uint8_t *p = record.data() + 1;
+		for( int i = 0; i < header.numNeurons; i++, p += valsize )
+			frames.push_back( header.format == FLOAT16 ? halfToFloat(get16(p)) : bitsFloat(get32(p)) );
+		numFrames++;
+	}
+
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+class AbstractFile;
+
+//===========================================================================
+// BrainFunctionFile
+//
+// The brainFunction log in its binary forms. A file is a header followed by
+// one record per step the agent lived, each holding the activations of all
+// its neurons, and, once the agent has died, an end record with its fitness:
+//
+//   "PWBF" uint8 version uint8 format uint16 0
+//   int64 agent int32 neurons int32 inputNeurons int32 outputNeurons
+//   int32 organsLength int64 synapses int64 birthStep char organs[]
+//   { 'F' activation[neurons] }...
+//   [ 'E' float32 fitness ]
+//
+// Activations are float32 or IEEE half precision, according to the format.
+// Everything is little-endian. organs is what the text format has after the
+// birth step on its header line, e.g. " 2-3 4-5 6-7".
+//===========================================================================
+namespace BrainFunctionFile
+{
+	enum Format
+	{
+		TEXT = 0,
+		FLOAT32 = 1,
+		FLOAT16 = 2
+	};
+
+	struct Header
+	{
+		Format format;
+		long agentNumber;
+		int numNeurons;
+		int numInputNeurons;
+		int numOutputNeurons;
+		long numSynapses;
+		long birthStep;
+		std::string organs;
+	};
+
+	// Returns true if the file is in a binary format, leaving it at its start.
+	bool isBinary( AbstractFile *file );
+
+	//---------------------------------------------------------------------------
+	// BrainFunctionFile::Writer
+	//---------------------------------------------------------------------------
+	class Writer
+	{
+	 public:
+		Writer( AbstractFile *file, const Header &header );
+
+		void writeFrame( const double *activations );
+		void writeEnd( float fitness );
+
+	 private:
+		AbstractFile *file;
+		Format format;
+		int numNeurons;
+		std::vector<uint8_t> record;
+	};
+
+	//---------------------------------------------------------------------------
+	// BrainFunctionFile::Reader
+	//
+	// Reads the whole file. A file whose agent was still alive has no end
+	// record; any partially written record at its end is ignored.
+	//---------------------------------------------------------------------------
+	class Reader
+	{
+	 public:
+		Reader();
+
+		// Returns false, with a message on cerr, if the file isn't valid.
+		bool read( AbstractFile *file, const char *path );
+
+		Header header;
+		long numFrames;
+		std::vector<float> frames;	// numFrames x header.numNeurons
+		bool complete;
+		float fitness;
+	};
+}
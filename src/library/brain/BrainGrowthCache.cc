@@ -0,0 +1,110 @@
+#include "BrainGrowthCache.h"
+
+#include <assert.h>
+
+#include "Brain.h"
+#include "brain/groups/GroupsBrain.h"
+#include "genome/Genome.h"
+
+using namespace std;
+
+BrainGrowthCache::EntryList BrainGrowthCache::entries;
+unordered_map<string, BrainGrowthCache::EntryList::iterator> BrainGrowthCache::index;
+std::mutex BrainGrowthCache::mutex;
+
+//---------------------------------------------------------------------------
+// BrainGrowthCache::isEnabled
+//---------------------------------------------------------------------------
+bool BrainGrowthCache::isEnabled()
+{
+	if( Brain::config.growthCacheSize <= 0 )
+		return false;
+
+	switch( Brain::config.architecture )
+	{
+	case Brain::Configuration::Groups:
+		// Without their seed genes, the topological distortion and initial
+		// weights are drawn from the agent's random stream, as are gaussian
+		// weights regardless.
+		if( !GroupsBrain::config.enableTopologicalDistortionRngSeed )
+			return false;
+		if( Brain::config.fixedInitWeight )
+			return true;
+		return GroupsBrain::config.enableInitWeightRngSeed && !Brain::config.gaussianInitWeight;
+	case Brain::Configuration::Sheets:
+		return true;
+	default:
+		assert( false );
+		return false;
+	}
+}
+
+//---------------------------------------------------------------------------
+// BrainGrowthCache::find
+//---------------------------------------------------------------------------
+BrainGrowthCache::GrowthRef BrainGrowthCache::find( genome::Genome *g )
+{
+	string key = getKey( g );
+
+	lock_guard<std::mutex> lock( mutex );
+
+	auto it = index.find( key );
+	if( it == index.end() )
+		return GrowthRef();
+
+	entries.splice( entries.begin(), entries, it->second );
+
+	return it->second->second;
+}
+
+//---------------------------------------------------------------------------
+// BrainGrowthCache::insert
+//---------------------------------------------------------------------------
+void BrainGrowthCache::insert( genome::Genome *g, GrowthRef growth )
+{
+	string key = getKey( g );
+
+	lock_guard<std::mutex> lock( mutex );
+
+	// Another thread may have grown the same genome meanwhile.
+	if( index.find(key) != index.end() )
+		return;
+
+	entries.push_front( Entry(key, growth) );
+	index[key] = entries.begin();
+
+	while( (int)entries.size() > Brain::config.growthCacheSize )
+	{
+		index.erase( entries.back().first );
+		entries.pop_back();
+	}
+}
+
+//---------------------------------------------------------------------------
+// BrainGrowthCache::clear
+//---------------------------------------------------------------------------
+void BrainGrowthCache::clear()
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	index.clear();
+	entries.clear();
+}
+
+//---------------------------------------------------------------------------
+// BrainGrowthCache::getKey
+//
+// The genome's bytes, after the seed settings. The settings are fixed for a
+// run, but they decide which genes growth reads.
+//---------------------------------------------------------------------------
+string BrainGrowthCache::getKey( genome::Genome *g )
+{
+	string key;
+
+	key.reserve( 2 + g->getByteCount() );
+	key.push_back( GroupsBrain::config.enableTopologicalDistortionRngSeed ? 1 : 0 );
+	key.push_back( GroupsBrain::config.enableInitWeightRngSeed ? 1 : 0 );
+	key.append( (const char *)g->getBytes(), g->getByteCount() );
+
+	return key;
+}
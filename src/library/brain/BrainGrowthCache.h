@@ -0,0 +1,61 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "NeuronModel.h"
+
+namespace genome { class Genome; }
+
+//===========================================================================
+// BrainGrowthCache
+//
+// Brains grown from byte-identical genomes, like the copies of the fittest
+// agents that CreateAgents revives, are identical whenever growth takes
+// nothing from the agent's random stream. This keeps the most recently grown
+// of those brains, by their genomes' bytes and the random seed settings, so a
+// new brain can copy its network rather than grow it again.
+//
+// Agents are grown in parallel, so access is serialized, and an entry is
+// never modified once it's inserted.
+//===========================================================================
+class BrainGrowthCache
+{
+ public:
+	// What growth produced.
+	struct Growth
+	{
+		NeuronModel::Dimensions dims;
+		std::string neurons;		// from NeuronModel::getGrowth()
+		std::string synapses;
+		std::vector<int> counts;	// anything else the brain needs, e.g. its nerves' sizes
+	};
+	typedef std::shared_ptr<const Growth> GrowthRef;
+
+	// Whether brains are cached, which needs BrainGrowthCacheSize > 0 and
+	// growth that depends only on the genome.
+	static bool isEnabled();
+
+	// NULL if g's brain isn't cached.
+	static GrowthRef find( genome::Genome *g );
+	static void insert( genome::Genome *g, GrowthRef growth );
+
+	// Forgets every brain, e.g. when the genes' ranges may have changed, so
+	// the same genome would grow a different one.
+	static void clear();
+
+ private:
+	typedef std::pair<std::string, GrowthRef> Entry;
+	typedef std::list<Entry> EntryList;
+
+	static std::string getKey( genome::Genome *g );
+
+	static EntryList entries;	// most recently used first
+	static std::unordered_map<std::string, EntryList::iterator> index;
+	static std::mutex mutex;
+};
@@ -0,0 +1,263 @@
+#include "FiringRateArena.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "FiringRateModel.h"
+#include "sim/Scheduler.h"
+#include "sim/StepProfiler.h"
+
+using namespace std;
+
+FiringRateArena FiringRateArena::gArena;
+
+const long FiringRateArena::ChunkSynapses;
+const int FiringRateArena::ChunkNeurons;
+const long FiringRateArena::BlockSynapses;
+
+//===========================================================================
+// FiringRateArena::Chunk
+//===========================================================================
+struct FiringRateArena::Chunk
+{
+	Chunk( int neuronCapacity, long synapseCapacity )
+	: neuronCapacity( neuronCapacity )
+	, synapseCapacity( synapseCapacity )
+	, neuronsUsed( 0 )
+	, synapsesUsed( 0 )
+	, neuronsLive( 0 )
+	, synapsesLive( 0 )
+	, segmentsLive( 0 )
+	, rows( neuronCapacity )
+	, activation( neuronCapacity )
+	, efficacy( synapseCapacity )
+	, lrate( synapseCapacity )
+	, from( synapseCapacity )
+	{
+	}
+
+	bool fits( int numNeurons, long numSynapses )
+	{
+		return (neuronsUsed + numNeurons <= neuronCapacity)
+			&& (synapsesUsed + numSynapses <= synapseCapacity);
+	}
+
+	bool isSparse()
+	{
+		return (2 * synapsesLive < synapsesUsed) || (2 * neuronsLive < neuronsUsed);
+	}
+
+	int neuronCapacity;
+	long synapseCapacity;
+	int neuronsUsed;
+	long synapsesUsed;
+	int neuronsLive;
+	long synapsesLive;
+	size_t segmentsLive;
+
+	std::vector<Row> rows;
+	std::vector<float> activation;
+	std::vector<float> efficacy;
+	std::vector<float> lrate;
+	std::vector<int32_t> from;
+
+	std::vector<Segment *> segments;	// in order of placement; NULL once freed
+};
+
+//---------------------------------------------------------------------------
+// FiringRateArena::FiringRateArena
+//---------------------------------------------------------------------------
+FiringRateArena::FiringRateArena()
+: current( NULL )
+{
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::~FiringRateArena
+//---------------------------------------------------------------------------
+FiringRateArena::~FiringRateArena()
+{
+	for( Chunk *chunk : chunks )
+		delete chunk;
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::alloc
+//---------------------------------------------------------------------------
+FiringRateArena::Segment *FiringRateArena::alloc( FiringRateModel *model, int numNeurons, long numSynapses )
+{
+	Segment *segment = new Segment();
+	segment->model = model;
+	segment->numNeurons = numNeurons;
+	segment->numSynapses = numSynapses;
+	segment->queued = false;
+
+	lock_guard<std::mutex> lock( mutex );
+
+	place( segment );
+
+	return segment;
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::free
+//---------------------------------------------------------------------------
+void FiringRateArena::free( Segment *segment )
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	release( segment );
+
+	delete segment;
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::place
+//
+// Puts the segment at the end of the current chunk, starting a new chunk if
+// it doesn't fit. Caller must hold the mutex.
+//---------------------------------------------------------------------------
+void FiringRateArena::place( Segment *segment )
+{
+	if( (current == NULL) || !current->fits(segment->numNeurons, segment->numSynapses) )
+	{
+		if( current && (current->segmentsLive == 0) )
+		{
+			chunks.remove( current );
+			delete current;
+		}
+
+		current = new Chunk( max(ChunkNeurons, segment->numNeurons),
+							 max(ChunkSynapses, segment->numSynapses) );
+		chunks.push_back( current );
+	}
+
+	Chunk *chunk = current;
+
+	segment->chunk = chunk;
+	segment->index = chunk->segments.size();
+	segment->neuronOffset = chunk->neuronsUsed;
+	segment->synapseOffset = chunk->synapsesUsed;
+
+	segment->rows = chunk->rows.data() + segment->neuronOffset;
+	segment->activation = chunk->activation.data() + segment->neuronOffset;
+	segment->efficacy = chunk->efficacy.data() + segment->synapseOffset;
+	segment->lrate = chunk->lrate.data() + segment->synapseOffset;
+	segment->from = chunk->from.data() + segment->synapseOffset;
+
+	chunk->segments.push_back( segment );
+	chunk->neuronsUsed += segment->numNeurons;
+	chunk->synapsesUsed += segment->numSynapses;
+	chunk->neuronsLive += segment->numNeurons;
+	chunk->synapsesLive += segment->numSynapses;
+	chunk->segmentsLive++;
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::release
+//
+// Removes the segment's space from its chunk, deleting the chunk once it's
+// empty unless new segments are still being placed in it. Caller must hold
+// the mutex.
+//---------------------------------------------------------------------------
+void FiringRateArena::release( Segment *segment )
+{
+	Chunk *chunk = segment->chunk;
+
+	assert( chunk->segments[segment->index] != NULL );
+
+	chunk->segments[segment->index] = NULL;
+	chunk->neuronsLive -= segment->numNeurons;
+	chunk->synapsesLive -= segment->numSynapses;
+	chunk->segmentsLive--;
+
+	if( (chunk->segmentsLive == 0) && (chunk != current) )
+	{
+		chunks.remove( chunk );
+		delete chunk;
+	}
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::compact
+//---------------------------------------------------------------------------
+void FiringRateArena::compact()
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	vector<Chunk *> sparse;
+	for( Chunk *chunk : chunks )
+		if( (chunk != current) && chunk->isSparse() )
+			sparse.push_back( chunk );
+
+	for( Chunk *chunk : sparse )
+	{
+		// Copy the list first, since releasing the last segment deletes the
+		// chunk.
+		vector<Segment *> segments;
+		for( Segment *segment : chunk->segments )
+			if( segment )
+				segments.push_back( segment );
+
+		for( Segment *segment : segments )
+		{
+			Segment old = *segment;
+
+			place( segment );
+
+			memcpy( segment->rows, old.rows, old.numNeurons * sizeof(Row) );
+			memcpy( segment->activation, old.activation, old.numNeurons * sizeof(float) );
+			memcpy( segment->efficacy, old.efficacy, old.numSynapses * sizeof(float) );
+			memcpy( segment->lrate, old.lrate, old.numSynapses * sizeof(float) );
+			memcpy( segment->from, old.from, old.numSynapses * sizeof(int32_t) );
+
+			release( &old );
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// FiringRateArena::update
+//---------------------------------------------------------------------------
+void FiringRateArena::update( Scheduler &scheduler, StepProfiler &profiler )
+{
+	compact();
+
+	queued.clear();
+	blocks.clear();
+
+	long blockSynapses = 0;
+	for( Chunk *chunk : chunks )
+	{
+		for( Segment *segment : chunk->segments )
+		{
+			if( !segment || !segment->queued )
+				continue;
+
+			if( blocks.empty() || (blockSynapses >= BlockSynapses) )
+			{
+				blocks.push_back( queued.size() );
+				blockSynapses = 0;
+			}
+
+			queued.push_back( segment );
+			blockSynapses += segment->numSynapses;
+		}
+	}
+	blocks.push_back( queued.size() );
+
+	size_t nblocks = blocks.size() - 1;
+	scheduler.execParallelFor( nblocks, [this, &profiler]( size_t i ) {
+			StepProfiler::Timer timer( profiler, StepProfiler::Brain );
+
+			for( size_t j = blocks[i]; j < blocks[i + 1]; j++ )
+			{
+				Segment *segment = queued[j];
+
+				segment->model->updateSimd();
+				segment->queued = false;
+			}
+		});
+}
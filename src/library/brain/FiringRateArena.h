@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <list>
+#include <mutex>
+#include <vector>
+
+class FiringRateModel;
+class Scheduler;
+class StepProfiler;
+
+//===========================================================================
+// FiringRateArena
+//
+// Holds the packed neurons and synapses of every firing-rate brain using the
+// SIMD update, in a few large chunks rather than one allocation per brain,
+// and updates the brains queued for the step together: the queued brains
+// are taken in chunk order and split into blocks of about BlockSynapses
+// synapses, and each block is updated by one task, so neighbouring brains
+// stream through the cache one after another.
+//
+// Space is never moved while brains may be updating; allocation and freeing
+// may be done from any thread, but compact() and update() must be called
+// while no brain is being grown, updated or destroyed.
+//===========================================================================
+class FiringRateArena
+{
+ public:
+	static FiringRateArena gArena;
+
+	// Packed neuron: its parameters and its row of synapses, relative to the
+	// start of its brain's synapses.
+	struct Row
+	{
+		float bias;
+		float tau;
+		float gain;
+		int32_t start;
+		int32_t count;
+	};
+
+	struct Chunk;
+
+	//---------------------------------------------------------------------------
+	// FiringRateArena::Segment
+	//
+	// One brain's space. The pointers change if compact() moves it.
+	//---------------------------------------------------------------------------
+	struct Segment
+	{
+		FiringRateModel *model;
+		int numNeurons;
+		long numSynapses;
+
+		Row *rows;
+		float *activation;
+		float *efficacy;
+		float *lrate;
+		int32_t *from;
+
+		bool queued;
+
+	 private:
+		friend class FiringRateArena;
+
+		Chunk *chunk;
+		size_t index;	// in chunk->segments
+		int neuronOffset;
+		long synapseOffset;
+	};
+
+	FiringRateArena();
+	~FiringRateArena();
+
+	Segment *alloc( FiringRateModel *model, int numNeurons, long numSynapses );
+	void free( Segment *segment );
+
+	// Moves brains out of chunks that are mostly free space.
+	void compact();
+
+	// Updates every queued brain, in parallel. Block times are added to the
+	// profiler's Brain phase.
+	void update( Scheduler &scheduler, StepProfiler &profiler );
+
+ private:
+	static const long ChunkSynapses = 1 << 18;
+	static const int ChunkNeurons = 1 << 14;
+	static const long BlockSynapses = 1 << 14;
+
+	void place( Segment *segment );
+	void release( Segment *segment );
+
+	std::mutex mutex;
+	std::list<Chunk *> chunks;
+	Chunk *current;
+
+	std::vector<Segment *> queued;
+	std::vector<size_t> blocks;	// start of each block in queued, then its end
+};
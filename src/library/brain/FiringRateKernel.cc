@@ -0,0 +1,318 @@
+#include "FiringRateKernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+	#define FRK_X86 1
+	#include <immintrin.h>
+#else
+	#define FRK_X86 0
+#endif
+
+// Contracting a multiply and add into one fused instruction would make the
+// scalar version round differently from the vector ones.
+#if defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+	#pragma GCC optimize ("fp-contract=off")
+#endif
+
+using namespace FiringRateKernel;
+
+// Sums are accumulated in 8 lanes (lane j takes k % 8 == j), reduced as
+// ((l0+l4) + (l2+l6)) + ((l1+l5) + (l3+l7)), and then the remaining n % 8
+// terms are added in order.
+#define NLANES 8
+
+typedef float (*SumFunc)( const float *, const int32_t *, long, const float * );
+typedef void (*LearnFunc)( float *, const float *, const int32_t *, long, const float *, float, const LearningParams & );
+
+//---------------------------------------------------------------------------
+// learnOne
+//
+// The per-synapse update shared by every implementation's tail.
+//---------------------------------------------------------------------------
+static inline float learnOne( float efficacy,
+							  float lrate,
+							  float pre,
+							  float post,
+							  const LearningParams &params )
+{
+	float e = efficacy + (lrate * post) * pre;
+	float a = e < 0.0f ? -e : e;
+
+	if( a > params.halfMaxWeight )
+	{
+		e *= 1.0f - params.oneMinusDecayRate * (a - params.halfMaxWeight) / params.halfMaxWeight;
+		e = e < params.maxWeight ? e : params.maxWeight;
+		e = -params.maxWeight > e ? -params.maxWeight : e;
+	}
+	else if( lrate >= 0.0f )
+	{
+		e = 0.0f > e ? 0.0f : e;
+	}
+	else
+	{
+		e = -1.e-10f < e ? -1.e-10f : e;
+	}
+
+	return e;
+}
+
+//===========================================================================
+// Scalar
+//===========================================================================
+
+static float sumScalar( const float *efficacy,
+						const int32_t *from,
+						long n,
+						const float *activation )
+{
+	float l[NLANES] = { 0.0f };
+	long n8 = n & ~(long)(NLANES - 1);
+	long k;
+
+	for( k = 0; k < n8; k += NLANES )
+		for( int j = 0; j < NLANES; j++ )
+			l[j] += efficacy[k + j] * activation[from[k + j]];
+
+	float result = ((l[0] + l[4]) + (l[2] + l[6])) + ((l[1] + l[5]) + (l[3] + l[7]));
+	for( ; k < n; k++ )
+		result += efficacy[k] * activation[from[k]];
+
+	return result;
+}
+
+static void learnScalar( float *efficacy,
+						 const float *lrate,
+						 const int32_t *from,
+						 long n,
+						 const float *activation,
+						 float post,
+						 const LearningParams &params )
+{
+	for( long k = 0; k < n; k++ )
+		efficacy[k] = learnOne( efficacy[k], lrate[k], activation[from[k]] - 0.5f, post, params );
+}
+
+#if FRK_X86
+
+//===========================================================================
+// SSE2
+//===========================================================================
+
+__attribute__((target("sse2")))
+static inline __m128 gather4( const float *activation, const int32_t *from )
+{
+	return _mm_setr_ps( activation[from[0]], activation[from[1]], activation[from[2]], activation[from[3]] );
+}
+
+__attribute__((target("sse2")))
+static float sumSse2( const float *efficacy,
+					  const int32_t *from,
+					  long n,
+					  const float *activation )
+{
+	__m128 lo = _mm_setzero_ps();
+	__m128 hi = _mm_setzero_ps();
+	long n8 = n & ~(long)(NLANES - 1);
+	long k;
+
+	for( k = 0; k < n8; k += NLANES )
+	{
+		lo = _mm_add_ps( lo, _mm_mul_ps(_mm_loadu_ps(efficacy + k), gather4(activation, from + k)) );
+		hi = _mm_add_ps( hi, _mm_mul_ps(_mm_loadu_ps(efficacy + k + 4), gather4(activation, from + k + 4)) );
+	}
+
+	__m128 v = _mm_add_ps( lo, hi );
+	v = _mm_add_ps( v, _mm_movehl_ps(v, v) );
+	v = _mm_add_ss( v, _mm_shuffle_ps(v, v, 1) );
+	float result = _mm_cvtss_f32( v );
+
+	for( ; k < n; k++ )
+		result += efficacy[k] * activation[from[k]];
+
+	return result;
+}
+
+__attribute__((target("sse2")))
+static void learnSse2( float *efficacy,
+					   const float *lrate,
+					   const int32_t *from,
+					   long n,
+					   const float *activation,
+					   float post,
+					   const LearningParams &params )
+{
+	const __m128 vpost = _mm_set1_ps( post );
+	const __m128 vhalf = _mm_set1_ps( 0.5f );
+	const __m128 vhalfMax = _mm_set1_ps( params.halfMaxWeight );
+	const __m128 vmax = _mm_set1_ps( params.maxWeight );
+	const __m128 vnegMax = _mm_set1_ps( -params.maxWeight );
+	const __m128 vdecay = _mm_set1_ps( params.oneMinusDecayRate );
+	const __m128 vone = _mm_set1_ps( 1.0f );
+	const __m128 vzero = _mm_setzero_ps();
+	const __m128 vminInhibitory = _mm_set1_ps( -1.e-10f );
+	const __m128 vabsMask = _mm_castsi128_ps( _mm_set1_epi32(0x7fffffff) );
+	long n4 = n & ~3L;
+	long k;
+
+	for( k = 0; k < n4; k += 4 )
+	{
+		__m128 lr = _mm_loadu_ps( lrate + k );
+		__m128 pre = _mm_sub_ps( gather4(activation, from + k), vhalf );
+		__m128 e = _mm_add_ps( _mm_loadu_ps(efficacy + k), _mm_mul_ps(_mm_mul_ps(lr, vpost), pre) );
+		__m128 a = _mm_and_ps( e, vabsMask );
+
+		__m128 decayed = _mm_mul_ps( e, _mm_sub_ps(vone, _mm_div_ps(_mm_mul_ps(vdecay, _mm_sub_ps(a, vhalfMax)), vhalfMax)) );
+		decayed = _mm_max_ps( vnegMax, _mm_min_ps(decayed, vmax) );
+
+		__m128 excitatory = _mm_cmpge_ps( lr, vzero );
+		__m128 signKept = _mm_or_ps( _mm_and_ps(excitatory, _mm_max_ps(vzero, e)),
+									 _mm_andnot_ps(excitatory, _mm_min_ps(vminInhibitory, e)) );
+
+		__m128 large = _mm_cmpgt_ps( a, vhalfMax );
+		e = _mm_or_ps( _mm_and_ps(large, decayed), _mm_andnot_ps(large, signKept) );
+
+		_mm_storeu_ps( efficacy + k, e );
+	}
+
+	for( ; k < n; k++ )
+		efficacy[k] = learnOne( efficacy[k], lrate[k], activation[from[k]] - 0.5f, post, params );
+}
+
+//===========================================================================
+// AVX2
+//===========================================================================
+
+__attribute__((target("avx2")))
+static float sumAvx2( const float *efficacy,
+					  const int32_t *from,
+					  long n,
+					  const float *activation )
+{
+	__m256 acc = _mm256_setzero_ps();
+	long n8 = n & ~(long)(NLANES - 1);
+	long k;
+
+	for( k = 0; k < n8; k += NLANES )
+	{
+		__m256i idx = _mm256_loadu_si256( (const __m256i *)(from + k) );
+		__m256 act = _mm256_i32gather_ps( activation, idx, 4 );
+		acc = _mm256_add_ps( acc, _mm256_mul_ps(_mm256_loadu_ps(efficacy + k), act) );
+	}
+
+	__m128 v = _mm_add_ps( _mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1) );
+	v = _mm_add_ps( v, _mm_movehl_ps(v, v) );
+	v = _mm_add_ss( v, _mm_shuffle_ps(v, v, 1) );
+	float result = _mm_cvtss_f32( v );
+
+	for( ; k < n; k++ )
+		result += efficacy[k] * activation[from[k]];
+
+	return result;
+}
+
+__attribute__((target("avx2")))
+static void learnAvx2( float *efficacy,
+					   const float *lrate,
+					   const int32_t *from,
+					   long n,
+					   const float *activation,
+					   float post,
+					   const LearningParams &params )
+{
+	const __m256 vpost = _mm256_set1_ps( post );
+	const __m256 vhalf = _mm256_set1_ps( 0.5f );
+	const __m256 vhalfMax = _mm256_set1_ps( params.halfMaxWeight );
+	const __m256 vmax = _mm256_set1_ps( params.maxWeight );
+	const __m256 vnegMax = _mm256_set1_ps( -params.maxWeight );
+	const __m256 vdecay = _mm256_set1_ps( params.oneMinusDecayRate );
+	const __m256 vone = _mm256_set1_ps( 1.0f );
+	const __m256 vzero = _mm256_setzero_ps();
+	const __m256 vminInhibitory = _mm256_set1_ps( -1.e-10f );
+	const __m256 vabsMask = _mm256_castsi256_ps( _mm256_set1_epi32(0x7fffffff) );
+	long n8 = n & ~(long)(NLANES - 1);
+	long k;
+
+	for( k = 0; k < n8; k += NLANES )
+	{
+		__m256i idx = _mm256_loadu_si256( (const __m256i *)(from + k) );
+		__m256 lr = _mm256_loadu_ps( lrate + k );
+		__m256 pre = _mm256_sub_ps( _mm256_i32gather_ps(activation, idx, 4), vhalf );
+		__m256 e = _mm256_add_ps( _mm256_loadu_ps(efficacy + k), _mm256_mul_ps(_mm256_mul_ps(lr, vpost), pre) );
+		__m256 a = _mm256_and_ps( e, vabsMask );
+
+		__m256 decayed = _mm256_mul_ps( e, _mm256_sub_ps(vone, _mm256_div_ps(_mm256_mul_ps(vdecay, _mm256_sub_ps(a, vhalfMax)), vhalfMax)) );
+		decayed = _mm256_max_ps( vnegMax, _mm256_min_ps(decayed, vmax) );
+
+		__m256 excitatory = _mm256_cmp_ps( lr, vzero, _CMP_GE_OQ );
+		__m256 signKept = _mm256_blendv_ps( _mm256_min_ps(vminInhibitory, e), _mm256_max_ps(vzero, e), excitatory );
+
+		__m256 large = _mm256_cmp_ps( a, vhalfMax, _CMP_GT_OQ );
+		e = _mm256_blendv_ps( signKept, decayed, large );
+
+		_mm256_storeu_ps( efficacy + k, e );
+	}
+
+	for( ; k < n; k++ )
+		efficacy[k] = learnOne( efficacy[k], lrate[k], activation[from[k]] - 0.5f, post, params );
+}
+
+#endif // FRK_X86
+
+//===========================================================================
+// Dispatch
+//===========================================================================
+
+struct Impl
+{
+	const char *name;
+	SumFunc sum;
+	LearnFunc learn;
+};
+
+static Impl selectImpl()
+{
+#if FRK_X86
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports("avx2") )
+		return { "AVX2", sumAvx2, learnAvx2 };
+	if( __builtin_cpu_supports("sse2") )
+		return { "SSE2", sumSse2, learnSse2 };
+#endif
+	return { "Scalar", sumScalar, learnScalar };
+}
+
+static const Impl impl = selectImpl();
+
+//---------------------------------------------------------------------------
+// FiringRateKernel::getName
+//---------------------------------------------------------------------------
+const char *FiringRateKernel::getName()
+{
+	return impl.name;
+}
+
+//---------------------------------------------------------------------------
+// FiringRateKernel::sum
+//---------------------------------------------------------------------------
+float FiringRateKernel::sum( const float *efficacy,
+							 const int32_t *from,
+							 long n,
+							 const float *activation )
+{
+	return impl.sum( efficacy, from, n, activation );
+}
+
+//---------------------------------------------------------------------------
+// FiringRateKernel::learn
+//---------------------------------------------------------------------------
+void FiringRateKernel::learn( float *efficacy,
+							  const float *lrate,
+							  const int32_t *from,
+							  long n,
+							  const float *activation,
+							  float postActivation,
+							  const LearningParams &params )
+{
+	impl.learn( efficacy, lrate, from, n, activation, postActivation, params );
+}
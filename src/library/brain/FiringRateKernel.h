@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+//===========================================================================
+// FiringRateKernel
+//
+// Single-precision inner loops of FiringRateModel's SIMD update, each over
+// one neuron's row of synapses stored as separate efficacy, learning rate
+// and from-neuron arrays. The AVX2, SSE2 and scalar versions accumulate in
+// the same order and use no fused multiply-add, so they give bit-identical
+// results; the best one the CPU supports is chosen at startup.
+//===========================================================================
+namespace FiringRateKernel
+{
+	struct LearningParams
+	{
+		float maxWeight;
+		float halfMaxWeight;
+		float oneMinusDecayRate;
+	};
+
+	// Name of the implementation in use ("AVX2", "SSE2" or "Scalar").
+	const char *getName();
+
+	// Returns the sum of efficacy[k] * activation[from[k]] over the row.
+	float sum( const float *efficacy,
+			   const int32_t *from,
+			   long n,
+			   const float *activation );
+
+	// Hebbian update of the row's efficacies, given the postsynaptic
+	// neuron's new activation, followed by decay of large weights or,
+	// otherwise, keeping each synapse's sign that of its learning rate.
+	void learn( float *efficacy,
+				const float *lrate,
+				const int32_t *from,
+				long n,
+				const float *activation,
+				float postActivation,
+				const LearningParams &params );
+}
@@ -1,5 +1,6 @@
 #include "FiringRateModel.h"
 
+#include "FiringRateKernel.h"
 #include "genome/Genome.h"
 #include "genome/GenomeSchema.h"
 #include "sim/debug.h"
@@ -22,10 +23,16 @@ using namespace genome;
 FiringRateModel::FiringRateModel( NervousSystem *cns )
 : BaseNeuronModel<Neuron, NeuronAttrs, Synapse>( cns )
 {
+	packed.valid = false;
+	packed.usable = false;
+	packed.efficacyDirty = false;
+	packed.segment = NULL;
 }
 
 FiringRateModel::~FiringRateModel()
 {
+	if( packed.segment )
+		FiringRateArena::gArena.free( packed.segment );
 }
 
 void FiringRateModel::init_derived( double initial_activation )
@@ -57,11 +64,217 @@ void FiringRateModel::update( bool bprint )
 {
     debugcheck( "(firing-rate brain) on entry" );
 
-    short i;
-    long k;
     if ((neuron == NULL) || (synapse == NULL) || (neuronactivation == NULL))
         return;
 
+	if( (Brain::config.firingRateKernel == Brain::Configuration::KERNEL_SIMD) && !bprint && pack() )
+	{
+		updateSimd();
+	}
+	else
+	{
+		sync_synapses();
+		updateReference( bprint );
+		if( packed.usable )
+			synapses_changed();
+	}
+}
+
+bool FiringRateModel::enqueueUpdate()
+{
+	if( (Brain::config.firingRateKernel != Brain::Configuration::KERNEL_SIMD)
+		|| (neuron == NULL) || (synapse == NULL) || (neuronactivation == NULL)
+		|| !pack() )
+	{
+		return false;
+	}
+
+	packed.segment->queued = true;
+
+	return true;
+}
+
+void FiringRateModel::sync_synapses()
+{
+	if( !packed.efficacyDirty )
+		return;
+
+	const float *efficacy = packed.segment->efficacy;
+	for( long k = 0; k < dims->numSynapses; k++ )
+		synapse[k].efficacy = efficacy[k];
+
+	packed.efficacyDirty = false;
+}
+
+void FiringRateModel::synapses_changed()
+{
+	packed.valid = false;
+	packed.efficacyDirty = false;
+
+	if( packed.segment )
+	{
+		FiringRateArena::gArena.free( packed.segment );
+		packed.segment = NULL;
+	}
+}
+
+// Builds the packed copy of the neurons and synapses if needed. Returns
+// false if the synapses can't be packed, in which case the reference update
+// must be used.
+bool FiringRateModel::pack()
+{
+	if( packed.valid )
+		return packed.usable;
+
+	long numSynapses = dims->numSynapses;
+
+	packed.valid = true;
+	packed.efficacyDirty = false;
+	packed.usable = true;
+
+	// Each output and internal neuron's row must hold exactly the synapses
+	// to it, and the rows must cover all the synapses, so that learning row
+	// by row updates every synapse the reference update would.
+	long covered = 0;
+	for( int i = dims->getFirstOutputNeuron(); packed.usable && (i < dims->numNeurons); i++ )
+	{
+		long start = neuron[i].startsynapses;
+		long end = neuron[i].endsynapses;
+
+		if( (start < 0) || (end < start) || (end > numSynapses) )
+		{
+			packed.usable = false;
+			break;
+		}
+
+		for( long k = start; k < end; k++ )
+		{
+			if( synapse[k].toneuron != i )
+			{
+				packed.usable = false;
+				break;
+			}
+		}
+
+		covered += end - start;
+	}
+	if( covered != numSynapses )
+		packed.usable = false;
+
+	if( !packed.usable )
+		return false;
+
+	FiringRateArena::Segment *segment = FiringRateArena::gArena.alloc( this, dims->numNeurons, numSynapses );
+	packed.segment = segment;
+
+	for( int i = 0; i < dims->numNeurons; i++ )
+	{
+		FiringRateArena::Row &row = segment->rows[i];
+		Neuron &n = neuron[i];
+
+		row.bias = n.bias;
+		row.tau = n.tau;
+		row.gain = n.gain;
+		if( i < dims->getFirstOutputNeuron() )
+		{
+			row.start = 0;
+			row.count = 0;
+		}
+		else
+		{
+			row.start = n.startsynapses;
+			row.count = n.endsynapses - n.startsynapses;
+		}
+	}
+
+	for( long k = 0; k < numSynapses; k++ )
+	{
+		segment->efficacy[k] = synapse[k].efficacy;
+		segment->lrate[k] = synapse[k].lrate;
+		segment->from[k] = synapse[k].fromneuron;
+	}
+
+	return true;
+}
+
+// Single-precision update using the packed synapses. Each neuron's synapses
+// are learned right after its new activation is computed, rather than in a
+// second pass over all the synapses; since a row's efficacies only feed its
+// own neuron, the result is the same.
+void FiringRateModel::updateSimd()
+{
+	FiringRateArena::Segment *segment = packed.segment;
+	int firstOutput = dims->getFirstOutputNeuron();
+	int numneurons = dims->numNeurons;
+	const FiringRateArena::Row *rows = segment->rows;
+	float *activation = segment->activation;
+	float *efficacy = segment->efficacy;
+	const float *lrate = segment->lrate;
+	const int32_t *from = segment->from;
+
+	bool learn = Brain::config.enableLearning && !cns->getBrain()->isFrozen();
+	bool tauGain = Brain::config.neuronModel == Brain::Configuration::TAU_GAIN;
+	float logisticSlope = Brain::config.logisticSlope;
+
+	FiringRateKernel::LearningParams params;
+	params.maxWeight = Brain::config.maxWeight;
+	params.halfMaxWeight = 0.5f * Brain::config.maxWeight;
+	params.oneMinusDecayRate = 1.0f - Brain::config.decayRate;
+
+	for( int i = 0; i < numneurons; i++ )
+		activation[i] = (float)neuronactivation[i];
+
+	for( int i = 0; i < firstOutput; i++ )
+		newneuronactivation[i] = neuronactivation[i];
+
+	for( int i = firstOutput; i < numneurons; i++ )
+	{
+		const FiringRateArena::Row &n = rows[i];
+		long start = n.start;
+		long count = n.count;
+
+		float x = n.bias + FiringRateKernel::sum( efficacy + start, from + start, count, activation );
+
+		float newactivation;
+	#if GaussianOutputNeurons
+		if( i < dims->getFirstInternalNeuron() )
+			newactivation = gaussian( x, GaussianActivationMean, GaussianActivationVariance );
+		else
+	#endif
+		if( tauGain )
+			newactivation = (1.0f - n.tau) * activation[i]  +  n.tau * (float)logistic( x, n.gain );
+		else
+			newactivation = (float)logistic( x, logisticSlope );
+
+		newneuronactivation[i] = newactivation;
+
+		if( learn )
+			FiringRateKernel::learn( efficacy + start,
+									 lrate + start,
+									 from + start,
+									 count,
+									 activation,
+									 newactivation - 0.5f,
+									 params );
+	}
+
+	if( learn )
+		packed.efficacyDirty = true;
+
+    debugcheck( "after updating neurons and synapses" );
+
+    double* saveneuronactivation = neuronactivation;
+    neuronactivation = newneuronactivation;
+    newneuronactivation = saveneuronactivation;
+}
+
+// The original double-precision update, kept for comparison with earlier
+// runs and used whenever the SIMD update can't be.
+void FiringRateModel::updateReference( bool bprint )
+{
+    short i;
+    long k;
+
 	IF_BPRINTED
 	(
         printf("neuron (toneuron)  fromneuron   synapse   efficacy\n");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BaseNeuronModel.h"
+#include "FiringRateArena.h"
 
 // forward decls
 class NervousSystem;
@@ -52,4 +53,29 @@ class FiringRateModel : public BaseNeuronModel<FiringRateModel__Neuron, FiringRa
 							 int endsynapses );
 
 	virtual void update( bool bprint );
+	virtual bool enqueueUpdate();
+
+	virtual void sync_synapses();
+	virtual void synapses_changed();
+
+ private:
+	friend class FiringRateArena;
+
+	void updateReference( bool bprint );
+	void updateSimd();
+	bool pack();
+
+	// Single-precision copy of the neurons and synapses used by
+	// updateSimd(), kept in FiringRateArena. The synapses have the same
+	// indices as synapse[] but are split into arrays so each neuron's row
+	// can be loaded with vector instructions. Built by the first update
+	// after synapses_changed(); while efficacyDirty, learning has changed the
+	// packed efficacies since they were last copied back to synapse[].
+	struct Packed
+	{
+		bool valid;
+		bool usable;	// synapse[] is partitioned into the neurons' rows
+		bool efficacyDirty;
+		FiringRateArena::Segment *segment;
+	} packed;
 };
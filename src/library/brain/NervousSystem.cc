@@ -43,6 +43,13 @@ void NervousSystem::grow( Genome *g )
 }
 
 void NervousSystem::update( bool bprint )
+{
+	updateSensors( bprint );
+
+	b->update( bprint );
+}
+
+void NervousSystem::updateSensors( bool bprint )
 {
 	for( SensorList::iterator
 			 it = sensors.begin(),
@@ -52,8 +59,6 @@ void NervousSystem::update( bool bprint )
 	{
 		(*it)->sensor_update( bprint );
 	}	
-
-	b->update( bprint );
 }
 
 float NervousSystem::getEnergyUse()
@@ -144,7 +149,7 @@ void NervousSystem::prebirthSignal()
 	}	
 }
 
-void NervousSystem::startFunctional( AbstractFile *f )
+void NervousSystem::startFunctional( std::string &organs )
 {
 	for( SensorList::iterator
 			 it = sensors.begin(),
@@ -152,7 +157,7 @@ void NervousSystem::startFunctional( AbstractFile *f )
 		 it != end;
 		 it++ )
 	{
-		(*it)->sensor_start_functional( f );
+		(*it)->sensor_start_functional( organs );
 	}	
 }
 
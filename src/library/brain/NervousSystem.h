@@ -28,6 +28,7 @@ class NervousSystem
 
 	virtual void grow( genome::Genome *g );
 	void update( bool bprint );
+	void updateSensors( bool bprint );
 
 	RandomNumberGenerator *getRNG();
 	Brain *getBrain();
@@ -47,7 +48,7 @@ class NervousSystem
 
 	void prebirth();
 	void prebirthSignal();
-	void startFunctional( AbstractFile *f );
+	void startFunctional( std::string &organs );
 	void dumpAnatomical( AbstractFile *f );
 
  protected:
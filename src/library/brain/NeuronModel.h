@@ -3,9 +3,12 @@
 #include <stdio.h>
 
 #include <iostream>
+#include <string>
 
 // forward decls
 class AbstractFile;
+class CheckPointReader;
+class CheckPointWriter;
 
 #define DebugDumpAnatomical false
 #if DebugDumpAnatomical
@@ -58,6 +61,9 @@ class NeuronModel
 							  float lrate ) = 0;
 
 	virtual void update( bool bprint ) = 0;
+	// Leaves the update to a population-wide batch run after all the brains'
+	// inputs are set, if the model supports it; see FiringRateArena.
+	virtual bool enqueueUpdate() { return false; }
 
 	virtual void getActivations( double *activations, int start, int count ) = 0;
 	virtual void setActivations( double *activations, int start, int count ) = 0;
@@ -72,4 +78,15 @@ class NeuronModel
 	virtual void loadSynapses( AbstractFile *file ) = 0;
 	virtual void copySynapses( NeuronModel *other ) = 0;
 	virtual void scaleSynapses( float factor ) = 0;
+
+	// The neurons and synapses as growth leaves them, so an identical network
+	// can be made without growing it; see BrainGrowthCache. setGrowth()
+	// expects the dimensions they were got with.
+	virtual void getGrowth( std::string &neurons, std::string &synapses ) = 0;
+	virtual void setGrowth( const std::string &neurons, const std::string &synapses ) = 0;
+
+	// Everything that changes once the network is built: neurons,
+	// activations and synapses.
+	virtual void dumpState( CheckPointWriter &out ) = 0;
+	virtual void loadState( CheckPointReader &in ) = 0;
 };
@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 
+#include <string>
 #include <vector>
 
 class AbstractFile;
@@ -15,7 +16,8 @@ class Sensor
 	virtual void sensor_grow( NervousSystem *cns ) = 0;
 	virtual void sensor_prebirth_signal( RandomNumberGenerator *rng ) = 0;
 	virtual void sensor_update( bool bprint ) = 0;
-	virtual void sensor_start_functional( AbstractFile * ) {}
+	// Appends the sensor's part of the brain function header.
+	virtual void sensor_start_functional( std::string & ) {}
 	virtual void sensor_dump_anatomical( AbstractFile * ) {}
 };
 
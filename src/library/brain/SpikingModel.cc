@@ -3,6 +3,8 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include <algorithm>
+
 #include "NervousSystem.h"
 #include "genome/Genome.h"
 #include "genome/GenomeSchema.h"
@@ -10,6 +12,13 @@
 #include "utils/misc.h"
 #include "utils/RandomNumberGenerator.h"
 
+// The event-driven update must round exactly as the reference update does,
+// so neither may contract a multiply and add into one fused instruction.
+#if defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+	#pragma GCC optimize ("fp-contract=off")
+#endif
 
 using namespace std;
 
@@ -21,6 +30,9 @@ SpikingModel::SpikingModel( NervousSystem *cns, float scale_latest_spikes_ )
 	this->rng = cns->getRNG();
 
 	outputActivation = NULL;
+
+	events.valid = false;
+	events.usable = false;
 }
 
 SpikingModel::~SpikingModel()
@@ -69,7 +81,37 @@ void SpikingModel::set_neuron( int index,
 	n.maxfiringcount = 1;
 }
 
+void SpikingModel::dumpState( CheckPointWriter &out )
+{
+	BaseNeuronModel<Neuron, NeuronAttrs, Synapse>::dumpState( out );
+
+	out.putArray( outputActivation, dims->numOutputNeurons );
+}
+
+void SpikingModel::loadState( CheckPointReader &in )
+{
+	BaseNeuronModel<Neuron, NeuronAttrs, Synapse>::loadState( in );
+
+	in.getArray( outputActivation, dims->numOutputNeurons );
+}
+
+void SpikingModel::synapses_changed()
+{
+	events.valid = false;
+}
+
 void SpikingModel::update( bool bprint )
+{
+	if( (neuron == NULL) || (synapse == NULL) || (neuronactivation == NULL) )
+		return;
+
+	if( (Brain::config.spikingEngine == Brain::Configuration::SPIKING_EVENT_DRIVEN) && prepareEvents() )
+		updateEventDriven();
+	else
+		updateReference();
+}
+
+void SpikingModel::updateReference()
 {
 	FILE *fHandle = NULL;
 
@@ -140,7 +182,7 @@ void SpikingModel::update( bool bprint )
     double* saveneuronactivation = neuronactivation;
 
 	//calculate activity in each neuron i then learn for each synapse in i
-	long synapsesToDepress[dims->numSynapses];
+	synapsesToDepress.resize( dims->numSynapses );
 	int numSynapsesToDepress = 0, startSynapsesToDepress = 0;
 	short fromNeuron = 0;
 	for (n_steps = 0; n_steps < BrainStepsPerWorldStep; n_steps++)
@@ -336,6 +378,361 @@ void SpikingModel::update( bool bprint )
 	}//end brainsteps
 
 
+	learn();
+
+	updateOutputActivations( outputNeuronFiringCounter );
+
+
+//###################################################################################################################################
+
+
+//watch your ass buddy I got a damn sigbus here check out run_sigbus do I need to lock the file
+//this can't be threaded.  I did switch moniters maybe that cause the error?????
+#if 1
+	if(fHandle)
+	{
+		for(int i = 0; i < dims->getFirstOutputNeuron(); i++ )
+		{
+			fprintf( fHandle, "%d %1.4f\t", i, (float)NeuronFiringCounter[i]/BrainStepsPerWorldStep);
+			for(int j=0; j<BrainStepsPerWorldStep; j++)
+				fprintf( fHandle, "%c", spikeMatrix[i][j] );
+			fprintf( fHandle, "\n");
+		}
+		for (int i = dims->getFirstOutputNeuron(); i < dims->numNeurons; i++)
+		{
+			fprintf( fHandle, "%d %1.4f\t", i, neuronactivation[i]);
+			for(int j=0; j<BrainStepsPerWorldStep; j++)
+				fprintf( fHandle, "%c", spikeMatrix[i][j] );
+			fprintf( fHandle, "\n");
+		}
+
+	}
+#endif
+}
+
+// Builds the event-driven update's state if needed. Returns false if the
+// brain's synapses can't be updated that way.
+bool SpikingModel::prepareEvents()
+{
+	if( events.valid )
+		return events.usable;
+
+	events.valid = true;
+	events.usable = false;
+
+	int numNeurons = dims->numNeurons;
+	long numSynapses = dims->numSynapses;
+	int firstOutput = dims->getFirstOutputNeuron();
+
+	// Every synapse visited must lie in its to-neuron's row, and in no other
+	// row, for the marks of a brain step to be read back by row.
+	vector<unsigned char> inRow( numSynapses, 0 );
+	vector<int32_t> outCount( numNeurons + 1, 0 );
+	for( int i = firstOutput; i < numNeurons; i++ )
+	{
+		Neuron &n = neuron[i];
+		if( (n.startsynapses < 0) || (n.endsynapses > numSynapses) )
+			return false;
+
+		for( long k = n.startsynapses; k < n.endsynapses; k++ )
+		{
+			int from = abs( synapse[k].fromneuron );
+			if( inRow[k] || (abs(synapse[k].toneuron) != i) || (from >= numNeurons) )
+				return false;
+			inRow[k] = 1;
+			outCount[from + 1]++;
+		}
+	}
+
+	events.outStart.assign( numNeurons + 1, 0 );
+	for( int j = 0; j < numNeurons; j++ )
+		events.outStart[j + 1] = events.outStart[j] + outCount[j + 1];
+
+	events.outSynapse.resize( events.outStart[numNeurons] );
+	events.outTarget.resize( events.outStart[numNeurons] );
+	vector<int32_t> next( events.outStart.begin(), events.outStart.end() - 1 );
+	for( int i = firstOutput; i < numNeurons; i++ )
+	{
+		for( long k = neuron[i].startsynapses; k < neuron[i].endsynapses; k++ )
+		{
+			int32_t p = next[ abs(synapse[k].fromneuron) ]++;
+			events.outSynapse[p] = k;
+			events.outTarget[p] = i;
+		}
+	}
+
+	events.marked.assign( (numSynapses + 63) / 64, 0 );
+	events.touched.reserve( numNeurons );
+	events.isTouched.assign( numNeurons, 0 );
+	events.fired.reserve( numNeurons );
+	events.prevFired.reserve( numNeurons );
+
+	events.current.assign( numNeurons, 0.0 );
+	events.v.resize( numNeurons );
+	events.u.resize( numNeurons );
+	events.a.resize( numNeurons );
+	events.b.resize( numNeurons );
+	events.c.resize( numNeurons );
+	events.d.resize( numNeurons );
+	events.biasProbability.resize( numNeurons );
+	events.biasFired.assign( numNeurons, 0 );
+	for( int i = firstOutput; i < numNeurons; i++ )
+	{
+		Neuron &n = neuron[i];
+		events.a[i] = n.SpikingParameter_a;
+		events.b[i] = n.SpikingParameter_b;
+		events.c[i] = n.SpikingParameter_c;
+		events.d[i] = n.SpikingParameter_d;
+		events.biasProbability[i] = 1.0 / (1.0 + exp(-1 * n.bias * .5));
+	}
+	events.inputFiringProbability.resize( dims->numInputNeurons );
+	events.outputNeuronFiringCounter.resize( dims->numOutputNeurons );
+
+	events.stdp.resize( numNeurons );
+
+	events.usable = true;
+
+	return true;
+}
+
+// Calls f(k) for each synapse k in [start, end) whose bit is set, in order.
+template<typename F>
+static inline void forEachMarked( const uint64_t *marked, long start, long end, F f )
+{
+	for( long w = start >> 6; (w << 6) < end; w++ )
+	{
+		uint64_t bits = marked[w];
+		if( (w << 6) < start )
+			bits &= ~uint64_t(0) << (start & 63);
+		if( ((w + 1) << 6) > end )
+			bits &= ~uint64_t(0) >> (64 - (end & 63));
+
+		for( ; bits; bits &= bits - 1 )
+			f( (w << 6) + __builtin_ctzll(bits) );
+	}
+}
+
+// Same results as updateReference(), bit for bit: the random numbers are
+// drawn in the same order, each synapse's delta sees the same operations,
+// and each neuron's input is summed over its row in the same order. When the
+// neurons that spiked on the previous brain step have few synapses between
+// them, only those synapses are visited, by following the lists of synapses
+// leaving each neuron and marking the synapses reached; otherwise every row
+// is scanned, as updateReference() does. The membrane equations and STDP
+// decay are computed over arrays of all the neurons at once.
+void SpikingModel::updateEventDriven()
+{
+	int numNeurons = dims->numNeurons;
+	int firstOutput = dims->getFirstOutputNeuron();
+	int firstInternal = dims->getFirstInternalNeuron();
+	long numSynapses = dims->numSynapses;
+
+	float *inputFiringProbability = events.inputFiringProbability.data();
+	int *outputNeuronFiringCounter = events.outputNeuronFiringCounter.data();
+	uint64_t *marked = events.marked.data();
+	double *current = events.current.data();
+	double *v = events.v.data();
+	double *u = events.u.data();
+	float *stdp = events.stdp.data();
+	const double *a = events.a.data();
+	const double *b = events.b.data();
+	const double *c = events.c.data();
+	const double *d = events.d.data();
+	const unsigned char *biasFired = events.biasFired.data();
+
+	// The output neurons' activations are firing rates between updates; the
+	// inputs' are firing probabilities.
+	for( int i = 0; i < dims->numOutputNeurons; i++ )
+	{
+		outputNeuronFiringCounter[i] = 0;
+		if( neuron[i + firstOutput].v >= 30 )
+			neuronactivation[i + firstOutput] = SpikingActivation;
+		else
+			neuronactivation[i + firstOutput] = 0;
+	}
+
+	for( int i = 0; i < dims->numInputNeurons; i++ )
+	{
+		inputFiringProbability[i] = neuronactivation[i];
+		neuronactivation[i] = 0;
+	}
+
+	events.fired.clear();
+	for( int i = 0; i < numNeurons; i++ )
+	{
+		v[i] = neuron[i].v;
+		u[i] = neuron[i].u;
+		stdp[i] = neuron[i].STDP;
+
+		if( neuronactivation[i] )
+			events.fired.push_back( i );
+	}
+
+	for( int step = 0; step < BrainStepsPerWorldStep; step++ )
+	{
+		events.prevFired.swap( events.fired );
+		events.fired.clear();
+
+		for( int i = 0; i < firstOutput; i++ )
+		{
+			if( rng->drand() < inputFiringProbability[i] )
+			{
+				newneuronactivation[i] = SpikingActivation;
+				v[i] = 31;	// for STDP, as in updateReference()
+				events.fired.push_back( i );
+			}
+			else
+			{
+				newneuronactivation[i] = 0.0;
+				v[i] = -30;
+			}
+		}
+
+#if USE_BIAS
+		for( int i = firstOutput; i < numNeurons; i++ )
+			events.biasFired[i] = rng->drand() < events.biasProbability[i];
+#endif
+
+		long reached = 0;
+		for( int j : events.prevFired )
+			reached += events.outStart[j + 1] - events.outStart[j];
+
+		// Following the spikes costs several times as much per synapse as
+		// scanning the rows.
+		bool sparse = reached * 4 < numSynapses;
+
+		if( sparse )
+		{
+			for( int j : events.prevFired )
+			{
+				for( int32_t p = events.outStart[j]; p < events.outStart[j + 1]; p++ )
+				{
+					int32_t k = events.outSynapse[p];
+					int32_t to = events.outTarget[p];
+
+					marked[k >> 6] |= uint64_t(1) << (k & 63);
+					if( !events.isTouched[to] )
+					{
+						events.isTouched[to] = 1;
+						events.touched.push_back( to );
+					}
+				}
+			}
+
+			for( int i : events.touched )
+			{
+				double input = .0;
+				forEachMarked( marked, neuron[i].startsynapses, neuron[i].endsynapses, [&]( long k ) {
+						input += synapse[k].efficacy * neuronactivation[abs(synapse[k].fromneuron)];
+					});
+				current[i] = input;
+			}
+		}
+		else
+		{
+			for( int i = firstOutput; i < numNeurons; i++ )
+			{
+				double input = .0;
+				for( long k = neuron[i].startsynapses; k < neuron[i].endsynapses; k++ )
+				{
+					double activation = neuronactivation[abs(synapse[k].fromneuron)];
+					if( activation )
+						input += synapse[k].efficacy * activation;
+				}
+				current[i] = input;
+			}
+		}
+
+		#pragma omp simd
+		for( int i = firstOutput; i < numNeurons; i++ )
+		{
+			bool spiked = v[i] >= 30.;
+			double vi = spiked ? c[i] : v[i];
+			double ui = spiked ? u[i] + d[i] : u[i];
+			double input = biasFired[i] ? current[i] + BIAS_INJECTED_VOLTAGE : current[i];
+
+			v[i] = vi + (.5 * ((0.04 * vi * vi) + (5 * vi) + 140-ui + input));
+			u[i] = ui + a[i] * (b[i] * vi - ui);
+		}
+
+		for( int i = firstOutput; i < numNeurons; i++ )
+		{
+			if( v[i] >= 30. )
+			{
+				if( i < firstInternal )
+					outputNeuronFiringCounter[i - firstOutput]++;
+				newneuronactivation[i] = SpikingActivation;
+				events.fired.push_back( i );
+
+				// Potentiate every incoming synapse.
+				for( long k = neuron[i].startsynapses; k < neuron[i].endsynapses; k++ )
+					synapse[k].delta += stdp[abs(synapse[k].fromneuron)];
+			}
+			else
+			{
+				newneuronactivation[i] = 0.;
+			}
+		}
+
+		// Depress the synapses that carried a spike to a neuron that didn't
+		// fire.
+		if( sparse )
+		{
+			for( int i : events.touched )
+			{
+				bool depress = v[i] < 30.;
+				float stdp_i = stdp[i];
+
+				forEachMarked( marked, neuron[i].startsynapses, neuron[i].endsynapses, [&]( long k ) {
+						if( depress )
+							synapse[k].delta -= stdp_i;
+						marked[k >> 6] &= ~(uint64_t(1) << (k & 63));
+					});
+
+				current[i] = 0.0;
+				events.isTouched[i] = 0;
+			}
+			events.touched.clear();
+		}
+		else
+		{
+			for( int i = firstOutput; i < numNeurons; i++ )
+			{
+				current[i] = 0.0;
+				if( v[i] >= 30. )
+					continue;
+
+				for( long k = neuron[i].startsynapses; k < neuron[i].endsynapses; k++ )
+					if( neuronactivation[abs(synapse[k].fromneuron)] )
+						synapse[k].delta -= stdp[i];
+			}
+		}
+
+		double *saveneuronactivation = neuronactivation;
+		neuronactivation = newneuronactivation;
+		newneuronactivation = saveneuronactivation;
+
+		#pragma omp simd
+		for( int i = 0; i < numNeurons; i++ )
+			stdp[i] = v[i] > 30 ? STDP_RESET : stdp[i] * STDP_DEGRADATION_SCALER;
+	}
+
+	for( int i = 0; i < numNeurons; i++ )
+	{
+		neuron[i].v = v[i];
+		neuron[i].u = u[i];
+		neuron[i].STDP = stdp[i];
+	}
+
+	learn();
+
+	updateOutputActivations( outputNeuronFiringCounter );
+}
+
+// Moves the synapses' efficacies by the deltas accumulated over the brain
+// steps.
+void SpikingModel::learn()
+{
 	if (Brain::config.enableLearning && !cns->getBrain()->isFrozen())
 	{
 		//now this is where learning actually takes place.  It's here that we take the delta's we've been modifying
@@ -345,7 +742,7 @@ void SpikingModel::update( bool bprint )
 		float learningrate;
 		// float half_max_weight = .5f * Brain::config.maxWeight, one_minus_decay = 1. - Brain::config.decayRate;
 
-        for (k = 0; k < dims->numSynapses; k++)
+        for (long k = 0; k < dims->numSynapses; k++)
         {
 			learningrate = synapse[k].lrate;
 			synapse[k].delta *= .9; //cheating a little
@@ -400,56 +797,25 @@ void SpikingModel::update( bool bprint )
 		}
 */
     }
+}
 
-
-	//simulation.cc readworldfile
-	//when you change bump the version number
-	//when version < new version then set spiking to false.
-	//tsimulation object might want fUseSpikingModel or something similair.
-
-	// compute smoothed output unit activation levels
-
-	double currentActivationLevel[dims->numOutputNeurons];
+// Sets the output neurons' activations to their smoothed firing rates.
+void SpikingModel::updateOutputActivations( const int *outputNeuronFiringCounter )
+{
+	double currentActivationLevel;
 	float scale_total_spikes = 1.0-scale_latest_spikes;
-	for (i = 0; i < dims->numOutputNeurons; i++)
+	for (int i = 0; i < dims->numOutputNeurons; i++)
 	{
 		neuron[i+dims->getFirstOutputNeuron()].maxfiringcount = max(outputNeuronFiringCounter[i], (int) neuron[i+dims->getFirstOutputNeuron()].maxfiringcount);
 
 #if USE_BIAS
-		currentActivationLevel[i]=fmin(1.0, (double)outputNeuronFiringCounter[i] / (double)BrainStepsPerWorldStep);
+		currentActivationLevel=fmin(1.0, (double)outputNeuronFiringCounter[i] / (double)BrainStepsPerWorldStep);
 #else
-		currentActivationLevel[i]=fmin(1.0, (double)outputNeuronFiringCounter[i] / (double)neuron[i+dims->getFirstOutputNeuron()].maxfiringcount);
+		currentActivationLevel=fmin(1.0, (double)outputNeuronFiringCounter[i] / (double)neuron[i+dims->getFirstOutputNeuron()].maxfiringcount);
 #endif
-		outputActivation[i] = scale_total_spikes * outputActivation[i]  +  scale_latest_spikes * currentActivationLevel[i];
+		outputActivation[i] = scale_total_spikes * outputActivation[i]  +  scale_latest_spikes * currentActivationLevel;
 
 		neuronactivation[i+dims->getFirstOutputNeuron()] = outputActivation[i];
 
 	}
-
-
-//###################################################################################################################################
-
-
-//watch your ass buddy I got a damn sigbus here check out run_sigbus do I need to lock the file
-//this can't be threaded.  I did switch moniters maybe that cause the error?????
-#if 1
-	if(fHandle)
-	{
-		for(int i = 0; i < dims->getFirstOutputNeuron(); i++ )
-		{
-			fprintf( fHandle, "%d %1.4f\t", i, (float)NeuronFiringCounter[i]/BrainStepsPerWorldStep);
-			for(int j=0; j<BrainStepsPerWorldStep; j++)
-				fprintf( fHandle, "%c", spikeMatrix[i][j] );
-			fprintf( fHandle, "\n");
-		}
-		for (int i = dims->getFirstOutputNeuron(); i < dims->numNeurons; i++)
-		{
-			fprintf( fHandle, "%d %1.4f\t", i, neuronactivation[i]);
-			for(int j=0; j<BrainStepsPerWorldStep; j++)
-				fprintf( fHandle, "%c", spikeMatrix[i][j] );
-			fprintf( fHandle, "\n");
-		}
-
-	}
-#endif
 }
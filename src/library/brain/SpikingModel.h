@@ -1,5 +1,9 @@
 #pragma once
 
+#include <stdint.h>
+
+#include <vector>
+
 #include "BaseNeuronModel.h"
 
 #define USE_BIAS				true
@@ -73,10 +77,55 @@ class SpikingModel : public BaseNeuronModel<SpikingModel__Neuron, SpikingModel__
 
 	virtual void update( bool bprint );
 
+	virtual void dumpState( CheckPointWriter &out );
+	virtual void loadState( CheckPointReader &in );
+
+	virtual void synapses_changed();
+
  private:
+	void updateReference();
+	void updateEventDriven();
+	bool prepareEvents();
+	void learn();
+	void updateOutputActivations( const int *outputNeuronFiringCounter );
+
 	RandomNumberGenerator *rng;
 
 	float scale_latest_spikes;
 
 	double *outputActivation;
+
+	// Scratch space for the reference update.
+	std::vector<long> synapsesToDepress;
+
+	// State of the event-driven update, built by the first update after
+	// synapses_changed(). The neurons' state is copied into arrays for the
+	// length of an update.
+	struct
+	{
+		bool valid;
+		bool usable;	// synapse[] is partitioned into the neurons' rows
+
+		// Synapses leaving each neuron, as (synapse, to-neuron) lists:
+		// neuron j's are [outStart[j], outStart[j+1]).
+		std::vector<int32_t> outStart;
+		std::vector<int32_t> outSynapse;
+		std::vector<int32_t> outTarget;
+
+		// Synapses carrying a spike this brain step, one bit per synapse.
+		std::vector<uint64_t> marked;
+		std::vector<int32_t> touched;
+		std::vector<unsigned char> isTouched;
+		std::vector<int32_t> fired;
+		std::vector<int32_t> prevFired;
+
+		std::vector<double> current;
+		std::vector<double> v, u, a, b, c, d;
+		std::vector<double> biasProbability;
+		std::vector<unsigned char> biasFired;
+		std::vector<float> inputFiringProbability;
+		std::vector<int> outputNeuronFiringCounter;
+
+		std::vector<float> stdp;
+	} events;
 };
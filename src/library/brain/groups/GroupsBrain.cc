@@ -2,6 +2,7 @@
 
 #include "GroupsNeuralNetRenderer.h"
 #include "agent/agent.h"
+#include "brain/BrainGrowthCache.h"
 #include "brain/FiringRateModel.h"
 #include "brain/NervousSystem.h"
 #include "brain/SpikingModel.h"
@@ -26,11 +27,7 @@ static float initminweight = 0.0; // could read this in
 #define ALLOC_GROW_STACK_BUFFERS()										\
 	int __numgroups = _genome->getGroupCount(NGT_ANY);			\
 	ALLOC_STACK_BUFFER( firsteneur, short );							\
-	ALLOC_STACK_BUFFER( firstineur, short );							\
-	ALLOC_STACK_BUFFER( eeremainder, float );							\
-	ALLOC_STACK_BUFFER( eiremainder, float );							\
-	ALLOC_STACK_BUFFER( iiremainder, float );							\
-	ALLOC_STACK_BUFFER( ieremainder, float )
+	ALLOC_STACK_BUFFER( firstineur, short )
 
 GroupsBrain::Configuration GroupsBrain::config;
 
@@ -150,7 +147,7 @@ void GroupsBrain::initNeuralNet( double initial_activation )
 	case Brain::Configuration::SPIKING:
 		{
 			SpikingModel *spiking = new SpikingModel( _cns,
-													  _genome->get("ScaleLatestSpikes") );
+													  _genome->get(_genome->genes().scaleLatestSpikes) );
 			_neuralnet = spiking;
 			_renderer = new GroupsNeuralNetRenderer<SpikingModel>( spiking, _genome );
 		}
@@ -366,6 +363,12 @@ void GroupsBrain::grow()
 	}
 #endif
 
+	BrainGrowthCache::GrowthRef growth;
+	if( BrainGrowthCache::isEnabled() )
+		growth = BrainGrowthCache::find( _genome );
+	if( growth )
+		_dims.numSynapses = growth->dims.numSynapses;
+
 	// ---
 	// --- Allocate Neural Net
 	// ---
@@ -375,6 +378,46 @@ void GroupsBrain::grow()
 
     debugcheck( "after allocating brain memory" );
 
+	if( growth )
+	{
+		// An identical genome grew this brain recently.
+		_neuralnet->setGrowth( growth->neurons, growth->synapses );
+	}
+	else
+	{
+		growNeuralNet( firsteneur, firstineur );
+
+		if( BrainGrowthCache::isEnabled() )
+		{
+			BrainGrowthCache::Growth *newGrowth = new BrainGrowthCache::Growth();
+			newGrowth->dims = _dims;
+			_neuralnet->getGrowth( newGrowth->neurons, newGrowth->synapses );
+			BrainGrowthCache::insert( _genome, BrainGrowthCache::GrowthRef(newGrowth) );
+		}
+	}
+
+	// ---
+	// --- Calculate Energy Use
+	// ---
+    _energyUse = Brain::config.maxneuron2energy * float(_dims.numNeurons) / float(config.maxneurons)
+		+ Brain::config.maxsynapse2energy * float(_dims.numSynapses) / float(config.maxsynapses);
+
+    debugcheck( "after setting up brain architecture" );
+}
+
+//---------------------------------------------------------------------------
+// GroupsBrain::growNeuralNet
+//
+// Sets up the neurons and grows their synapses, once the neural net is
+// allocated.
+//---------------------------------------------------------------------------
+void GroupsBrain::growNeuralNet( short *firsteneur, short *firstineur )
+{
+	__ALLOC_STACK_BUFFER( eeremainder, float, _numgroups );
+	__ALLOC_STACK_BUFFER( eiremainder, float, _numgroups );
+	__ALLOC_STACK_BUFFER( iiremainder, float, _numgroups );
+	__ALLOC_STACK_BUFFER( ieremainder, float, _numgroups );
+
     long numsyn = 0;
     short numneur = _dims.numInputNeurons;
 
@@ -609,14 +652,6 @@ void GroupsBrain::grow()
 		_dims.numSynapses = numsyn;
 	}
 	//printf( "numsynapses=%ld\n", numsyn );
-
-	// ---
-	// --- Calculate Energy Use
-	// ---
-    _energyUse = Brain::config.maxneuron2energy * float(_dims.numNeurons) / float(config.maxneurons)
-		+ Brain::config.maxsynapse2energy * float(_dims.numSynapses) / float(config.maxsynapses);
-
-    debugcheck( "after setting up brain architecture" );
 }
 
 //---------------------------------------------------------------------------
@@ -638,29 +673,15 @@ void GroupsBrain::growSynapses( int groupIndex_to,
 #endif
 
 	RandomNumberGenerator *td_rng;
-	Gene *td_seedGene;
 	if( config.enableTopologicalDistortionRngSeed )
-	{
 		td_rng = RandomNumberGenerator::create( RandomNumberGenerator::TOPOLOGICAL_DISTORTION );
-		td_seedGene = _genome->gene( "TopologicalDistortionRngSeed" );
-	}
 	else
-	{
 		td_rng = _cns->getRNG();
-		td_seedGene = NULL;
-	}
 	RandomNumberGenerator *weight_rng;
-	Gene *weight_seedGene;
 	if( config.enableInitWeightRngSeed )
-	{
 		weight_rng = RandomNumberGenerator::create( RandomNumberGenerator::INIT_WEIGHT );
-		weight_seedGene = _genome->gene( "InitWeightRngSeed" );
-	}
 	else
-	{
 		weight_rng = _cns->getRNG();
-		weight_seedGene = NULL;
-	}
 
 	for (int groupIndex_from = 0; groupIndex_from < _numgroups; groupIndex_from++)
 	{
@@ -693,7 +714,7 @@ void GroupsBrain::growSynapses( int groupIndex_to,
 										g_groupIndex_to );
 		if( config.enableTopologicalDistortionRngSeed )
 		{
-			long td_seed = _genome->get( td_seedGene,
+			long td_seed = _genome->get( _genome->TOPOLOGICAL_DISTORTION_RNG_SEED,
 										 synapseType,
 										 g_groupIndex_from,
 										 g_groupIndex_to );
@@ -701,7 +722,7 @@ void GroupsBrain::growSynapses( int groupIndex_to,
 		}
 		if( config.enableInitWeightRngSeed )
 		{
-			long weight_seed = _genome->get( weight_seedGene,
+			long weight_seed = _genome->get( _genome->INIT_WEIGHT_RNG_SEED,
 											 synapseType,
 											 g_groupIndex_from,
 											 g_groupIndex_to );
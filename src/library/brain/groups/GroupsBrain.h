@@ -65,6 +65,7 @@ class GroupsBrain : public Brain
 	short nearestFreeNeuron(short iin, bool* used, short num, short exclude);
 
 	void grow();
+	void growNeuralNet( short *firsteneur, short *firstineur );
 	void growSynapses( int groupIndex_to,
 					   short neuronCount_to,
 					   float *remainder,
@@ -68,6 +68,21 @@ SheetsBrain::SheetsBrain( NervousSystem *cns, SheetsGenome *genome, SheetsModel
 	delete model;
 }
 
+//---------------------------------------------------------------------------
+// SheetsBrain::SheetsBrain
+//---------------------------------------------------------------------------
+SheetsBrain::SheetsBrain( NervousSystem *cns, SheetsGenome *genome, BrainGrowthCache::GrowthRef growth )
+: Brain( cns )
+, _numInternalSheets( 0 )
+, _numInternalNeurons( 0 )
+{
+	memset( _numSynapses, 0, sizeof(_numSynapses) );
+
+	_dims = growth->dims;
+	initNeuralNet( genome );
+	loadGrowth( growth );
+}
+
 //---------------------------------------------------------------------------
 // SheetsBrain::~SheetsBrain
 //---------------------------------------------------------------------------
@@ -148,29 +163,7 @@ void SheetsBrain::grow( SheetsGenome *genome, SheetsModel *model )
 	// ---
 	// --- Instantiate Neural Net
 	// ---
-	{
-		switch( Brain::config.neuronModel )
-		{
-		case Brain::Configuration::SPIKING:
-			{
-				SpikingModel *spiking = new SpikingModel( _cns,
-														  genome->get("ScaleLatestSpikes") );
-				_neuralnet = spiking;
-			}
-			break;
-		case Brain::Configuration::FIRING_RATE:
-		case Brain::Configuration::TAU_GAIN:
-			{
-				FiringRateModel *firingRate = new FiringRateModel( _cns );
-				_neuralnet = firingRate;
-			}
-			break;
-		default:
-			assert(false);
-		}
-
-		_neuralnet->init( &_dims, 0.0 );
-	}
+	initNeuralNet( genome );
 
 	// ---
 	// --- Configure Neural Net
@@ -202,4 +195,86 @@ void SheetsBrain::grow( SheetsGenome *genome, SheetsModel *model )
 			_neuralnet->set_neuron_endsynapses( neuron->id, synapseIndex );
 		}
 	}
+
+	if( BrainGrowthCache::isEnabled() )
+		saveGrowth( genome );
+}
+
+//---------------------------------------------------------------------------
+// SheetsBrain::initNeuralNet
+//---------------------------------------------------------------------------
+void SheetsBrain::initNeuralNet( SheetsGenome *genome )
+{
+	switch( Brain::config.neuronModel )
+	{
+	case Brain::Configuration::SPIKING:
+		{
+			SpikingModel *spiking = new SpikingModel( _cns,
+													  genome->get(genome->genes().scaleLatestSpikes) );
+			_neuralnet = spiking;
+		}
+		break;
+	case Brain::Configuration::FIRING_RATE:
+	case Brain::Configuration::TAU_GAIN:
+		{
+			FiringRateModel *firingRate = new FiringRateModel( _cns );
+			_neuralnet = firingRate;
+		}
+		break;
+	default:
+		assert(false);
+	}
+
+	_neuralnet->init( &_dims, 0.0 );
+}
+
+//---------------------------------------------------------------------------
+// SheetsBrain::saveGrowth
+//
+// The counts are the internal sheets and neurons, the synapses between each
+// pair of sheet types, and then each nerve's size and first neuron.
+//---------------------------------------------------------------------------
+void SheetsBrain::saveGrowth( SheetsGenome *genome )
+{
+	BrainGrowthCache::Growth *growth = new BrainGrowthCache::Growth();
+
+	growth->dims = _dims;
+	_neuralnet->getGrowth( growth->neurons, growth->synapses );
+
+	growth->counts.push_back( _numInternalSheets );
+	growth->counts.push_back( _numInternalNeurons );
+	for( int from = 0; from < Sheet::__NTYPES; from++ )
+		for( int to = 0; to < Sheet::__NTYPES; to++ )
+			growth->counts.push_back( _numSynapses[from][to] );
+	citfor( NervousSystem::NerveList, _cns->getNerves(), it )
+	{
+		growth->counts.push_back( (*it)->getNeuronCount() );
+		growth->counts.push_back( (*it)->getIndex() );
+	}
+
+	BrainGrowthCache::insert( genome, BrainGrowthCache::GrowthRef(growth) );
+}
+
+//---------------------------------------------------------------------------
+// SheetsBrain::loadGrowth
+//---------------------------------------------------------------------------
+void SheetsBrain::loadGrowth( BrainGrowthCache::GrowthRef growth )
+{
+	_neuralnet->setGrowth( growth->neurons, growth->synapses );
+
+	const int *counts = &growth->counts[0];
+
+	_numInternalSheets = *counts++;
+	_numInternalNeurons = *counts++;
+	for( int from = 0; from < Sheet::__NTYPES; from++ )
+		for( int to = 0; to < Sheet::__NTYPES; to++ )
+			_numSynapses[from][to] = *counts++;
+	citfor( NervousSystem::NerveList, _cns->getNerves(), it )
+	{
+		int numneurons = *counts++;
+		int index = *counts++;
+		(*it)->config( numneurons, index );
+	}
+
+	assert( counts == &growth->counts[0] + growth->counts.size() );
 }
@@ -2,6 +2,7 @@
 
 #include "SheetsModel.h"
 #include "brain/Brain.h"
+#include "brain/BrainGrowthCache.h"
 
 namespace genome { class SheetsGenome; }
 
@@ -30,6 +31,8 @@ class SheetsBrain : public Brain
 	static void init();
 
 	SheetsBrain( NervousSystem *cns, genome::SheetsGenome *genome, sheets::SheetsModel *model );
+	// A copy of a brain grown from an identical genome.
+	SheetsBrain( NervousSystem *cns, genome::SheetsGenome *genome, BrainGrowthCache::GrowthRef growth );
 	virtual ~SheetsBrain();
 
 	int getNumInternalSheets();
@@ -38,6 +41,9 @@ class SheetsBrain : public Brain
 
  private:
     void grow( genome::SheetsGenome *genome, sheets::SheetsModel *model );
+	void initNeuralNet( genome::SheetsGenome *genome );
+	void saveGrowth( genome::SheetsGenome *genome );
+	void loadGrowth( BrainGrowthCache::GrowthRef growth );
 
 	int _numInternalSheets;
 	int _numInternalNeurons;
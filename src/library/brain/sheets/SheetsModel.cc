@@ -135,6 +135,7 @@ Sheet::Sheet( SheetsModel *model,
 Sheet::~Sheet()
 {
 	delete [] _neurons;
+	delete [] _absPositions;
 }
 
 //---------------------------------------------------------------------------
@@ -194,28 +195,24 @@ Neuron *Sheet::getNeuron( Vector2i index )
 }
 
 //---------------------------------------------------------------------------
-// Sheet::addReceptiveField
+// Sheet::findReceptiveFieldSynapses
 //---------------------------------------------------------------------------
-void Sheet::addReceptiveField( ReceptiveFieldRole role,
-							   Vector2f currentCenter,
-							   Vector2f currentSize,
-							   Vector2f otherCenter,
-							   Vector2f otherSize,
-							   Vector2f fieldOffset,
-							   Vector2f fieldSize,
-							   Sheet *other,
-							   function<bool (Neuron *, ReceptiveFieldNeuronRole)> neuronPredicate,
-							   function<void (Synapse *)> synapseCreated )
+void Sheet::findReceptiveFieldSynapses( const ReceptiveField &field,
+										vector<NeuronPair> &result )
 {
+	Sheet *other = field.other;
+
+	Vector2f currentSize = field.currentSize;
 	currentSize.a = max( currentSize.a, _neuronSpacing.a );
 	currentSize.b = max( currentSize.b, _neuronSpacing.b );
 
+	Vector2f fieldSize = field.fieldSize;
 	fieldSize.a = max( fieldSize.a, other->_neuronSpacing.a );
 	fieldSize.b = max( fieldSize.b, other->_neuronSpacing.b );
 
 	ReceptiveFieldNeuronRole currentNeuronRole;
 	ReceptiveFieldNeuronRole otherNeuronRole;
-	switch( role )
+	switch( field.role )
 	{
 	case Source:
 		currentNeuronRole = To;
@@ -229,15 +226,24 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 		assert( false );
 	}
 
-	NeuronSubset currentNeurons = findNeurons( currentCenter, currentSize );
-	NeuronSubset otherNeurons = other->findNeurons( otherCenter, otherSize );
+	NeuronSubset currentNeurons = findNeurons( field.currentCenter, currentSize );
+	NeuronSubset otherNeurons = other->findNeurons( field.otherCenter, field.otherSize );
+
+	if( otherNeurons.size() < 1 )
+		return;
+
+	// The receptive fields of neighbouring neurons overlap, so remember
+	// whether each neuron of the other region passes the predicate: 0 if not
+	// yet asked, else 1 if it fails or 2 if it passes.
+	int otherWidth = otherNeurons._end.a - otherNeurons._begin.a + 1;
+	vector<unsigned char> otherPasses( otherNeurons.size(), 0 );
 
 	// Iterate over each neuron in this sheet's region.
 	for( Vector2i currentNeuronIndex : currentNeurons )
 	{
 		Neuron *currentNeuron = getNeuron( currentNeuronIndex );
 
-		if( !neuronPredicate(currentNeuron, currentNeuronRole) )
+		if( !field.neuronPredicate(currentNeuron, currentNeuronRole) )
 			continue;
 
 		// ---
@@ -245,7 +251,7 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 		// ---
 		NeuronSubset allReceptiveFieldNeurons =
 			other->findReceptiveFieldNeurons( currentNeuron->sheetPosition,
-											  fieldOffset,
+											  field.fieldOffset,
 											  fieldSize );
 
 		// ---
@@ -261,8 +267,6 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 		constrainedReceptiveFieldNeurons._end.b = min( allReceptiveFieldNeurons._end.b,
 													   otherNeurons._end.b );
 
-		//cout << "otherCount=" << other->_neuronCount << ", otherCenter=" << otherCenter << ", otherSize=" << otherSize << ", otherNeurons=" << otherNeurons << ", allRF=" << allReceptiveFieldNeurons << ", constrainRF=" << constrainedReceptiveFieldNeurons << ", size=" << constrainedReceptiveFieldNeurons.size() << endl;
-
 		if( constrainedReceptiveFieldNeurons.size() < 1 )
 			continue;
 		
@@ -273,6 +277,7 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 		Neuron *fieldNeurons[ constrainedReceptiveFieldNeurons.size() ];
 		int nfieldNeurons = 0;
 		float totalDistance = 0;
+		Vector3f currentPosition = currentNeuron->absPosition;
 
 		for( Vector2i otherNeuronIndex : constrainedReceptiveFieldNeurons )
 		{
@@ -282,11 +287,15 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 			if( currentNeuron == otherNeuron )
 				continue;
 
-			if( !neuronPredicate(otherNeuron, otherNeuronRole) )
+			unsigned char &passes = otherPasses[ (otherNeuronIndex.a - otherNeurons._begin.a)
+												 + (otherNeuronIndex.b - otherNeurons._begin.b) * otherWidth ];
+			if( passes == 0 )
+				passes = field.neuronPredicate( otherNeuron, otherNeuronRole ) ? 2 : 1;
+			if( passes == 1 )
 				continue;
 
 			fieldNeurons[ nfieldNeurons++ ] = otherNeuron;
-			totalDistance += currentNeuron->absPosition.distance( otherNeuron->absPosition );
+			totalDistance += currentPosition.distance( other->_absPositions[otherNeuron - other->_neurons] );
 		}
 
 		// No neurons in receptive field.
@@ -304,29 +313,25 @@ void Sheet::addReceptiveField( ReceptiveFieldRole role,
 			continue;
 
 		// ---
-		// --- Create synapses
+		// --- Choose synapses
 		// ---
 		int stride = nfieldNeurons / nsynapses;
 
 		for( int offset = 0; nsynapses > 0; offset += stride, nsynapses-- )
 		{
 			Neuron *otherNeuron = fieldNeurons[offset];
-			Synapse *synapse = NULL;
 
-			switch( role )
+			switch( field.role )
 			{
 			case Source:
-				synapse = createSynapse( otherNeuron, currentNeuron );
+				result.push_back( NeuronPair(otherNeuron, currentNeuron) );
 				break;
 			case Target:
-				synapse = createSynapse( currentNeuron, otherNeuron );
+				result.push_back( NeuronPair(currentNeuron, otherNeuron) );
 				break;
 			default:
 				assert( false );
 			}
-
-			if( synapse )
-				synapseCreated( synapse );
 		}
 	}
 }
@@ -365,6 +370,7 @@ void Sheet::trim( float &center, float &size )
 void Sheet::createNeurons( function<void (Neuron*)> &neuronCreated )
 {
 	_neurons = new Neuron[ _nneurons ];
+	_absPositions = new Vector3f[ _nneurons ];
 
 	for( int i = 0; i < _neuronCount.a; i++ )
 	{
@@ -403,6 +409,7 @@ void Sheet::createNeurons( function<void (Neuron*)> &neuronCreated )
 
 			// Scale to model size.
 			neuron->absPosition.scale( _sheetsModel->getSize() );
+			_absPositions[ neuron - _neurons ] = neuron->absPosition;
 
 			trc( "Neuron[" << i << "," << j << "]: sheetPos=" << neuron->sheetPosition << ", absPos=" << neuron->absPosition );
 
@@ -585,6 +592,37 @@ const SheetVector &SheetsModel::getSheets( Sheet::Type type )
 	}
 }
 
+//---------------------------------------------------------------------------
+// SheetsModel::addReceptiveFields
+//
+// Laying out a field only reads the sheets, so that's done for all the
+// fields at once. Creating a synapse fails if an earlier field created the
+// same one, so the synapses are then created one field at a time, in order.
+//---------------------------------------------------------------------------
+void SheetsModel::addReceptiveFields( ReceptiveFieldVector &fields, int nthreads )
+{
+	int nfields = (int)fields.size();
+	vector< vector<Sheet::NeuronPair> > fieldSynapses( nfields );
+
+	#pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads) if(nthreads > 1 && nfields > 1)
+	for( int i = 0; i < nfields; i++ )
+	{
+		fields[i].sheet->findReceptiveFieldSynapses( fields[i], fieldSynapses[i] );
+	}
+
+	for( int i = 0; i < nfields; i++ )
+	{
+		ReceptiveField &field = fields[i];
+
+		for( Sheet::NeuronPair &pair : fieldSynapses[i] )
+		{
+			Synapse *synapse = field.sheet->createSynapse( pair.first, pair.second );
+			if( synapse )
+				field.synapseCreated( synapse );
+		}
+	}
+}
+
 //---------------------------------------------------------------------------
 // SheetsModel::cull
 //---------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "brain/FiringRateModel.h"
@@ -170,6 +171,8 @@ namespace sheets
 
 	std::ostream &operator<<( std::ostream &out, const NeuronSubset &n );
 
+	struct ReceptiveField;
+
 	//===========================================================================
 	// Sheet
 	//===========================================================================
@@ -219,16 +222,14 @@ namespace sheets
 		{
 			From, To
 		};
-		void addReceptiveField( ReceptiveFieldRole role,
-								Vector2f currentCenter,
-								Vector2f currentSize,
-								Vector2f otherCenter,
-								Vector2f otherSize,
-								Vector2f fieldOffset,
-								Vector2f fieldSize,
-								Sheet *other,
-								std::function<bool (Neuron *, ReceptiveFieldNeuronRole)> neuronPredicate,
-								std::function<void (Synapse *)> synapseCreated );
+		typedef std::pair<Neuron *, Neuron *> NeuronPair;	// from, to
+
+		// The synapses a receptive field of this sheet calls for, in the
+		// order they're to be created. This only reads the sheets, so the
+		// fields may be laid out concurrently; see
+		// SheetsModel::addReceptiveFields().
+		void findReceptiveFieldSynapses( const ReceptiveField &field,
+										 std::vector<NeuronPair> &result );
 
 	private:
 		NeuronSubset findNeurons( const Vector2f &center,
@@ -256,10 +257,34 @@ namespace sheets
 		Vector2f _neuronInsets;
 		int _nneurons;
 		Neuron *_neurons;
+		Vector3f *_absPositions;	// the neurons', packed for findReceptiveFieldSynapses()
 	};
 
 	typedef std::vector<Sheet *> SheetVector;
 
+	//===========================================================================
+	// ReceptiveField
+	//
+	// Connects neurons of the current sheet's region to those of the other
+	// sheet's region that lie within a field centered on each of them.
+	//===========================================================================
+	struct ReceptiveField
+	{
+		Sheet *sheet;
+		Sheet::ReceptiveFieldRole role;
+		Vector2f currentCenter;
+		Vector2f currentSize;
+		Vector2f otherCenter;
+		Vector2f otherSize;
+		Vector2f fieldOffset;
+		Vector2f fieldSize;
+		Sheet *other;
+		std::function<bool (Neuron *, Sheet::ReceptiveFieldNeuronRole)> neuronPredicate;
+		std::function<void (Synapse *)> synapseCreated;
+	};
+
+	typedef std::vector<ReceptiveField> ReceptiveFieldVector;
+
 	//===========================================================================
 	// SheetsModel
 	//===========================================================================
@@ -284,6 +309,10 @@ namespace sheets
 		Sheet *getSheet( int id );
 		const SheetVector &getSheets( Sheet::Type type );
 
+		// Creates the fields' synapses as if the fields were added one at a
+		// time in order, laying them out on up to nthreads threads.
+		void addReceptiveFields( ReceptiveFieldVector &fields, int nthreads );
+
 		void cull();
 
 		NeuronVector &getNeurons();
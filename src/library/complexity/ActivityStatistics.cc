@@ -0,0 +1,194 @@
+#include "ActivityStatistics.h"
+
+#include <assert.h>
+
+#include <gsl/gsl_matrix.h>
+
+#include "complexity_brain.h"
+#include "utils/CheckPoint.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// ActivityStatistics::ActivityStatistics
+//---------------------------------------------------------------------------
+ActivityStatistics::ActivityStatistics( Mode mode_,
+										long agentNumber_,
+										long birthStep_,
+										int numNeurons_,
+										int numInputNeurons_,
+										int numOutputNeurons_ )
+: mode( mode_ )
+, agentNumber( agentNumber_ )
+, birthStep( birthStep_ )
+, numNeurons( numNeurons_ )
+, numInputNeurons( numInputNeurons_ )
+, numOutputNeurons( numOutputNeurons_ )
+, numSteps( 0 )
+, windowSteps( 0 )
+{
+	if( mode == COVARIANCE )
+	{
+		mean.resize( numNeurons, 0.0 );
+		comoment.resize( (long)numNeurons * (numNeurons + 1) / 2, 0.0 );
+		delta.resize( numNeurons );
+	}
+	else
+	{
+		windowSteps = GetMaxNumTimeStepsToComputeComplexityOver();
+		assert( windowSteps > 0 );
+	}
+}
+
+//---------------------------------------------------------------------------
+// ActivityStatistics::add
+//---------------------------------------------------------------------------
+void ActivityStatistics::add( const double *activations )
+{
+	numSteps++;
+
+	if( mode == COVARIANCE )
+	{
+		// C += (x - mean_old)(x - mean_new)' == (1 - 1/n)(x - mean_old)(x - mean_old)'
+		double inv = 1.0 / numSteps;
+		double scale = 1.0 - inv;
+		double *d = delta.data();
+
+		for( int i = 0; i < numNeurons; i++ )
+		{
+			d[i] = activations[i] - mean[i];
+			mean[i] += d[i] * inv;
+		}
+
+		double *c = comoment.data();
+		for( int i = 0; i < numNeurons; i++ )
+		{
+			double di = d[i] * scale;
+
+			#pragma omp simd
+			for( int j = 0; j <= i; j++ )
+				c[j] += di * d[j];
+
+			c += i + 1;
+		}
+	}
+	else
+	{
+		float *step;
+		if( numSteps <= windowSteps )
+		{
+			window.resize( window.size() + numNeurons );
+			step = window.data() + window.size() - numNeurons;
+		}
+		else
+		{
+			step = window.data() + ((numSteps - 1) % windowSteps) * numNeurons;
+		}
+
+		for( int i = 0; i < numNeurons; i++ )
+			step[i] = activations[i];
+	}
+}
+
+//---------------------------------------------------------------------------
+// ActivityStatistics::calcComplexity
+//---------------------------------------------------------------------------
+double ActivityStatistics::calcComplexity( const char *part, Events *events )
+{
+	if( numSteps < 2 )
+		return 0.0;
+
+	double complexity;
+
+	if( mode == COVARIANCE )
+	{
+		gsl_matrix *COV = gsl_matrix_alloc( numNeurons, numNeurons );
+
+		const double *c = comoment.data();
+		for( int i = 0; i < numNeurons; i++ )
+		{
+			for( int j = 0; j <= i; j++ )
+			{
+				double cov = c[j] / (numSteps - 1);
+				gsl_matrix_set( COV, i, j, cov );
+				gsl_matrix_set( COV, j, i, cov );
+			}
+			c += i + 1;
+		}
+
+		complexity = CalcComplexityWithCOV_brainfunction( COV,
+														  numSteps,
+														  part,
+														  numInputNeurons,
+														  numOutputNeurons );
+		gsl_matrix_free( COV );
+	}
+	else
+	{
+		// Oldest step first, as in the log
+		long numRows = window.size() / numNeurons;
+		long oldest = numSteps > windowSteps ? numSteps % windowSteps : 0;
+		gsl_matrix *activity = gsl_matrix_alloc( numRows, numNeurons );
+
+		for( long row = 0; row < numRows; row++ )
+		{
+			const float *step = window.data() + ((oldest + row) % numRows) * numNeurons;
+			for( int i = 0; i < numNeurons; i++ )
+				gsl_matrix_set( activity, row, i, step[i] );
+		}
+
+		complexity = CalcComplexityWithActivity_brainfunction( activity,
+															   part,
+															   events,
+															   agentNumber,
+															   birthStep,
+															   numSteps,
+															   numInputNeurons,
+															   numOutputNeurons );
+		gsl_matrix_free( activity );
+	}
+
+	return complexity;
+}
+
+//---------------------------------------------------------------------------
+// ActivityStatistics::dumpState
+//---------------------------------------------------------------------------
+void ActivityStatistics::dumpState( CheckPointWriter &out )
+{
+	out.put( birthStep );
+	out.put( numSteps );
+
+	if( mode == COVARIANCE )
+	{
+		out.putArray( mean.data(), mean.size() );
+		out.putArray( comoment.data(), comoment.size() );
+	}
+	else
+	{
+		out.put( (long)window.size() );
+		out.putArray( window.data(), window.size() );
+	}
+}
+
+//---------------------------------------------------------------------------
+// ActivityStatistics::loadState
+//---------------------------------------------------------------------------
+void ActivityStatistics::loadState( CheckPointReader &in )
+{
+	in.get( birthStep );
+	in.get( numSteps );
+
+	if( mode == COVARIANCE )
+	{
+		in.getArray( mean.data(), mean.size() );
+		in.getArray( comoment.data(), comoment.size() );
+	}
+	else
+	{
+		long size;
+		in.get( size );
+		window.resize( size );
+		in.getArray( window.data(), window.size() );
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <vector>
+
+class CheckPointReader;
+class CheckPointWriter;
+class Events;
+
+//===========================================================================
+// ActivityStatistics
+//
+// What a brain keeps of its activity while it lives, so that its complexity
+// can be calculated when it dies without writing and reading back its
+// brainFunction log.
+//
+// COVARIANCE keeps only the mean and co-moments of the neurons' activations
+// over the whole life, updated each step by Welford's method, so memory and
+// time per step are O(neurons^2) however long the agent lives. Activity isn't
+// Gaussianized and events can't be filtered.
+//
+// WINDOW keeps the activations of the last
+// GetMaxNumTimeStepsToComputeComplexityOver() steps, the same steps
+// complexity is calculated over from the log, and calculates it the same way.
+//===========================================================================
+class ActivityStatistics
+{
+ public:
+	enum Mode
+	{
+		COVARIANCE,
+		WINDOW
+	};
+
+	ActivityStatistics( Mode mode,
+						long agentNumber,
+						long birthStep,
+						int numNeurons,
+						int numInputNeurons,
+						int numOutputNeurons );
+
+	void add( const double *activations );
+
+	// part is as for CalcComplexity_brainfunction.
+	double calcComplexity( const char *part, Events *events = NULL );
+
+	void dumpState( CheckPointWriter &out );
+	void loadState( CheckPointReader &in );
+
+ private:
+	Mode mode;
+	long agentNumber;
+	long birthStep;
+	int numNeurons;
+	int numInputNeurons;
+	int numOutputNeurons;
+	long numSteps;
+
+	// COVARIANCE
+	std::vector<double> mean;
+	std::vector<double> comoment;	// lower triangle, row by row
+	std::vector<double> delta;
+
+	// WINDOW
+	long windowSteps;
+	std::vector<float> window;	// ring of steps once full
+};
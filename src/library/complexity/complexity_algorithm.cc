@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "complexity_fast.h"
 #include "utils/next_combination.h"
 
 // RescaleCOV and Fix_I can go away, as RescaleCOV should always be off
@@ -28,6 +29,8 @@
 #endif
 
 static bool Gaussianize = true;
+static bool FastComplexityEngine = true;
+static int ComplexityThreads = 0;
 
 using namespace std;
 
@@ -73,6 +76,30 @@ void setGaussianize( bool gaussianize )
 }
 
 
+//---------------------------------------------------------------------------
+// setFastComplexity()
+//
+// allows client code to choose between FastComplexity and the reference
+// calcC_k() and calcC_k_exact(), which agree to within rounding
+//---------------------------------------------------------------------------
+void setFastComplexity( bool fast )
+{
+	FastComplexityEngine = fast;
+}
+
+
+//---------------------------------------------------------------------------
+// setComplexityThreads()
+//
+// sets the number of threads FastComplexity evaluates subsets with; 0 means
+// OpenMP's default
+//---------------------------------------------------------------------------
+void setComplexityThreads( int numThreads )
+{
+	ComplexityThreads = numThreads;
+}
+
+
 //---------------------------------------------------------------------------
 // create_rng()
 //
@@ -380,7 +407,7 @@ double determinant( gsl_matrix* m )
 //---------------------------------------------------------------------------
 double calcC_k( gsl_matrix* COV, double I_n, int k )
 {
-	#define NumSamples 1000
+	#define NumSamples C_kNumSamples
 	
 	int n = COV->size1;
 
@@ -551,13 +578,11 @@ double CalcComplexityWithMatrix( gsl_matrix* data )
 //---------------------------------------------------------------------------
 double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints )
 {
-	double complexity = 0.0;
-	
     // if have an invalid matrix return 0.
     if( data == NULL )
     {
     	fprintf( stderr, "\n%s passed NULL data matrix\n", __func__ );
-    	return complexity;
+    	return 0.0;
 	}
 	
 	// Make room for a copy of the data, that we will add noise to and possibly Gaussianize
@@ -576,14 +601,12 @@ double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints
 		gsamp( m );	// replaces original columns by rank-equivalent Gaussian distributions
 
 	gsl_matrix* COV;
-	size_t n;
 	double det;
 	
 	do
 	{
 		// We calculate the covariance matrix and use it to compute Complexity.
 		COV = calcCOV( m );
-		n = COV->size1;	// same as size2
 	
 		det = determinant( COV );
 		
@@ -612,21 +635,78 @@ double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints
 	}
 	while( det == 0.0 );
 
+	gsl_matrix_free( m );
+	dispose_rng( randNumGen );
+
+	double complexity = CalcApproximateFullComplexityWithDeterminant( COV, det, numPoints );
+
+	gsl_matrix_free( COV );
+
+	return( complexity );
+}
+
+
+//---------------------------------------------------------------------------
+// CalcApproximateFullComplexityWithCOV
+//
+// For data whose covariance matrix is already known, such as one accumulated
+// while the data was produced. The noise CalcApproximateFullComplexityWithMatrix
+// injects into the data is accounted for by adding its variance to the
+// diagonal, so COV is modified.
+//---------------------------------------------------------------------------
+double CalcApproximateFullComplexityWithCOV( gsl_matrix* COV, int numPoints )
+{
+	double noise_scale = 0.00001;
+	for( size_t i = 0; i < COV->size1; i++ )
+		gsl_matrix_set( COV, i, i, gsl_matrix_get( COV, i, i ) + noise_scale*noise_scale );
+
+	double det = determinant( COV );
+
+	// If the determinant is zero, add more noise, as for data
+	while( det == 0.0 )
+	{
+		if( noise_scale*10.0 < 1.1 )
+		{
+			noise_scale *= 10.0;
+			for( size_t i = 0; i < COV->size1; i++ )
+				gsl_matrix_set( COV, i, i, gsl_matrix_get( COV, i, i ) + noise_scale*noise_scale );
+			det = determinant( COV );
+		}
+		else
+		{
+			det = 1.e-250;
+		}
+	}
+
+	return( CalcApproximateFullComplexityWithDeterminant( COV, det, numPoints ) );
+}
+
+
+//---------------------------------------------------------------------------
+// CalcApproximateFullComplexityWithDeterminant
+//
+// Calculates complexity from the covariance matrix and its (non-zero)
+// determinant.
+//---------------------------------------------------------------------------
+double CalcApproximateFullComplexityWithDeterminant( gsl_matrix* COV, double det, int numPoints )
+{
+	double complexity = 0.0;
+	size_t n = COV->size1;	// same as size2
+
 	double I_n = CalcI( COV, det );
 	
 #if RescaleCOV
 	rescaleCOV( COV, det );
 #endif
 
-	gsl_matrix_free( m );
-	dispose_rng( randNumGen );
-	
+	FastComplexity *fast = (FastComplexityEngine && n > 1) ? new FastComplexity( COV, ComplexityThreads ) : NULL;
+
 	if( numPoints <= 0 || (size_t) numPoints >= n )
 		numPoints = n-1;		// zero (or invalid value) means use all (non-zero) points
 
 	if( numPoints == 1 )	// use just the k=N-1 point, which is the original simplified TSE complexity
 	{
-		complexity = calcC_k_exact( COV, I_n, n-1 );
+		complexity = fast ? fast->calcC_k_exact( I_n, n-1 ) : calcC_k_exact( COV, I_n, n-1 );
 	}
 	else if( (size_t) numPoints < n )
 	{
@@ -656,7 +736,7 @@ double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints
 		{
 			float_k += delta_k;
 			k = lround( float_k );
-			c_k = calcC_k( COV, I_n, k );
+			c_k = fast ? fast->calcC_k( I_n, k ) : calcC_k( COV, I_n, k );
 			dk = k - k_prev;
 			delta_c = dk * 0.5 * (c_k + c_prev);	// area of next quadrilateral
 			complexity += delta_c;
@@ -669,7 +749,7 @@ double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints
 		// same as the original simplified TSE (which is Olbrich's version of excess entropy).
 		k = n - 1;
 		dk = k - k_prev;
-		c_k = calcC_k_exact( COV, I_n, k );			// last non-zero term
+		c_k = fast ? fast->calcC_k_exact( I_n, k ) : calcC_k_exact( COV, I_n, k );	// last non-zero term
 		delta_c = dk * 0.5 * (c_k + c_prev);		// area of final quadrilateral
 		complexity += delta_c;
 		calcC_k_print( "%d: I_%d = %g, C_%d = %g, dk = %d, dc = %g, c = %g\n", numPoints, k, I_n*(n-1)/n, k, c_k, dk, delta_c, complexity );
@@ -687,7 +767,7 @@ double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints
 		complexity /= n;	// based on Olbrich et al 2008, How should complexity scale with system size?, Eur. Phys. J. B
 	}
 
-	gsl_matrix_free( COV );
+	delete fast;
 
 	return( complexity );
 }
@@ -16,8 +16,13 @@
 
 #define DEFAULT_SEED 42
 
+// Number of subsets sampled to estimate <I(X_k)> when there are more than that
+const int C_kNumSamples = 1000;
+
 bool n_choose_k_le_s( int n, int k, int s );
 void setGaussianize( bool gaussianize );
+void setFastComplexity( bool fast );
+void setComplexityThreads( int numThreads );
 
 gsl_rng *create_rng( int seed );
 void dispose_rng( gsl_rng *rng );
@@ -47,6 +52,8 @@ int qsort_compare_rows0( const void *a, const void *b );
 double CalcComplexityWithMatrix( gsl_matrix* data );
 double CalcComplexityWithVector( gsl_vector* vector, size_t blockDuration, size_t blockOffset );
 double CalcApproximateFullComplexityWithMatrix( gsl_matrix* data, int numPoints );
+double CalcApproximateFullComplexityWithCOV( gsl_matrix* COV, int numPoints );
+double CalcApproximateFullComplexityWithDeterminant( gsl_matrix* COV, double det, int numPoints );
 double CalcApproximateFullComplexityWithVector( gsl_vector* vector, size_t blockDuration, size_t blockOffset, int numPoints );
 
 #endif // COMPLEXITY_ALGORITHM_H
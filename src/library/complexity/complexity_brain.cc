@@ -6,7 +6,9 @@
 #include <list>
 
 #include "complexity_algorithm.h"
+#include "brain/BrainFunctionFile.h"
 #include "utils/AbstractFile.h"
+#include "utils/LogContainer.h"
 
 using namespace std;
 
@@ -60,6 +62,8 @@ using namespace std;
 //===========================================================================
 
 void FilterActivity( gsl_matrix* activity, const char* filter_events, const long agent_number, const long agent_birth, const long lifespan, Events* events, long numinputneurons );
+static bool SelectComplexityColumns( const char *part, long numneurons, long numinputneurons, long numoutputneurons, int *columns, int *numColumns, int *num_points );
+gsl_matrix * readin_brainfunction_binary( AbstractFile *FunctionFile, const char* fname, bool tile, int num_timesteps, int max_timesteps, long *agent_number, long *agent_birth, long *lifespan, long *num_neurons, long *num_ineurons, long *num_oneurons );
 
 //===========================================================================
 // Function Implementations
@@ -78,23 +82,103 @@ CalcComplexity_brainfunction_result *
 	if( callback )
 		callback->begin( parms, nparms );
 
-#pragma omp parallel for
+	// Consecutive parms that read the same activity from the same file are
+	// done together, so each file is read once and only one activity matrix
+	// per thread is held at a time.
+	vector<int> runs;
 	for( int iparm = 0; iparm < nparms; iparm++ )
 	{
-		CalcComplexity_brainfunction_parms *parm = &parms[iparm];
+		if( iparm == 0
+			|| strcmp(parms[iparm].path, parms[iparm - 1].path) != 0
+			|| parms[iparm].tile != parms[iparm - 1].tile
+			|| parms[iparm].num_timesteps != parms[iparm - 1].num_timesteps )
+		{
+			runs.push_back( iparm );
+		}
+	}
+	int nruns = runs.size();
+	runs.push_back( nparms );
+
+	// Files vary a lot in length, so threads take the next one as they finish.
+#pragma omp parallel for schedule(dynamic, 1)
+	for( int irun = 0; irun < nruns; irun++ )
+	{
+		vector<int> pending;
+		for( int iparm = runs[irun]; iparm < runs[irun + 1]; iparm++ )
+		{
+			if( callback && callback->parms_cached(result, iparm) )
+				callback->parms_result( result, iparm );
+			else
+				pending.push_back( iparm );
+		}
 
-		double complexity = CalcComplexity_brainfunction( parm->path,
-								 parm->parts,
-								 parm->events,
-								 parm->tile,
-								 parm->num_timesteps,
-								 result->agent_number + iparm,
-								 result->lifespan + iparm,
-								 result->num_neurons + iparm );
-		result->complexity[iparm] = complexity;
+		if( pending.empty() )
+			continue;
+
+		CalcComplexity_brainfunction_parms *first = &parms[ pending.front() ];
+		long numinputneurons = 0;
+		long numoutputneurons = 0;
+		long agent_birth = -1;
+		long agent_num = 0;
+		long agent_lifespan = 0;
+		long num_neurons = 0;
+
+		gsl_matrix *activity = readin_brainfunction( first->path,
+													 first->tile,
+													 first->num_timesteps,
+													 first->tile ? 0 : MaxNumTimeStepsToComputeComplexityOver,
+													 &agent_num,
+													 &agent_birth,
+													 &agent_lifespan,
+													 &num_neurons,
+													 &numinputneurons,
+													 &numoutputneurons );
+
+		for( size_t i = 0; i < pending.size(); i++ )
+		{
+			int iparm = pending[i];
+			CalcComplexity_brainfunction_parms *parm = &parms[iparm];
 
-		if( callback )
-			callback->parms_result(result, iparm);
+			double complexity = 0.0;	// as for an invalid file
+			if( activity )
+			{
+				// Filtering events modifies the activity, so give it a copy
+				bool filter = false;
+				if( parm->events )
+					for( const char *c = parm->parts; *c; c++ )
+						filter = filter || islower( *c );
+
+				gsl_matrix *partActivity = activity;
+				if( filter )
+				{
+					partActivity = gsl_matrix_alloc( activity->size1, activity->size2 );
+					gsl_matrix_memcpy( partActivity, activity );
+				}
+
+				complexity = CalcComplexityWithActivity_brainfunction( partActivity,
+																	   parm->parts,
+																	   parm->events,
+																	   agent_num,
+																	   agent_birth,
+																	   agent_lifespan,
+																	   numinputneurons,
+																	   numoutputneurons );
+
+				if( filter )
+					gsl_matrix_free( partActivity );
+			}
+
+			result->complexity[iparm] = complexity;
+			result->agent_number[iparm] = agent_num;
+			result->lifespan[iparm] = agent_lifespan;
+			result->num_neurons[iparm] = num_neurons;
+
+			if( callback )
+				callback->parms_result(result, iparm);
+		}
+
+		if( activity )
+			gsl_matrix_free( activity );
 	}
 
 	if(callback)
@@ -144,6 +228,36 @@ double CalcComplexity_brainfunction(const char *fnameAct,
 	if( activity == NULL )
 		return( 0.0 );
 
+	complexity = CalcComplexityWithActivity_brainfunction(activity,
+														  part,
+														  events,
+														  agent_num,
+														  agent_birth,
+														  agent_lifespan,
+														  numinputneurons,
+														  numoutputneurons);
+
+	gsl_matrix_free( activity );
+
+	return( complexity );
+}
+
+//---------------------------------------------------------------------------
+// CalcComplexityWithActivity_brainfunction
+//
+// activity holds the steps CalcComplexity_brainfunction would have read from
+// the agent's brainFunction file, one row per step. It is modified if events
+// are filtered.
+//---------------------------------------------------------------------------
+double CalcComplexityWithActivity_brainfunction(gsl_matrix *activity,
+												const char *part,
+												Events *events,
+												long agent_num,
+												long agent_birth,
+												long agent_lifespan,
+												long numinputneurons,
+												long numoutputneurons)
+{
     // If agent lived fewer timesteps than it has neurons, or it hasn't lived long enough,
     // return Complexity = 0.0.
     if( activity->size2 > activity->size1 || activity->size1 < IgnoreAgentsThatLivedLessThan_N_Timesteps )
@@ -173,32 +287,82 @@ double CalcComplexity_brainfunction(const char *fnameAct,
 	    	FilterActivity( activity, filter_events, agent_num, agent_birth, agent_lifespan, events, numinputneurons );
     }
 
-	complexity = CalcComplexityWithMatrix_brainfunction(activity,
-														part,
-														numinputneurons,
-														numoutputneurons);
+	double complexity = CalcComplexityWithMatrix_brainfunction(activity,
+															   part,
+															   numinputneurons,
+															   numoutputneurons);
 
 // 	printf( "CalcComplexity for agent %ld part %s %s event filtering = %g\n", agent_num, part, events ? "with" : "without", complexity );
 
-	gsl_matrix_free( activity );
-
 	return( complexity );
 }
 
 //---------------------------------------------------------------------------
-// CalcComplexityWithMatrix_brainfunction
+// CalcComplexityWithCOV_brainfunction
+//
+// COV is the covariance matrix of all of an agent's neurons over the numSteps
+// steps of its life. Unlike the other variants, activity isn't Gaussianized,
+// and events can't be filtered.
 //---------------------------------------------------------------------------
-double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
-											  const char *part,
-											  long numinputneurons,
-											  long numoutputneurons)
+double CalcComplexityWithCOV_brainfunction(gsl_matrix *COV,
+										   long numSteps,
+										   const char *part,
+										   long numinputneurons,
+										   long numoutputneurons)
 {
-// 	printf( "\n------- part = %s --------\n", part );
+    // If agent lived fewer timesteps than it has neurons, or it hasn't lived long enough,
+    // return Complexity = 0.0.
+	if( numSteps < (long)COV->size1 || numSteps < IgnoreAgentsThatLivedLessThan_N_Timesteps )
+		return( 0.0 );
+
 	if( numinputneurons == 0 )
 		return( -2 );
 
-	setGaussianize( FLAG_useGSAMP );
+	int columns[COV->size1];
+	int numColumns;
+	int num_points;
+	gsl_matrix* subset;
+
+	if( SelectComplexityColumns(part, COV->size1, numinputneurons, numoutputneurons, columns, &numColumns, &num_points) )
+	{
+		subset = matrix_crosssection( COV, columns, numColumns );
+	}
+	else
+	{
+		subset = gsl_matrix_alloc( COV->size1, COV->size2 );
+		gsl_matrix_memcpy( subset, COV );
+	}
+
+	double complexity = CalcApproximateFullComplexityWithCOV( subset, num_points );
+
+	gsl_matrix_free( subset );
+
+	return complexity;
+}
+
+//---------------------------------------------------------------------------
+// GetMaxNumTimeStepsToComputeComplexityOver
+//---------------------------------------------------------------------------
+int GetMaxNumTimeStepsToComputeComplexityOver()
+{
+	return MaxNumTimeStepsToComputeComplexityOver;
+}
 
+//---------------------------------------------------------------------------
+// SelectComplexityColumns
+//
+// Finds the neurons the complexity type part is calculated over. Returns
+// false if it's calculated over all of them, in which case columns isn't
+// filled in.
+//---------------------------------------------------------------------------
+static bool SelectComplexityColumns(const char *part,
+									long numneurons,
+									long numinputneurons,
+									long numoutputneurons,
+									int *columns,
+									int *numColumns,
+									int *num_points)
+{
 	int flagAll = 0;
 	int flagPro = 0;
 	int flagInp = 0;
@@ -206,7 +370,7 @@ double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
 	int flagHea = 0;
 
 	int startPro = numinputneurons;
-	int numPro = activity->size2 - numinputneurons;	// size 2 is number of columns == number of neurons
+	int numPro = numneurons - numinputneurons;
 	int indexPro[numPro];
 
 	int startInp = 0;
@@ -219,7 +383,7 @@ double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
 
 	int indexHea = 1;
 
-	int num_points = 1;
+	*num_points = 1;
 
 	for( unsigned int j = 0; j < strlen( part ); j++ )
 	{
@@ -231,7 +395,7 @@ double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
 		if( isdigit( part[j] ) )
 		{
 			const char* num_points_str = &(part[j]);
-			num_points = atoi( num_points_str );
+			*num_points = atoi( num_points_str );
 			break;
 		}
 
@@ -268,46 +432,71 @@ double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
 	}
 
 	if (flagAll == 1)
-	{
-		double complexity = CalcApproximateFullComplexityWithMatrix( activity, num_points );
-		return complexity;
-	}
+		return false;
 
 	// Accumulate the indexes of neurons related to the requested complexity type
 
-	int columns[activity->size2];	// size 2 is number of columns == number of neurons
-	int numColumns = 0;
+	int n = 0;
 
 	if( flagInp == 1 )
 	{
 		int j = 0;
-		for( int i = numColumns; i < numInp; i++ )
+		for( int i = n; i < numInp; i++ )
 			columns[i] = indexInp[j++];
-		numColumns += numInp;
+		n += numInp;
 	}
 
 	if( flagHea == 1 && flagInp == 0 )
 	{
 	    columns[0] = indexHea;
-		numColumns = 1;
+		n = 1;
 	}
 
 	if( flagPro == 1 )
 	{
 
 		int j = 0;
-		for( int i = numColumns; i < (numPro + numColumns); i++ )
+		for( int i = n; i < (numPro + n); i++ )
 			columns[i] = indexPro[j++];
-		numColumns += numPro;
+		n += numPro;
 
 	}
 
 	if( flagBeh == 1 && flagPro == 0 )
     {
 		int j = 0;
-		for( int i = numColumns; i < (numBeh + numColumns); i++)
+		for( int i = n; i < (numBeh + n); i++)
 			columns[i] = indexBeh[j++];
-		numColumns += numBeh;
+		n += numBeh;
+	}
+
+	*numColumns = n;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// CalcComplexityWithMatrix_brainfunction
+//---------------------------------------------------------------------------
+double CalcComplexityWithMatrix_brainfunction(gsl_matrix *activity,
+											  const char *part,
+											  long numinputneurons,
+											  long numoutputneurons)
+{
+// 	printf( "\n------- part = %s --------\n", part );
+	if( numinputneurons == 0 )
+		return( -2 );
+
+	setGaussianize( FLAG_useGSAMP );
+
+	int columns[activity->size2];	// size 2 is number of columns == number of neurons
+	int numColumns;
+	int num_points;
+
+	if( !SelectComplexityColumns(part, activity->size2, numinputneurons, numoutputneurons, columns, &numColumns, &num_points) )
+	{
+		double complexity = CalcApproximateFullComplexityWithMatrix( activity, num_points );
+		return complexity;
 	}
 
 	gsl_matrix* subset = matrix_subset_col( activity, columns, numColumns );
@@ -370,6 +559,41 @@ vector<string> get_list_of_brainfunction_logfiles( string directory_name )
 }
 
 
+//---------------------------------------------------------------------------
+// get_brainfunction_path
+//---------------------------------------------------------------------------
+string get_brainfunction_path( string run, long agent_number )
+{
+	string key = to_string( agent_number );
+
+	LogContainer *container = LogContainer::get( run + "/brain/function.pwlog" );
+	if( container && container->exists(key) )
+		return container->getRecordPath( key );
+
+	return run + "/brain/function/brainFunction_" + key + ".txt";
+}
+
+//---------------------------------------------------------------------------
+// get_list_of_brainfunction_records
+//---------------------------------------------------------------------------
+vector<string> get_list_of_brainfunction_records( string run, string view )
+{
+	vector<string> z;
+
+	LogContainer *container = LogContainer::get( run + "/brain/function.pwlog" );
+	if( container == NULL )
+	{
+		cerr << "Could not open brain function container in '" << run << "' -- Terminating." << endl;
+		exit(1);
+	}
+
+	vector<string> keys = container->getView( view );
+	for( size_t i = 0; i < keys.size(); i++ )
+		z.push_back( container->getRecordPath(keys[i]) );
+
+	return z;
+}
+
 //---------------------------------------------------------------------------
 // get_list_of_brainanatomy_logfiles
 //---------------------------------------------------------------------------
@@ -594,6 +818,10 @@ gsl_matrix * readin_brainfunction(const char* fname,
 		exit(1);
 	}
 
+	if( BrainFunctionFile::isBinary(FunctionFile) )
+		return readin_brainfunction_binary( FunctionFile, fname, tile, num_timesteps, max_timesteps,
+											agent_number, agent_birth, lifespan, num_neurons, num_ineurons, num_oneurons );
+
 	char tline[100];
 	FunctionFile->gets( tline, 100 );
 
@@ -779,6 +1007,87 @@ gsl_matrix * readin_brainfunction(const char* fname,
 	return activity;
 }
 
+//---------------------------------------------------------------------------
+// readin_brainfunction_binary
+//
+// Takes the same steps from a binary brainFunction file as
+// readin_brainfunction does from a text one. Deletes FunctionFile.
+//---------------------------------------------------------------------------
+gsl_matrix * readin_brainfunction_binary( AbstractFile *FunctionFile,
+										  const char* fname,
+										  bool tile,
+										  int num_timesteps,
+										  int max_timesteps,
+										  long *agent_number,
+										  long *agent_birth,
+										  long *lifespan,
+										  long *num_neurons,
+										  long *num_ineurons,
+										  long *num_oneurons )
+{
+	BrainFunctionFile::Reader reader;
+	bool ok = reader.read( FunctionFile, fname );
+	delete FunctionFile;
+	if( !ok )
+	{
+		cerr << "Could not read brainFunction file '" << fname << "'. -- Terminating." << endl;
+		exit(1);
+	}
+
+	if( agent_number )
+		*agent_number = reader.header.agentNumber;
+	if( num_neurons )
+		*num_neurons = reader.header.numNeurons;
+	if( num_ineurons )
+		*num_ineurons = reader.header.numInputNeurons;
+	if( num_oneurons )
+		*num_oneurons = reader.header.numOutputNeurons;
+	if( agent_birth )
+		*agent_birth = reader.header.birthStep;
+
+	int numcols = reader.header.numNeurons;
+	int numframes = reader.numFrames;
+	if( lifespan )
+		*lifespan = numframes;	// actual lifespan, not accounting for max_timesteps
+	if( numframes == 0 )
+		return NULL;
+
+	int numrows = numframes;
+	if( num_timesteps > 0 )
+	{
+		if( tile )
+		{
+			numrows = num_timesteps;
+		}
+		else	// if we are only looking at the first N timesteps of an agent's life...
+		{
+			numrows = min( numrows, num_timesteps );
+			num_timesteps = numrows;
+		}
+	}
+
+	// Frames [begin, end), wrapping around when tiling.
+	int end = num_timesteps > 0 ? num_timesteps : numframes;
+	int begin = 0;
+	if( max_timesteps > 0 )	// if we are only looking at last max_timesteps of an agent's life
+	{
+		numrows = min( numrows, max_timesteps );
+		if( numrows < end )
+			begin = end - numrows;
+	}
+
+	gsl_matrix *activity = gsl_matrix_alloc( numrows, numcols );
+
+	for( int row = 0; row < numrows; row++ )
+	{
+		const float *frame = reader.frames.data() + (long)((begin + row) % numframes) * numcols;
+		for( int col = 0; col < numcols; col++ )
+			gsl_matrix_set( activity, row, col, frame[col] );
+	}
+
+	return activity;
+}
+
 //---------------------------------------------------------------------------
 // FilterActivity
 //---------------------------------------------------------------------------
@@ -56,6 +56,11 @@ class CalcComplexity_brainfunction_callback
 
 	virtual void begin(CalcComplexity_brainfunction_parms *parms,
 			   int nparms) = 0;
+	// Fills in result for parms_index and returns true if it's already known,
+	// in which case it isn't calculated. parms_result() is still called for it.
+	// May be called from several threads at once.
+	virtual bool parms_cached(CalcComplexity_brainfunction_result *result,
+				  int parms_index) { return false; }
 	virtual void parms_result(CalcComplexity_brainfunction_result *result,
 				  int parms_index) = 0;
 	virtual void end(CalcComplexity_brainfunction_result *result) = 0;
@@ -76,9 +81,28 @@ double CalcComplexityWithMatrix_brainfunction(gsl_matrix *matrix,
 											  const char *parts,
 											  long numinputneurons,
 											  long numoutputneurons);
+double CalcComplexityWithActivity_brainfunction(gsl_matrix *activity,
+												const char *parts,
+												Events *events,
+												long agent_number,
+												long agent_birth,
+												long lifespan,
+												long numinputneurons,
+												long numoutputneurons);
+double CalcComplexityWithCOV_brainfunction(gsl_matrix *COV,
+										   long numSteps,
+										   const char *parts,
+										   long numinputneurons,
+										   long numoutputneurons);
+int GetMaxNumTimeStepsToComputeComplexityOver();
 
 std::vector<std::string> get_list_of_brainfunction_logfiles( std::string );
 std::vector<std::string> get_list_of_brainanatomy_logfiles( std::string );
+// The brainFunction log of agent_number in run, whether it's in a container
+// (RecordLogContainers) or a file of its own.
+std::string get_brainfunction_path( std::string run, long agent_number );
+// The brainFunction logs in a view of run's container, e.g. "Recent/3"
+std::vector<std::string> get_list_of_brainfunction_records( std::string run, std::string view );
 
 gsl_matrix * readin_brainfunction(const char *path,
 											 bool tile,
@@ -0,0 +1,311 @@
+#include "complexity_fast.h"
+
+#include <math.h>
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+#include "complexity_algorithm.h"
+#include "utils/next_combination.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// cholesky()
+//
+// Factors the m x m symmetric matrix a (row major, lower triangle used) in
+// place, returning false if it isn't positive definite. Otherwise sets
+// log2Det to log2 of its determinant.
+//---------------------------------------------------------------------------
+static bool cholesky( double *a, int m, double *log2Det )
+{
+	double logDet = 0.0;
+
+	for( int j = 0; j < m; j++ )
+	{
+		double *aj = a + j * m;
+
+		double s = aj[j];
+		for( int p = 0; p < j; p++ )
+			s -= aj[p] * aj[p];
+		if( !(s > 0.0) )
+			return false;
+
+		double d = sqrt( s );
+		aj[j] = d;
+		logDet += log( d );
+
+		for( int i = j + 1; i < m; i++ )
+		{
+			double *ai = a + i * m;
+			double t = ai[j];
+			for( int p = 0; p < j; p++ )
+				t -= ai[p] * aj[p];
+			ai[j] = t / d;
+		}
+	}
+
+	*log2Det = 2.0 * logDet / M_LN2;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::FastComplexity
+//---------------------------------------------------------------------------
+FastComplexity::FastComplexity( gsl_matrix *COV_, int numThreads_ )
+: COV( COV_ )
+, n( COV_->size1 )
+, numThreads( numThreads_ )
+, cov( n * n )
+, log2Var( n )
+, log2Det( 0.0 )
+, rng( NULL )
+{
+#ifdef _OPENMP
+	if( numThreads <= 0 )
+		numThreads = omp_get_max_threads();
+#else
+	numThreads = 1;
+#endif
+
+	for( int i = 0; i < n; i++ )
+	{
+		for( int j = 0; j < n; j++ )
+			cov[i * n + j] = gsl_matrix_get( COV, i, j );
+		log2Var[i] = log2( cov[i * n + i] );
+	}
+
+	chol = cov;
+	factored = cholesky( chol.data(), n, &log2Det );
+
+	work.resize( numThreads, vector<double>(n * n) );
+	marks.resize( numThreads, vector<char>(n) );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::~FastComplexity
+//---------------------------------------------------------------------------
+FastComplexity::~FastComplexity()
+{
+	if( rng )
+		dispose_rng( rng );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::calcC_k
+//
+// As calcC_k().
+//---------------------------------------------------------------------------
+double FastComplexity::calcC_k( double I_n, int k )
+{
+	if( !factored )
+		return( ::calcC_k(COV, I_n, k) );
+
+	if( k == n-1 )
+		return( calcC_k_exact(I_n, k) );
+	else if( k == 1 )
+		return( I_n / n );
+	else if( k == 0 || k == n )
+		return( 0.0 );
+	else if( n_choose_k_le_s(n, k, C_kNumSamples) )
+		return( calcC_k_exact(I_n, k) );
+
+	// The same subsets as calcC_k(), which starts from the same seed each time
+	if( rng == NULL )
+		rng = create_rng( DEFAULT_SEED );
+	else
+		gsl_rng_set( rng, DEFAULT_SEED );
+
+	vector<int> subsets( C_kNumSamples * k );
+	for( int i = 0; i < C_kNumSamples; i++ )
+	{
+		int *indexes = subsets.data() + i * k;
+		int numChosen = 0;
+		int numVisited = 0;
+		for( int j = 0; j < n; j++ )
+		{
+			double prob = ((double) (k - numChosen)) / (n - numVisited);
+			if( gsl_rng_uniform(rng) < prob )
+				indexes[numChosen++] = j;
+			numVisited++;
+		}
+	}
+
+	return( I_n * k / n  -  calcMeanI_k(subsets, k) );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::calcC_k_exact
+//
+// As calcC_k_exact().
+//---------------------------------------------------------------------------
+double FastComplexity::calcC_k_exact( double I_n, int k )
+{
+	if( !factored )
+		return( ::calcC_k_exact(COV, I_n, k) );
+
+	if( k == n-1 )
+		return( calcC_nm1(I_n) );
+
+	int index[n];
+	for( int i = 0; i < n; i++ )
+		index[i] = i;
+
+	vector<int> subsets;
+	do
+	{
+		subsets.insert( subsets.end(), index, index + k );
+	}
+	while( next_combination( index, index+k, index+n ) );
+
+	return( I_n * k / n  -  calcMeanI_k(subsets, k) );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::calcC_nm1
+//
+// C_k for k = n-1, from the diagonal of the inverse.
+//---------------------------------------------------------------------------
+double FastComplexity::calcC_nm1( double I_n )
+{
+	invert();
+
+	double sumLog2Var = 0.0;
+	for( int i = 0; i < n; i++ )
+		sumLog2Var += log2Var[i];
+
+	double sumI_k = 0.0;
+	for( int i = 0; i < n; i++ )
+	{
+		double log2DetSubset = log2Det + log2( inverse[i * n + i] );
+		sumI_k += 0.5 * ((sumLog2Var - log2Var[i]) - log2DetSubset);
+	}
+
+	return( I_n * (n-1) / n  -  sumI_k / n );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::calcMeanI_k
+//
+// subsets holds subsets.size() / k subsets of size k, one after another.
+//---------------------------------------------------------------------------
+double FastComplexity::calcMeanI_k( const vector<int> &subsets, int k )
+{
+	int numSubsets = subsets.size() / k;
+
+	if( 2 * k > n )
+		invert();
+
+	terms.resize( numSubsets );
+
+	#pragma omp parallel for num_threads(numThreads) schedule(dynamic, 16) if(numThreads > 1)
+	for( int i = 0; i < numSubsets; i++ )
+	{
+#ifdef _OPENMP
+		int thread = omp_get_thread_num();
+#else
+		int thread = 0;
+#endif
+		terms[i] = calcI_k( subsets.data() + i * k, k, work[thread].data(), marks[thread].data() );
+	}
+
+	double sumI_k = 0.0;
+	for( int i = 0; i < numSubsets; i++ )
+		sumI_k += terms[i];
+
+	return( sumI_k / numSubsets );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::calcI_k
+//
+// As CalcI_k(), using work for the factorization and mark to find the
+// complement.
+//---------------------------------------------------------------------------
+double FastComplexity::calcI_k( const int *indexes, int k, double *w, char *mark )
+{
+	double sumLog2Var = 0.0;
+	for( int r = 0; r < k; r++ )
+		sumLog2Var += log2Var[ indexes[r] ];
+
+	double log2DetSubset;
+
+	if( 2 * k <= n )
+	{
+		for( int r = 0; r < k; r++ )
+			for( int c = 0; c <= r; c++ )
+				w[r * k + c] = cov[ indexes[r] * n + indexes[c] ];
+
+		if( cholesky(w, k, &log2DetSubset) )
+			return( 0.5 * (sumLog2Var - log2DetSubset) );
+	}
+	else
+	{
+		for( int i = 0; i < n; i++ )
+			mark[i] = 0;
+		for( int r = 0; r < k; r++ )
+			mark[ indexes[r] ] = 1;
+
+		int complement[n - k];
+		int m = 0;
+		for( int i = 0; i < n; i++ )
+			if( !mark[i] )
+				complement[m++] = i;
+
+		for( int r = 0; r < m; r++ )
+			for( int c = 0; c <= r; c++ )
+				w[r * m + c] = inverse[ complement[r] * n + complement[c] ];
+
+		double log2DetComplement;
+		if( cholesky(w, m, &log2DetComplement) )
+			return( 0.5 * (sumLog2Var - (log2Det + log2DetComplement)) );
+	}
+
+	// Lost to rounding; do it the slow way
+	int subset[k];
+	for( int r = 0; r < k; r++ )
+		subset[r] = indexes[r];
+
+	return( CalcI_k(COV, subset, k) );
+}
+
+//---------------------------------------------------------------------------
+// FastComplexity::invert
+//
+// Computes the inverse from the Cholesky factor, L^-T L^-1, if it hasn't
+// been already.
+//---------------------------------------------------------------------------
+void FastComplexity::invert()
+{
+	if( !inverse.empty() )
+		return;
+
+	// Linv, lower triangular, by forward substitution column by column
+	vector<double> linv( n * n, 0.0 );
+	for( int j = 0; j < n; j++ )
+	{
+		linv[j * n + j] = 1.0 / chol[j * n + j];
+		for( int i = j + 1; i < n; i++ )
+		{
+			double t = 0.0;
+			for( int p = j; p < i; p++ )
+				t -= chol[i * n + p] * linv[p * n + j];
+			linv[i * n + j] = t / chol[i * n + i];
+		}
+	}
+
+	inverse.resize( n * n );
+	for( int i = 0; i < n; i++ )
+	{
+		for( int j = 0; j <= i; j++ )
+		{
+			double t = 0.0;
+			for( int p = i; p < n; p++ )
+				t += linv[p * n + i] * linv[p * n + j];
+			inverse[i * n + j] = t;
+			inverse[j * n + i] = t;
+		}
+	}
+}
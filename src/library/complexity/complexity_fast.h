@@ -0,0 +1,62 @@
+#ifndef COMPLEXITY_FAST_H
+#define COMPLEXITY_FAST_H
+
+#include <vector>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_rng.h>
+
+//===========================================================================
+// FastComplexity
+//
+// Replacements for calcC_k() and calcC_k_exact() that share the work done on
+// one covariance matrix across all the subsets and values of k:
+//
+//   - COV is Cholesky factored once, and the n-1 subsets are taken from the
+//     diagonal of its inverse, since det(COV_-i) = det(COV) * (COV^-1)_ii.
+//   - Any other subset S is factored directly if it's no larger than its
+//     complement T, and otherwise through the complementary minor of the
+//     inverse, det(COV_S) = det(COV) * det((COV^-1)_TT), so no subset costs
+//     more than a factorization of half the matrix.
+//   - Subsets are drawn exactly as the reference does, from the same seed,
+//     and then evaluated in parallel, each thread reusing its own workspace.
+//     Their terms are summed in order, so the result doesn't depend on the
+//     number of threads.
+//
+// If COV can't be factored (it's numerically singular), the reference
+// functions are used instead.
+//===========================================================================
+class FastComplexity
+{
+ public:
+	// numThreads of 0 means OpenMP's default.
+	FastComplexity( gsl_matrix *COV, int numThreads );
+	~FastComplexity();
+
+	double calcC_k( double I_n, int k );
+	double calcC_k_exact( double I_n, int k );
+
+ private:
+	double calcC_nm1( double I_n );
+	double calcMeanI_k( const std::vector<int> &subsets, int k );
+	double calcI_k( const int *indexes, int k, double *work, char *mark );
+	void invert();
+
+	gsl_matrix *COV;
+	int n;
+	int numThreads;
+	bool factored;
+
+	std::vector<double> cov;		// n x n, row major
+	std::vector<double> chol;		// lower Cholesky factor of cov
+	std::vector<double> inverse;	// cov^-1, once invert() has been called
+	std::vector<double> log2Var;	// log2( cov_ii )
+	double log2Det;
+
+	gsl_rng *rng;
+	std::vector< std::vector<double> > work;	// per thread
+	std::vector< std::vector<char> > marks;		// per thread
+	std::vector<double> terms;
+};
+
+#endif // COMPLEXITY_FAST_H
@@ -12,6 +12,7 @@
 #include "graphics/graphics.h"
 #include "sim/globals.h"
 #include "sim/Simulation.h"
+#include "utils/CheckPoint.h"
 #include "utils/distributions.h"
 
 
@@ -60,6 +61,25 @@ void BrickPatch::updateOn()
 	}
 }
 
+//-------------------------------------------------------------------------------------------
+// BrickPatch::dump
+//
+// The bricks themselves are saved with the other objects; this only records
+// whether the patch had placed them.
+//-------------------------------------------------------------------------------------------
+void BrickPatch::dump( CheckPointWriter &out )
+{
+	out.put( onPrev );
+}
+
+//-------------------------------------------------------------------------------------------
+// BrickPatch::load
+//-------------------------------------------------------------------------------------------
+void BrickPatch::load( CheckPointReader &in )
+{
+	in.get( onPrev );
+}
+
 void BrickPatch::addBricks()
 {
 	for( int i = 0; i < brickCount; i++ )
@@ -18,6 +18,8 @@ using namespace std;
 
 // Forward declarations
 class BrickPatch;
+class CheckPointReader;
+class CheckPointWriter;
 class FoodPatch;
 
 //===========================================================================
@@ -37,6 +39,9 @@ class BrickPatch : public Patch
 
 	void updateOn();
 
+	void dump( CheckPointWriter &out );
+	void load( CheckPointReader &in );
+
  private:
 	void addBricks();
 	void removeBricks();
@@ -12,6 +12,7 @@
 #include "graphics/graphics.h"
 #include "sim/globals.h"
 #include "sim/Simulation.h"
+#include "utils/CheckPoint.h"
 #include "utils/distributions.h"
 
 
@@ -162,3 +163,26 @@ void FoodPatch::endStep()
 {
 	onPrev = on;
 }
+
+//-------------------------------------------------------------------------------------------
+// FoodPatch::dump
+//
+// Whether the patch is on now comes from the worldfile's dynamic properties,
+// so only what it was last step is saved.
+//-------------------------------------------------------------------------------------------
+void FoodPatch::dump( CheckPointWriter &out )
+{
+	out.put( (int32_t)foodCount );
+	out.put( foodGrown );
+	out.put( onPrev );
+}
+
+//-------------------------------------------------------------------------------------------
+// FoodPatch::load
+//-------------------------------------------------------------------------------------------
+void FoodPatch::load( CheckPointReader &in )
+{
+	foodCount = in.get<int32_t>();
+	in.get( foodGrown );
+	in.get( onPrev );
+}
@@ -18,6 +18,8 @@
 using namespace std;
 
 // Forward declarations
+class CheckPointReader;
+class CheckPointWriter;
 class food;
 class FoodPatch;
 
@@ -45,6 +47,9 @@ class FoodPatch : public Patch
 	bool isOnChanged();
 	void endStep();
 
+	void dump( CheckPointWriter &out );
+	void load( CheckPointReader &in );
+
 	float growthRate;
 	float energy;
 
@@ -86,6 +86,27 @@ void barrier::update()
 }
 
 
+//---------------------------------------------------------------------------
+// barrier::dump
+//---------------------------------------------------------------------------
+void barrier::dump( CheckPointWriter &out )
+{
+	out.put( currPosition );
+	out.put( nextPosition );
+}
+
+
+//---------------------------------------------------------------------------
+// barrier::load
+//---------------------------------------------------------------------------
+void barrier::load( CheckPointReader &in )
+{
+	in.get( nextPosition );
+	updateVertices();
+	in.get( nextPosition );
+}
+
+
 //---------------------------------------------------------------------------
 // barrier::updateVertices
 //---------------------------------------------------------------------------
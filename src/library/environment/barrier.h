@@ -31,6 +31,10 @@ public:
     ~bxsortedlist() { }
     void add(barrier* a);
     void xsort();
+
+    // Iterate without the list's cursor, so several threads may do so at once
+    gdlink<barrier*> *firstLink() { return lastItem ? lastItem->nextItem : 0; }
+    gdlink<barrier*> *nextLink( gdlink<barrier*> *link ) { return link == lastItem ? 0 : link->nextItem; }
 private:
 	bool needXSort;
 	void actuallyXSort();
@@ -92,6 +96,9 @@ public:
 
 	void update();
 
+	void dump( CheckPointWriter &out );
+	void load( CheckPointReader &in );
+
 	LineSegment &getPosition();
 
     float xmin();
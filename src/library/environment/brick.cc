@@ -51,6 +51,16 @@ brick::brick( Color color, float x, float z )
 }
 
 
+//-------------------------------------------------------------------------------------------
+// brick::brick
+//-------------------------------------------------------------------------------------------
+brick::brick( CheckPointReader &in )
+{
+	initBrick( Color(), 0.0, 0.0 );
+	gobject::load( in );
+}
+
+
 //-------------------------------------------------------------------------------------------
 // brick::~brick
 //-------------------------------------------------------------------------------------------
@@ -83,6 +93,33 @@ void brick::load(istream& in)
 
 
 
+//-------------------------------------------------------------------------------------------
+// brick::dump
+//-------------------------------------------------------------------------------------------
+void brick::dump( CheckPointWriter &out )
+{
+	gobject::dump( out );
+}
+
+
+//-------------------------------------------------------------------------------------------
+// brick::brickdump
+//-------------------------------------------------------------------------------------------
+void brick::brickdump( CheckPointWriter &out )
+{
+	out.put( NumBricks );
+}
+
+
+//-------------------------------------------------------------------------------------------
+// brick::brickload
+//-------------------------------------------------------------------------------------------
+void brick::brickload( CheckPointReader &in )
+{
+	in.get( NumBricks );
+}
+
+
 //-------------------------------------------------------------------------------------------
 // brick::initBrick
 //-------------------------------------------------------------------------------------------
@@ -34,10 +34,15 @@ class brick : public gboxf
 	
 	brick( Color color );
 	brick( Color color, float x, float z );
+	brick( CheckPointReader &in );	// restores what dump(CheckPointWriter&) saved
 	~brick();
     
 	void dump(ostream& out);
 	void load(istream& in);
+	void dump(CheckPointWriter& out);
+
+	static void brickdump(CheckPointWriter& out);
+	static void brickload(CheckPointReader& in);
     
 	float pickup(float e);
 
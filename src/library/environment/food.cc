@@ -66,6 +66,22 @@ food::food( const FoodType *foodType, long step, const Energy &e, float x, float
 }
 
 
+//-------------------------------------------------------------------------------------------
+// food::food
+//-------------------------------------------------------------------------------------------
+food::food( CheckPointReader &in )
+{
+	const FoodType *foodType = FoodType::get( in.get<int32_t>() );
+	long step = in.get<int64_t>();
+	Energy e = in.get<Energy>();
+
+	initfood( foodType, step, e, 0.0, 0.0 );
+
+	in.get( fDomain );
+	gobject::load( in );
+}
+
+
 //-------------------------------------------------------------------------------------------
 // food::~food
 //-------------------------------------------------------------------------------------------
@@ -98,6 +114,37 @@ void food::load(istream& in)
 }
 
 
+//-------------------------------------------------------------------------------------------
+// food::dump
+//-------------------------------------------------------------------------------------------
+void food::dump( CheckPointWriter &out )
+{
+	out.put( (int32_t)foodType->index );
+	out.put( (int64_t)fCreationStep );
+	out.put( fEnergy );
+	out.put( fDomain );
+	gobject::dump( out );
+}
+
+
+//-------------------------------------------------------------------------------------------
+// food::fooddump
+//-------------------------------------------------------------------------------------------
+void food::fooddump( CheckPointWriter &out )
+{
+	out.put( fFoodEver );
+}
+
+
+//-------------------------------------------------------------------------------------------
+// food::foodload
+//-------------------------------------------------------------------------------------------
+void food::foodload( CheckPointReader &in )
+{
+	in.get( fFoodEver );
+}
+
+
 //-------------------------------------------------------------------------------------------
 // food::eat
 //-------------------------------------------------------------------------------------------
@@ -132,6 +179,15 @@ long food::getAge(long step)
 }
 
 
+//-------------------------------------------------------------------------------------------
+// food::moveToEndOfAllFood
+//-------------------------------------------------------------------------------------------
+void food::moveToEndOfAllFood()
+{
+	gAllFood.splice( gAllFood.end(), gAllFood, fAllFoodIterator );
+}
+
+
 //-------------------------------------------------------------------------------------------
 // food::initfood
 //-------------------------------------------------------------------------------------------
@@ -45,10 +45,15 @@ public:
     food( const FoodType *foodType, long step );
     food( const FoodType *foodType, long step, const Energy &e );
     food( const FoodType *foodType, long step, const Energy &e, float x, float z);
+    food( CheckPointReader &in );	// restores what dump(CheckPointWriter&) saved
     ~food();
 
 	void dump(ostream& out);
 	void load(istream& in);
+	void dump(CheckPointWriter& out);
+
+	static void fooddump(CheckPointWriter& out);
+	static void foodload(CheckPointReader& in);
 
 	Energy eat(const Energy &e);
 
@@ -67,6 +72,10 @@ public:
 
 	long getAge( long step );
 
+	// Moves this food to the end of gAllFood, so a checkpoint can restore
+	// the order in which food was created.
+	void moveToEndOfAllFood();
+
 protected:
     void initfood( const FoodType *foodType, long step );
     void initfood( const FoodType *foodType, long step, const Energy &e );
@@ -156,6 +156,7 @@ __InterpolatedGene::__InterpolatedGene( const GeneType *_type,
 , smax( max_ )
 , rounding( _rounding )
 , interpolationPower( 1.0 )
+, ratios( getUnitRatios() )
 {
 	init( _type,
 		  _ismutable,
@@ -177,18 +178,49 @@ const Scalar &__InterpolatedGene::getMax()
 void __InterpolatedGene::setInterpolationPower( double power )
 {
 	interpolationPower = power;
+
+	if( interpolationPower == 1.0 )
+	{
+		ratios = getUnitRatios();
+		powerRatios.clear();
+	}
+	else
+	{
+		const double *unitRatios = getUnitRatios();
+		powerRatios.resize( 256 );
+		for( int raw = 0; raw < 256; raw++ )
+			powerRatios[raw] = pow( unitRatios[raw], interpolationPower );
+		ratios = &powerRatios[0];
+	}
 }
 
-Scalar __InterpolatedGene::interpolate( unsigned char raw )
+//-------------------------------------------------------------------------------------------
+// getUnitRatios
+//
+// raw / 255 for each raw value, shared by the genes with an interpolation power of 1.
+//-------------------------------------------------------------------------------------------
+static const double *createUnitRatios()
 {
 	static const float OneOver255 = 1. / 255.;
+	static double unitRatios[256];
 
 	// temporarily cast to double for backwards compatibility
-	double ratio = float(raw) * OneOver255;
-	if( interpolationPower != 1.0 )
-		ratio = pow( ratio, interpolationPower );
+	for( int raw = 0; raw < 256; raw++ )
+		unitRatios[raw] = float(raw) * OneOver255;
 
-	return interpolate( ratio );
+	return unitRatios;
+}
+
+const double *__InterpolatedGene::getUnitRatios()
+{
+	static const double *unitRatios = createUnitRatios();
+
+	return unitRatios;
+}
+
+Scalar __InterpolatedGene::interpolate( unsigned char raw )
+{
+	return interpolate( ratios[raw] );
 }
 
 Scalar __InterpolatedGene::interpolate( double ratio )
@@ -238,6 +270,48 @@ void __InterpolatedGene::printRanges( FILE *file, const string &prefix )
 }
 
 
+// ================================================================================
+// ===
+// === CLASS GeneAccessor
+// ===
+// ================================================================================
+GeneAccessor::GeneAccessor()
+: defined( false )
+, interpolated( NULL )
+, offset( -1 )
+{
+}
+
+GeneAccessor::GeneAccessor( Gene *gene )
+: defined( gene != NULL )
+, interpolated( NULL )
+, offset( -1 )
+{
+	if( !gene )
+		return;
+
+	if( gene->ismutable )
+	{
+		MutableScalarGene *mgene = GeneType::to_MutableScalar( gene );
+		interpolated = mgene;
+		offset = gene->getOffset();
+		assert( offset >= 0 );
+	}
+	else
+	{
+		value = GeneType::to_ImmutableScalar( gene )->get( NULL );
+	}
+}
+
+GeneAccessor::GeneAccessor( const Scalar &value_ )
+: defined( true )
+, interpolated( NULL )
+, offset( -1 )
+, value( value_ )
+{
+}
+
+
 // ================================================================================
 // ===
 // === CLASS NonVectorGene
@@ -153,10 +153,18 @@ namespace genome
 		void printRanges( FILE *file, const std::string &prefix );
 
 	private:
+		friend class GeneAccessor;
+
+		static const double *getUnitRatios();
+
 		Scalar smin;
 		Scalar smax;
 		Rounding rounding;
 		double interpolationPower;
+		// The ratio interpolated for each raw value. smin and smax aren't
+		// baked in, since dynamic properties may change them.
+		const double *ratios;
+		std::vector<double> powerRatios;	// ratios if interpolationPower != 1
 	};
 
 
@@ -274,4 +282,33 @@ namespace genome
 		class GeneSchema *_containerSchema;
 	};
 
+
+	// ================================================================================
+	// ===
+	// === CLASS GeneAccessor
+	// ===
+	// === A scalar gene resolved once, after its schema is complete, so that
+	// === reading it from a genome takes no name lookup, cast or virtual call.
+	// === It may also stand for a constant that isn't a gene.
+	// ===
+	// ================================================================================
+	class GeneAccessor
+	{
+	public:
+		GeneAccessor();
+		// An ImmutableScalarGene or MutableScalarGene, or NULL.
+		GeneAccessor( Gene *gene );
+		GeneAccessor( const Scalar &value );
+
+		bool isDefined() const { return defined; }
+
+		inline Scalar get( Genome *genome ) const;
+
+	private:
+		bool defined;
+		__InterpolatedGene *interpolated;	// NULL if constant
+		int offset;
+		Scalar value;
+	};
+
 } // namespace genome
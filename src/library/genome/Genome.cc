@@ -1,22 +1,15 @@
 #include "Genome.h"
 
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "GenomeLayout.h"
+#include "SeparationKernel.h"
 #include "utils/AbstractFile.h"
-
-
-#ifdef __ALTIVEC__
-	// Turn pw_UseAltivec on to use ALTIVEC if it's available
-	#define pw_UseAltivec false
-#endif
-
-#if pw_UseAltivec
-	// veclib
-	#include <vecLib/vBLAS.h>
-#endif
+#include "utils/CheckPoint.h"
 
 using namespace genome;
 using namespace std;
@@ -33,8 +26,6 @@ Genome::Genome( GenomeSchema *schema,
 	this->schema = schema;
 	this->layout = layout;
 
-	MISC_BIAS = gene("MiscBias");
-	MISC_INVIS_SLOPE = gene("MiscInvisSlope");
 	gray = GenomeSchema::config.grayCoding;
 
 	nbytes = schema->getMutableSize();
@@ -168,21 +159,54 @@ void Genome::randomize()
 		assert( false );
 }
 
+//---------------------------------------------------------------------------
+// mutationGap
+//
+// How many of a sequence of draws that each mutate with probability rate
+// come before the next one that does, i.e. a geometric variate. logKeep is
+// log(1 - rate), with 0 < rate < 1.
+//---------------------------------------------------------------------------
+static inline long mutationGap( double logKeep )
+{
+	double gap = floor( log(1.0 - randpw()) / logKeep );
+	// guard the conversion; anything past the genome is as good as infinite
+	return gap < double(LONG_MAX >> 1) ? long(gap) : (LONG_MAX >> 1);
+}
+
 void Genome::mutateBits( float rate )
 {
-    for (long byte = 0; byte < nbytes; byte++)
-    {
-        for (long bit = 0; bit < 8; bit++)
-        {
-            if (randpw() < rate)
-                mutable_data[byte] ^= char(1 << (7-bit));
-        }
-    }
+	if( GenomeSchema::config.mutationSampling == GenomeSchema::MUTATION_PER_DRAW )
+	{
+		for (long byte = 0; byte < nbytes; byte++)
+		{
+			for (long bit = 0; bit < 8; bit++)
+			{
+				if (randpw() < rate)
+					mutable_data[byte] ^= char(1 << (7-bit));
+			}
+		}
+		return;
+	}
+
+	if( rate <= 0.0f )
+		return;
+
+	long nbits = nbytes << 3;
+	if( rate >= 1.0f )
+	{
+		for (long byte = 0; byte < nbytes; byte++)
+			mutable_data[byte] ^= char(255);
+		return;
+	}
+
+	double logKeep = log( 1.0 - rate );
+	for (long i = mutationGap( logKeep ); i < nbits; i += 1 + mutationGap( logKeep ))
+		mutable_data[i >> 3] ^= char(1 << (7 - (i & 7)));
 }
 
 void Genome::mutateBits()
 {
-    mutateBits( get( "MutationRate" ) );
+    mutateBits( get( genes().mutationRate ) );
 }
 
 void Genome::mutateOneByte( long byte, float stdev )
@@ -193,17 +217,36 @@ void Genome::mutateOneByte( long byte, float stdev )
 
 void Genome::mutateBytes( float rate )
 {
-    float stdev = pow( 2.0, get( "MutationStdevPower" ) );
-    for (long byte = 0; byte < nbytes; byte++)
-    {
-        if (randpw() < rate)
-            mutateOneByte( byte, stdev );
-    }
+    float stdev = pow( 2.0, get( genes().mutationStdevPower ) );
+
+	if( GenomeSchema::config.mutationSampling == GenomeSchema::MUTATION_PER_DRAW )
+	{
+		for (long byte = 0; byte < nbytes; byte++)
+		{
+			if (randpw() < rate)
+				mutateOneByte( byte, stdev );
+		}
+		return;
+	}
+
+	if( rate <= 0.0f )
+		return;
+
+	if( rate >= 1.0f )
+	{
+		for (long byte = 0; byte < nbytes; byte++)
+			mutateOneByte( byte, stdev );
+		return;
+	}
+
+	double logKeep = log( 1.0 - rate );
+	for (long byte = mutationGap( logKeep ); byte < nbytes; byte += 1 + mutationGap( logKeep ))
+		mutateOneByte( byte, stdev );
 }
 
 void Genome::mutateBytes()
 {
-    mutateBytes( get( "MutationRate" ) );
+    mutateBytes( get( genes().mutationRate ) );
 }
 
 void Genome::mutate( float rate )
@@ -220,7 +263,7 @@ void Genome::mutate( float rate )
 
 void Genome::mutate()
 {
-	mutate( get( "MutationRate" ) );
+	mutate( get( genes().mutationRate ) );
 }
 
 void Genome::crossover( Genome *g1, Genome *g2, bool mutate )
@@ -232,9 +275,9 @@ void Genome::crossover( Genome *g1, Genome *g2, bool mutate )
     // Randomly select number of crossover points from chosen genome
     long numCrossPoints;
     if (randpw() < 0.5)
-        numCrossPoints = g1->get( "CrossoverPointCount" );
+        numCrossPoints = g1->get( genes().crossoverPointCount );
     else
-		numCrossPoints = g2->get( "CrossoverPointCount" );
+		numCrossPoints = g2->get( genes().crossoverPointCount );
 
 	if (!GenomeSchema::config.enableEvolution)
 		numCrossPoints = 0;
@@ -256,7 +299,7 @@ void Genome::crossover( Genome *g1, Genome *g2, bool mutate )
 	// figure out crossover points -- derived class logic.
 	getCrossoverPoints( crossoverPoints, numCrossPoints );
 
-    long i, j;
+    long i;
 
 #ifdef DUMPBITS
     if (GenomeSchema::config.resolution == GenomeSchema::RESOLUTION_BIT)
@@ -321,8 +364,9 @@ void Genome::crossover( Genome *g1, Genome *g2, bool mutate )
         cout.flush();
 #endif
 
-        for (j = begbyte; j < endbyte; j++)
-            mutable_data[j] = ga->mutable_data[j];    // copy from the appropriate genome
+        // copy from the appropriate genome
+        if (endbyte > begbyte)
+            memcpy( mutable_data + begbyte, ga->mutable_data + begbyte, endbyte - begbyte );
 
         if (i < numCrossPoints)  // except on the last stretch...
         {
@@ -362,134 +406,14 @@ float Genome::separation( Genome *g )
 {
 	assert( schema == g->schema );
 
-#if pw_UseAltivec
-	#warning compiling with (broken) ALTIVEC code
-#else
-	int sep = 0;
-#endif
-	float fsep = 0.f;
-    unsigned char* gi = mutable_data;
-    unsigned char* gj = g->mutable_data;
-
-    if( gray )
-    {
-#if pw_UseAltivec
-		float val_gi[ nbytes ];
-		float val_gj[ nbytes ];
-		short size = 4;
-
-                long max = nbytes / size;
-                long left = nbytes - (max * size);
-
-		float result[ max * size ];
-
-		for (long i = 0; i < nbytes; i++)
-		{
-			val_gi[i] = binofgray[gi[i]];
-			val_gj[i] = binofgray[gj[i]];
-		}
-
-
-		for (long i = 0; i < max; i++)
-		{
-			vector float vGi = vec_ld(size, val_gi + size * i);
-			vector float vGj = vec_ld(size, val_gj + size * i);
-
-			vector float diff = vec_sub(vGi, vGj);
-
-			vec_st(diff, size, result + i * size);
-
-		}
-
-		fsep = cblas_sasum(size * max, result, 1);
-		vector float vGi = vec_ld(left, val_gi + size * max);
-		vector float vGj = vec_ld(left, val_gj + size * max);
-
-		vector float diff = vec_sub(vGi, vGj);
-		vector float absdiff = vec_abs(diff);
-
-		vec_st(absdiff, left, result);
-
-		for (long j = 0; j < left ;  j++)
-		{
-			fsep += result[j];
-		}
-#else
-    for (long i = 0; i < nbytes; i++)
-        {
-            short vi, vj;
-            vi = binofgray[ * (gi++)];
-            vj = binofgray[ * (gj++)];
-            sep += abs(vi - vj);
-        }
-#endif
-    }
-    else
-    {
-#if pw_UseAltivec
-		float val_gi[ nbytes ];
-		float val_gj[ nbytes ];
-		short size = 4;
-
-		long max = nbytes / size;
-		long left = nbytes - (max * size);
-
-		float result[ max * size ];
-
-		for (long i = 0; i < nbytes; i++)
-		{
-			val_gi[i] = gi[i];
-			val_gj[i] = gj[i];
-		}
-
-
-		for (long i = 0; i < max; i++)
-		{
-			vector float vGi = vec_ld(size, val_gi + size * i);
-			vector float vGj = vec_ld(size, val_gj + size * i);
-
-			vector float diff = vec_sub(vGi, vGj);
-
-			vec_st(diff, size, result + i * size);
-
-		}
-
-		fsep = cblas_sasum(size * max, result, 1);
-		vector float vGi = vec_ld(left, val_gi + size * max);
-		vector float vGj = vec_ld(left, val_gj + size * max);
-
-		vector float diff = vec_sub(vGi, vGj);
-		vector float absdiff = vec_abs(diff);
-
-		vec_st(absdiff, left, result);
-
-		for (long j = 0; j < left ;  j++)
-		{
-			fsep += result[j];
-		}
-#else
-        for (long i = 0; i < nbytes; i++)
-        {
-            short vi, vj;
-            vi = * (gi++);
-            vj = * (gj++);
-            sep += abs(vi - vj);
-        }
-#endif
-    }
-#if pw_UseAltivec
-    fsep /= (255.0f * float(nbytes));
-    return fsep;
-#else
-	fsep = float(sep) / (255 * nbytes);
-    return fsep;
-#endif
+	uint64_t sep = SeparationKernel::distance( mutable_data, g->mutable_data, nbytes, gray );
 
+	return float(sep) / (255 * nbytes);
 }
 
 float Genome::mateProbability( Genome *g )
 {
-	double miscbias = get( MISC_BIAS );
+	double miscbias = get( genes().miscBias );
 
     // returns probability that two agents will successfully mate
     // based on their degree of genetic similarity/difference
@@ -499,7 +423,7 @@ float Genome::mateProbability( Genome *g )
     float a = separation( g );
     float cosa = cos( pow(a, miscbias) * PI );
     float s = cosa > 0.0 ? 0.5 : -0.5;
-    float p = 0.5  +  s * pow(fabs(cosa), get(MISC_INVIS_SLOPE));
+    float p = 0.5  +  s * pow(fabs(cosa), get(genes().miscInvisSlope));
 
     return p;
 }
@@ -538,6 +462,19 @@ void Genome::load( AbstractFile *in )
 	}
 }
 
+void Genome::dump( CheckPointWriter &out )
+{
+	out.put( (int32_t)nbytes );
+	out.putBytes( mutable_data, nbytes );
+}
+
+void Genome::load( CheckPointReader &in )
+{
+	if( in.get<int32_t>() != nbytes )
+		in.fail( "genome size mismatch (different genome schema?)" );
+	in.getBytes( mutable_data, nbytes );
+}
+
 void Genome::print()
 {
 	long lobit = 0;
@@ -12,6 +12,8 @@
 // forward decl
 class AbstractFile;
 class Brain;
+class CheckPointReader;
+class CheckPointWriter;
 class NervousSystem;
 
 namespace genome
@@ -33,15 +35,17 @@ namespace genome
 
 		virtual Brain *createBrain( NervousSystem *cns ) = 0;
 
-		Gene *MISC_BIAS;
-		Gene *MISC_INVIS_SLOPE;
-
 		Gene *gene( const char *name );
+		const GenomeSchema::Accessors &genes() { return schema->accessors; }
 
 		Scalar get( const char *name );
 		Scalar get( Gene *gene );
+		Scalar get( const GeneAccessor &accessor ) { return accessor.get( this ); }
 
 		unsigned int get_raw_uint( long byte );
+		// All the raw genes, e.g. to recognize identical genomes.
+		const unsigned char *getBytes() { return mutable_data; }
+		int getByteCount() { return nbytes; }
 		void updateSum( unsigned long *sum, unsigned long *sum2 );
 
 		void seed( Gene *gene,
@@ -72,12 +76,15 @@ namespace genome
 
 		void dump( AbstractFile *out );
 		void load( AbstractFile *in );
+		void dump( CheckPointWriter &out );
+		void load( CheckPointReader &in );
 
 		void print();
 		void print( long lobit, long hibit );
 
 	protected:
 		friend class Gene;
+		friend class GeneAccessor;
 		friend class MutableScalarGene;
 		friend class MutableNeurGroupGene;
 		friend class NeurGroupAttrGene;
@@ -109,6 +116,16 @@ namespace genome
 //===========================================================================
 // inlines
 //===========================================================================
+inline Scalar GeneAccessor::get( Genome *genome ) const
+{
+	assert( defined );
+
+	if( interpolated )
+		return interpolated->interpolate( genome->get_raw(offset) );
+	else
+		return value;
+}
+
 inline unsigned char Genome::get_raw( int offset )
 {
 	assert( offset >= 0 && offset < nbytes );
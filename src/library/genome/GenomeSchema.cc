@@ -45,6 +45,15 @@ void GenomeSchema::processWorldfile( proplib::Document &doc )
 			assert( false );
 	}
     GenomeSchema::config.enableEvolution = doc.get( "EnableEvolution" );
+	{
+		string sampling = doc.get( "MutationSampling" );
+		if( sampling == "Geometric" )
+			GenomeSchema::config.mutationSampling = GenomeSchema::MUTATION_GEOMETRIC;
+		else if( sampling == "PerDraw" )
+			GenomeSchema::config.mutationSampling = GenomeSchema::MUTATION_PER_DRAW;
+		else
+			assert( false );
+	}
     GenomeSchema::config.minMutationRate = doc.get( "MinMutationRate" );
     GenomeSchema::config.maxMutationRate = doc.get( "MaxMutationRate" );
     GenomeSchema::config.minMutationStdevPower = doc.get( "MinMutationStdevPower" );
@@ -189,6 +198,54 @@ void GenomeSchema::define()
 #undef INDEX
 }
 
+//-------------------------------------------------------------------------------------------
+// GenomeSchema::complete
+//-------------------------------------------------------------------------------------------
+void GenomeSchema::complete( int offset )
+{
+	GeneSchema::complete( offset );
+
+	resolveAccessors();
+}
+
+//-------------------------------------------------------------------------------------------
+// GenomeSchema::resolveAccessors
+//
+// Must follow endComplete(), which assigns the genes' offsets.
+//-------------------------------------------------------------------------------------------
+void GenomeSchema::resolveAccessors()
+{
+	assert( _state == STATE_COMPLETE );
+
+	// don't use get(), which would add the names of genes that aren't defined
+	auto find = [this]( const char *name )
+		{
+			GeneMap::iterator it = _name2gene.find( name );
+			return GeneAccessor( it == _name2gene.end() ? NULL : it->second );
+		};
+
+	accessors.mutationRate = find( "MutationRate" );
+	accessors.mutationStdevPower = find( "MutationStdevPower" );
+	accessors.crossoverPointCount = find( "CrossoverPointCount" );
+	accessors.lifeSpan = find( "LifeSpan" );
+	accessors.id = find( "ID" );
+	accessors.strength = find( "Strength" );
+	accessors.size = find( "Size" );
+	accessors.maxSpeed = find( "MaxSpeed" );
+	accessors.mateEnergyFraction = find( "MateEnergyFraction" );
+	accessors.metabolismIndex = find( "MetabolismIndex" );
+	accessors.scaleLatestSpikes = find( "ScaleLatestSpikes" );
+
+	// The miscegenation function's parameters are no longer genes, so they
+	// come from the worldfile.
+	accessors.miscBias = find( "MiscBias" );
+	if( !accessors.miscBias.isDefined() )
+		accessors.miscBias = GeneAccessor( Scalar(GenomeSchema::config.miscBias) );
+	accessors.miscInvisSlope = find( "MiscInvisSlope" );
+	if( !accessors.miscInvisSlope.isDefined() )
+		accessors.miscInvisSlope = GeneAccessor( Scalar(GenomeSchema::config.miscInvisSlope) );
+}
+
 //-------------------------------------------------------------------------------------------
 // GenomeSchema::seed
 //
@@ -26,6 +26,12 @@ namespace genome
 			SEED_RANDOM
 		};
 
+		enum MutationSampling
+		{
+			MUTATION_GEOMETRIC,
+			MUTATION_PER_DRAW
+		};
+
 		static struct Configuration
 		{
 			GenomeLayout::LayoutType layoutType;
@@ -34,6 +40,7 @@ namespace genome
 			GeneInterpolationPowers geneInterpolationPower;
 
 			bool enableEvolution;
+			MutationSampling mutationSampling;
 
 			SeedType seedType;
 			float seedMutationRate;
@@ -61,13 +68,36 @@ namespace genome
 
 		static void processWorldfile( proplib::Document &doc );
 
+		// The scalar genes read whenever agents are born, grown or mate.
+		// Those not in the schema are undefined.
+		struct Accessors
+		{
+			GeneAccessor mutationRate;
+			GeneAccessor mutationStdevPower;
+			GeneAccessor crossoverPointCount;
+			GeneAccessor lifeSpan;
+			GeneAccessor id;
+			GeneAccessor strength;
+			GeneAccessor size;
+			GeneAccessor maxSpeed;
+			GeneAccessor mateEnergyFraction;
+			GeneAccessor metabolismIndex;
+			GeneAccessor scaleLatestSpikes;
+			GeneAccessor miscBias;
+			GeneAccessor miscInvisSlope;
+		} accessors;
+
 		GenomeSchema();
 		virtual ~GenomeSchema();
 
 		virtual void define();
+		virtual void complete( int offset = 0 );
 		virtual void seed( Genome *genome );
 
 		virtual Genome *createGenome( GenomeLayout *layout ) = 0;
+
+	protected:
+		void resolveAccessors();
 	};
 
 } // namespace genome
@@ -122,7 +122,7 @@ const Metabolism *GenomeUtil::getMetabolism( Genome *g )
 	}
 	else
 	{
-		index = (int)g->get( "MetabolismIndex" );
+		index = (int)g->get( g->genes().metabolismIndex );
 	}
 
 	return Metabolism::get( index );
@@ -1,5 +1,10 @@
 #include "SeparationCache.h"
 
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+
 #include "agent/agent.h"
 #include "utils/datalib.h"
 
@@ -69,21 +74,107 @@ float SeparationCache::createEntry( agent *a, agent *b )
 	DB("  x,y=%ld,%ld\n", x->Number(), y->Number());
 
 	AgentEntries &entries = getEntries(x);
-	AgentEntries::iterator it = entries.find( y->Number() );
 	float result;
 	
-	if( it == entries.end() )
+	if( !entries.find(y->Number(), result) )
 	{
 		DB("  CACHE MISS\n");
 		result = a->Genes()->separation( b->Genes() );
-		entries[y->Number()] = result;
-	}
-	else
-	{
-		result = it->second;
+		entries.insert( y->Number(), result );
 	}
 
 	DB("  separation=%f\n", result);
 
 	return result;
 }
+
+// --------------------------------------------------------------------------------
+// AgentEntries::slot()
+//
+// Where number's probe sequence starts. Fibonacci hashing, so consecutive
+// numbers are spread over the table.
+// --------------------------------------------------------------------------------
+size_t SeparationCache::AgentEntries::slot( long number ) const
+{
+	return size_t( (uint64_t(number) * 0x9E3779B97F4A7C15ULL) >> 32 ) & (slots.size() - 1);
+}
+
+// --------------------------------------------------------------------------------
+// AgentEntries::find()
+// --------------------------------------------------------------------------------
+bool SeparationCache::AgentEntries::find( long number, float &separation ) const
+{
+	if( count == 0 )
+		return false;
+
+	size_t mask = slots.size() - 1;
+	for( size_t i = slot(number); slots[i].first != 0; i = (i + 1) & mask )
+	{
+		if( slots[i].first == number )
+		{
+			separation = slots[i].second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// --------------------------------------------------------------------------------
+// AgentEntries::insert()
+//
+// Replaces any entry for number.
+// --------------------------------------------------------------------------------
+void SeparationCache::AgentEntries::insert( long number, float separation )
+{
+	assert( number > 0 );
+
+	// keep the table at most 3/4 full
+	if( (count + 1) * 4 > slots.size() * 3 )
+		grow();
+
+	size_t mask = slots.size() - 1;
+	size_t i = slot( number );
+	while( (slots[i].first != 0) && (slots[i].first != number) )
+		i = (i + 1) & mask;
+
+	if( slots[i].first == 0 )
+		count++;
+	slots[i] = Entry( number, separation );
+}
+
+// --------------------------------------------------------------------------------
+// AgentEntries::grow()
+// --------------------------------------------------------------------------------
+void SeparationCache::AgentEntries::grow()
+{
+	vector<Entry> old( slots.empty() ? 16 : slots.size() * 2, Entry(0, 0.0f) );
+	slots.swap( old );	// slots is now the larger, empty table
+
+	size_t mask = slots.size() - 1;
+	for( size_t j = 0; j < old.size(); j++ )
+	{
+		if( old[j].first != 0 )
+		{
+			size_t i = slot( old[j].first );
+			while( slots[i].first != 0 )
+				i = (i + 1) & mask;
+			slots[i] = old[j];
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------
+// AgentEntries::getSorted()
+// --------------------------------------------------------------------------------
+void SeparationCache::AgentEntries::getSorted( vector<Entry> &result ) const
+{
+	result.clear();
+	result.reserve( count );
+	for( size_t i = 0; i < slots.size(); i++ )
+	{
+		if( slots[i].first != 0 )
+			result.push_back( slots[i] );
+	}
+	sort( result.begin(), result.end() );
+}
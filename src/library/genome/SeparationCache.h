@@ -1,6 +1,7 @@
 #pragma once
 
-#include <map>
+#include <utility>
+#include <vector>
 
 #include "agent/AgentAttachedData.h"
 #include "sim/simtypes.h"
@@ -11,6 +12,30 @@ class SeparationCache
 	SeparationCache() {}
 
  public:
+	// An agent's separations from other agents, by their numbers, in an
+	// open-addressing hash table with linear probing. Agent numbers start at
+	// 1, so 0 marks an empty slot.
+	class AgentEntries
+	{
+	 public:
+		typedef std::pair<long, float> Entry;
+
+		AgentEntries() : count( 0 ) {}
+
+		size_t size() const { return count; }
+		bool find( long number, float &separation ) const;
+		void insert( long number, float separation );
+		// The entries in order of agent number.
+		void getSorted( std::vector<Entry> &result ) const;
+
+	 private:
+		size_t slot( long number ) const;
+		void grow();
+
+		std::vector<Entry> slots;
+		size_t count;
+	};
+
 	static void init();
 
 	static void birth( const sim::AgentBirthEvent &birth );
@@ -18,7 +43,6 @@ class SeparationCache
 
 	static float createEntry( agent *a, agent *b );
 
-	typedef std::map<long, float> AgentEntries;
 	static AgentEntries &getEntries( agent *a );
 
  private:
@@ -0,0 +1,216 @@
+#include "SeparationKernel.h"
+
+#include <stdlib.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+	#define SK_X86 1
+	#include <immintrin.h>
+#else
+	#define SK_X86 0
+#endif
+
+using namespace SeparationKernel;
+
+typedef uint64_t (*DistanceFunc)( const unsigned char *, const unsigned char *, long, bool );
+
+//---------------------------------------------------------------------------
+// grayDecode
+//
+// Same as binofgray[g] (see utils/graybin.h), whose tables this file would
+// otherwise include without using most of: a prefix XOR of g's bits from the
+// top.
+//---------------------------------------------------------------------------
+static inline int grayDecode( unsigned char g )
+{
+	unsigned x = g;
+	x ^= x >> 1;
+	x ^= x >> 2;
+	x ^= x >> 4;
+	return (int)x;
+}
+
+//---------------------------------------------------------------------------
+// distanceTail
+//
+// The scalar loop, also used for what's left over after the vector loops.
+//---------------------------------------------------------------------------
+static inline uint64_t distanceTail( const unsigned char *a,
+									 const unsigned char *b,
+									 long k,
+									 long n,
+									 bool gray )
+{
+	uint64_t sum = 0;
+
+	if( gray )
+	{
+		for( ; k < n; k++ )
+			sum += abs( grayDecode(a[k]) - grayDecode(b[k]) );
+	}
+	else
+	{
+		for( ; k < n; k++ )
+			sum += abs( int(a[k]) - int(b[k]) );
+	}
+
+	return sum;
+}
+
+//===========================================================================
+// Scalar
+//===========================================================================
+
+static uint64_t distanceScalar( const unsigned char *a,
+								const unsigned char *b,
+								long n,
+								bool gray )
+{
+	return distanceTail( a, b, 0, n, gray );
+}
+
+#if SK_X86
+
+// The vector versions apply grayDecode()'s three shift-and-XOR steps to every
+// byte at once. There are no byte shifts, so the bits shifted in from
+// the neighbouring byte of each 16-bit lane are masked off.
+
+//===========================================================================
+// SSE2
+//===========================================================================
+
+__attribute__((target("sse2")))
+static inline __m128i grayDecode16( __m128i x )
+{
+	x = _mm_xor_si128( x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi8(0x7f)) );
+	x = _mm_xor_si128( x, _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi8(0x3f)) );
+	x = _mm_xor_si128( x, _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0f)) );
+	return x;
+}
+
+__attribute__((target("sse2")))
+static uint64_t distanceSse2( const unsigned char *a,
+							  const unsigned char *b,
+							  long n,
+							  bool gray )
+{
+	__m128i sum = _mm_setzero_si128();
+	long n16 = n & ~15L;
+	long k;
+
+	if( gray )
+	{
+		for( k = 0; k < n16; k += 16 )
+		{
+			__m128i va = grayDecode16( _mm_loadu_si128((const __m128i *)(a + k)) );
+			__m128i vb = grayDecode16( _mm_loadu_si128((const __m128i *)(b + k)) );
+			sum = _mm_add_epi64( sum, _mm_sad_epu8(va, vb) );
+		}
+	}
+	else
+	{
+		for( k = 0; k < n16; k += 16 )
+		{
+			__m128i va = _mm_loadu_si128( (const __m128i *)(a + k) );
+			__m128i vb = _mm_loadu_si128( (const __m128i *)(b + k) );
+			sum = _mm_add_epi64( sum, _mm_sad_epu8(va, vb) );
+		}
+	}
+
+	uint64_t lanes[2];
+	_mm_storeu_si128( (__m128i *)lanes, sum );
+
+	return lanes[0] + lanes[1] + distanceTail( a, b, k, n, gray );
+}
+
+//===========================================================================
+// AVX2
+//===========================================================================
+
+__attribute__((target("avx2")))
+static inline __m256i grayDecode32( __m256i x )
+{
+	x = _mm256_xor_si256( x, _mm256_and_si256(_mm256_srli_epi16(x, 1), _mm256_set1_epi8(0x7f)) );
+	x = _mm256_xor_si256( x, _mm256_and_si256(_mm256_srli_epi16(x, 2), _mm256_set1_epi8(0x3f)) );
+	x = _mm256_xor_si256( x, _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0f)) );
+	return x;
+}
+
+__attribute__((target("avx2")))
+static uint64_t distanceAvx2( const unsigned char *a,
+							  const unsigned char *b,
+							  long n,
+							  bool gray )
+{
+	__m256i sum = _mm256_setzero_si256();
+	long n32 = n & ~31L;
+	long k;
+
+	if( gray )
+	{
+		for( k = 0; k < n32; k += 32 )
+		{
+			__m256i va = grayDecode32( _mm256_loadu_si256((const __m256i *)(a + k)) );
+			__m256i vb = grayDecode32( _mm256_loadu_si256((const __m256i *)(b + k)) );
+			sum = _mm256_add_epi64( sum, _mm256_sad_epu8(va, vb) );
+		}
+	}
+	else
+	{
+		for( k = 0; k < n32; k += 32 )
+		{
+			__m256i va = _mm256_loadu_si256( (const __m256i *)(a + k) );
+			__m256i vb = _mm256_loadu_si256( (const __m256i *)(b + k) );
+			sum = _mm256_add_epi64( sum, _mm256_sad_epu8(va, vb) );
+		}
+	}
+
+	uint64_t lanes[4];
+	_mm256_storeu_si256( (__m256i *)lanes, sum );
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + distanceTail( a, b, k, n, gray );
+}
+
+#endif // SK_X86
+
+//===========================================================================
+// Dispatch
+//===========================================================================
+
+struct Impl
+{
+	const char *name;
+	DistanceFunc distance;
+};
+
+static Impl selectImpl()
+{
+#if SK_X86
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports("avx2") )
+		return { "AVX2", distanceAvx2 };
+	if( __builtin_cpu_supports("sse2") )
+		return { "SSE2", distanceSse2 };
+#endif
+	return { "Scalar", distanceScalar };
+}
+
+static const Impl impl = selectImpl();
+
+//---------------------------------------------------------------------------
+// SeparationKernel::getName
+//---------------------------------------------------------------------------
+const char *SeparationKernel::getName()
+{
+	return impl.name;
+}
+
+//---------------------------------------------------------------------------
+// SeparationKernel::distance
+//---------------------------------------------------------------------------
+uint64_t SeparationKernel::distance( const unsigned char *a,
+									 const unsigned char *b,
+									 long n,
+									 bool gray )
+{
+	return impl.distance( a, b, n, gray );
+}
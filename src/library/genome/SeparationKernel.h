@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+//===========================================================================
+// SeparationKernel
+//
+// The inner loop of Genome::separation(): the sum of absolute differences
+// between two genomes' bytes, optionally gray-decoding each byte first. The
+// sums are exact, so the AVX2, SSE2 and scalar versions agree; the best one
+// the CPU supports is chosen at startup.
+//===========================================================================
+namespace SeparationKernel
+{
+	// Name of the implementation in use ("AVX2", "SSE2" or "Scalar").
+	const char *getName();
+
+	// Returns the sum over k of |decode(a[k]) - decode(b[k])|, where decode
+	// is binofgray[] if gray, else the identity.
+	uint64_t distance( const unsigned char *a,
+					   const unsigned char *b,
+					   long n,
+					   bool gray );
+}
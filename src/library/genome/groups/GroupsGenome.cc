@@ -16,9 +16,12 @@ GroupsGenome::GroupsGenome( GroupsGenomeSchema *schema,
 		  layout )
 , _schema( schema )
 {
+#define GROUP_ATTR(NAME) GroupsGeneType::to_NeurGroupAttr( gene(NAME) )
+#define SYNAPSE_ATTR(NAME) GroupsGeneType::to_SynapseAttr( gene(NAME) )
+
 	if( GroupsBrain::config.orderedinternalneurgroups )
 	{
-		ORDER = gene("Order");
+		ORDER = GROUP_ATTR("Order");
 	}
 	else
 	{
@@ -27,15 +30,33 @@ GroupsGenome::GroupsGenome( GroupsGenomeSchema *schema,
 
 	if( Brain::config.gaussianInitWeight )
 	{
-		WEIGHT_STDEV = gene("WeightStdev");
+		WEIGHT_STDEV = SYNAPSE_ATTR("WeightStdev");
 	}
 	else
 	{
 		WEIGHT_STDEV = NULL;
 	}
 
-	CONNECTION_DENSITY = gene("ConnectionDensity");
-	TOPOLOGICAL_DISTORTION = gene("TopologicalDistortion");
+	CONNECTION_DENSITY = SYNAPSE_ATTR("ConnectionDensity");
+	TOPOLOGICAL_DISTORTION = SYNAPSE_ATTR("TopologicalDistortion");
+
+	if( GroupsBrain::config.enableTopologicalDistortionRngSeed )
+	{
+		TOPOLOGICAL_DISTORTION_RNG_SEED = SYNAPSE_ATTR("TopologicalDistortionRngSeed");
+	}
+	else
+	{
+		TOPOLOGICAL_DISTORTION_RNG_SEED = NULL;
+	}
+
+	if( GroupsBrain::config.enableInitWeightRngSeed )
+	{
+		INIT_WEIGHT_RNG_SEED = SYNAPSE_ATTR("InitWeightRngSeed");
+	}
+	else
+	{
+		INIT_WEIGHT_RNG_SEED = NULL;
+	}
 
 	if( Brain::config.enableLearning )
 	{
@@ -46,15 +67,15 @@ GroupsGenome::GroupsGenome( GroupsGenomeSchema *schema,
 		LEARNING_RATE = NULL;
 	}
 
-	INHIBITORY_COUNT = gene("InhibitoryNeuronCount");
-	EXCITATORY_COUNT = gene("ExcitatoryNeuronCount");
-	BIAS = gene("Bias");
+	INHIBITORY_COUNT = GROUP_ATTR("InhibitoryNeuronCount");
+	EXCITATORY_COUNT = GROUP_ATTR("ExcitatoryNeuronCount");
+	BIAS = GROUP_ATTR("Bias");
 	INTERNAL = schema->getGroupGene( schema->getFirstGroup(NGT_INTERNAL) );
 
 	if( Brain::config.neuronModel == Brain::Configuration::TAU_GAIN )
 	{
-		TAU = gene( "Tau" );
-		GAIN = gene( "Gain" );
+		TAU = GROUP_ATTR( "Tau" );
+		GAIN = GROUP_ATTR( "Gain" );
 	}
 	else
 	{
@@ -65,10 +86,10 @@ GroupsGenome::GroupsGenome( GroupsGenomeSchema *schema,
 	if( (Brain::config.neuronModel == Brain::Configuration::SPIKING)
 		&& Brain::config.Spiking.enableGenes )
 	{
-		SPIKING_A = gene("SpikingParameterA");
-		SPIKING_B = gene("SpikingParameterB");
-		SPIKING_C = gene("SpikingParameterC");
-		SPIKING_D = gene("SpikingParameterD");
+		SPIKING_A = GROUP_ATTR("SpikingParameterA");
+		SPIKING_B = GROUP_ATTR("SpikingParameterB");
+		SPIKING_C = GROUP_ATTR("SpikingParameterC");
+		SPIKING_D = GROUP_ATTR("SpikingParameterD");
 	}
 	else
 	{
@@ -78,6 +99,9 @@ GroupsGenome::GroupsGenome( GroupsGenomeSchema *schema,
 		SPIKING_D = NULL;
 	}
 
+#undef GROUP_ATTR
+#undef SYNAPSE_ATTR
+
 #define ST(NAME) NAME = schema->getSynapseType(#NAME)
 	ST(EE);
 	ST(EI);
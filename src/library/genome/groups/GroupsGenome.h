@@ -16,23 +16,26 @@ namespace genome
 		GroupsSynapseType *IE;
 		GroupsSynapseType *II;
 
-		Gene *ORDER;
-		Gene *WEIGHT_STDEV;
-		Gene *CONNECTION_DENSITY;
-		Gene *TOPOLOGICAL_DISTORTION;
-		Gene *LEARNING_RATE;
-		Gene *INHIBITORY_COUNT;
-		Gene *EXCITATORY_COUNT;
-		Gene *BIAS;
+		// Cast once here, so reading them takes no dynamic_cast.
+		NeurGroupAttrGene *ORDER;
+		SynapseAttrGene *WEIGHT_STDEV;
+		SynapseAttrGene *CONNECTION_DENSITY;
+		SynapseAttrGene *TOPOLOGICAL_DISTORTION;
+		SynapseAttrGene *TOPOLOGICAL_DISTORTION_RNG_SEED;
+		SynapseAttrGene *INIT_WEIGHT_RNG_SEED;
+		Gene *LEARNING_RATE;	// immutable if its range is empty
+		NeurGroupAttrGene *INHIBITORY_COUNT;
+		NeurGroupAttrGene *EXCITATORY_COUNT;
+		NeurGroupAttrGene *BIAS;
 		Gene *INTERNAL;
 
-		Gene *TAU;
-		Gene *GAIN;
+		NeurGroupAttrGene *TAU;
+		NeurGroupAttrGene *GAIN;
 
-		Gene *SPIKING_A;
-		Gene *SPIKING_B;
-		Gene *SPIKING_C;
-		Gene *SPIKING_D;
+		NeurGroupAttrGene *SPIKING_A;
+		NeurGroupAttrGene *SPIKING_B;
+		NeurGroupAttrGene *SPIKING_C;
+		NeurGroupAttrGene *SPIKING_D;
 
 		GroupsGenome( GroupsGenomeSchema *schema,
 					  GenomeLayout *layout );
@@ -59,11 +62,17 @@ namespace genome
 
 		Scalar get( Gene *gene,
 					int group );
+		Scalar get( NeurGroupAttrGene *gene,
+					int group ) { return gene->get( this, group ); }
 
 		Scalar get( Gene *gene,
 					GroupsSynapseType *synapseType,
 					int from,
 					int to );
+		Scalar get( SynapseAttrGene *gene,
+					GroupsSynapseType *synapseType,
+					int from,
+					int to ) { return gene->get( this, synapseType, from, to ); }
 
 		using Genome::seed;
 		using Genome::seedRandom;
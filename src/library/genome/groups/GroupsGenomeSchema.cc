@@ -736,4 +736,6 @@ void GroupsGenomeSchema::complete( int offset )
 	}
 
 	endComplete();
+
+	resolveAccessors();
 }
@@ -22,6 +22,13 @@ SheetsGenome::~SheetsGenome()
 
 Brain *SheetsGenome::createBrain( NervousSystem *cns )
 {
+	if( BrainGrowthCache::isEnabled() )
+	{
+		BrainGrowthCache::GrowthRef growth = BrainGrowthCache::find( this );
+		if( growth )
+			return new SheetsBrain( cns, this, growth );
+	}
+
 	return new SheetsBrain( cns, this, _schema->createSheetsModel(this) );
 }
 
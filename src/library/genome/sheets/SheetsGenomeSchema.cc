@@ -66,6 +66,7 @@ void SheetsGenomeSchema::processWorldfile( proplib::Document &doc )
 
 	SheetsGenomeSchema::config.enableReceptiveFieldCurrentRegion = sheets.get( "EnableReceptiveFieldCurrentRegion" );
 	SheetsGenomeSchema::config.enableReceptiveFieldOtherRegion = sheets.get( "EnableReceptiveFieldOtherRegion" );
+	SheetsGenomeSchema::config.growthThreads = sheets.get( "GrowthThreads" );
 }
 
 
@@ -689,9 +690,11 @@ SheetsModel *SheetsGenomeSchema::createSheetsModel( SheetsGenome *genome )
 	createSheets( model, genome, genome->gene("OutputSheets") );
 	createSheets( model, genome, genome->gene("InternalSheets"), genome->get("InternalSheetsCount") );
 
-	createReceptiveFields( model, genome, genome->gene("InputSheets") );
-	createReceptiveFields( model, genome, genome->gene("OutputSheets") );
-	createReceptiveFields( model, genome, genome->gene("InternalSheets") );
+	ReceptiveFieldVector fields;
+	createReceptiveFields( model, genome, genome->gene("InputSheets"), fields );
+	createReceptiveFields( model, genome, genome->gene("OutputSheets"), fields );
+	createReceptiveFields( model, genome, genome->gene("InternalSheets"), fields );
+	model->addReceptiveFields( fields, SheetsGenomeSchema::config.growthThreads );
 
 	model->cull();
 
@@ -843,7 +846,10 @@ Neuron::Attributes SheetsGenomeSchema::decodeNeuronAttrs( SheetsGenome *g,
 	return attrs;
 }
 
-void SheetsGenomeSchema::createReceptiveFields( SheetsModel *model, SheetsGenome *g, Gene *sheetsGene )
+void SheetsGenomeSchema::createReceptiveFields( SheetsModel *model,
+												SheetsGenome *g,
+												Gene *sheetsGene,
+												ReceptiveFieldVector &fields )
 {
 	ContainerGene *container = GeneType::to_Container( sheetsGene );
 
@@ -880,7 +886,7 @@ void SheetsGenomeSchema::createReceptiveFields( SheetsModel *model, SheetsGenome
 				{
 					ContainerGene *fieldGene = GeneType::to_Container( fieldsGene->getAll()[i] );
 
-					createReceptiveField( model, sheet, g, fieldGene );
+					createReceptiveField( model, sheet, g, fieldGene, fields );
 				}
 			}
 		}
@@ -890,7 +896,8 @@ void SheetsGenomeSchema::createReceptiveFields( SheetsModel *model, SheetsGenome
 void SheetsGenomeSchema::createReceptiveField( SheetsModel *model,
 											   Sheet *sheet,
 											   SheetsGenome *g,
-											   ContainerGene *fieldGene )
+											   ContainerGene *fieldGene,
+											   ReceptiveFieldVector &fields )
 {
 	// ---
 	// --- Fetch field attributes
@@ -954,16 +961,20 @@ void SheetsGenomeSchema::createReceptiveField( SheetsModel *model,
 		assert( false );
 	}
 
-	sheet->addReceptiveField( role,
-							  currentCenter,
-							  currentSize,
-							  otherCenter,
-							  otherSize,
-							  offset,
-							  size,
-							  otherSheet,
-							  neuronPredicate,
-							  synapseCreated );
+	ReceptiveField field;
+	field.sheet = sheet;
+	field.role = role;
+	field.currentCenter = currentCenter;
+	field.currentSize = currentSize;
+	field.otherCenter = otherCenter;
+	field.otherSize = otherSize;
+	field.fieldOffset = offset;
+	field.fieldSize = size;
+	field.other = otherSheet;
+	field.neuronPredicate = neuronPredicate;
+	field.synapseCreated = synapseCreated;
+
+	fields.push_back( field );
 }
 
 Synapse::Attributes SheetsGenomeSchema::decodeSynapseAttrs( SheetsGenome *g,
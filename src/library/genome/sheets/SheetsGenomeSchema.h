@@ -37,6 +37,7 @@ namespace genome
 			bool enableReceptiveFieldOtherRegion;
 			int minExplicitVectorSize;
 			int maxExplicitVectorSize;
+			int growthThreads;
 		} config;
 
 		static void processWorldfile( proplib::Document &doc );
@@ -107,11 +108,15 @@ namespace genome
 		sheets::Neuron::Attributes decodeNeuronAttrs( SheetsGenome *g,
 													  ContainerGene *attrsGene );
 
-		void createReceptiveFields( sheets::SheetsModel *model, SheetsGenome *g, Gene *sheetsGene );
+		void createReceptiveFields( sheets::SheetsModel *model,
+									SheetsGenome *g,
+									Gene *sheetsGene,
+									sheets::ReceptiveFieldVector &fields );
 		void createReceptiveField( sheets::SheetsModel *model,
 								   sheets::Sheet *sheet,
 								   SheetsGenome *g,
-								   ContainerGene *fieldGene );
+								   ContainerGene *fieldGene,
+								   sheets::ReceptiveFieldVector &fields );
 		sheets::Synapse::Attributes decodeSynapseAttrs( SheetsGenome *g,
 														ContainerGene *container );
 	};
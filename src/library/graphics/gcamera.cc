@@ -64,7 +64,10 @@ gcamera::gcamera()
 		fFollowObject(NULL),
 		fPerspectiveFixed(false),
 		fPerspectiveInUse(false),
-		glFogOn(false)				// this will be turned on for cameras attached to agents at the SetGraphics() function
+		glFogOn(false),				// this will be turned on for cameras attached to agents at the SetGraphics() function
+		sFogFunction('O'),
+		fExpFogDensity(0.0),
+		iLinearFogEnd(0)
 {
 	fPosition[0] = 0.0;
     fPosition[1] = 0.0;
@@ -325,11 +328,61 @@ void gcamera::print()
         cout << "  not attached to any object" nl;
 	}
 }
+//---------------------------------------------------------------------------
+// gcamera::GetFogFactor
+//---------------------------------------------------------------------------    
+// Fraction of a fragment's color that survives the fog at the given eye
+// distance, as computed by GL (the fog color is black).
+float gcamera::GetFogFactor( float distance )
+{
+	float f = 1.0;
+
+	if( glFogOn )
+	{
+		if( sFogFunction == 'L' )
+			f = (iLinearFogEnd - distance) / (iLinearFogEnd - fNear);
+		else if( sFogFunction == 'E' )
+			f = exp( -fExpFogDensity * distance );
+
+		f = clamp( f, 0.0f, 1.0f );
+	}
+
+	return f;
+}
+
+
+//---------------------------------------------------------------------------
+// gcamera::GetVisibleDistance
+//---------------------------------------------------------------------------    
+// Distance beyond which nothing can be seen, due to either the far plane or
+// the fog reducing all colors to black (i.e. below half of 1/255).
+float gcamera::GetVisibleDistance()
+{
+	float d = fFar;
+
+	if( glFogOn )
+	{
+		if( sFogFunction == 'L' )
+			d = fmin( d, float(iLinearFogEnd) );
+		else if( (sFogFunction == 'E') && (fExpFogDensity > 0.0) )
+			d = fmin( d, float(log(510.0) / fExpFogDensity) );
+	}
+
+	return d;
+}
+
+
 //---------------------------------------------------------------------------
 // gcamera::SetFog
 //---------------------------------------------------------------------------    
 void gcamera::SetFog( bool fog, char function, float density, int end )
 {
+	// Remember the settings for renderers that don't go through GL
+	glFogOn = fog;
+	sFogFunction = function;
+	fExpFogDensity = density;
+	iLinearFogEnd = end;
+
 	if( fog )			
 	{
 		glEnable(GL_FOG);				// turn on Fog to give the agents depth perception
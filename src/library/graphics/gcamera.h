@@ -27,7 +27,16 @@ public:
 	void SetFar(float f);        
 	void SetAspect(float width, float height);
 	void SetAspect(float a);
+	float GetAspect();
+	float GetNear();
+	float GetFar();
 	void SetFog( bool fog, char function, float density, int end );
+	bool GetFog();
+	char GetFogFunction();
+	float GetExpFogDensity();
+	int GetLinearFogEnd();
+	float GetFogFactor( float distance );
+	float GetVisibleDistance();
 
 	void Use();
     virtual void print();
@@ -75,6 +84,13 @@ inline float gcamera::GetFOV() { return fFOV; }
 inline void gcamera::SetNear(float n) { fNear = n; }
 inline void gcamera::SetFar(float f) { fFar = f; }
 inline void gcamera::SetAspect(float a) { fAspect = a; }
+inline float gcamera::GetAspect() { return fAspect; }
+inline float gcamera::GetNear() { return fNear; }
+inline float gcamera::GetFar() { return fFar; }
+inline bool gcamera::GetFog() { return glFogOn; }
+inline char gcamera::GetFogFunction() { return sFogFunction; }
+inline float gcamera::GetExpFogDensity() { return fExpFogDensity; }
+inline int gcamera::GetLinearFogEnd() { return iLinearFogEnd; }
 //inline void gcamera::SetTwist(float t) { fAngle[2] = t; }
 inline bool gcamera::PerspectiveSet() { return fPerspectiveInUse; }
 
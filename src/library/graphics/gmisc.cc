@@ -327,8 +327,15 @@ void frustumXZ::Set(float x, float z, float ang, float fov, float rad)
 }
 
 
-static long infrustum = 0;
-static long outfrustum = 0;
+// The counters are only maintained when debugging, so that Inside() may be
+// called concurrently.
+#if DebugFrustum
+	static long infrustum = 0;
+	static long outfrustum = 0;
+	#define frustumCount( counter ) counter++
+#else
+	#define frustumCount( counter )
+#endif
 
 int frustumXZ::Inside(float* p) const
 {
@@ -340,17 +347,17 @@ int frustumXZ::Inside(float* p) const
     {
         if (ang < angmin)
         {
-            outfrustum++;
+            frustumCount( outfrustum );
             return 0;
         }
         else if (ang > angmax)
         {
-            outfrustum++;
+            frustumCount( outfrustum );
             return 0;
         }
         else
         {
-            infrustum++;
+            frustumCount( infrustum );
             return 1;
         }
     }
@@ -358,17 +365,17 @@ int frustumXZ::Inside(float* p) const
     {
         if (ang > angmin)
         {
-            infrustum++;
+            frustumCount( infrustum );
             return 1;
         }
         else if (ang < angmax)
         {
-            infrustum++;
+            frustumCount( infrustum );
             return 1;
         }
         else
         {
-            outfrustum++;
+            frustumCount( outfrustum );
             return 0;
         }
     }
@@ -47,6 +47,7 @@ void gobject::init()
 	fColor[2] = rand() / 32767.0;
 	fColor[3] = 0.;
 	listLink = NULL;
+	gridSlot = -1;
 	fCarriedBy = NULL;
 	fTypeNumber = 0;
 	fCarryOffset[0] = 0.0;
@@ -85,6 +86,32 @@ void gobject::load(istream& in)
 }
 
 
+void gobject::dump(CheckPointWriter& out)
+{
+	out.put( fTypeNumber );
+	out.putArray( fPosition, 3 );
+	out.putArray( fAngle, 3 );
+	out.putArray( fColor, 4 );
+	out.put( fScale );
+	out.put( fRadius );
+	out.put( fRotated );
+	out.putArray( fCarryOffset, 3 );
+}
+
+
+void gobject::load(CheckPointReader& in)
+{
+	in.get( fTypeNumber );
+	in.getArray( fPosition, 3 );
+	in.getArray( fAngle, 3 );
+	in.getArray( fColor, 4 );
+	in.get( fScale );
+	in.get( fRadius );
+	in.get( fRotated );
+	in.getArray( fCarryOffset, 3 );
+}
+
+
 void gobject::print()
 {
    	cout << "For object named = \"" << fName << "\"...\n";
@@ -331,6 +358,12 @@ void gobject::PickedUp( gobject* carrier, float dy )
 }
 
 
+void gobject::RestoreCarriedBy( gobject* carrier )
+{
+	fCarriedBy = carrier;
+}
+
+
 void gobject::Dropped( void )
 {
 	debugcheck( "%s # %lu dropped by %s # %lu", OBJECTTYPE( this ), getTypeNumber(), OBJECTTYPE( fCarriedBy ), fCarriedBy->getTypeNumber() );
@@ -30,6 +30,7 @@
 
 // Local
 #include "graphics/graphics.h"
+#include "utils/CheckPoint.h"
 #include "utils/error.h"
 #include "utils/gdlink.h"
 #include "utils/misc.h"
@@ -84,6 +85,7 @@ public:
     float pitch();
     float roll();
     void setscale(float s);
+    float scale();
     void setradius(float r);
     
     void setcol3(float* c);
@@ -128,6 +130,7 @@ public:
 
     gdlink<gobject*>* listLink;    
     gdlink<gobject*>* GetListLink();
+    int gridSlot;	// slot in objectxsortedlist's SpatialGrid, or -1
 
 	bool BeingCarried( void );
 	gobject* CarriedBy( void );
@@ -135,6 +138,7 @@ public:
 	bool IsCarrying(int type);
 	void PickedUp( gobject* carrier, float dy );
 	void Dropped( void );
+	void RestoreCarriedBy( gobject* carrier );	// offset comes from load()
 
 	typedef std::list<gobject*> gObjectList;
 
@@ -152,6 +156,8 @@ protected:
     void init();
 	void dump(std::ostream& out);
 	void load(std::istream& in);
+	void dump(CheckPointWriter& out);
+	void load(CheckPointReader& in);
 
     float fPosition[3];
     float fAngle[3];
@@ -179,6 +185,7 @@ inline float gobject::yaw() { return fAngle[0]; }
 inline float gobject::pitch() { return fAngle[1]; }
 inline float gobject::roll() { return fAngle[2]; }
 inline void gobject::setscale(float s) { fScale = s; }
+inline float gobject::scale() { return fScale; }
 inline void gobject::setradius(float r) { fRadius = r; srPrint( "gobject::%s(r): r=%g\n", __FUNCTION__, fRadius ); }
 inline void gobject::settransparency(float t) { fColor[3] = t; }
 inline void gobject::SetRed(float r) { fColor[0] = r; }
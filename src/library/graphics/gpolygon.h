@@ -42,6 +42,8 @@ public:
     float ly();
     float lz();
     float radiusscale();
+    long numPoints();
+    const float* vertices();
     
     virtual void draw();
     virtual void print();
@@ -61,6 +63,8 @@ inline float gpoly::lx() { return fLength[0]; }
 inline float gpoly::ly() { return fLength[1]; }
 inline float gpoly::lz() { return fLength[2]; }
 inline float gpoly::radiusscale() { return fRadiusScale; }
+inline long  gpoly::numPoints() { return fNumPoints; }
+inline const float* gpoly::vertices() { return fVertices; }
 
 
 
@@ -88,6 +92,7 @@ public:
     float lz();
     float radiusscale();
 	long numPolygons();
+	const opoly* polygon(long i);
 
     void drawcolpolyrange(long i1, long i2, float* color);
     
@@ -112,5 +117,6 @@ inline float gpolyobj::ly() { return fLength[1]; }
 inline float gpolyobj::lz() { return fLength[2]; }
 inline float gpolyobj::radiusscale() { return fRadiusScale; }
 inline long  gpolyobj::numPolygons() { return fNumPolygons; }
+inline const opoly* gpolyobj::polygon(long i) { return &fPolygon[i]; }
 
 #endif
@@ -30,6 +30,8 @@ public:
     void SetSet(TSetList* ps) { fSetList = ps; }
     void SetProps(TPropList* pp) { fPropList = pp; }    
     void SetCast(TCastList* cast);    
+    TSetList* GetSet() { return fSetList; }
+    TCastList* GetCast() { return fCastList; }
     void SetLights(TGraphicsLightList* lights);
     void SetDrawLights(bool dl) { fDrawLights = dl; }
     void SetLightModel(glightmodel* plm) { fLightModel = plm; }    
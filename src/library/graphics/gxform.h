@@ -0,0 +1,148 @@
+/********************************************************************/
+/* PolyWorld:  An Artificial Life Ecological Simulator              */
+/* by Larry Yaeger                                                  */
+/* Copyright Apple Computer 1990,1991,1992                          */
+/********************************************************************/
+
+// gxform.h: affine transforms for renderers that don't use the GL matrix stack
+
+#ifndef GXFORM_H
+#define GXFORM_H
+
+// System
+#include <math.h>
+#include <string.h>
+
+// Local
+#include "gcamera.h"
+#include "gobject.h"
+#include "utils/misc.h"
+
+//===========================================================================
+// gxform
+//
+// A 3x4 affine matrix. Operations post-multiply the current matrix, just
+// like the corresponding GL calls, so code that builds a GL modelview can
+// be mirrored line for line.
+//===========================================================================
+class gxform
+{
+public:
+	gxform();
+
+	void mult(const gxform& r);
+	void translate(float x, float y, float z);
+	void scale(float x, float y, float z);
+	void rotate(float deg, int axis);	// glRotatef() about x (0), y (1) or z (2)
+
+	void position(gobject* obj);		// gobject::position()
+	void inverseposition(gobject* obj);	// gobject::inverseposition()
+	void view(gcamera* camera, gobject* followObject);	// gcamera::Use()
+
+	void apply(const float* in, float* out) const;
+	void applyrotation(const float* in, float* out) const;
+	gxform inverse() const;				// assumes the rotation part is orthonormal
+
+	float m[3][4];
+};
+
+inline gxform::gxform()
+{
+	memset(m, 0, sizeof(m));
+	m[0][0] = m[1][1] = m[2][2] = 1.0f;
+}
+
+inline void gxform::mult(const gxform& r)
+{
+	gxform l = *this;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+			m[i][j] = l.m[i][0] * r.m[0][j] + l.m[i][1] * r.m[1][j] + l.m[i][2] * r.m[2][j];
+		m[i][3] += l.m[i][3];
+	}
+}
+
+inline void gxform::translate(float x, float y, float z)
+{
+	gxform t;
+	t.m[0][3] = x;
+	t.m[1][3] = y;
+	t.m[2][3] = z;
+	mult(t);
+}
+
+inline void gxform::scale(float x, float y, float z)
+{
+	gxform s;
+	s.m[0][0] = x;
+	s.m[1][1] = y;
+	s.m[2][2] = z;
+	mult(s);
+}
+
+inline void gxform::rotate(float deg, int axis)
+{
+	float c = cos(deg * DEGTORAD);
+	float s = sin(deg * DEGTORAD);
+	int a = (axis + 1) % 3;
+	int b = (axis + 2) % 3;
+	gxform r;
+	r.m[a][a] = c;
+	r.m[a][b] = -s;
+	r.m[b][a] = s;
+	r.m[b][b] = c;
+	mult(r);
+}
+
+inline void gxform::position(gobject* obj)
+{
+	translate(obj->x(), obj->y(), obj->z());
+	rotate(obj->yaw(), 1);
+	rotate(obj->pitch(), 0);
+	rotate(obj->roll(), 2);
+}
+
+inline void gxform::inverseposition(gobject* obj)
+{
+	rotate(-obj->roll(), 2);
+	rotate(-obj->pitch(), 0);
+	rotate(-obj->yaw(), 1);
+	translate(-obj->x(), -obj->y(), -obj->z());
+}
+
+inline void gxform::view(gcamera* camera, gobject* followObject)
+{
+	rotate(-camera->roll(), 2);
+	rotate(-camera->pitch(), 0);
+	rotate(-camera->yaw(), 1);
+	translate(-camera->x(), -camera->y(), -camera->z());
+	if (followObject != NULL)
+		inverseposition(followObject);
+}
+
+inline void gxform::apply(const float* in, float* out) const
+{
+	for (int i = 0; i < 3; i++)
+		out[i] = m[i][0] * in[0] + m[i][1] * in[1] + m[i][2] * in[2] + m[i][3];
+}
+
+inline void gxform::applyrotation(const float* in, float* out) const
+{
+	for (int i = 0; i < 3; i++)
+		out[i] = m[i][0] * in[0] + m[i][1] * in[1] + m[i][2] * in[2];
+}
+
+inline gxform gxform::inverse() const
+{
+	gxform inv;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+			inv.m[i][j] = m[j][i];
+		inv.m[i][3] = -(m[0][i] * m[0][3] + m[1][i] * m[1][3] + m[2][i] * m[2][3]);
+	}
+	return inv;
+}
+
+#endif
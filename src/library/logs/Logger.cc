@@ -10,7 +10,9 @@
 #include "sim/globals.h"
 #include "sim/Simulation.h"
 #include "utils/AbstractFile.h"
+#include "utils/AsyncWriter.h"
 #include "utils/datalib.h"
+#include "utils/LogContainer.h"
 #include "utils/misc.h"
 
 
@@ -29,6 +31,8 @@ using namespace std;
 Logger::Logger()
 	: _simulation( NULL )
 	, _record( false )
+	, _profileSlot( -1 )
+	, _container( NULL )
 {
 	Logs::installLogger( const_cast<Logger *>(this) );
 }
@@ -38,6 +42,12 @@ Logger::Logger()
 //---------------------------------------------------------------------------
 Logger::~Logger()
 {
+	if( _container )
+	{
+		// Its records may still be being written.
+		AsyncWriter::flush();
+		delete _container;
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -49,6 +59,10 @@ int Logger::getMaxOpenFiles()
 
 	assert( _simulation );
 
+	// The data and its index
+	if( _container )
+		return 2;
+
 	switch( _scope )
 	{
 	case AgentStateScope:
@@ -85,6 +99,29 @@ void Logger::initRecording( TSimulation *sim, StateScope scope, sim::EventType e
 	Logs::registerEvents( this, events );
 }
 
+//---------------------------------------------------------------------------
+// Logger::initContainer
+//---------------------------------------------------------------------------
+void Logger::initContainer( Document *doc, const string &path )
+{
+	if( doc->get("RecordLogContainers") )
+	{
+		_container = LogContainer::create( path,
+										   globals::recordFileType == AbstractFile::TYPE_GZIP_FILE );
+	}
+}
+
+//---------------------------------------------------------------------------
+// Logger::getRecordPath
+//---------------------------------------------------------------------------
+string Logger::getRecordPath( const string &key, const string &filePath )
+{
+	if( _container )
+		return _container->getRecordPath( key );
+	else
+		return filePath;
+}
+
 //---------------------------------------------------------------------------
 // Logger::getStep
 //---------------------------------------------------------------------------
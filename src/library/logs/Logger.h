@@ -90,9 +90,17 @@ class Logger
 	void setSimulationState( void *state );
 	void setAgentState( class agent *a, void *state );
 
+	// If RecordLogContainers is set, keeps the logger's per-agent files as
+	// records of a container at path rather than in files of their own.
+	void initContainer( proplib::Document *doc, const std::string &path );
+	// The path of key's record in the container, or else filePath.
+	std::string getRecordPath( const std::string &key, const std::string &filePath );
+
 	StateScope _scope;
 	class TSimulation *_simulation;
 	bool _record;
+	int _profileSlot;	// StepProfiler slot, if profiling
+	class LogContainer *_container;
 
  private:
 	union
@@ -2,10 +2,13 @@
 
 #include "Logs.h"
 
+#include <cxxabi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <mutex>
+#include <typeinfo>
 
 #include "agent/agent.h"
 #include "brain/Brain.h"
@@ -16,6 +19,7 @@
 #include "sim/globals.h"
 #include "sim/Simulation.h"
 #include "utils/datalib.h"
+#include "utils/LogContainer.h"
 #include "utils/misc.h"
 
 using namespace datalib;
@@ -31,7 +35,8 @@ Logs *logs = NULL;
 
 Logs::LoggerList Logs::_installedLoggers;
 sim::EventType Logs::_registeredEvents;
-Logs::EventRegistry Logs::_eventRegistry;
+Logs::LoggerVector Logs::_eventLoggers[Logs::MaxEventTypes];
+StepProfiler *Logs::_profiler = NULL;
 
 //---------------------------------------------------------------------------
 // Logs::Logs
@@ -40,6 +45,7 @@ Logs::Logs( TSimulation *sim, Document *doc )
 {
 	assert( logs == NULL );
 
+	_profiler = &sim->getProfiler();
 	_registeredEvents = 0;
 	itfor( LoggerList, _installedLoggers, it )
 	{
@@ -78,11 +84,27 @@ void Logs::registerEvents( Logger *logger, sim::EventType eventTypes )
 
 		if( eventTypes & type )
 		{
-			_eventRegistry[ type ].push_back( logger );
+			_eventLoggers[ bit ].push_back( logger );
 		}
 	}
 
 	_registeredEvents |= eventTypes;
+
+	if( _profiler->isEnabled() && eventTypes && (logger->_profileSlot < 0) )
+	{
+		// Name the logger's column after its class, e.g. Logs::PopulationLog -> Population
+		int status;
+		char *demangled = abi::__cxa_demangle( typeid(*logger).name(), NULL, NULL, &status );
+		string name = status == 0 ? demangled : typeid(*logger).name();
+		free( demangled );
+
+		if( name.compare(0, 6, "Logs::") == 0 )
+			name.erase( 0, 6 );
+		if( (name.size() > 3) && (name.compare(name.size() - 3, 3, "Log") == 0) )
+			name.erase( name.size() - 3 );
+
+		logger->_profileSlot = _profiler->addLogger( name );
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -170,6 +192,8 @@ void Logs::AgentEnergyLog::init( TSimulation *sim, Document *doc )
 					   sim::Event_AgentBirth
 					   | sim::Event_StepEnd
 					   | sim::Event_AgentDeath );
+
+		initContainer( doc, "run/energy/agents.pwlog" );
 	}
 }
 
@@ -186,7 +210,10 @@ void Logs::AgentEnergyLog::processEvent( const sim::AgentBirthEvent &e )
 			 "run/energy/agents/agent_%ld.txt",
 			 e.a->getTypeNumber() );
 
-	DataLibWriter *writer = createWriter( e.a, path, true, false );
+	DataLibWriter *writer = createWriter( e.a,
+										  getRecordPath( to_string(e.a->getTypeNumber()), path ),
+										  true,
+										  false );
 
 	static const char *colnames[] =
 		{
@@ -306,6 +333,8 @@ void Logs::AgentPositionLog::init( TSimulation *sim, Document *doc )
 					   sim::Event_AgentBirth
 					   | sim::Event_BodyUpdated
 					   | sim::Event_AgentDeath );
+
+		initContainer( doc, "run/motion/position/agents.pwlog" );
 	}
 }
 
@@ -321,12 +350,13 @@ void Logs::AgentPositionLog::processEvent( const sim::AgentBirthEvent &e )
 	sprintf( path,
 			 "run/motion/position/agents/position_%ld.txt",
 			 e.a->getTypeNumber() );
+	string recordPath = getRecordPath( to_string(e.a->getTypeNumber()), path );
 
 	switch( _mode )
 	{
 	case Precise:
 		{
-			DataLibWriter *writer = createWriter( e.a, path, true, false );
+			DataLibWriter *writer = createWriter( e.a, recordPath, true, false );
 
 			static const char *colnames[] = {"Timestep", "x", "y", "z", NULL};
 			static const datalib::Type coltypes[] = {datalib::INT, datalib::FLOAT, datalib::FLOAT, datalib::FLOAT};
@@ -338,7 +368,7 @@ void Logs::AgentPositionLog::processEvent( const sim::AgentBirthEvent &e )
 		break;
 	case Approximate:
 		{
-			DataLibWriter *writer = createWriter( e.a, path );
+			DataLibWriter *writer = createWriter( e.a, recordPath );
 
 			static const char *colnames[] = {"Timestep", "x", "z", NULL};
 			static const datalib::Type coltypes[] = {datalib::INT, datalib::FLOAT, datalib::FLOAT};
@@ -490,6 +520,8 @@ void Logs::BrainAnatomyLog::init( TSimulation *sim, Document *doc )
 						   | sim::Event_AgentGrown
 						   | sim::Event_BrainAnalysisBegin );
 		}
+
+		initContainer( doc, "run/brain/anatomy.pwlog" );
 	}
 }
 
@@ -536,10 +568,12 @@ void Logs::BrainAnatomyLog::processEvent( const EpochEndEvent &e )
 //---------------------------------------------------------------------------
 void Logs::BrainAnatomyLog::createAnatomyFile( agent *a, const char *suffix, float fitness )
 {
+	char key[64];
 	char path[256];
-	sprintf( path, "run/brain/anatomy/brainAnatomy_%ld_%s.txt", a->Number(), suffix );
+	sprintf( key, "%ld_%s", a->Number(), suffix );
+	sprintf( path, "run/brain/anatomy/brainAnatomy_%s.txt", key );
 
-	AbstractFile *file = createFile( path );
+	AbstractFile *file = createFile( getRecordPath(key, path) );
 	a->GetBrain()->dumpAnatomical( file, a->Number(), fitness );
 	delete file;
 }
@@ -553,6 +587,24 @@ void Logs::BrainAnatomyLog::recordEpochFittest( long step, sim::FitnessScope sco
 	FittestList *fittest = _simulation->getFittest( scope );
 
 	sprintf( s, "run/brain/%s/%ld", scopeName, step );
+	if( _container )
+	{
+		string view = s + strlen( "run/brain/" );
+		for( int i = 0; i < fittest->size(); i++ )
+		{
+			static const char *prefixes[] = { "incept", "birth", "death", NULL };
+
+			for( const char **prefix = prefixes; *prefix; prefix++ )
+			{
+				char key[64];
+				sprintf( key, "%ld_%s", fittest->get(i)->agentID, *prefix );
+				if( _container->exists(key) )
+					_container->addView( view, key );
+			}
+		}
+		return;
+	}
+
 	makeDirs( s );
 	for( int i = 0; i < fittest->size(); i++ )
 	{
@@ -748,6 +800,16 @@ void Logs::BrainFunctionLog::init( TSimulation *sim, Document *doc )
 		_recordBestSoFar = doc->get( "RecordBrainBestSoFar" );
 		_nseeds = doc->get( "InitAgents" );
 
+		string format = doc->get( "BrainFunctionFormat" );
+		if( format == "Text" )
+			_format = BrainFunctionFile::TEXT;
+		else if( format == "Float32" )
+			_format = BrainFunctionFile::FLOAT32;
+		else if( format == "Float16" )
+			_format = BrainFunctionFile::FLOAT16;
+		else
+			assert( false );
+
 		if( _recordBestRecent || _recordBestSoFar )
 		{
 			initRecording( sim,
@@ -767,6 +829,8 @@ void Logs::BrainFunctionLog::init( TSimulation *sim, Document *doc )
 						   | sim::Event_BrainAnalysisBegin
 						   | sim::Event_SimEnd );
 		}
+
+		initContainer( doc, "run/brain/function.pwlog" );
 	}
 }
 
@@ -780,8 +844,9 @@ void Logs::BrainFunctionLog::processEvent( const AgentGrownEvent &e )
 	char path[256];
 	sprintf( path, "run/brain/function/incomplete_brainFunction_%ld.txt", e.a->Number() );
 
-	AbstractFile *file = createFile( e.a, path );
-	e.a->GetBrain()->startFunctional( file, e.a->Number() );
+	// A record is incomplete until it's ended, so there's nothing to rename
+	AbstractFile *file = createFile( e.a, getRecordPath(to_string(e.a->Number()), path) );
+	e.a->GetBrain()->startFunctional( file, e.a->Number(), _format );
 }
 
 //---------------------------------------------------------------------------
@@ -807,6 +872,22 @@ void Logs::BrainFunctionLog::processEvent( const BrainAnalysisBeginEvent &e )
 	e.a->GetBrain()->endFunctional( file, e.a->CurrentHeuristicFitness() );
 	delete file;
 
+	if( _container )
+	{
+		string key = to_string( e.a->Number() );
+
+		// Simulation needs this path for calculating complexity.
+		e.a->brainAnalysisParms.functionPath = _container->getRecordPath( key );
+
+		if( _recordRecent )
+		{
+			_container->addView( "Recent/" + to_string(_simulation->getEpoch()), key );
+			if( e.a->Number() <= _nseeds )
+				_container->addView( "Recent/0", key );
+		}
+		return;
+	}
+
 	char s[256];
 	char t[256];
 	sprintf( s, "run/brain/function/incomplete_brainFunction_%ld.txt", e.a->Number() );
@@ -863,6 +944,14 @@ void Logs::BrainFunctionLog::recordEpochFittest( long step, sim::FitnessScope sc
 	FittestList *fittest = _simulation->getFittest( scope );
 
 	sprintf( s, "run/brain/%s/%ld", scopeName, step );
+	if( _container )
+	{
+		string view = s + strlen( "run/brain/" );
+		for( int i = 0; i < fittest->size(); i++ )
+			_container->addView( view, to_string(fittest->get(i)->agentID) );
+		return;
+	}
+
 	makeDirs( s );
 	for( int i = 0; i < fittest->size(); i++ )
 	{
@@ -1775,7 +1864,9 @@ void Logs::SeparationLog::processEvent( const sim::AgentDeathEvent &death )
 							coltypes );
 
 
-		itfor( SeparationCache::AgentEntries, entries, it )
+		vector<SeparationCache::AgentEntries::Entry> sorted;
+		entries.getSorted( sorted );
+		itfor( vector<SeparationCache::AgentEntries::Entry>, sorted, it )
 		{
 			writer->addRow( it->first, it->second );
 		}
@@ -1825,6 +1916,8 @@ void Logs::SynapseLog::init( TSimulation *sim, Document *doc )
 					   sim::Event_BrainGrown
 					   | sim::Event_AgentGrown
 					   | sim::Event_BrainAnalysisBegin );
+
+		initContainer( doc, "run/brain/synapses.pwlog" );
 	}
 }
 
@@ -1859,10 +1952,12 @@ void Logs::SynapseLog::processEvent( const BrainAnalysisBeginEvent &e )
 //---------------------------------------------------------------------------
 void Logs::SynapseLog::createSynapseFile( agent *a, const char *suffix )
 {
+	char key[64];
 	char path[256];
-	sprintf( path, "run/brain/synapses/synapses_%ld_%s.txt", a->Number(), suffix );
+	sprintf( key, "%ld_%s", a->Number(), suffix );
+	sprintf( path, "run/brain/synapses/synapses_%s.txt", key );
 
-	AbstractFile *file = createFile( path );
+	AbstractFile *file = createFile( getRecordPath(key, path) );
 	a->GetBrain()->dumpSynapses( file, a->Number() );
 	delete file;
 }
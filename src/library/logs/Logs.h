@@ -3,10 +3,12 @@
 #include <vector>
 
 #include "Logger.h"
+#include "brain/BrainFunctionFile.h"
 #include "environment/Energy.h"
 #include "proplib/cppprops.h"
 #include "utils/misc.h"
 #include "sim/simconst.h"
+#include "sim/StepProfiler.h"
 
 //===========================================================================
 // Logs
@@ -35,15 +37,20 @@ class Logs
 
  private:
 	typedef std::list<Logger *> LoggerList;
-	typedef std::map< sim::EventType, LoggerList > EventRegistry;
+	typedef std::vector<Logger *> LoggerVector;
+
+	static const int MaxEventTypes = sizeof(sim::EventType) * 8;
 
 	static LoggerList _installedLoggers;
 
 	// Bitwise OR of all registered event types.
 	static sim::EventType _registeredEvents;
 
-	// Maps from a given event type to all registered logs.
-	static EventRegistry _eventRegistry;
+	// The loggers registered for each event type, by its bit.
+	static LoggerVector _eventLoggers[MaxEventTypes];
+
+	// Times each logger's processEvent().
+	static StepProfiler *_profiler;
 
  public:
 	//---------------------------------------------------------------------------
@@ -56,17 +63,30 @@ class Logs
 	void postEvent( const T &e )
 	{
 		// Check if any loggers are registered.
-		if( _registeredEvents & e.getType() )
+		if( isListening<T>() )
 		{
 			// Send event to loggers.
-			LoggerList &loggers = _eventRegistry[ e.getType() ];
-			itfor( LoggerList, loggers, it )
+			const LoggerVector &loggers = _eventLoggers[ sim::eventIndex(T::Type) ];
+			for( size_t i = 0; i < loggers.size(); i++ )
 			{
-				(*it)->processEvent( e );
+				StepProfiler::Timer timer( *_profiler, loggers[i]->_profileSlot );
+				loggers[i]->processEvent( e );
 			}
 		}
 	}
 
+	//---------------------------------------------------------------------------
+	// Logs::isListening
+	//
+	// Whether any logger is registered for events of type T, so callers can
+	// skip building an event (e.g. AgentContactBeginEvent) no one will see.
+	//---------------------------------------------------------------------------
+	template< typename T >
+	static bool isListening()
+	{
+		return (_registeredEvents & T::Type) != 0;
+	}
+
 	int getMaxOpenFiles();
 
  private:
@@ -208,6 +228,7 @@ class Logs
 		bool _recordBestRecent;
 		bool _recordBestSoFar;
 		int _nseeds;
+		BrainFunctionFile::Format _format;
 
 	} _brainFunction;
 
@@ -2,6 +2,7 @@
 
 #include "agent/agent.h"
 #include "genome/GenomeUtil.h"
+#include "utils/CheckPoint.h"
 
 using namespace genome;
 using namespace std;
@@ -122,3 +123,50 @@ void FittestList::dump( ostream &out )
 		*/
 	}
 }
+
+//---------------------------------------------------------------------------
+// FittestList::dump
+//---------------------------------------------------------------------------
+void FittestList::dump( CheckPointWriter &out )
+{
+	out.put( (int32_t)_capacity );
+	out.put( _storeGenome );
+	out.put( (int32_t)_size );
+
+	for( int i = 0; i < _size; i++ )
+	{
+		out.put( (uint64_t)_elements[i]->agentID );
+		out.put( _elements[i]->fitness );
+		out.put( _elements[i]->complexity );
+		if( _storeGenome )
+			_elements[i]->genes->dump( out );
+	}
+}
+
+//---------------------------------------------------------------------------
+// FittestList::load
+//---------------------------------------------------------------------------
+void FittestList::load( CheckPointReader &in )
+{
+	if( (in.get<int32_t>() != _capacity) || (in.get<bool>() != _storeGenome) )
+		in.fail( "fittest list configuration mismatch" );
+
+	clear();
+
+	int size = in.get<int32_t>();
+	for( int i = 0; i < size; i++ )
+	{
+		FitStruct *element = _elements[i];
+
+		element->agentID = in.get<uint64_t>();
+		element->fitness = in.get<float>();
+		element->complexity = in.get<float>();
+		if( _storeGenome )
+		{
+			if( element->genes == NULL )
+				element->genes = GenomeUtil::createGenome();
+			element->genes->load( in );
+		}
+	}
+	_size = size;
+}
@@ -6,6 +6,9 @@
 
 #include "genome/Genome.h"
 
+class CheckPointReader;
+class CheckPointWriter;
+
 //===========================================================================
 // FitStruct
 //===========================================================================
@@ -37,6 +40,8 @@ class FittestList
 	FitStruct *get( int rank );
 
 	void dump( std::ostream &out );
+	void dump( CheckPointWriter &out );
+	void load( CheckPointReader &in );
 
  private:
 	int _capacity;
@@ -6,21 +6,30 @@
 
 using namespace std;
 
-static unsigned get_thread_count()
+static unsigned get_thread_count( unsigned nthreads )
 {
-    unsigned ncores = thread::hardware_concurrency();
-    if(ncores == 0)
+    if(nthreads == 0)
     {
-        ncores = 1;
-        cerr << "Unable to determine CPU core count via thread::hardware_concurrency(), assuming 1 core." << endl;
+        nthreads = thread::hardware_concurrency();
+        if(nthreads == 0)
+        {
+            nthreads = 1;
+            cerr << "Unable to determine CPU core count via thread::hardware_concurrency(), assuming 1 core." << endl;
+        }
     }
-    return ncores - 1; // (ncores - 1) helper threads in thread pool + 1 master thread
-                       // occupies CPU.
+    return nthreads - 1; // (nthreads - 1) helper threads in thread pool + 1 master thread
+                         // occupies CPU.
 }
 
 Scheduler::Scheduler()
-    : threadPool(get_thread_count())
+    : threadPool(get_thread_count(0))
+{
+}
+
+void Scheduler::setThreadCount( unsigned nthreads )
 {
+    assert(state == Idle);
+    threadPool.set_max_threads( get_thread_count(nthreads) );
 }
 
 void Scheduler::execMasterTask( Task masterTask,
@@ -66,6 +75,58 @@ void Scheduler::postParallel( Task task )
 	}
 }
 
+void Scheduler::postParallelFor( size_t n, IndexTask task )
+{
+	if( forceAllSerial )
+	{
+		for( size_t i = 0; i < n; i++ )
+			task( i );
+	}
+	else
+	{
+        assert(state == Master);
+        threadPool.schedule_range( n, 0, [task](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    task(i);
+                }
+            });
+	}
+}
+
+void Scheduler::execParallelFor( size_t n, IndexTask task )
+{
+	if( forceAllSerial )
+	{
+		for( size_t i = 0; i < n; i++ )
+			task( i );
+	}
+	else
+	{
+        assert(state == Master);
+        threadPool.run_range( n, 0, [task](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    task(i);
+                }
+            });
+	}
+}
+
+void Scheduler::waitParallel()
+{
+	if( !forceAllSerial )
+	{
+        assert(state == Master);
+        threadPool.join();
+	}
+}
+
+size_t Scheduler::getGrain( size_t n )
+{
+	return threadPool.default_grain( n );
+}
+
 void Scheduler::postSerial( Task task )
 {
 	if( forceAllSerial )
@@ -81,3 +142,24 @@ void Scheduler::postSerial( Task task )
 	}
 		
 }
+
+void Scheduler::setTiming( bool timing )
+{
+    threadPool.set_timing( timing );
+}
+
+vector<double> Scheduler::getBusyTimes()
+{
+    return threadPool.busy_times();
+}
+
+double Scheduler::getWaitTime()
+{
+    return threadPool.wait_time();
+}
+
+void Scheduler::resetTimes()
+{
+    assert(state == Idle);
+    threadPool.reset_times();
+}
@@ -10,14 +10,36 @@ class Scheduler
 {
  public:
     typedef std::function<void()> Task;
+    typedef std::function<void(size_t i)> IndexTask;
 
     Scheduler();
 
+	// Total number of threads for parallel tasks, including the master
+	// thread. 0 uses one per CPU core.
+	void setThreadCount( unsigned nthreads );
+
 	void execMasterTask(Task masterTask,
                         bool forceAllSerial );
 	void postParallel( Task task );
+	// Like posting task(i) for every i in [0,n), but in chunks of indices
+	// rather than one task per index.
+	void postParallelFor( size_t n, IndexTask task );
+	// Runs task(i) for every i in [0,n) in parallel and waits for them to
+	// finish, so the master task can use the results right away.
+	void execParallelFor( size_t n, IndexTask task );
+	// Waits for the parallel tasks posted so far, so the master task can use
+	// their results; it may then post more.
+	void waitParallel();
+	// How many of n indices postParallelFor() puts in each chunk.
+	size_t getGrain( size_t n );
 	void postSerial( Task task );
 
+	// Thread timing, for StepProfiler; see ThreadPool.
+	void setTiming( bool timing );
+	std::vector<double> getBusyTimes();
+	double getWaitTime();
+	void resetTimes();
+
  private:
     enum State {Idle, Master, Parallel, Serial} state = Idle;
 
@@ -32,6 +32,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -45,8 +46,11 @@
 #include "agent/AgentPovRenderer.h"
 #include "agent/Metabolism.h"
 #include "brain/Brain.h"
+#include "brain/BrainGrowthCache.h"
+#include "brain/FiringRateArena.h"
 #include "brain/groups/GroupsBrain.h"
 #include "brain/sheets/SheetsBrain.h"
+#include "complexity/ActivityStatistics.h"
 #include "complexity/complexity.h"
 #include "environment/barrier.h"
 #include "environment/brick.h"
@@ -59,9 +63,13 @@
 #include "logs/Logs.h"
 #include "proplib/proplib.h"
 #include "utils/AbstractFile.h"
+#include "utils/AsyncWriter.h"
+#include "utils/CheckPoint.h"
+#include "utils/misc.h"
 #include "utils/objectxsortedlist.h"
 #include "utils/PwMovieUtils.h"
 #include "utils/RandomNumberGenerator.h"
+#include "utils/RandomStream.h"
 #include "utils/Resources.h"
 
 
@@ -186,7 +194,7 @@ inline float AverageAngles( float a, float b )
 //---------------------------------------------------------------------------
 // TSimulation::TSimulation
 //---------------------------------------------------------------------------
-TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters )
+TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters, string restorePath )
 	:
 		fLockStepWithBirthsDeathsLog(false),
 		fLockstepFile(NULL),
@@ -241,6 +249,16 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 
     srand(1);
 
+	// ---
+	// --- Open the checkpoint being restored, before run/ (which may hold it) is moved aside
+	// ---
+	CheckPointReader *restoreFrom = NULL;
+	if( !restorePath.empty() )
+	{
+		restoreFrom = new CheckPointReader( restorePath );
+		fLoadState = true;
+	}
+
 	// ---
 	// --- Create the run directory
 	// ---
@@ -277,6 +295,11 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 		}
 
 		schema->apply( worldfile );
+
+		ostringstream out;
+		proplib::DocumentWriter writer( out );
+		writer.write( worldfile );
+		fNormalizedWorldfile = out.str();
 	}
 	processWorldFile( worldfile );
 	agent::processWorldfile( *worldfile );
@@ -370,13 +393,18 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 
 	srand48(fGenomeSeed);
 
-	agentPovRenderer = AgentPovRenderer::create( fMaxNumAgents,
+	agentPovRenderer = AgentPovRenderer::create( fPovRendererType,
+                                                 &fStage,
+                                                 fStaticTimestepGeometry,
+                                                 fMaxNumAgents,
                                                  Brain::config.retinaWidth,
                                                  Brain::config.retinaHeight );
 
 	// ---
 	// --- Init Logs
 	// ---
+	if( fLogWriterThreads > 0 )
+		AsyncWriter::start( fLogWriterThreads, fLogWriterQueueSize );
 	logs = new Logs( this, worldfile );
 
 	// ---
@@ -399,10 +427,34 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 	// ---
 	InitGround();
 
+	// ---
+	// --- Init Event Filtering
+	// ---
+	// Before a restore, which fills in the events so far.
+	if( fCalcComplexity )
+	{
+		bool eventFiltering = false;
+		for( unsigned int i = 0; i < fComplexityType.size(); i++ )
+		{
+			if( islower( fComplexityType[i] ) )
+			{
+				eventFiltering = true;
+				break;
+			}
+		}
+		if( eventFiltering )
+			fEvents = new Events( fMaxSteps );
+	}
+
 	// ---
 	// --- Init Agents, Food, Bricks, and Barriers
 	// ---
-	if (!fLoadState)
+	if( fLoadState )
+	{
+		RestoreCheckPoint( *restoreFrom );
+		delete restoreFrom;
+	}
+	else
 	{
 		// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 		// !!! EXEC MASTER
@@ -412,37 +464,23 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 
 		InitFood();
 		InitBricks();
-		InitBarriers();
 	}
+	InitBarriers();
 
 	fEatStatistics.Init();
 
-    fTotalFoodEnergyIn = fFoodEnergyIn;
-    fTotalFoodEnergyOut = fFoodEnergyOut;
-    fTotalEnergyEaten = fEnergyEaten;
-    fAverageFoodEnergyIn = 0.0;
-    fAverageFoodEnergyOut = 0.0;
-
-    fStage.SetSet(&fWorldSet);
-
-	// ---
-	// --- Init Event Filtering
-	// ---
-	if( fCalcComplexity )
+	// A restored run carries its totals over from the checkpoint
+	if( !fLoadState )
 	{
-		bool eventFiltering = false;
-		for( unsigned int i = 0; i < fComplexityType.size(); i++ )
-		{
-			if( islower( fComplexityType[i] ) )
-			{
-				eventFiltering = true;
-				break;
-			}
-		}
-		if( eventFiltering )
-			fEvents = new Events( fMaxSteps );
+		fTotalFoodEnergyIn = fFoodEnergyIn;
+		fTotalFoodEnergyOut = fFoodEnergyOut;
+		fTotalEnergyEaten = fEnergyEaten;
+		fAverageFoodEnergyIn = 0.0;
+		fAverageFoodEnergyOut = 0.0;
 	}
 
+    fStage.SetSet(&fWorldSet);
+
 	// ---
 	// --- Save worldfile data to run/ and dispose documents
 	// ---
@@ -452,8 +490,7 @@ TSimulation::TSimulation( string worldfilePath, proplib::ParameterMap parameters
 
 		{
 			ofstream out( "run/normalized.wf" );
-			proplib::DocumentWriter writer( out );
-			writer.write( worldfile );
+			out << fNormalizedWorldfile;
 		}
 
 		delete worldfile;
@@ -494,6 +531,7 @@ TSimulation::~TSimulation()
 	// --- Dispose Logs
 	// ---
 	delete logs;
+	AsyncWriter::stop();
 
 	if( fLockstepFile )
 		fclose( fLockstepFile );
@@ -564,7 +602,7 @@ void TSimulation::Step()
 	static unsigned long frame = 0;
 	double			timeNow;
 
-	if( (frame == 0) && (fSimulationSeed != 0) )
+	if( (frame == 0) && (fSimulationSeed != 0) && !fLoadState )
 	{
 		srand48(fSimulationSeed);
 	}
@@ -587,11 +625,14 @@ void TSimulation::Step()
 
 	fStep++;
 
+	fProfiler.beginStep();
+
 	debugcheck( "beginning of step %ld", fStep );
 
 	// compute some frame rates
+	// (counted in frames rather than fStep, which a restored run doesn't start at 0)
 	timeNow = hirestime();
-	if( fStep == 1 )
+	if( frame == 1 )
 	{
 		fFramesPerSecondOverall = 0.;
 		fSecondsPerFrameOverall = 0.;
@@ -606,10 +647,10 @@ void TSimulation::Step()
 	}
 	else
 	{
-		fFramesPerSecondOverall = fStep / (timeNow - fTimeStart);
+		fFramesPerSecondOverall = frame / (timeNow - fTimeStart);
 		fSecondsPerFrameOverall = 1. / fFramesPerSecondOverall;
 
-		if( fStep > RecentSteps )
+		if( frame > RecentSteps )
 		{
 			fFramesPerSecondRecent = RecentSteps / (timeNow - sTimePrevious[RecentSteps-1]);
 			fSecondsPerFrameRecent = 1. / fFramesPerSecondRecent;
@@ -618,7 +659,7 @@ void TSimulation::Step()
 		fFramesPerSecondInstantaneous = 1. / (timeNow - sTimePrevious[0]);
 		fSecondsPerFrameInstantaneous = 1. / fFramesPerSecondInstantaneous;
 
-		int numSteps = fStep < RecentSteps ? fStep : RecentSteps;
+		int numSteps = frame < RecentSteps ? frame : RecentSteps;
 		for( int i = numSteps-1; i > 0; i-- )
 			sTimePrevious[i] = sTimePrevious[i-1];
 	}
@@ -646,6 +687,15 @@ void TSimulation::Step()
 
 	// Update dynamic properties
 	proplib::CppProperties::update();
+	{
+		// They may have moved the genes' ranges, so identical genomes grown
+		// from now on needn't match the brains already grown.
+		int nprops;
+		proplib::CppProperties::PropertyMetadata *metadata;
+		proplib::CppProperties::getMetadata( &metadata, &nprops );
+		if( nprops > 0 )
+			BrainGrowthCache::clear();
+	}
 
 	// Update the barriers, since they can be dynamic
 	barrier* b;
@@ -676,8 +726,11 @@ void TSimulation::Step()
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// !!! EXEC MASTER
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-	fScheduler.execMasterTask( [=]() { Interact(); },
-							   !fParallelInteract );
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::Interact );
+		fScheduler.execMasterTask( [=]() { Interact(); },
+								   !fParallelInteract );
+	}
 
 	assert( fNumberAlive == objectxsortedlist::gXSortedObjects.getCount(AGENTTYPE) );
 
@@ -696,20 +749,29 @@ void TSimulation::Step()
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// !!! EXEC MASTER
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-	fScheduler.execMasterTask( [=]() { CreateAgents(); },
-							   !fParallelCreateAgents );
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::CreateAgents );
+		fScheduler.execMasterTask( [=]() { CreateAgents(); },
+								   !fParallelCreateAgents );
+	}
 
 	// -------------------------
 	// ---- Maintain Bricks ----
 	// -------------------------
 	// maintain bricks, which may be in dynamic patches...
-	MaintainBricks();
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::MaintainBricks );
+		MaintainBricks();
+	}
 
 	// -----------------------
 	// ---- Maintain Food ----
 	// -----------------------
 	// finally, maintain the world's food supply...
-	MaintainFood();
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::MaintainFood );
+		MaintainFood();
+	}
 
 	fTotalFoodEnergyIn += fFoodEnergyIn;
 	fTotalFoodEnergyOut += fFoodEnergyOut;
@@ -721,7 +783,10 @@ void TSimulation::Step()
 	// ---------------------------------------------------
 	// ---- Step Ending Signal (e.g. update monitors) ----
 	// ---------------------------------------------------
-    stepEnding();
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::Monitors );
+		stepEnding();
+	}
 
 	// ---------------
 	// ---- Epoch ----
@@ -736,6 +801,17 @@ void TSimulation::Step()
 	}
 
 	logs->postEvent( StepEndEvent() );
+
+	// ---------------------
+	// ---- Checkpoints ----
+	// ---------------------
+	if( fCheckPointFrequency && ((fStep % fCheckPointFrequency) == 0) )
+	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::CheckPoint );
+		SaveCheckPoint();
+	}
+
+	fProfiler.endStep( fStep );
 }
 
 //---------------------------------------------------------------------------
@@ -749,6 +825,7 @@ void TSimulation::End( const string &reason )
 		fout.close();
 	}
 	logs->postEvent( SimEndEvent() );
+	AsyncWriter::flush();
 
 	ended();
 }
@@ -845,6 +922,10 @@ void TSimulation::InitAgents()
 			c = agent::getfreeagent(this, &fStage);
 			assert(c != NULL);
 
+			// The new agent's draws come from its own streams, so they don't
+			// depend on the order agents are created in.
+			RandomStream::Scope genomeScope( c->Number(), fStep, RandomStream::GENOME );
+
 			fNumberCreated++;
 			fNumberCreatedRandom++;
 			fDomains[id].numcreated++;
@@ -873,6 +954,7 @@ void TSimulation::InitAgents()
 
 			fStage.AddObject(c);
 
+			RandomStream::Scope birthScope( c->Number(), fStep, RandomStream::BIRTH );
 			float x, z;
 			fDomains[id].initAgentsPatch->setPoint( &x, &z );
 			float y = 0.5 * agent::config.agentHeight;
@@ -925,6 +1007,8 @@ void TSimulation::InitAgents()
 
 		c = agent::getfreeagent( this, &fStage );
 
+		RandomStream::Scope genomeScope( c->Number(), fStep, RandomStream::GENOME );
+
 		fNumberCreated++;
 		fNumberCreatedRandom++;
 
@@ -952,6 +1036,7 @@ void TSimulation::InitAgents()
 
 		fStage.AddObject(c);
 
+		RandomStream::Scope birthScope( c->Number(), fStep, RandomStream::BIRTH );
 		float x =  0.01 + randpw() * (globals::worldsize - 0.02);
 		float z = -0.01 - randpw() * (globals::worldsize - 0.02);
 		float y = 0.5 * agent::config.agentHeight;
@@ -1370,6 +1455,8 @@ void TSimulation::UpdateAgents()
 #if DEBUGCHECK
 	int pass = 0;
 #endif
+	FiringRateArena::gArena.compact();
+
 	agent* a;
 	objectxsortedlist::gXSortedObjects.reset();
 	while (objectxsortedlist::gXSortedObjects.nextObj(AGENTTYPE, (gobject**)&a))
@@ -1379,13 +1466,22 @@ void TSimulation::UpdateAgents()
 		pass++;
 	#endif
 
-		a->UpdateVision();
-		a->UpdateBrain();
+		{
+			StepProfiler::Timer timer( fProfiler, StepProfiler::Vision );
+			a->UpdateVision();
+		}
+		{
+			StepProfiler::Timer timer( fProfiler, StepProfiler::Brain );
+			a->UpdateBrain();
+		}
 		if( !a->BeingCarried() )
+		{
+			StepProfiler::Timer timer( fProfiler, StepProfiler::Body );
 			fFoodEnergyOut += a->UpdateBody(fMoveFitnessParameter,
 											agent::config.speed2DPosition,
 											fSolidObjects,
 											NULL);
+		}
 	}
 }
 
@@ -1398,44 +1494,136 @@ void TSimulation::UpdateAgents_StaticTimestepGeometry()
     // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     // !!! EXEC MASTER
     // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    // If the POV renderer doesn't depend on a GL context, vision can be
+    // executed in parallel along with the brains.
+    const bool parallelVision = agentPovRenderer->isThreadSafe();
+
     fScheduler.execMasterTask([=]() {
-            fStage.Compile();
+            if( !parallelVision )
+                fStage.Compile();
             objectxsortedlist::gXSortedObjects.reset();
 
+            vector<agent *> agents;
+            agents.reserve( objectxsortedlist::gXSortedObjects.getCount(AGENTTYPE) );
+
             agent *a = NULL;
             while (objectxsortedlist::gXSortedObjects.nextObj(AGENTTYPE, (gobject**)&a))
+                agents.push_back( a );
+
+            // With batched brains, this sets the inputs (updating the
+            // networks that can't be batched) and queues the firing-rate
+            // networks, which are then updated together, block by block of
+            // the arena, and finally logged.
+            vector<char> queued( agents.size() );
+
+            auto updateBrain = [&]( size_t i ) {
+                    agent *a = agents[i];
+
+                    if( parallelVision )
+                    {
+                        StepProfiler::Timer timer( fProfiler, StepProfiler::Vision );
+                        a->UpdateVision();
+                    }
+
+                    // ---
+                    // --- Execute Neural Net
+                    // ---
+                    StepProfiler::Timer timer( fProfiler, StepProfiler::Brain );
+                    if( fBatchBrains )
+                        queued[i] = a->BeginUpdateBrain();
+                    else
+                        a->UpdateBrain();
+                };
+
+            if( parallelVision )
+            {
+                fScheduler.execParallelFor( agents.size(), updateBrain );
+            }
+            else
             {
                 // ---
                 // --- Update POV (3D rendering... expensive)
                 // ---
-                a->UpdateVision();
+                // Each chunk of brains is posted as soon as its agents'
+                // vision is rendered, so it runs while the next chunk is.
+                size_t grain = fScheduler.getGrain( agents.size() );
+                for( size_t begin = 0; begin < agents.size(); begin += grain )
+                {
+                    size_t end = min( agents.size(), begin + grain );
 
-                fScheduler.postParallel([=]() {
-                        // ---
-                        // --- Execute Neural Net
-                        // ---
-                        a->UpdateBrain();
+                    for( size_t i = begin; i < end; i++ )
+                    {
+                        StepProfiler::Timer timer( fProfiler, StepProfiler::Vision );
+                        agents[i]->UpdateVision();
+                    }
+
+                    fScheduler.postParallel( [&updateBrain, begin, end]() {
+                            for( size_t i = begin; i < end; i++ )
+                                updateBrain( i );
+                        });
+                }
+
+                fScheduler.waitParallel();
+            }
+
+            if( fBatchBrains )
+            {
+                FiringRateArena::gArena.update( fScheduler, fProfiler );
+
+                fScheduler.execParallelFor( agents.size(), [&]( size_t i ) {
+                        if( queued[i] )
+                        {
+                            StepProfiler::Timer timer( fProfiler, StepProfiler::Brain );
+                            agents[i]->EndUpdateBrain();
+                        }
                     });
             }
 
-            fStage.Decompile();
+            if( !parallelVision )
+                fStage.Decompile();
         },
         !fParallelBrains);
 
 	// ---
 	// --- Body
 	// ---
+	// The first half of each body update involves only the agent itself, so
+	// it's done in parallel. The second half resolves collisions between
+	// agents, and is done serially in list order, so the outcome (and the
+	// order in which energy is summed) doesn't depend on the thread count.
+
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    // !!! EXEC MASTER
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    fScheduler.execMasterTask([=]() {
+            objectxsortedlist::gXSortedObjects.reset();
+
+            vector<agent *> agents;
+            agents.reserve( objectxsortedlist::gXSortedObjects.getCount(AGENTTYPE) );
+
+            agent *a = NULL;
+            while (objectxsortedlist::gXSortedObjects.nextObj(AGENTTYPE, (gobject**)&a))
+                agents.push_back( a );
+
+            fScheduler.postParallelFor( agents.size(), [=]( size_t i ) {
+                    StepProfiler::Timer timer( fProfiler, StepProfiler::Body );
+                    agents[i]->BeginUpdateBody();
+                });
+        },
+        !fParallelBodies);
+
 	{
+		StepProfiler::Timer timer( fProfiler, StepProfiler::Body );
 		agent *a;
 
 		objectxsortedlist::gXSortedObjects.reset();
 		while( objectxsortedlist::gXSortedObjects.nextObj( AGENTTYPE, (gobject**)&a) )
 		{
 			if( !a->BeingCarried() )
-				fFoodEnergyOut += a->UpdateBody( fMoveFitnessParameter,
-												 agent::config.speed2DPosition,
-												 fSolidObjects,
-												 NULL );
+				fFoodEnergyOut += a->EndUpdateBody( fMoveFitnessParameter,
+													agent::config.speed2DPosition,
+													fSolidObjects,
+													NULL );
 		}
 	}
 }
@@ -1548,6 +1736,37 @@ void TSimulation::Interact()
 		}
 	}
 
+	// Find the agents each agent is in contact with up front, in parallel.
+	// That's only safe while nothing can move an agent or add one to the list
+	// during the loop below, so births must be deferred until after Interact()
+	// and agents may not be carried. The interactions themselves are still
+	// carried out serially, in list order.
+	bool precomputedContacts = fParallelContacts
+		&& fParallelInteract
+		&& !(agent::config.enableCarry && (fCarryObjects & AGENTTYPE))
+		&& (objectxsortedlist::gXSortedObjects.getSpatialIndex() != objectxsortedlist::Verify);
+	size_t contactsIndex = 0;
+
+	bool logContacts = Logs::isListening<AgentContactBeginEvent>()
+		|| Logs::isListening<AgentContactEndEvent>();
+
+	if( precomputedContacts )
+	{
+		fContactAgents.clear();
+		objectxsortedlist::gXSortedObjects.reset();
+		while( objectxsortedlist::gXSortedObjects.nextObj( AGENTTYPE, (gobject**) &c ) )
+			fContactAgents.push_back( c );
+
+		if( fAgentContacts.size() < fContactAgents.size() )
+			fAgentContacts.resize( fContactAgents.size() );
+
+		// Each chunk is a run of consecutive agents in the list, i.e. an x-strip
+		// of the world. Searches only read, so they may cross strip boundaries.
+		fScheduler.execParallelFor( fContactAgents.size(), [=]( size_t i ) {
+				FindAgentContacts( i );
+			});
+	}
+
 	// Now go through the list, and use the influence radius to determine
 	// all possible interactions
 
@@ -1564,8 +1783,32 @@ void TSimulation::Interact()
 		objectxsortedlist::gXSortedObjects.setMark( AGENTTYPE ); // so can point back to this agent later
         cDied = false;
 
+		if( objectxsortedlist::gXSortedObjects.getSpatialIndex() == objectxsortedlist::Verify )
+			VerifyAgentContacts( c );
+
+		// With precomputed contacts, the agents c touches are visited in list
+		// order, skipping any that have died since
+		vector<agent *> *contacts = NULL;
+		size_t contactsCursor = 0;
+		if( precomputedContacts )
+		{
+			while( fContactAgents[contactsIndex] != c )
+				contactsIndex++;
+			contacts = &fAgentContacts[contactsIndex];
+		}
+
+		// With the grid, only the agents near c are visited, still in list order
+		bool useGrid = !contacts && (objectxsortedlist::gXSortedObjects.getSpatialIndex() == objectxsortedlist::Grid);
+		SpatialGrid::Query query;
+		if( useGrid )
+			query = objectxsortedlist::gXSortedObjects.nearQuery( c, AGENTTYPE,
+																  c->x() - c->radius(), c->x() + c->radius(),
+																  c->z() - c->radius(), c->z() + c->radius() );
+
 		// See if there's an overlap with any other agents
-        while( objectxsortedlist::gXSortedObjects.nextObj( AGENTTYPE, (gobject**) &d ) ) // to end of list or...
+        while( contacts ? NextLiveContact( *contacts, &contactsCursor, &d )
+			   : useGrid ? objectxsortedlist::gXSortedObjects.nearObj( NEXT, query, (gobject**) &d )
+			   : objectxsortedlist::gXSortedObjects.nextObj( AGENTTYPE, (gobject**) &d ) ) // to end of list or...
         {
 			if( d == c )	// sanity check; shouldn't happen
 			{
@@ -1573,8 +1816,16 @@ void TSimulation::Interact()
 				continue;
 			}
 
+			// leave the list pointing at d, just as the scan would, for Kill() and friends
+			if( useGrid || contacts )
+				objectxsortedlist::gXSortedObjects.setcurr( d->GetListLink() );
+
             if( (d->x() - d->radius()) >= (c->x() + c->radius()) )
+			{
+				if( useGrid || contacts )
+					continue;	// the grid isn't sorted, so others may still be close enough
                 break;  // this guy (& everybody else in list) is too far away
+			}
 
             // so if we get here, then c & d are close enough in x to interact
 
@@ -1590,14 +1841,21 @@ void TSimulation::Interact()
 
 				ttPrint( "age %ld: agents # %ld & %ld are close\n", fStep, c->Number(), d->Number() );
 
-				AgentContactBeginEvent contactEvent( c, d );
+				// Filled in by Mate(), Fight() and Give(), if contacts are logged
+				AgentContactBeginEvent contactEvent;
+				AgentContactBeginEvent *contact = NULL;
+				if( logContacts )
+				{
+					contactEvent = AgentContactBeginEvent( c, d );
+					contact = &contactEvent;
 
-				logs->postEvent( contactEvent );
+					logs->postEvent( contactEvent );
+				}
 
 				// -----------------------
 				// ---- Mate (Normal) ----
 				// -----------------------
-                Mate( c, d, &contactEvent );
+                Mate( c, d, contact );
 
 				// -----------------------
 				// -------- Fight --------
@@ -1605,7 +1863,7 @@ void TSimulation::Interact()
 				bool dDied = false;
                 if (fPower2Energy > 0.0)
                 {
-					Fight( c, d, &contactEvent, &cDied, &dDied );
+					Fight( c, d, contact, &cDied, &dDied );
                 }
 
 				// -----------------------
@@ -1615,15 +1873,16 @@ void TSimulation::Interact()
 				{
 					if( !cDied && !dDied )
 					{
-						Give( c, d, &contactEvent, &cDied, true );
+						Give( c, d, contact, &cDied, true );
 						if(!cDied)
 						{
-							Give( d, c, &contactEvent, &dDied, false );
+							Give( d, c, contact, &dDied, false );
 						}
 					}
 				}
 
-				logs->postEvent( AgentContactEndEvent(contactEvent) );
+				if( contact )
+					logs->postEvent( AgentContactEndEvent(*contact) );
 
 				if( cDied )
 					break;
@@ -1678,6 +1937,104 @@ void TSimulation::Interact()
 }
 
 
+//---------------------------------------------------------------------------
+// TSimulation::FindAgentContacts
+//---------------------------------------------------------------------------
+// Find the agents after fContactAgents[i] in the list that are in contact
+// with it, in list order, just as the loop in Interact() would find them.
+// Only reads the list and grid, so it may run for many agents at once.
+void TSimulation::FindAgentContacts( size_t i )
+{
+	agent *c = fContactAgents[i];
+	vector<agent *> &contacts = fAgentContacts[i];
+	agent *d;
+
+	contacts.clear();
+
+	if( c->Age() <= 0 )
+		return;	// won't interact this step
+
+	if( objectxsortedlist::gXSortedObjects.getSpatialIndex() == objectxsortedlist::Grid )
+	{
+		SpatialGrid::Query query = objectxsortedlist::gXSortedObjects.nearQuery( c, AGENTTYPE,
+																				 c->x() - c->radius(), c->x() + c->radius(),
+																				 c->z() - c->radius(), c->z() + c->radius() );
+		while( objectxsortedlist::gXSortedObjects.nearObj( NEXT, query, (gobject**) &d ) )
+		{
+			if( (d->x() - d->radius()) >= (c->x() + c->radius()) )
+				continue;
+			if( sqrt( (d->x()-c->x())*(d->x()-c->x()) + (d->z()-c->z())*(d->z()-c->z()) ) <= (d->radius() + c->radius()) )
+				contacts.push_back( d );
+		}
+	}
+	else
+	{
+		for( size_t j = i + 1; j < fContactAgents.size(); j++ )
+		{
+			d = fContactAgents[j];
+			if( (d->x() - d->radius()) >= (c->x() + c->radius()) )
+				break;
+			if( sqrt( (d->x()-c->x())*(d->x()-c->x()) + (d->z()-c->z())*(d->z()-c->z()) ) <= (d->radius() + c->radius()) )
+				contacts.push_back( d );
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// TSimulation::NextLiveContact
+//---------------------------------------------------------------------------
+bool TSimulation::NextLiveContact( const vector<agent *> &contacts, size_t *cursor, agent **d )
+{
+	while( *cursor < contacts.size() )
+	{
+		agent *candidate = contacts[(*cursor)++];
+		if( candidate->Alive() )
+		{
+			*d = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+// TSimulation::VerifyAgentContacts
+//---------------------------------------------------------------------------
+// Check that the x-sorted list and the grid find the same agents in contact
+// with c, in the same order.  Leaves the list as it found it.
+void TSimulation::VerifyAgentContacts( agent *c )
+{
+	vector<gobject *> listContacts;
+	vector<gobject *> gridContacts;
+	agent *d;
+
+	gdlink<gobject*> *saveCurr = objectxsortedlist::gXSortedObjects.getcurr();
+	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE );
+	while( objectxsortedlist::gXSortedObjects.nextObj( AGENTTYPE, (gobject**) &d ) )
+	{
+		if( (d->x() - d->radius()) >= (c->x() + c->radius()) )
+			break;
+		if( sqrt( (d->x()-c->x())*(d->x()-c->x()) + (d->z()-c->z())*(d->z()-c->z()) ) <= (d->radius() + c->radius()) )
+			listContacts.push_back( d );
+	}
+	objectxsortedlist::gXSortedObjects.setcurr( saveCurr );
+
+	SpatialGrid::Query query = objectxsortedlist::gXSortedObjects.nearQuery( c, AGENTTYPE,
+																			 c->x() - c->radius(), c->x() + c->radius(),
+																			 c->z() - c->radius(), c->z() + c->radius() );
+	while( objectxsortedlist::gXSortedObjects.nearObj( NEXT, query, (gobject**) &d ) )
+	{
+		if( (d->x() - d->radius()) >= (c->x() + c->radius()) )
+			continue;
+		if( sqrt( (d->x()-c->x())*(d->x()-c->x()) + (d->z()-c->z())*(d->z()-c->z()) ) <= (d->radius() + c->radius()) )
+			gridContacts.push_back( d );
+	}
+
+	objectxsortedlist::gXSortedObjects.verifyNeighbors( "Interact", fStep, c, listContacts, gridContacts );
+}
+
+
 //---------------------------------------------------------------------------
 // TSimulation::DeathAndStats
 //---------------------------------------------------------------------------
@@ -1994,6 +2351,9 @@ void TSimulation::MateLockstep( void )
 
 		agent* e = agent::getfreeagent( this, &fStage );
 
+		// Keyed by the parents, so the child's genome and placement don't
+		// depend on the order births happen in.
+		RandomStream::Scope genomeScope( c->Number(), fStep, RandomStream::GENOME, d->Number() );
 		e->Genes()->crossover(c->Genes(), d->Genes(), true);
 		e->setGenomeReady();
 		e->grow( fMateWait );
@@ -2003,6 +2363,7 @@ void TSimulation::MateLockstep( void )
 		eenergy.constrain( minenergy, e->GetMaxEnergy() );
 		e->SetEnergy(eenergy);
 		e->SetFoodEnergy(eenergy);
+		RandomStream::Scope birthScope( c->Number(), fStep, RandomStream::BIRTH, d->Number() );
 		float x =  0.01 + randpw() * (globals::worldsize - 0.02);
 		float z = -0.01 - randpw() * (globals::worldsize - 0.02);
 		float y = 0.5 * agent::config.agentHeight;
@@ -2212,7 +2573,12 @@ void TSimulation::Mate( agent *c,
 
 				agent* e = agent::getfreeagent(this, &fStage);
 
-				e->Genes()->crossover(c->Genes(), d->Genes(), true);
+				// Keyed by the parents, so the child's genome and placement
+				// don't depend on the order encounters are handled in.
+				{
+					RandomStream::Scope genomeScope( c->Number(), fStep, RandomStream::GENOME, d->Number() );
+					e->Genes()->crossover(c->Genes(), d->Genes(), true);
+				}
 				e->setGenomeReady();
 
 				Energy eenergy = c->mating( fMateFitnessParameter, fMateWait, /*lockstep*/ false )
@@ -2224,6 +2590,7 @@ void TSimulation::Mate( agent *c,
 				float yaw = AverageAngles( c->yaw(), d->yaw() );
 				if( fRandomBirthLocation )
 				{
+					RandomStream::Scope birthScope( c->Number(), fStep, RandomStream::BIRTH, d->Number() );
 					float distance = globals::worldsize * fRandomBirthLocationRadius * randpw();
 					float angle = 2*M_PI * randpw();
 
@@ -2275,8 +2642,11 @@ void TSimulation::Mate( agent *c,
 		}	// steady-state GA vs. natural selection
 	}	// if agents are trying to mate
 
-	contactEvent->mate( c, cMateStatus );
-	contactEvent->mate( d, dMateStatus );
+	if( contactEvent )
+	{
+		contactEvent->mate( c, cMateStatus );
+		contactEvent->mate( d, dMateStatus );
+	}
 
 	debugcheck( "after all mating is complete" );
 }
@@ -2414,8 +2784,11 @@ void TSimulation::Fight( agent *c,
 	int cstatus = GetFightStatus( c, d, &cpower );
 	int dstatus = GetFightStatus( d, c, &dpower );
 
-	contactEvent->fight( c, cstatus );
-	contactEvent->fight( d, dstatus );
+	if( contactEvent )
+	{
+		contactEvent->fight( c, cstatus );
+		contactEvent->fight( d, dstatus );
+	}
 
 	if ( (cpower > 0.0) || (dpower > 0.0) )
 	{
@@ -2517,7 +2890,8 @@ void TSimulation::Give( agent *x,
 	Energy energy;
 	int xstatus = GetGiveStatus( x, energy );
 
-	contactEvent->give( x, xstatus );
+	if( contactEvent )
+		contactEvent->give( x, xstatus );
 
 #if DEBUGCHECK
 	unsigned long xnum = x->Number();
@@ -2555,7 +2929,6 @@ void TSimulation::Give( agent *x,
 //---------------------------------------------------------------------------
 void TSimulation::Eat( agent *c, bool *cDied )
 {
-	bool ateBackwardFood;
 	food* f = NULL;
 	bool eatAllowed = true;
 	bool eatFailedYaw = false;
@@ -2563,11 +2936,6 @@ void TSimulation::Eat( agent *c, bool *cDied )
 	bool eatFailedMinAge = false;
 	bool eatAttempted = false;
 
-	// Just to be slightly more like the old multi-x-sorted list version of the code, look backwards first
-
-	// set the list back to the agent mark, so we can look backward from that point
-	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE ); // point list back to c
-
 	if( IS_PREVENTED_BY_CARRY(Eat, c) )
 	{
 		eatAllowed = false;
@@ -2597,8 +2965,91 @@ void TSimulation::Eat( agent *c, bool *cDied )
 		eatAllowed = false;
 	}
 
+	switch( objectxsortedlist::gXSortedObjects.getSpatialIndex() )
+	{
+	case objectxsortedlist::XSortedList:
+		f = FindFood_XSortedList( c, NULL );
+		break;
+	case objectxsortedlist::Grid:
+		f = FindFood_Grid( c, NULL );
+		break;
+	case objectxsortedlist::Verify:
+		{
+			vector<gobject *> listContacts;
+			vector<gobject *> gridContacts;
+			f = FindFood_XSortedList( c, &listContacts );
+			FindFood_Grid( c, &gridContacts );
+			objectxsortedlist::gXSortedObjects.verifyNeighbors( "Eat", fStep, c, listContacts, gridContacts );
+		}
+		break;
+	default:
+		assert( false );
+	}
+
+	if( f )
+	{
+		eatAttempted = true;
+		if( eatAllowed )
+		{
+			ttPrint( "step %ld: agent # %ld is eating\n", fStep, c->Number() );
+			Energy foodEnergyLost;
+			Energy energyEatenRaw;
+			Energy energyEaten;
+			c->eat( f, fEatFitnessParameter, fEat2Consume, fEatThreshold, fStep, foodEnergyLost, energyEatenRaw, energyEaten );
+			logs->postEvent( EnergyEvent(c, f, c->Eat(), energyEaten, energyEatenRaw, EnergyEvent::Eat) );
+			if( fEvents )
+				fEvents->AddEvent( fStep, c->Number(), 'e' );
+
+			FoodEnergyOut( foodEnergyLost );
+			fEnergyEaten += energyEaten;
+
+			eatPrint( "at step %ld, agent %ld at (%g,%g) with rad=%g wasted %g units of food at (%g,%g) with rad=%g\n", fStep, c->Number(), c->x(), c->z(), c->radius(), foodEaten, f->x(), f->z(), f->radius() );
+
+			if( f->isDepleted() || fFoodRemoveFirstEat )  // all gone
+			{
+				objectxsortedlist::gXSortedObjects.setcurr( f->GetListLink() );	// RemoveFood() requires the list to point to f
+				RemoveFood( f );
+			}
+		}
+	}
+
+	if( eatAttempted )
+	{
+		fEatStatistics.AgentEatAttempt( eatAllowed, eatFailedYaw, eatFailedVel, eatFailedMinAge );
+	}
+
+	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE ); // point list back to c
+	if( !fLockStepWithBirthsDeathsLog )
+	{
+		// If we're not running in LockStep mode, allow natural deaths
+		if( c->GetEnergy().isDepleted() ||
+			((c->IsSeed() || c->Age() >= agent::config.starvationWait) && c->GetFoodEnergy().isDepleted( c->GetStarvationFoodEnergy() )) )
+		{
+			// note: this leaves list pointing to item before c, and markedAgent set to previous agent
+			Kill( c, LifeSpan::DR_EAT );
+			fNumberDiedEat++;
+			*cDied = true;
+		}
+	}
+	debugcheck( "after all agents had a chance to eat" );
+}
+
+//---------------------------------------------------------------------------
+// TSimulation::FindFood_XSortedList
+//---------------------------------------------------------------------------
+// Find the food c touches, which is the one it will eat, by scanning the
+// x-sorted list.  If contacts is given, keep scanning and collect all of them.
+food *TSimulation::FindFood_XSortedList( agent *c, vector<gobject *> *contacts )
+{
+	food *f = NULL;
+	food *found = NULL;
+
+	// Just to be slightly more like the old multi-x-sorted list version of the code, look backwards first
+
+	// set the list back to the agent mark, so we can look backward from that point
+	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE ); // point list back to c
+
 	// look for food in the -x direction
-	ateBackwardFood = false;
 #if CompatibilityMode
 	// go backwards in the list until we reach a place where even the largest possible piece of food
 	// would entirely precede our agent, and no smaller piece of food sorting after it, but failing
@@ -2624,38 +3075,21 @@ void TSimulation::Eat( agent *c, bool *cDied )
 			// time to check for overlap in z
 			if( fabs( f->z() - c->z() ) < ( f->radius() + c->radius() ) )
 			{
-				eatAttempted = true;
-				if( !eatAllowed )
-					break;
 				// also overlap in z, so they really interact
-				ttPrint( "step %ld: agent # %ld is eating\n", fStep, c->Number() );
-				Energy foodEnergyLost;
-				Energy energyEatenRaw;
-				Energy energyEaten;
-				c->eat( f, fEatFitnessParameter, fEat2Consume, fEatThreshold, fStep, foodEnergyLost, energyEatenRaw, energyEaten );
-				logs->postEvent( EnergyEvent(c, f, c->Eat(), energyEaten, energyEatenRaw, EnergyEvent::Eat) );
-				if( fEvents )
-					fEvents->AddEvent( fStep, c->Number(), 'e' );
-
-				FoodEnergyOut( foodEnergyLost );
-				fEnergyEaten += energyEaten;
-
-				eatPrint( "at step %ld, agent %ld at (%g,%g) with rad=%g wasted %g units of food at (%g,%g) with rad=%g\n", fStep, c->Number(), c->x(), c->z(), c->radius(), foodEaten, f->x(), f->z(), f->radius() );
-
-				if( f->isDepleted() || fFoodRemoveFirstEat )  // all gone
-				{
-					RemoveFood( f );
-				}
-
-				// but this guy only gets to eat from one food source
-				ateBackwardFood = true;
-				break;  // so get out of the backward food while loop
+				if( !found )
+					found = f;
+				if( !contacts )
+					break;  // this guy only gets to eat from one food source
+				contacts->push_back( f );
 			}
 		}
 	}	// backward while loop on food
+
+	if( contacts )
+		reverse( contacts->begin(), contacts->end() );	// back into list order
 #endif // CompatibilityMode
 
-	if( !ateBackwardFood && !eatAttempted )
+	if( !found || contacts )
 	{
 	#if ! CompatibilityMode
 		// set the list back to the agent mark, so we can look forward from that point
@@ -2682,55 +3116,86 @@ void TSimulation::Eat( agent *c, bool *cDied )
 				if( fabs( f->z() - c->z() ) < (f->radius() + c->radius()) )
 	#endif
 				{
-					eatAttempted = true;
-					if( !eatAllowed )
-						break;
 					// also overlap in z, so they really interact
-					ttPrint( "step %ld: agent # %ld is eating\n", fStep, c->Number() );
-					Energy foodEnergyLost;
-					Energy energyEatenRaw;
-					Energy energyEaten;
-					c->eat( f, fEatFitnessParameter, fEat2Consume, fEatThreshold, fStep, foodEnergyLost, energyEatenRaw, energyEaten );
-					logs->postEvent( EnergyEvent(c, f, c->Eat(), energyEaten, energyEatenRaw, EnergyEvent::Eat) );
-					if( fEvents )
-						fEvents->AddEvent( fStep, c->Number(), 'e' );
+					if( !found )
+						found = f;
+					if( !contacts )
+						break;  // this guy only gets to eat from one food source
+					contacts->push_back( f );
+				}
+			}
+		} // forward while loop on food
+	}
 
-					FoodEnergyOut( foodEnergyLost );
-					fEnergyEaten += energyEaten;
+	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE ); // point list back to c
 
-					eatPrint( "at step %ld, agent %ld at (%g,%g) with rad=%g wasted %g units of food at (%g,%g) with rad=%g\n", fStep, c->Number(), c->x(), c->z(), c->radius(), foodEaten, f->x(), f->z(), f->radius() );
+	return found;
+}
 
-					if( f->isDepleted() || fFoodRemoveFirstEat )  // all gone
-					{
-						RemoveFood( f );
-					}
+//---------------------------------------------------------------------------
+// TSimulation::FindFood_Grid
+//---------------------------------------------------------------------------
+// Same as FindFood_XSortedList(), but only visits the food near c.
+food *TSimulation::FindFood_Grid( agent *c, vector<gobject *> *contacts )
+{
+	food *f = NULL;
+	food *found = NULL;
+	SpatialGrid::Query query = objectxsortedlist::gXSortedObjects.nearQuery( c, FOODTYPE,
+																			 c->x() - c->radius(), c->x() + c->radius(),
+																			 c->z() - c->radius(), c->z() + c->radius() );
 
-					// but this guy only gets to eat from one food source
-					break;  // so get out of the forward food while loop
-				}
-			}
-		} // forward while loop on food
-	} // if( !ateBackwardFood )
+#if CompatibilityMode
+	// the list is scanned forward from food that is entirely before c, so the first touching food in list order wins
+	query.order = -numeric_limits<double>::infinity();
+	while( objectxsortedlist::gXSortedObjects.nearObj( NEXT, query, (gobject**) &f ) )
+	{
+		if( ((f->x() - f->radius()) <= (c->x() + c->radius())) &&
+			((f->x() + f->radius()) > (c->x() - c->radius())) &&
+			(fabs( f->z() - c->z() ) < (f->radius() + c->radius())) )
+		{
+			if( !found )
+				found = f;
+			if( !contacts )
+				break;
+			contacts->push_back( f );
+		}
+	}
+#else // CompatibilityMode
+	double cOrder = query.order;
 
-	if( eatAttempted )
+	// backward first, nearest to c in list order
+	while( objectxsortedlist::gXSortedObjects.nearObj( PREV, query, (gobject**) &f ) )
 	{
-		fEatStatistics.AgentEatAttempt( eatAllowed, eatFailedYaw, eatFailedVel, eatFailedMinAge );
+		if( ((f->x() + f->radius()) >= (c->x() - c->radius())) &&
+			(fabs( f->z() - c->z() ) < (f->radius() + c->radius())) )
+		{
+			if( !found )
+				found = f;
+			if( !contacts )
+				break;
+			contacts->insert( contacts->begin(), f );
+		}
 	}
 
-	objectxsortedlist::gXSortedObjects.toMark( AGENTTYPE ); // point list back to c
-	if( !fLockStepWithBirthsDeathsLog )
+	if( !found || contacts )
 	{
-		// If we're not running in LockStep mode, allow natural deaths
-		if( c->GetEnergy().isDepleted() ||
-			((c->IsSeed() || c->Age() >= agent::config.starvationWait) && c->GetFoodEnergy().isDepleted( c->GetStarvationFoodEnergy() )) )
+		query.order = cOrder;
+		while( objectxsortedlist::gXSortedObjects.nearObj( NEXT, query, (gobject**) &f ) )
 		{
-			// note: this leaves list pointing to item before c, and markedAgent set to previous agent
-			Kill( c, LifeSpan::DR_EAT );
-			fNumberDiedEat++;
-			*cDied = true;
+			if( ((f->x() - f->radius()) <= (c->x() + c->radius())) &&
+				(fabs( f->z() - c->z() ) < (f->radius() + c->radius())) )
+			{
+				if( !found )
+					found = f;
+				if( !contacts )
+					break;
+				contacts->push_back( f );
+			}
 		}
 	}
-	debugcheck( "after all agents had a chance to eat" );
+#endif // CompatibilityMode
+
+	return found;
 }
 
 //---------------------------------------------------------------------------
@@ -2961,6 +3426,10 @@ void TSimulation::CreateAgents( void )
                 fDomains[id].lastcreate = fStep;
                 agent* newAgent = agent::getfreeagent(this, &fStage);
 
+				// The new agent's draws come from its own streams, so they don't
+				// depend on the order agents are created in.
+				RandomStream::Scope genomeScope( newAgent->Number(), fStep, RandomStream::GENOME );
+
                 if ( fDomains[id].fittest && fDomains[id].fittest->isFull() )
                 {
                     // the list exists and is full
@@ -3023,6 +3492,7 @@ void TSimulation::CreateAgents( void )
                         newAgent->grow( fMateWait );
                     });
 
+				RandomStream::Scope birthScope( newAgent->Number(), fStep, RandomStream::BIRTH );
 				float x = randpw() * (fDomains[id].absoluteSizeX - 0.02) + fDomains[id].startX + 0.01;
 				float z = randpw() * (fDomains[id].absoluteSizeZ - 0.02) + fDomains[id].startZ + 0.01;
 				float y = 0.5 * agent::config.agentHeight;
@@ -3069,6 +3539,8 @@ void TSimulation::CreateAgents( void )
 
             agent* newAgent = agent::getfreeagent(this, &fStage);
 
+			RandomStream::Scope genomeScope( newAgent->Number(), fStep, RandomStream::GENOME );
+
             if( fFittest && fFittest->isFull() )
             {
                 if( fFitness1Frequency
@@ -3121,6 +3593,7 @@ void TSimulation::CreateAgents( void )
             newAgent->grow( fMateWait );
 			FoodEnergyIn( newAgent->GetFoodEnergy() );
 
+			RandomStream::Scope birthScope( newAgent->Number(), fStep, RandomStream::BIRTH );
             newAgent->settranslation(randpw() * globals::worldsize, 0.5 * agent::config.agentHeight, randpw() * -globals::worldsize);
             newAgent->setyaw(randpw() * 360.0);
             id = WhichDomain(newAgent->x(), newAgent->z(), 0);
@@ -3604,9 +4077,27 @@ void TSimulation::Kill( agent* c,
 //---------------------------------------------------------------------------
 void TSimulation::analyzeBrain( agent *c )
 {
+	RandomStream::Scope randomScope( c->Number(), fStep, RandomStream::BRAIN_ANALYSIS );
+
 	logs->postEvent( BrainAnalysisBeginEvent(c) );
 
-	if ( fCalcComplexity )
+	if( fCalcComplexity && c->GetBrain()->getActivityStatistics() )
+	{
+		// The brain kept what's needed while it lived, so there's no file to read.
+		ActivityStatistics *statistics = c->GetBrain()->getActivityStatistics();
+
+		if( fComplexityType == "D" )	// special case the difference of complexities case
+		{
+			float pComplexity = statistics->calcComplexity( "P" );
+			float iComplexity = statistics->calcComplexity( "I" );
+			c->SetComplexity( pComplexity - iComplexity );
+		}
+		else if( fComplexityType != "Z" )	// avoid special hack case to evolve towards zero max velocity, for testing purposes only
+		{
+			c->SetComplexity( statistics->calcComplexity( fComplexityType.c_str(), fEvents ) );
+		}
+	}
+	else if ( fCalcComplexity )
 	{
 		// This should have been configured in response to the begin event.
 		const char *brainFunctionPath = c->brainAnalysisParms.functionPath.c_str();
@@ -3789,8 +4280,8 @@ float TSimulation::AgentFitness( agent* c )
 		if( c->Complexity() < 0.0 )
 		{
 			fprintf( stderr, "********** complexity being calculated when it should already be known **********\n" );
-			char filename[256];
-			sprintf( filename, "run/brain/function/brainFunction_%ld.txt", c->Number() );
+			string path = get_brainfunction_path( "run", c->Number() );
+			const char *filename = path.c_str();
 			if( fComplexityType == "D" )	// difference between I and P complexity being used for fitness
 			{
 				float pComplexity = CalcComplexity_brainfunction( filename, "P" );
@@ -3822,7 +4313,10 @@ void TSimulation::processWorldFile( proplib::Document *docWorldFile )
 	fAdaptivityMode = doc.get( "AdaptivityMode" );
 	fMaxSteps = doc.get( "MaxSteps" );
 	fEndOnPopulationCrash = doc.get( "EndOnPopulationCrash" );
-	fDumpFrequency = doc.get( "CheckPointFrequency" );
+	fCheckPointFrequency = doc.get( "CheckPointFrequency" );
+	fCheckPointCompress = doc.get( "CheckPointCompress" );
+	fLogWriterThreads = doc.get( "LogWriterThreads" );
+	fLogWriterQueueSize = doc.get( "LogWriterQueueSize" );
 	{
 		string prop = doc.get( "Edges" );
 		if( prop == "B" )
@@ -3862,8 +4356,37 @@ void TSimulation::processWorldFile( proplib::Document *docWorldFile )
 	}
 	fParallelInitAgents = doc.get( "ParallelInitAgents" );
 	fParallelInteract = doc.get( "ParallelInteract" );
+	fParallelContacts = doc.get( "ParallelContacts" );
 	fParallelCreateAgents = doc.get( "ParallelCreateAgents" );
 	fParallelBrains = doc.get( "ParallelBrains" );
+	fBatchBrains = doc.get( "BatchBrains" );
+	fParallelBodies = doc.get( "ParallelBodies" );
+	fScheduler.setThreadCount( (int)doc.get("NumThreads") );
+	fProfiler.init( &fScheduler, (long)doc.get("StepProfileFrequency") );
+	{
+		string val = doc.get( "PovRenderer" );
+		if( val == "OpenGL" )
+			fPovRendererType = AgentPovRenderer::OpenGL;
+		else if( val == "Software" )
+			fPovRendererType = AgentPovRenderer::Software;
+		else if( val == "RayCast" )
+			fPovRendererType = AgentPovRenderer::RayCast;
+		else
+			assert( false );
+	}
+	{
+		objectxsortedlist::SpatialIndex spatialIndex = objectxsortedlist::XSortedList;
+		string val = doc.get( "SpatialIndex" );
+		if( val == "XSortedList" )
+			spatialIndex = objectxsortedlist::XSortedList;
+		else if( val == "Grid" )
+			spatialIndex = objectxsortedlist::Grid;
+		else if( val == "Verify" )
+			spatialIndex = objectxsortedlist::Verify;
+		else
+			assert( false );
+		objectxsortedlist::gXSortedObjects.setSpatialIndex( spatialIndex, (float)doc.get("SpatialIndexCellSize") );
+	}
 	fMinNumAgents = doc.get( "MinAgents" );
 	fMaxNumAgents = doc.get( "MaxAgents" );
 	fInitNumAgents = doc.get( "InitAgents" );
@@ -3892,6 +4415,9 @@ void TSimulation::processWorldFile( proplib::Document *docWorldFile )
     fPositionSeed = doc.get( "PositionSeed" );
     fGenomeSeed = doc.get( "InitSeed" );
 	fSimulationSeed = doc.get( "SimulationSeed" );
+	// Replicates usually differ only in InitSeed, so both seeds key the streams.
+	RandomStream::setSeed( ((uint64_t)(uint32_t)fGenomeSeed << 32) | (uint32_t)fSimulationSeed );
+	RandomStream::setEnabled( doc.get("RandomStreams") );
 	{
 		proplib::Property &rfood = doc.get( "AgentsAreFood" );
 		if( (string)rfood == "Fight" )
@@ -4542,6 +5068,44 @@ void TSimulation::processWorldFile( proplib::Document *docWorldFile )
 	fComplexityFitnessWeight = doc.get( "ComplexityFitnessWeight" );
 	if( fComplexityFitnessWeight )
 		fCalcComplexity = true;
+	{
+		string val = doc.get( "ComplexitySource" );
+		if( val == "File" )
+			Brain::config.activityStatistics = Brain::Configuration::STATISTICS_NONE;
+		else if( val == "Streaming" )
+			Brain::config.activityStatistics = (bool)doc.get( "ComplexityGaussianize" )
+				? Brain::Configuration::STATISTICS_WINDOW
+				: Brain::Configuration::STATISTICS_COVARIANCE;
+		else
+			assert( false );
+
+		if( !fCalcComplexity )
+			Brain::config.activityStatistics = Brain::Configuration::STATISTICS_NONE;
+
+		if( Brain::config.activityStatistics == Brain::Configuration::STATISTICS_COVARIANCE )
+		{
+			for( unsigned int i = 0; i < fComplexityType.size(); i++ )
+			{
+				if( islower( fComplexityType[i] ) )
+				{
+					cerr << "ComplexityType " << fComplexityType << " filters events, which requires ComplexityGaussianize with ComplexitySource Streaming." << endl;
+					exit( 1 );
+				}
+			}
+		}
+	}
+	{
+		string val = doc.get( "ComplexityEngine" );
+		if( val == "Fast" )
+			setFastComplexity( true );
+		else if( val == "Reference" )
+			setFastComplexity( false );
+		else
+			assert( false );
+
+		// Brains are already analyzed in parallel, one per thread.
+		setComplexityThreads( 1 );
+	}
 	fHeuristicFitnessWeight = doc.get( "HeuristicFitnessWeight" );
 
 	fTournamentSize = doc.get( "TournamentSize" );
@@ -4719,81 +5283,623 @@ void TSimulation::initAdaptivityMode()
 }
 
 //---------------------------------------------------------------------------
-// TSimulation::Dump
+// TSimulation::SaveCheckPoint
+//
+// Writes the state of the world at the end of the current step to
+// run/checkpoints/step_<N>.pwc (gzipped if so configured), so a restored run
+// goes on to the same worlds, and the same checkpoints, as an uninterrupted
+// one (make checkpointcheck tests this). Objects are saved in x-sorted list
+// order, so the restored list (and everything that iterates it) matches the
+// saved one exactly.
+//
+// Not saved, so a resumed run differs from an uninterrupted one in these:
+//  - the logs, which start over in the new run/ directory, with the restored
+//    agents logged as born at the restore;
+//  - the 'state' structs and 'stage' of dynamic properties, which live in
+//    the generated properties library (their values are saved);
+//  - complexity computed from brainFunction logs, which needs the logs of
+//    agents born before the checkpoint (use ComplexitySource Streaming).
 //---------------------------------------------------------------------------
-void TSimulation::Dump()
+void TSimulation::SaveCheckPoint()
 {
-    filebuf fb;
-    if (fb.open("pw.dump", ios_base::out) == 0)
-    {
-        error(1, "Unable to dump state to \"pw.dump\" file");
-        return;
-    }
+	// So the logs on disk are as of the checkpoint
+	AsyncWriter::flush();
 
-    ostream out(&fb);
-    char version[16];
-    sprintf(version, "%s", "pw1");
-
-    out << version nl;
-    out << fStep nl;
-    out << fNumberCreated nl;
-    out << fNumberCreatedRandom nl;
-    out << fNumberCreated1Fit nl;
-    out << fNumberCreated2Fit nl;
-    out << fNumberDied nl;
-    out << fNumberDiedAge nl;
-    out << fNumberDiedEnergy nl;
-    out << fNumberDiedFight nl;
-    out << fNumberDiedEdge nl;
-	out << fNumberDiedSmite nl;
-    out << fNumberBorn nl;
-	out << fNumberBornVirtual nl;
-    out << fNumberFights nl;
-    out << fMiscDenials nl;
-    out << fLastCreated nl;
-    out << fMaxGapCreate nl;
-    out << fNumBornSinceCreated nl;
-    out << fMaxFitness nl;
-    out << fAverageFitness nl;
-    out << fAverageFoodEnergyIn nl;
-    out << fAverageFoodEnergyOut nl;
-    out << fTotalFoodEnergyIn nl;
-    out << fTotalFoodEnergyOut nl;
-
-    agent::agentdump(out);
-
-    out << objectxsortedlist::gXSortedObjects.getCount(FOODTYPE) nl;
-	food* f = NULL;
-	objectxsortedlist::gXSortedObjects.reset();
-	while (objectxsortedlist::gXSortedObjects.nextObj(FOODTYPE, (gobject**)&f))
-		f->dump(out);
+	makeDirs( "run/checkpoints" );
+
+	char path[256];
+	sprintf( path, "run/checkpoints/step_%ld.pwc", fStep );
+
+	CheckPointWriter out( path, fCheckPointCompress );
+
+	// ---
+	// --- Worldfile, for a sanity check on restore
+	// ---
+	out.beginSection( "WRLD" );
+	out.putString( fNormalizedWorldfile );
+	out.endSection();
 
-    out << fFitI nl;
-    out << fFitJ nl;
+	// ---
+	// --- Simulation counters and stats
+	// ---
+	out.beginSection( "SIM " );
+	out.put( (int64_t)fStep );
+	out.put( (int64_t)fEpoch );
+	out.put( (int64_t)fNumberBorn );
+	out.put( (int64_t)fNumberBornVirtual );
+	out.put( (int64_t)fNumberDied );
+	out.put( (int64_t)fNumberDiedAge );
+	out.put( (int64_t)fNumberDiedEnergy );
+	out.put( (int64_t)fNumberDiedFight );
+	out.put( (int64_t)fNumberDiedEat );
+	out.put( (int64_t)fNumberDiedEdge );
+	out.put( (int64_t)fNumberDiedSmite );
+	out.put( (int64_t)fNumberDiedPatch );
+	out.put( (int64_t)fNumberCreated );
+	out.put( (int64_t)fNumberCreatedRandom );
+	out.put( (int64_t)fNumberCreated1Fit );
+	out.put( (int64_t)fNumberCreated2Fit );
+	out.put( (int64_t)fNumberFights );
+	out.put( (int64_t)fBirthDenials );
+	out.put( (int64_t)fMiscDenials );
+	out.put( (int64_t)fLastCreated );
+	out.put( (int64_t)fMaxGapCreate );
+	out.put( (int64_t)fNumBornSinceCreated );
+	out.put( fMaxFitness );
+	out.put( fAverageFitness );
+	out.put( (uint64_t)fNumAverageFitness );
+	out.put( fPrevAvgFitness );
+	out.put( fFitI );
+	out.put( fFitJ );
+	out.put( fTotalFoodEnergyIn );
+	out.put( fTotalFoodEnergyOut );
+	out.put( fAverageFoodEnergyIn );
+	out.put( fAverageFoodEnergyOut );
+	out.put( fTotalEnergyEaten );
+	out.put( fGlobalEnergyScaleFactor );
+	out.put( fPopulationPenaltyFraction );
+	fLifeSpanStats.dump( out );
+	fLifeSpanRecentStats.dump( out );
+	fLifeFractionRecentStats.dump( out );
+	out.endSection();
+
+	// ---
+	// --- Domains and their patches
+	// ---
+	out.beginSection( "DOMS" );
+	out.put( (int32_t)fNumDomains );
+	for( int id = 0; id < fNumDomains; id++ )
+	{
+		Domain &d = fDomains[id];
+
+		out.put( (int64_t)d.numAgents );
+		out.put( (int64_t)d.numcreated );
+		out.put( (int64_t)d.numborn );
+		out.put( (int64_t)d.numbornsincecreated );
+		out.put( (int64_t)d.numdied );
+		out.put( (int64_t)d.lastcreate );
+		out.put( (int64_t)d.maxgapcreate );
+		out.put( d.ifit );
+		out.put( d.jfit );
+		out.put( (int32_t)d.foodCount );
+		out.put( (int32_t)d.numFoodPatchesGrown );
+		out.put( d.energyScaleFactor );
+
+		out.put( d.fittest != NULL );
+		if( d.fittest )
+			d.fittest->dump( out );
+
+		out.put( (int32_t)d.numFoodPatches );
+		for( int i = 0; i < d.numFoodPatches; i++ )
+			d.fFoodPatches[i].dump( out );
+
+		out.put( (int32_t)d.numBrickPatches );
+		for( int i = 0; i < d.numBrickPatches; i++ )
+			d.fBrickPatches[i].dump( out );
+	}
+	out.endSection();
+
+	// ---
+	// --- Fittest lists
+	// ---
+	out.beginSection( "FITS" );
+	out.put( fFittest != NULL );
 	if( fFittest )
 		fFittest->dump( out );
-	if( fRecentFittest)
+	out.put( fRecentFittest != NULL );
+	if( fRecentFittest )
 		fRecentFittest->dump( out );
+	out.endSection();
 
-    out << fNumDomains nl;
-    for (int id = 0; id < fNumDomains; id++)
-    {
-        out << fDomains[id].numAgents nl;
-        out << fDomains[id].numcreated nl;
-        out << fDomains[id].numborn nl;
-        out << fDomains[id].numbornsincecreated nl;
-        out << fDomains[id].numdied nl;
-        out << fDomains[id].lastcreate nl;
-        out << fDomains[id].maxgapcreate nl;
-        out << fDomains[id].ifit nl;
-        out << fDomains[id].jfit nl;
-
-        if (fDomains[id].fittest)
-			fDomains[id].fittest->dump( out );
-    }
+	// ---
+	// --- Agents, food and bricks, one section each
+	// ---
+	map<gobject *, int32_t> indexes;
+	vector<gobject *> carriers;
+	{
+		gobject *obj;
+		objectxsortedlist::gXSortedObjects.reset();
+		while( objectxsortedlist::gXSortedObjects.nextObj(AGENTTYPE | FOODTYPE | BRICKTYPE, &obj) )
+		{
+			int32_t index = (int32_t)indexes.size();
+			indexes[obj] = index;
+			if( obj->NumCarries() > 0 )
+				carriers.push_back( obj );
+
+			switch( obj->getType() )
+			{
+			case AGENTTYPE:
+				out.beginSection( "AGNT" );
+				((agent *)obj)->dump( out );
+				out.endSection();
+				break;
+			case FOODTYPE:
+				{
+					food *f = (food *)obj;
+					FoodPatch *fp = f->getPatch();
+
+					out.beginSection( "FOOD" );
+					out.put( (int32_t)(fp ? fp->domainNumberOfParent : -1) );
+					out.put( (int32_t)(fp ? fp - fDomains[fp->domainNumberOfParent].fFoodPatches : -1) );
+					f->dump( out );
+					out.endSection();
+				}
+				break;
+			case BRICKTYPE:
+				{
+					brick *b = (brick *)obj;
+					BrickPatch *bp = b->myBrickPatch;
+
+					out.beginSection( "BRCK" );
+					out.put( (int32_t)(bp ? bp->domainNumberOfParent : -1) );
+					out.put( (int32_t)(bp ? bp - fDomains[bp->domainNumberOfParent].fBrickPatches : -1) );
+					b->dump( out );
+					out.endSection();
+				}
+				break;
+			default:
+				assert( false );
+			}
+		}
+	}
+
+	// ---
+	// --- Who is carrying what, by object index
+	// ---
+	out.beginSection( "CARY" );
+	out.put( (int32_t)carriers.size() );
+	for( gobject *carrier : carriers )
+	{
+		out.put( indexes[carrier] );
+		out.put( (int32_t)carrier->fCarries.size() );
+		for( gobject *carried : carrier->fCarries )
+			out.put( indexes[carried] );
+	}
+	out.endSection();
+
+	// ---
+	// --- Food age order (food::gAllFood), by object index
+	// ---
+	out.beginSection( "FDAG" );
+	out.put( (int32_t)food::gAllFood.size() );
+	for( food *f : food::gAllFood )
+		out.put( indexes[f] );
+	out.endSection();
+
+	// ---
+	// --- Class-wide counters
+	// ---
+	out.beginSection( "CLAS" );
+	agent::agentdump( out );
+	food::fooddump( out );
+	brick::brickdump( out );
+	out.endSection();
+
+	// ---
+	// --- Barriers, in worldfile order
+	// ---
+	out.beginSection( "BARR" );
+	out.put( (int32_t)barrier::gBarriers.size() );
+	for( barrier *b : barrier::gBarriers )
+		b->dump( out );
+	out.endSection();
+
+	// ---
+	// --- Dynamic property values, by name
+	// ---
+	out.beginSection( "DYNP" );
+	{
+		int nprops;
+		proplib::CppProperties::PropertyMetadata *metadata;
+		proplib::CppProperties::getMetadata( &metadata, &nprops );
+
+		int32_t ndynamic = 0;
+		for( int i = 0; i < nprops; i++ )
+			if( metadata[i].type == proplib::CppProperties::PropertyMetadata::Dynamic )
+				ndynamic++;
+
+		out.put( ndynamic );
+		for( int i = 0; i < nprops; i++ )
+		{
+			proplib::CppProperties::PropertyMetadata &prop = metadata[i];
+			if( prop.type != proplib::CppProperties::PropertyMetadata::Dynamic )
+				continue;
+
+			out.putString( prop.name );
+			out.put( (int32_t)prop.valueType );
+			switch( prop.valueType )
+			{
+			case datalib::INT:
+				out.put( (int32_t)*((int *)prop.value) );
+				break;
+			case datalib::FLOAT:
+				out.put( *((float *)prop.value) );
+				break;
+			case datalib::BOOL:
+				out.put( *((bool *)prop.value) );
+				break;
+			case datalib::STRING:
+				out.putString( *((string *)prop.value) );
+				break;
+			default:
+				assert( false );
+			}
+		}
+	}
+	out.endSection();
+
+	// ---
+	// --- Position in LOCKSTEP-BirthsDeaths.log
+	// ---
+	out.beginSection( "LOCK" );
+	out.put( fLockStepWithBirthsDeathsLog );
+	if( fLockStepWithBirthsDeathsLog )
+	{
+		out.put( (int64_t)ftell(fLockstepFile) );
+		out.put( (int32_t)fLockstepTimestep );
+		out.put( (int32_t)fLockstepNumDeathsAtTimestep );
+		out.put( (int32_t)fLockstepNumBirthsAtTimestep );
+	}
+	out.endSection();
+
+	// ---
+	// --- Eat and mate events back to the birth of the oldest living agent,
+	// --- which is as far back as event-filtered complexity looks
+	// ---
+	if( fEvents )
+	{
+		long firstStep = fStep;
+		{
+			agent *c;
+			objectxsortedlist::gXSortedObjects.reset();
+			while( objectxsortedlist::gXSortedObjects.nextObj(AGENTTYPE, (gobject **)&c) )
+				firstStep = min( firstStep, c->GetLifeSpan()->birth.step );
+		}
+
+		out.beginSection( "EVNT" );
+		out.put( (int64_t)firstStep );
+		out.put( (int64_t)fStep );
+		for( long step = firstStep; step <= fStep; step++ )
+		{
+			AgentEventsMapType events = fEvents->GetAgentEventsMap( step );
+			out.put( (int32_t)events.size() );
+			for( auto &entry : events )
+			{
+				out.put( (int64_t)entry.first );
+				out.put( (bool)entry.second.eat );
+				out.put( (bool)entry.second.mate );
+			}
+		}
+		out.endSection();
+	}
+
+	// ---
+	// --- Global random number state
+	// ---
+	out.beginSection( "RNG " );
+	{
+		GlobalRandomState state;
+		getGlobalRandomState( &state );
+		out.put( state );
+	}
+	out.endSection();
+
+	out.close();
+}
+
+//---------------------------------------------------------------------------
+// TSimulation::RestoreCheckPoint
+//
+// Called from the constructor in place of InitAgents(), InitFood() and
+// InitBricks(), with the worldfile already processed and the logs open.
+//---------------------------------------------------------------------------
+void TSimulation::RestoreCheckPoint( CheckPointReader &in )
+{
+	vector<gobject *> objects;
+	string tag;
+
+	while( in.nextSection(tag) )
+	{
+		if( tag == "WRLD" )
+		{
+			if( in.getString() != fNormalizedWorldfile )
+				cerr << "Warning: restoring " << in.getPath() << " with a worldfile that differs from the one it was saved with" << endl;
+		}
+		else if( tag == "SIM " )
+		{
+			fStep = in.get<int64_t>();
+			fEpoch = in.get<int64_t>();
+			fNumberBorn = in.get<int64_t>();
+			fNumberBornVirtual = in.get<int64_t>();
+			fNumberDied = in.get<int64_t>();
+			fNumberDiedAge = in.get<int64_t>();
+			fNumberDiedEnergy = in.get<int64_t>();
+			fNumberDiedFight = in.get<int64_t>();
+			fNumberDiedEat = in.get<int64_t>();
+			fNumberDiedEdge = in.get<int64_t>();
+			fNumberDiedSmite = in.get<int64_t>();
+			fNumberDiedPatch = in.get<int64_t>();
+			fNumberCreated = in.get<int64_t>();
+			fNumberCreatedRandom = in.get<int64_t>();
+			fNumberCreated1Fit = in.get<int64_t>();
+			fNumberCreated2Fit = in.get<int64_t>();
+			fNumberFights = in.get<int64_t>();
+			fBirthDenials = in.get<int64_t>();
+			fMiscDenials = in.get<int64_t>();
+			fLastCreated = in.get<int64_t>();
+			fMaxGapCreate = in.get<int64_t>();
+			fNumBornSinceCreated = in.get<int64_t>();
+			in.get( fMaxFitness );
+			in.get( fAverageFitness );
+			fNumAverageFitness = in.get<uint64_t>();
+			in.get( fPrevAvgFitness );
+			in.get( fFitI );
+			in.get( fFitJ );
+			in.get( fTotalFoodEnergyIn );
+			in.get( fTotalFoodEnergyOut );
+			in.get( fAverageFoodEnergyIn );
+			in.get( fAverageFoodEnergyOut );
+			in.get( fTotalEnergyEaten );
+			in.get( fGlobalEnergyScaleFactor );
+			in.get( fPopulationPenaltyFraction );
+			fLifeSpanStats.load( in );
+			fLifeSpanRecentStats.load( in );
+			fLifeFractionRecentStats.load( in );
+		}
+		else if( tag == "DOMS" )
+		{
+			if( in.get<int32_t>() != fNumDomains )
+				in.fail( "number of domains differs from worldfile" );
+
+			for( int id = 0; id < fNumDomains; id++ )
+			{
+				Domain &d = fDomains[id];
+
+				d.numAgents = in.get<int64_t>();
+				d.numcreated = in.get<int64_t>();
+				d.numborn = in.get<int64_t>();
+				d.numbornsincecreated = in.get<int64_t>();
+				d.numdied = in.get<int64_t>();
+				d.lastcreate = in.get<int64_t>();
+				d.maxgapcreate = in.get<int64_t>();
+				in.get( d.ifit );
+				in.get( d.jfit );
+				d.foodCount = in.get<int32_t>();
+				d.numFoodPatchesGrown = in.get<int32_t>();
+				in.get( d.energyScaleFactor );
+
+				if( in.get<bool>() != (d.fittest != NULL) )
+					in.fail( "domain fittest list differs from worldfile" );
+				if( d.fittest )
+					d.fittest->load( in );
+
+				if( in.get<int32_t>() != d.numFoodPatches )
+					in.fail( "number of food patches differs from worldfile" );
+				for( int i = 0; i < d.numFoodPatches; i++ )
+					d.fFoodPatches[i].load( in );
+
+				if( in.get<int32_t>() != d.numBrickPatches )
+					in.fail( "number of brick patches differs from worldfile" );
+				for( int i = 0; i < d.numBrickPatches; i++ )
+					d.fBrickPatches[i].load( in );
+			}
+		}
+		else if( tag == "FITS" )
+		{
+			if( in.get<bool>() != (fFittest != NULL) )
+				in.fail( "fittest list differs from worldfile" );
+			if( fFittest )
+				fFittest->load( in );
+			if( in.get<bool>() != (fRecentFittest != NULL) )
+				in.fail( "recent fittest list differs from worldfile" );
+			if( fRecentFittest )
+				fRecentFittest->load( in );
+		}
+		else if( tag == "AGNT" )
+		{
+			agent *c = agent::getfreeagent( this, &fStage );
+			c->load( in, fMateWait );
+
+			fStage.AddObject( c );
+			objectxsortedlist::gXSortedObjects.addLast( c );
+			objects.push_back( c );
+
+			// Birth() stamps the LifeSpan with the current step; keep the real one.
+			LifeSpan lifeSpan = *c->GetLifeSpan();
+			Birth( c, LifeSpan::BR_SIMINIT );
+			*c->GetLifeSpan() = lifeSpan;
+		}
+		else if( tag == "FOOD" )
+		{
+			int32_t domainNumber = in.get<int32_t>();
+			int32_t patchNumber = in.get<int32_t>();
+			if( (domainNumber >= fNumDomains)
+				|| ((domainNumber >= 0) && (patchNumber >= fDomains[domainNumber].numFoodPatches)) )
+			{
+				in.fail( "food patch out of range" );
+			}
+
+			food *f = new food( in );
+			f->setPatch( domainNumber < 0 ? NULL : &fDomains[domainNumber].fFoodPatches[patchNumber] );
+
+			fStage.AddObject( f );
+			objectxsortedlist::gXSortedObjects.addLast( f );
+			objects.push_back( f );
+		}
+		else if( tag == "BRCK" )
+		{
+			int32_t domainNumber = in.get<int32_t>();
+			int32_t patchNumber = in.get<int32_t>();
+			if( (domainNumber >= fNumDomains)
+				|| ((domainNumber >= 0) && (patchNumber >= fDomains[domainNumber].numBrickPatches)) )
+			{
+				in.fail( "brick patch out of range" );
+			}
+
+			brick *b = new brick( in );
+			b->setPatch( domainNumber < 0 ? NULL : &fDomains[domainNumber].fBrickPatches[patchNumber] );
+
+			fStage.AddObject( b );
+			objectxsortedlist::gXSortedObjects.addLast( b );
+			objects.push_back( b );
+		}
+		else if( tag == "CARY" )
+		{
+			auto getObject = [&in, &objects]()
+				{
+					uint32_t index = in.get<int32_t>();
+					if( index >= objects.size() )
+						in.fail( "object index out of range" );
+					return objects[index];
+				};
+
+			int32_t ncarriers = in.get<int32_t>();
+			for( int i = 0; i < ncarriers; i++ )
+			{
+				gobject *carrier = getObject();
+				int32_t ncarried = in.get<int32_t>();
+				for( int j = 0; j < ncarried; j++ )
+				{
+					gobject *carried = getObject();
+					carrier->fCarries.push_back( carried );
+					carried->RestoreCarriedBy( carrier );
+				}
+			}
+		}
+		else if( tag == "FDAG" )
+		{
+			int32_t nfood = in.get<int32_t>();
+			if( (size_t)nfood != food::gAllFood.size() )
+				in.fail( "food count mismatch" );
+			for( int i = 0; i < nfood; i++ )
+			{
+				uint32_t index = in.get<int32_t>();
+				if( (index >= objects.size()) || (objects[index]->getType() != FOODTYPE) )
+					in.fail( "food index out of range" );
+				((food *)objects[index])->moveToEndOfAllFood();
+			}
+		}
+		else if( tag == "CLAS" )
+		{
+			agent::agentload( in );
+			food::foodload( in );
+			brick::brickload( in );
+		}
+		else if( tag == "BARR" )
+		{
+			if( (size_t)in.get<int32_t>() != barrier::gBarriers.size() )
+				in.fail( "number of barriers differs from worldfile" );
+			for( barrier *b : barrier::gBarriers )
+				b->load( in );
+		}
+		else if( tag == "DYNP" )
+		{
+			int nprops;
+			proplib::CppProperties::PropertyMetadata *metadata;
+			proplib::CppProperties::getMetadata( &metadata, &nprops );
+
+			map<string, proplib::CppProperties::PropertyMetadata *> dynamicProperties;
+			for( int i = 0; i < nprops; i++ )
+				if( metadata[i].type == proplib::CppProperties::PropertyMetadata::Dynamic )
+					dynamicProperties[metadata[i].name] = &metadata[i];
+
+			int32_t ndynamic = in.get<int32_t>();
+			if( (size_t)ndynamic != dynamicProperties.size() )
+				in.fail( "number of dynamic properties differs from worldfile" );
+
+			for( int i = 0; i < ndynamic; i++ )
+			{
+				string name = in.getString();
+				if( dynamicProperties.count(name) == 0 )
+					in.fail( "dynamic property " + name + " not in worldfile" );
+
+				proplib::CppProperties::PropertyMetadata *prop = dynamicProperties[name];
+				if( in.get<int32_t>() != (int32_t)prop->valueType )
+					in.fail( "dynamic property " + name + " type differs from worldfile" );
+
+				switch( prop->valueType )
+				{
+				case datalib::INT:
+					*((int *)prop->value) = in.get<int32_t>();
+					break;
+				case datalib::FLOAT:
+					in.get( *((float *)prop->value) );
+					break;
+				case datalib::BOOL:
+					in.get( *((bool *)prop->value) );
+					break;
+				case datalib::STRING:
+					*((string *)prop->value) = in.getString();
+					break;
+				default:
+					assert( false );
+				}
+			}
+		}
+		else if( tag == "LOCK" )
+		{
+			if( in.get<bool>() != fLockStepWithBirthsDeathsLog )
+				in.fail( "lockstep mode differs from worldfile" );
+			if( fLockStepWithBirthsDeathsLog )
+			{
+				fseek( fLockstepFile, (long)in.get<int64_t>(), SEEK_SET );
+				fLockstepTimestep = in.get<int32_t>();
+				fLockstepNumDeathsAtTimestep = in.get<int32_t>();
+				fLockstepNumBirthsAtTimestep = in.get<int32_t>();
+			}
+		}
+		else if( tag == "EVNT" )
+		{
+			// Without event filtering in this run there's nothing to put them in.
+			if( fEvents )
+			{
+				long firstStep = in.get<int64_t>();
+				long lastStep = in.get<int64_t>();
+				if( (firstStep < 0) || (lastStep > fMaxSteps) )
+					in.fail( "event steps beyond MaxSteps" );
+
+				for( long step = firstStep; step <= lastStep; step++ )
+				{
+					int32_t nevents = in.get<int32_t>();
+					for( int i = 0; i < nevents; i++ )
+					{
+						long agentNumber = in.get<int64_t>();
+						if( in.get<bool>() )
+							fEvents->AddEvent( step, agentNumber, 'e' );
+						if( in.get<bool>() )
+							fEvents->AddEvent( step, agentNumber, 'm' );
+					}
+				}
+			}
+		}
+		else if( tag == "RNG " )
+		{
+			setGlobalRandomState( in.get<GlobalRandomState>() );
+		}
+		// Sections from newer builds that this one doesn't know about are skipped.
+	}
 
-    out.flush();
-    fb.close();
+	cout << "Restored " << in.getPath() << " at step " << fStep << endl;
 }
 
 
@@ -5174,6 +6280,8 @@ void TSimulation::getStatusText( StatusText& statusText,
 			 fFramesPerSecondOverall,       fSecondsPerFrameOverall  );
 	statusText.push_back( strdup( t ) );
 
+	fProfiler.getStatusText( statusText );
+
 	if( fCalcFoodPatchAgentCounts )
 	{
 		int numAgentsInAnyFoodPatchInAnyDomain = 0;
@@ -5,6 +5,7 @@
 #endif
 
 #include <string>
+#include <vector>
 
 // Local
 #include "Domain.h"
@@ -14,6 +15,8 @@
 #include "Scheduler.h"
 #include "simconst.h"
 #include "simtypes.h"
+#include "StepProfiler.h"
+#include "agent/AgentPovRenderer.h"
 #include "agent/LifeSpan.h"
 #include "environment/Energy.h"
 #include "genome/SeparationCache.h"
@@ -29,6 +32,7 @@
 using namespace sim;
 
 // Forward declarations
+class CheckPointReader;
 namespace proplib { class Document; }
 
 
@@ -41,7 +45,7 @@ class TSimulation
 	PROPLIB_CPP_PROPERTIES
 
 public:
-	TSimulation( std::string worldfilePath, proplib::ParameterMap parameters );
+	TSimulation( std::string worldfilePath, proplib::ParameterMap parameters, std::string restorePath = "" );
 	virtual ~TSimulation();
 
 	void Step();
@@ -55,6 +59,7 @@ public:
 
 	class AgentPovRenderer *GetAgentPovRenderer();
 	gstage &getStage();
+	StepProfiler &getProfiler();
 
 	bool isLockstep() const;
 	long GetMaxAgents() const;
@@ -170,6 +175,11 @@ private:
 	void UpdateAgents_StaticTimestepGeometry();
 
 	void Interact();
+	void FindAgentContacts( size_t i );
+	bool NextLiveContact( const std::vector<agent *> &contacts,
+						  size_t *cursor,
+						  agent **d );
+	void VerifyAgentContacts( agent *c );
 	void DeathAndStats();
 	void MateLockstep();
 	int GetMatePotential( agent *x );
@@ -200,6 +210,10 @@ private:
 			   bool toMarkOnDeath );
 	void Eat( agent *c,
 			  bool *cDied );
+	class food *FindFood_XSortedList( agent *c,
+									  std::vector<gobject *> *contacts );
+	class food *FindFood_Grid( agent *c,
+							   std::vector<gobject *> *contacts );
 	void Carry( agent *c );
 	void Pickup( agent *c );
 	void Drop( agent *c );
@@ -238,14 +252,20 @@ private:
 	void initFitnessMode();
 	void initAdaptivityMode();
 
-	void Dump();
+	void SaveCheckPoint();
+	void RestoreCheckPoint( CheckPointReader &in );
 
 	Scheduler fScheduler;
+	StepProfiler fProfiler;
 
 	long fMaxSteps;
 	bool fEndOnPopulationCrash;
-	int fDumpFrequency;
+	long fCheckPointFrequency;
+	bool fCheckPointCompress;
+	int fLogWriterThreads;
+	int fLogWriterQueueSize;
 	bool fLoadState;
+	std::string fNormalizedWorldfile;
 
 	gstage fStage;
 	TCastList fWorldCast;
@@ -441,19 +461,29 @@ private:
 	bool fStaticTimestepGeometry;
 	bool fParallelInitAgents;
 	bool fParallelInteract;
+	bool fParallelContacts;
 	bool fParallelCreateAgents;
 	bool fParallelBrains;
+	bool fBatchBrains;
+	bool fParallelBodies;
+	AgentPovRenderer::Type fPovRendererType;
 
     gpolyobj fGround;
     TSetList fWorldSet;
 
 	class AgentPovRenderer *agentPovRenderer;
+
+	// Agents in list order, and the contacts of each, found at the start of
+	// Interact() (see FindAgentContacts())
+	std::vector<agent *> fContactAgents;
+	std::vector< std::vector<agent *> > fAgentContacts;
 };
 
 inline void TSimulation::enableComplexityCalculations() { fCalcComplexity = true; }
 
 inline class AgentPovRenderer *TSimulation::GetAgentPovRenderer() { return agentPovRenderer; }
 inline gstage &TSimulation::getStage() { return fStage; }
+inline StepProfiler &TSimulation::getProfiler() { return fProfiler; }
 
 
 inline bool TSimulation::isLockstep() const { return fLockStepWithBirthsDeathsLog; }
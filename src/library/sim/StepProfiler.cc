@@ -0,0 +1,250 @@
+#include "StepProfiler.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Scheduler.h"
+#include "utils/datalib.h"
+#include "utils/misc.h"
+
+using namespace datalib;
+using namespace std;
+
+#define PROFILE_PATH "run/stats/profile.txt"
+
+static const char *PhaseNames[] =
+	{
+		"Vision",
+		"Brain",
+		"Body",
+		"Interact",
+		"CreateAgents",
+		"MaintainBricks",
+		"MaintainFood",
+		"Monitors",
+		"CheckPoint"
+	};
+
+
+//---------------------------------------------------------------------------
+// StepProfiler::getName
+//---------------------------------------------------------------------------
+const char *StepProfiler::getName( Phase phase )
+{
+	assert( phase >= 0 && phase < __NPHASES );
+
+	return PhaseNames[phase];
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::StepProfiler
+//---------------------------------------------------------------------------
+StepProfiler::StepProfiler()
+: fEnabled( false )
+, fFrequency( 0 )
+, fScheduler( NULL )
+, fWriter( NULL )
+, fCounters( __NPHASES )
+{
+	fInterval.steps = 0;
+	fRecent.step = 0.0;
+	fTotal.steps = 0;
+	fTotal.step = 0.0;
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::~StepProfiler
+//---------------------------------------------------------------------------
+StepProfiler::~StepProfiler()
+{
+	delete fWriter;
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::init
+//---------------------------------------------------------------------------
+void StepProfiler::init( Scheduler *scheduler, long frequency )
+{
+	fScheduler = scheduler;
+	fFrequency = frequency;
+	fEnabled = frequency > 0;
+
+	fScheduler->setTiming( fEnabled );
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::addLogger
+//---------------------------------------------------------------------------
+int StepProfiler::addLogger( const string &name )
+{
+	assert( fWriter == NULL );
+
+	fLoggerNames.push_back( name );
+	fCounters.push_back( Counter() );
+
+	return (int)fCounters.size() - 1;
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::getSlotName
+//---------------------------------------------------------------------------
+string StepProfiler::getSlotName( int slot )
+{
+	if( slot < __NPHASES )
+		return getName( (Phase)slot );
+	else
+		return "Log" + fLoggerNames[slot - __NPHASES];
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::beginStep
+//
+// Anything timed between steps (e.g. SimInited logging) is discarded.
+//---------------------------------------------------------------------------
+void StepProfiler::beginStep()
+{
+	if( !fEnabled )
+		return;
+
+	for( Counter &counter : fCounters )
+		counter.nanos = 0;
+	fScheduler->resetTimes();
+
+	fStepStart = Clock::now();
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::endStep
+//---------------------------------------------------------------------------
+void StepProfiler::endStep( long step )
+{
+	if( !fEnabled )
+		return;
+
+	double stepTime = chrono::duration<double>( Clock::now() - fStepStart ).count();
+
+	vector<double> busy = fScheduler->getBusyTimes();
+
+	if( fInterval.steps == 0 )
+	{
+		fInterval.step = 0.0;
+		fInterval.slots.assign( fCounters.size(), 0.0 );
+		fInterval.threads.assign( busy.size() + 1, 0.0 );
+	}
+
+	fTotal.slots.resize( fCounters.size(), 0.0 );
+
+	fInterval.steps++;
+	fInterval.step += stepTime;
+	fTotal.steps++;
+	fTotal.step += stepTime;
+	for( size_t i = 0; i < fCounters.size(); i++ )
+	{
+		double t = fCounters[i].nanos * 1e-9;
+		fInterval.slots[i] += t;
+		fTotal.slots[i] += t;
+	}
+	// The master thread is busy except while it waits on the helpers.
+	fInterval.threads[0] += stepTime - fScheduler->getWaitTime();
+	for( size_t i = 0; i < busy.size(); i++ )
+		fInterval.threads[i + 1] += busy[i];
+
+	if( (step % fFrequency) == 0 )
+	{
+		double n = fInterval.steps;
+
+		fRecent.step = fInterval.step / n;
+		fRecent.slots.resize( fInterval.slots.size() );
+		for( size_t i = 0; i < fInterval.slots.size(); i++ )
+			fRecent.slots[i] = fInterval.slots[i] / n;
+		fRecent.threads.resize( fInterval.threads.size() );
+		for( size_t i = 0; i < fInterval.threads.size(); i++ )
+			fRecent.threads[i] = fInterval.threads[i] / n;
+
+		writeRow( step );
+
+		fInterval.steps = 0;
+	}
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::writeRow
+//
+// Times are in milliseconds per step. The table is begun on the first row,
+// once all the loggers have been added.
+//---------------------------------------------------------------------------
+void StepProfiler::writeRow( long step )
+{
+	if( fWriter == NULL )
+	{
+		makeDirs( "run/stats" );
+		fWriter = new DataLibWriter( PROFILE_PATH );
+
+		vector<string> colnames;
+		vector<Type> coltypes;
+
+		colnames.push_back( "Timestep" );
+		coltypes.push_back( INT );
+		colnames.push_back( "Step" );
+		coltypes.push_back( FLOAT );
+		for( int i = 0; i < getNumSlots(); i++ )
+		{
+			colnames.push_back( getSlotName(i) );
+			coltypes.push_back( FLOAT );
+		}
+		for( size_t i = 0; i < fRecent.threads.size(); i++ )
+		{
+			char name[32];
+			sprintf( name, "Thread%luBusy", (unsigned long)i );
+			colnames.push_back( name );
+			coltypes.push_back( FLOAT );
+		}
+
+		fWriter->beginTable( "StepProfile", colnames, coltypes );
+	}
+
+	vector<Variant> coldata;
+	coldata.push_back( (int)step );
+	coldata.push_back( float(fRecent.step * 1000.0) );
+	for( double t : fRecent.slots )
+		coldata.push_back( float(t * 1000.0) );
+	for( double t : fRecent.threads )
+		coldata.push_back( float(t * 1000.0) );
+
+	fWriter->addRow( coldata.data() );
+	fWriter->flush();
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::getStatusText
+//---------------------------------------------------------------------------
+void StepProfiler::getStatusText( sim::StatusText &statusText )
+{
+	if( !fEnabled || fRecent.slots.empty() )
+		return;
+
+	char t[256];
+
+	sprintf( t, "Profile (ms/step) %.1f", fRecent.step * 1000.0 );
+	statusText.push_back( strdup(t) );
+
+	for( int i = 0; i < __NPHASES; i++ )
+	{
+		sprintf( t, " -%-14s %6.2f", getName((Phase)i), fRecent.slots[i] * 1000.0 );
+		statusText.push_back( strdup(t) );
+	}
+
+	double loggers = 0.0;
+	for( size_t i = __NPHASES; i < fRecent.slots.size(); i++ )
+		loggers += fRecent.slots[i];
+	sprintf( t, " -%-14s %6.2f", "Logs", loggers * 1000.0 );
+	statusText.push_back( strdup(t) );
+
+	double busy = 0.0;
+	for( double b : fRecent.threads )
+		busy += b;
+	sprintf( t, " -ThreadsBusy    %5.1f%%",
+			 fRecent.step > 0.0 ? 100.0 * busy / (fRecent.step * fRecent.threads.size()) : 0.0 );
+	statusText.push_back( strdup(t) );
+}
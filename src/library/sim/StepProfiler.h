@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "simtypes.h"
+
+class DataLibWriter;
+class Scheduler;
+
+//===========================================================================
+// StepProfiler
+//
+// Times the phases of TSimulation::Step(), each logger's event processing
+// and the scheduler's threads, and writes the averages per step to
+// run/stats/profile.txt every so many steps. Phase and logger times are
+// summed over all the threads that did the work, so a phase run in
+// parallel can exceed the step's wall-clock time. Logger times overlap the
+// phases that posted the events.
+//
+// When disabled, a Timer costs a single test.
+//===========================================================================
+class StepProfiler
+{
+ public:
+	enum Phase
+	{
+		Vision,
+		Brain,
+		Body,
+		Interact,
+		CreateAgents,
+		MaintainBricks,
+		MaintainFood,
+		Monitors,
+		CheckPoint,
+		__NPHASES
+	};
+
+	static const char *getName( Phase phase );
+
+	StepProfiler();
+	~StepProfiler();
+
+	// frequency is the number of steps averaged in each row of the table; 0
+	// disables profiling.
+	void init( Scheduler *scheduler, long frequency );
+	bool isEnabled() { return fEnabled; }
+
+	// Returns the slot to time the logger's processEvent() in. Must be called
+	// before the first step.
+	int addLogger( const std::string &name );
+
+	void beginStep();
+	void endStep( long step );
+
+	void getStatusText( sim::StatusText &statusText );
+
+	// Slots are the phases followed by the loggers.
+	int getNumSlots() { return (int)fCounters.size(); }
+	std::string getSlotName( int slot );
+
+	// Totals over every step profiled so far, in seconds.
+	long getTotalSteps() { return fTotal.steps; }
+	double getTotalStepTime() { return fTotal.step; }
+	double getTotalTime( int slot ) { return slot < (int)fTotal.slots.size() ? fTotal.slots[slot] : 0.0; }
+
+	//---------------------------------------------------------------------------
+	// StepProfiler::Timer
+	//
+	// Adds the time until it goes out of scope to a phase or logger slot. May
+	// be used from any thread.
+	//---------------------------------------------------------------------------
+	class Timer
+	{
+	 public:
+		Timer( StepProfiler &profiler, int slot );
+		~Timer();
+
+	 private:
+		StepProfiler &fProfiler;
+		int fSlot;
+		std::chrono::steady_clock::time_point fStart;
+	};
+
+ private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Counter
+	{
+		Counter() : nanos(0) {}
+		Counter( const Counter &other ) : nanos(other.nanos.load()) {}
+
+		std::atomic<uint64_t> nanos;
+	};
+
+	void writeRow( long step );
+
+	bool fEnabled;
+	long fFrequency;
+	Scheduler *fScheduler;
+	DataLibWriter *fWriter;
+
+	std::vector<std::string> fLoggerNames;
+	std::vector<Counter> fCounters;	// phases, then loggers
+
+	Clock::time_point fStepStart;
+
+	// Sums over the steps since the last row, in seconds.
+	struct Interval
+	{
+		long steps;
+		double step;
+		std::vector<double> slots;
+		std::vector<double> threads;	// master first
+	} fInterval;
+
+	// Sums over all steps, in seconds.
+	struct Total
+	{
+		long steps;
+		double step;
+		std::vector<double> slots;
+	} fTotal;
+
+	// Per-step averages over the last complete interval, in seconds.
+	struct Recent
+	{
+		double step;
+		std::vector<double> slots;
+		std::vector<double> threads;
+	} fRecent;
+};
+
+//---------------------------------------------------------------------------
+// StepProfiler::Timer::Timer
+//---------------------------------------------------------------------------
+inline StepProfiler::Timer::Timer( StepProfiler &profiler, int slot )
+: fProfiler( profiler )
+, fSlot( slot )
+{
+	if( fProfiler.fEnabled )
+		fStart = Clock::now();
+}
+
+//---------------------------------------------------------------------------
+// StepProfiler::Timer::~Timer
+//---------------------------------------------------------------------------
+inline StepProfiler::Timer::~Timer()
+{
+	if( fProfiler.fEnabled )
+		fProfiler.fCounters[fSlot].nanos +=
+			std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - fStart ).count();
+}
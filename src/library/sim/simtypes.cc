@@ -2,6 +2,7 @@
 
 #include "simconst.h"
 #include "agent/agent.h"
+#include "utils/CheckPoint.h"
 
 using namespace sim;
 
@@ -47,3 +48,58 @@ void AgentContactEndEvent::AgentInfo::init( const AgentContactBeginEvent::AgentI
 	fight = begin.fight;
 	give = begin.give;
 }
+
+
+//===========================================================================
+// Stat
+//===========================================================================
+void Stat::dump( CheckPointWriter &out )
+{
+	out.put( mn );
+	out.put( mx );
+	out.put( sum );
+	out.put( sum2 );
+	out.put( count );
+}
+
+void Stat::load( CheckPointReader &in )
+{
+	in.get( mn );
+	in.get( mx );
+	in.get( sum );
+	in.get( sum2 );
+	in.get( count );
+}
+
+
+//===========================================================================
+// StatRecent
+//===========================================================================
+void StatRecent::dump( CheckPointWriter &out )
+{
+	out.put( mn );
+	out.put( mx );
+	out.put( sum );
+	out.put( sum2 );
+	out.put( count );
+	out.put( w );
+	out.putArray( history, w );
+	out.put( index );
+	out.put( needMin );
+	out.put( needMax );
+}
+
+void StatRecent::load( CheckPointReader &in )
+{
+	in.get( mn );
+	in.get( mx );
+	in.get( sum );
+	in.get( sum2 );
+	in.get( count );
+	if( in.get<unsigned int>() != w )
+		in.fail( "statistics window mismatch" );
+	in.getArray( history, w );
+	in.get( index );
+	in.get( needMin );
+	in.get( needMax );
+}
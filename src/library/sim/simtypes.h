@@ -14,6 +14,8 @@
 // Forward declarations
 namespace genome { class Genome; }
 class agent;
+class CheckPointReader;
+class CheckPointWriter;
 class gobject;
 
 
@@ -42,12 +44,16 @@ namespace sim
 	static const EventType Event_EpochEnd = (1 << 15);
 	static const EventType Event_SimEnd = (1 << 16);
 
+	// The bit of type, e.g. 4 for Event_BrainUpdated.
+	constexpr int eventIndex( EventType type ) { return type == 1 ? 0 : 1 + eventIndex( type >> 1 ); }
+
 	//===========================================================================
 	// SimInitedEvent
 	//===========================================================================
 	struct SimInitedEvent
 	{
-		inline EventType getType() const { return Event_SimInited; }
+		static const EventType Type = Event_SimInited;
+		inline EventType getType() const { return Type; }
 	};
 
 	//===========================================================================
@@ -55,7 +61,8 @@ namespace sim
 	//===========================================================================
 	struct AgentBirthEvent
 	{
-		inline EventType getType() const { return Event_AgentBirth; }
+		static const EventType Type = Event_AgentBirth;
+		inline EventType getType() const { return Type; }
 
 		AgentBirthEvent( agent *_a,
 						 LifeSpan::BirthReason _reason,
@@ -78,7 +85,8 @@ namespace sim
 	//===========================================================================
 	struct BrainGrownEvent
 	{
-		inline EventType getType() const { return Event_BrainGrown; }
+		static const EventType Type = Event_BrainGrown;
+		inline EventType getType() const { return Type; }
 
 		BrainGrownEvent( agent *_a )
 		: a(_a)
@@ -92,7 +100,8 @@ namespace sim
 	//===========================================================================
 	struct AgentGrownEvent
 	{
-		inline EventType getType() const { return Event_AgentGrown; }
+		static const EventType Type = Event_AgentGrown;
+		inline EventType getType() const { return Type; }
 
 		AgentGrownEvent( agent *_a )
 		: a(_a)
@@ -106,7 +115,8 @@ namespace sim
 	//===========================================================================
 	struct AgentBodyUpdatedEvent
 	{
-		inline EventType getType() const { return Event_BodyUpdated; }
+		static const EventType Type = Event_BodyUpdated;
+		inline EventType getType() const { return Type; }
 
 		AgentBodyUpdatedEvent( agent *_a,
 							   float _energyUsed,
@@ -126,7 +136,8 @@ namespace sim
 	//===========================================================================
 	struct BrainUpdatedEvent
 	{
-		inline EventType getType() const { return Event_BrainUpdated; }
+		static const EventType Type = Event_BrainUpdated;
+		inline EventType getType() const { return Type; }
 
 		BrainUpdatedEvent( agent *_a ) : a(_a) {}
 
@@ -138,8 +149,10 @@ namespace sim
 	//===========================================================================
 	struct AgentContactBeginEvent
 	{
-		inline EventType getType() const { return Event_ContactBegin; }
+		static const EventType Type = Event_ContactBegin;
+		inline EventType getType() const { return Type; }
 
+		AgentContactBeginEvent() {}
 		AgentContactBeginEvent( agent *_c, agent *_d );
 
 		struct AgentInfo
@@ -165,7 +178,8 @@ namespace sim
 	//===========================================================================
 	struct AgentContactEndEvent
 	{
-		inline EventType getType() const { return Event_ContactEnd; }
+		static const EventType Type = Event_ContactEnd;
+		inline EventType getType() const { return Type; }
 
 		AgentContactEndEvent( const AgentContactBeginEvent &e );
 
@@ -185,7 +199,8 @@ namespace sim
 	//===========================================================================
 	struct CollisionEvent
 	{
-		inline EventType getType() const { return Event_Collision; }
+		static const EventType Type = Event_Collision;
+		inline EventType getType() const { return Type; }
 
 		CollisionEvent( agent *_a, ObjectType _ot ) : a(_a), ot(_ot) {}
 
@@ -198,7 +213,8 @@ namespace sim
 	//===========================================================================
 	struct CarryEvent
 	{
-		inline EventType getType() const { return Event_Carry; }
+		static const EventType Type = Event_Carry;
+		inline EventType getType() const { return Type; }
 
 		enum Action { Pickup = 0, DropRecent, DropObject };
 
@@ -215,7 +231,8 @@ namespace sim
 	//===========================================================================
 	struct EnergyEvent
 	{
-		inline EventType getType() const { return Event_Energy; }
+		static const EventType Type = Event_Energy;
+		inline EventType getType() const { return Type; }
 
 		enum Action { Give = 0, Fight, Eat };
 
@@ -246,7 +263,8 @@ namespace sim
 	//===========================================================================
 	struct AgentDeathEvent
 	{
-		inline EventType getType() const { return Event_AgentDeath; }
+		static const EventType Type = Event_AgentDeath;
+		inline EventType getType() const { return Type; }
 
 		AgentDeathEvent( agent *_a,
 						 LifeSpan::DeathReason _reason )
@@ -263,7 +281,8 @@ namespace sim
 	//===========================================================================
 	struct BrainAnalysisBeginEvent
 	{
-		inline EventType getType() const { return Event_BrainAnalysisBegin; }
+		static const EventType Type = Event_BrainAnalysisBegin;
+		inline EventType getType() const { return Type; }
 
 		BrainAnalysisBeginEvent( agent *_a )
 		: a(_a)
@@ -277,7 +296,8 @@ namespace sim
 	//===========================================================================
 	struct BrainAnalysisEndEvent
 	{
-		inline EventType getType() const { return Event_BrainAnalysisEnd; }
+		static const EventType Type = Event_BrainAnalysisEnd;
+		inline EventType getType() const { return Type; }
 
 		BrainAnalysisEndEvent( agent *_a )
 		: a(_a)
@@ -291,7 +311,8 @@ namespace sim
 	//===========================================================================
 	struct StepEndEvent
 	{
-		inline EventType getType() const { return Event_StepEnd; }
+		static const EventType Type = Event_StepEnd;
+		inline EventType getType() const { return Type; }
 	};
 
 	//===========================================================================
@@ -299,7 +320,8 @@ namespace sim
 	//===========================================================================
 	struct EpochEndEvent
 	{
-		inline EventType getType() const { return Event_EpochEnd; }
+		static const EventType Type = Event_EpochEnd;
+		inline EventType getType() const { return Type; }
 
 		EpochEndEvent( long _epoch ) : epoch(_epoch) {}
 
@@ -311,7 +333,8 @@ namespace sim
 	//===========================================================================
 	struct SimEndEvent
 	{
-		inline EventType getType() const { return Event_SimEnd; }
+		static const EventType Type = Event_SimEnd;
+		inline EventType getType() const { return Type; }
 	};
 
 	//===========================================================================
@@ -346,6 +369,9 @@ namespace sim
 		void	reset()			{ mn = FLT_MAX; mx = FLT_MIN; sum = sum2 = count = 0; }
 		unsigned long samples() { return( count ); }
 
+		void	dump( CheckPointWriter &out );
+		void	load( CheckPointReader &in );
+
 	private:
 		float	mn;		// minimum
 		float	mx;		// maximum
@@ -371,6 +397,9 @@ namespace sim
 	void	reset()			{ mn = FLT_MAX; mx = FLT_MIN; sum = sum2 = count = index = 0; needMin = needMax = false; }
 	unsigned long samples() { return( count ); }
 
+	void	dump( CheckPointWriter &out );
+	void	load( CheckPointReader &in );
+
 private:
 	float	mn;		// minimum
 	float	mx;		// maximum
@@ -8,19 +8,36 @@
 #include <unistd.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <string>
+
+#include "AsyncWriter.h"
+#include "LogContainer.h"
+
 #define GZIP_EXT ".gz"
+#define CONTAINER_SEGMENT_SIZE (256 * 1024)
 
 AbstractFile *AbstractFile::open( ConcreteFileType type,
 								  const char *abstractPath,
 								  const char *mode )
 {
-	return new AbstractFile( type, abstractPath, mode );
+	AbstractFile *file = new AbstractFile( type, abstractPath, mode );
+
+	if( (mode[0] != 'r') && AsyncWriter::isRunning() )
+		file = new AbstractFile( file );
+
+	return file;
 }
 
 AbstractFile *AbstractFile::open( const char *abstractPath,
 								  const char *mode )
 {
-	return new AbstractFile( abstractPath, mode );
+	AbstractFile *file = new AbstractFile( abstractPath, mode );
+
+	if( (mode[0] != 'r') && AsyncWriter::isRunning() )
+		file = new AbstractFile( file );
+
+	return file;
 }
 
 bool AbstractFile::exists(  const char *abstractPath,
@@ -30,6 +47,15 @@ bool AbstractFile::exists(  const char *abstractPath,
 	int numFound = 0;
 	ConcreteFileType type;
 
+	if( isRecordPath(abstractPath) )
+	{
+		if( isAmbiguous != NULL )
+			*isAmbiguous = false;
+		if( typeFound != NULL )
+			*typeFound = TYPE_CONTAINER;
+		return exists( TYPE_CONTAINER, abstractPath );
+	}
+
 	if( exists(TYPE_FILE, abstractPath) )
 	{
 		numFound++;
@@ -62,6 +88,15 @@ bool AbstractFile::exists(  const char *abstractPath,
 bool AbstractFile::exists( ConcreteFileType type, const char *abstractPath )
 {
 	bool retval = false;
+
+	if( type == TYPE_CONTAINER )
+	{
+		std::string path, key;
+		if( !LogContainer::splitRecordPath(abstractPath, path, key) )
+			return false;
+		LogContainer *container = LogContainer::get( path );
+		return container && container->exists( key );
+	}
 	char *path = createPath( type, abstractPath );
 
 	struct stat buf;
@@ -76,6 +111,10 @@ int AbstractFile::link( const char *oldAbstractPath,
 {
 	int rc = -1;
 
+	// Records are added to views instead (see LogContainer)
+	if( isRecordPath(oldAbstractPath) || isRecordPath(newAbstractPath) )
+		return rc;
+
 	if( !exists(newAbstractPath) )
 	{
 		bool isAmbiguous;
@@ -104,6 +143,9 @@ int AbstractFile::unlink( const char *abstractPath )
 {
 	int rc = -1;
 
+	if( isRecordPath(abstractPath) )
+		return rc;
+
 	bool isAmbiguous;
 	ConcreteFileType type;
 	bool found;
@@ -128,6 +170,9 @@ int AbstractFile::rename( const char *oldAbstractPath,
 {
 	int rc = -1;
 
+	if( isRecordPath(oldAbstractPath) || isRecordPath(newAbstractPath) )
+		return rc;
+
 	if( !exists(newAbstractPath) )
 	{
 		bool isAmbiguous;
@@ -143,6 +188,8 @@ int AbstractFile::rename( const char *oldAbstractPath,
 			char *newpath = createPath( type, newAbstractPath );
 
 			rc = ::rename( oldpath, newpath );
+			if( rc == 0 )
+				AsyncWriter::rename( oldAbstractPath, newAbstractPath );
 
 			free( oldpath );
 			free( newpath );
@@ -159,12 +206,25 @@ AbstractFile::AbstractFile( ConcreteFileType type,
 	init( type, abstractPath, mode );
 }
 
+AbstractFile::AbstractFile( AbstractFile *sink )
+{
+	this->type = sink->type;
+	this->abstractPath = strdup( sink->abstractPath );
+	async = new AsyncStream( sink );
+}
+
 AbstractFile::AbstractFile( const char *abstractPath,
 							const char *mode )
 {
 	ConcreteFileType type;
 	int numFound = 0;
 
+	if( isRecordPath(abstractPath) )
+	{
+		init( TYPE_CONTAINER, abstractPath, mode );
+		return;
+	}
+
 	if( exists(TYPE_GZIP_FILE, abstractPath) )
 	{
 		type = TYPE_GZIP_FILE;
@@ -203,6 +263,22 @@ int AbstractFile::close()
 {
 	int rc = 0;
 
+	if( async )
+	{
+		// The sink is closed by the writer thread.
+		async->close();
+		async = NULL;
+		free( (void *)abstractPath );
+		abstractPath = NULL;
+
+		return rc;
+	}
+	else if( abstractPath == NULL )
+	{
+		// Already closed
+		return rc;
+	}
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -224,6 +300,20 @@ int AbstractFile::close()
 			gzip.fp = NULL;
 		}
 		break;
+	case TYPE_CONTAINER:
+		if( container.key )
+		{
+			if( container.writing )
+			{
+				appendSegment();
+				container.container->end( container.key );
+			}
+			free( container.key );
+			free( container.buf );
+			container.key = NULL;
+			container.buf = NULL;
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -267,6 +357,11 @@ bool AbstractFile::isCapable( ConcreteFileCapability cap )
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			retval = (cap == CAP_SEEK_END) && !container.writing;
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -279,6 +374,9 @@ size_t AbstractFile::write( const void *ptr, size_t size, size_t nmemb )
 {
 	size_t rc = 0;
 
+	if( async )
+		return size ? async->write( ptr, size * nmemb ) / size : 0;
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -295,6 +393,28 @@ size_t AbstractFile::write( const void *ptr, size_t size, size_t nmemb )
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			assert( container.writing );
+
+			size_t n = size * nmemb;
+			if( container.length + n > container.capacity )
+			{
+				container.capacity = std::max( container.capacity * 2, container.length + n );
+				container.buf = (char *)realloc( container.buf, container.capacity );
+				assert( container.buf );
+			}
+			memcpy( container.buf + container.length, ptr, n );
+			container.length += n;
+
+			if( container.length >= CONTAINER_SEGMENT_SIZE )
+			{
+				appendSegment();
+			}
+
+			rc = nmemb;
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -330,6 +450,12 @@ int AbstractFile::flush( bool full )
 {
 	int rc = 0;
 
+	if( async )
+	{
+		async->flush( full );
+		return rc;
+	}
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -346,6 +472,15 @@ int AbstractFile::flush( bool full )
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			// Every segment costs an index entry, so only when asked.
+			if( full && container.writing )
+			{
+				appendSegment();
+			}
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -357,6 +492,8 @@ size_t AbstractFile::read( void *ptr, size_t size, size_t nmemb )
 {
 	size_t rc = 0;
 
+	assert( !async );
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -373,6 +510,15 @@ size_t AbstractFile::read( void *ptr, size_t size, size_t nmemb )
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			assert( !container.writing );
+
+			rc = std::min( nmemb, (container.length - container.pos) / size );
+			memcpy( ptr, container.buf + container.pos, rc * size );
+			container.pos += rc * size;
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -412,6 +558,8 @@ char *AbstractFile::gets( char *s, int size )
 {
 	char *retval = 0;
 
+	assert( !async );
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -424,6 +572,25 @@ char *AbstractFile::gets( char *s, int size )
 			retval = gzgets( gzip.fp, s, size );
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			assert( !container.writing );
+
+			if( container.pos < container.length && size > 1 )
+			{
+				int n = 0;
+				while( n < size - 1 && container.pos < container.length )
+				{
+					char c = container.buf[container.pos++];
+					s[n++] = c;
+					if( c == '\n' )
+						break;
+				}
+				s[n] = '\0';
+				retval = s;
+			}
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -436,6 +603,13 @@ int AbstractFile::seek( offset_t offset,
 {
 	int rc = 0;
 
+	if( async )
+	{
+		// Only to where it already is
+		offset_t target = whence == SEEK_CUR ? tell() + offset : offset;
+		return (whence != SEEK_END) && (target == tell()) ? 0 : -1;
+	}
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -452,6 +626,28 @@ int AbstractFile::seek( offset_t offset,
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			offset_t base = whence == SEEK_SET ? 0
+				: whence == SEEK_CUR ? tell()
+				: (offset_t)(container.appended + container.length);
+			offset_t target = base + offset;
+
+			if( container.writing )
+			{
+				// Only to where it already is
+				rc = target == tell() ? 0 : -1;
+			}
+			else if( target < 0 || target > (offset_t)container.length )
+			{
+				rc = -1;
+			}
+			else
+			{
+				container.pos = target;
+			}
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -463,6 +659,9 @@ AbstractFile::offset_t AbstractFile::tell()
 {
 	offset_t rc = 0;
 
+	if( async )
+		return async->tell();
+
 	switch( type )
 	{
 	case TYPE_FILE:
@@ -475,6 +674,11 @@ AbstractFile::offset_t AbstractFile::tell()
 			rc = gztell( gzip.fp );
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			rc = container.writing ? container.appended + container.length : container.pos;
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -486,8 +690,16 @@ void AbstractFile::init( ConcreteFileType type,
 						 const char *abstractPath,
 						 const char *mode )
 {
+	if( isRecordPath(abstractPath) )
+		type = TYPE_CONTAINER;
+
+	// Whatever's been written to it on another thread
+	if( mode[0] == 'r' )
+		AsyncWriter::sync( abstractPath );
+
 	this->type = type;
 	this->abstractPath = strdup( abstractPath );
+	this->async = NULL;
 
 	switch( type )
 	{
@@ -518,6 +730,40 @@ void AbstractFile::init( ConcreteFileType type,
                 sleep(1);
         }
     }
+    break;
+	case TYPE_CONTAINER:
+    {
+        std::string path, key;
+        bool isRecord = LogContainer::splitRecordPath( abstractPath, path, key );
+        assert( isRecord );
+
+        container.container = LogContainer::get( path );
+        container.key = strdup( key.c_str() );
+        container.writing = mode[0] != 'r';
+        container.buf = NULL;
+        container.length = container.capacity = container.pos = container.appended = 0;
+
+        bool ok = container.container != NULL
+            && (!container.writing || container.container->isWritable());
+        if( ok && !container.writing )
+        {
+            std::string data;
+            ok = container.container->read( key, data );
+            if( ok )
+            {
+                container.length = container.capacity = data.size();
+                container.buf = (char *)malloc( data.size() + 1 );
+                memcpy( container.buf, data.data(), data.size() );
+            }
+        }
+        if( !ok )
+        {
+            fprintf( stderr, "Unable to open record at '%s'\n", abstractPath );
+            exit( 1 );
+        }
+        if( container.writing )
+            container.container->begin( key );
+    }
     break;
 	default:
 		assert( false );
@@ -550,6 +796,11 @@ char *AbstractFile::createPath( ConcreteFileType type, const char *abstractPath
 			}
 		}
 		break;
+	case TYPE_CONTAINER:
+		{
+			path = strdup( abstractPath );
+		}
+		break;
 	default:
 		assert( false );
 	}
@@ -557,6 +808,20 @@ char *AbstractFile::createPath( ConcreteFileType type, const char *abstractPath
 	return path;
 }
 
+bool AbstractFile::isRecordPath( const char *abstractPath )
+{
+	std::string path, key;
+
+	return LogContainer::splitRecordPath( abstractPath, path, key );
+}
+
+void AbstractFile::appendSegment()
+{
+	container.container->append( container.key, container.buf, container.length );
+	container.appended += container.length;
+	container.length = 0;
+}
+
 void AbstractFile::test()
 {
 #define CLEANUP() \
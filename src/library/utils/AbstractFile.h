@@ -10,7 +10,8 @@ class AbstractFile
 	{
 		TYPE_UNDEFINED,
 		TYPE_FILE,
-		TYPE_GZIP_FILE
+		TYPE_GZIP_FILE,
+		TYPE_CONTAINER		// a record of a LogContainer, path of form <container>#<key>
 	};
 	enum ConcreteFileCapability
 	{
@@ -40,6 +41,8 @@ class AbstractFile
 	static int rename( const char *oldAbstractPath,
 					   const char *newAbstractPath );
 
+	static bool isRecordPath( const char *abstractPath );
+
 	AbstractFile( ConcreteFileType type,
 				  const char *abstractPath,
 				  const char *mode );
@@ -67,13 +70,18 @@ class AbstractFile
 	offset_t tell();
 
  private:
+	// Writes go to sink on an AsyncWriter thread.
+	AbstractFile( AbstractFile *sink );
+
 	void init( ConcreteFileType type,
 			   const char *abstractPath,
 			   const char *mode );
 	static char *createPath( ConcreteFileType type, const char *abstractPath );
+	void appendSegment();
 
 	ConcreteFileType type;
 	const char *abstractPath;
+	class AsyncStream *async;	// if written through AsyncWriter
 	union
 	{
 		struct
@@ -87,6 +95,18 @@ class AbstractFile
 			const char *path;
 			gzFile fp;
 		} gzip;
+
+		struct
+		{
+			class LogContainer *container;
+			char *key;
+			bool writing;
+			char *buf;			// unwritten part of the record, or all of it if reading
+			size_t length;
+			size_t capacity;
+			size_t pos;			// reading
+			size_t appended;	// writing, length of the segments already in container
+		} container;
 	};
 
  public:
@@ -0,0 +1,552 @@
+#include "AsyncWriter.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "AbstractFile.h"
+
+using namespace std;
+
+#define ASYNC_CHUNK_SIZE (64 * 1024)
+
+// A writer thread that finds its ring empty sleeps until woken by a producer,
+// or for at most this long, in case the wakeup crossed its going to sleep.
+#define ASYNC_IDLE_WAIT std::chrono::milliseconds( 10 )
+
+AsyncWriter *AsyncWriter::instance = NULL;
+
+//===========================================================================
+// AsyncWriter::Ring
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// AsyncWriter::Ring::Ring
+//---------------------------------------------------------------------------
+AsyncWriter::Ring::Ring( size_t size )
+: enqueuePos( 0 )
+, dequeuePos( 0 )
+{
+	size_t n = 2;
+	while( n < size )
+		n *= 2;
+
+	cells.reset( new Cell[n] );
+	mask = n - 1;
+	for( size_t i = 0; i < n; i++ )
+		cells[i].sequence.store( i, memory_order_relaxed );
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::Ring::push
+//
+// Returns false if full.
+//---------------------------------------------------------------------------
+bool AsyncWriter::Ring::push( const Op &op )
+{
+	size_t pos = enqueuePos.load( memory_order_relaxed );
+	Cell *cell;
+
+	for( ;; )
+	{
+		cell = &cells[pos & mask];
+		size_t sequence = cell->sequence.load( memory_order_acquire );
+		long dif = (long)sequence - (long)pos;
+		if( dif == 0 )
+		{
+			if( enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed) )
+				break;
+		}
+		else if( dif < 0 )
+			return false;
+		else
+			pos = enqueuePos.load( memory_order_relaxed );
+	}
+
+	cell->op = op;
+	cell->sequence.store( pos + 1, memory_order_release );
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::Ring::pop
+//
+// Returns false if empty.
+//---------------------------------------------------------------------------
+bool AsyncWriter::Ring::pop( Op &op )
+{
+	size_t pos = dequeuePos.load( memory_order_relaxed );
+	Cell *cell;
+
+	for( ;; )
+	{
+		cell = &cells[pos & mask];
+		size_t sequence = cell->sequence.load( memory_order_acquire );
+		long dif = (long)sequence - (long)(pos + 1);
+		if( dif == 0 )
+		{
+			if( dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed) )
+				break;
+		}
+		else if( dif < 0 )
+			return false;
+		else
+			pos = dequeuePos.load( memory_order_relaxed );
+	}
+
+	op = cell->op;
+	cell->sequence.store( pos + mask + 1, memory_order_release );
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::Ring::empty
+//---------------------------------------------------------------------------
+bool AsyncWriter::Ring::empty()
+{
+	size_t pos = dequeuePos.load( memory_order_acquire );
+
+	return cells[pos & mask].sequence.load( memory_order_acquire ) != pos + 1;
+}
+
+
+//===========================================================================
+// AsyncWriter
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// AsyncWriter::start
+//---------------------------------------------------------------------------
+void AsyncWriter::start( int numThreads, int queueSize )
+{
+	assert( instance == NULL );
+	assert( numThreads > 0 );
+
+	instance = new AsyncWriter( numThreads, queueSize );
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::stop
+//---------------------------------------------------------------------------
+void AsyncWriter::stop()
+{
+	if( instance )
+	{
+		instance->flushAll();
+
+		delete instance;
+		instance = NULL;
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::flush
+//---------------------------------------------------------------------------
+void AsyncWriter::flush()
+{
+	if( instance )
+		instance->flushAll();
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::sync
+//---------------------------------------------------------------------------
+void AsyncWriter::sync( const char *abstractPath )
+{
+	if( instance )
+		instance->syncPath( abstractPath );
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::rename
+//---------------------------------------------------------------------------
+void AsyncWriter::rename( const char *oldAbstractPath, const char *newAbstractPath )
+{
+	if( !instance )
+		return;
+
+	lock_guard<std::mutex> lock( instance->mutex );
+
+	multimap<string, AsyncStream *> &streams = instance->streams;
+	vector<AsyncStream *> renamed;
+
+	auto range = streams.equal_range( oldAbstractPath );
+	for( auto it = range.first; it != range.second; ++it )
+		renamed.push_back( it->second );
+	streams.erase( range.first, range.second );
+
+	for( AsyncStream *stream : renamed )
+	{
+		stream->path = newAbstractPath;
+		streams.insert( make_pair(stream->path, stream) );
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::AsyncWriter
+//---------------------------------------------------------------------------
+AsyncWriter::AsyncWriter( int numThreads, int queueSize )
+: stopping( false )
+, stalls( 0 )
+, nextShard( 0 )
+, nextId( 0 )
+, syncWaiters( 0 )
+{
+	for( int i = 0; i < numThreads; i++ )
+		shards.push_back( unique_ptr<Shard>(new Shard(queueSize)) );
+
+	for( auto &shard : shards )
+	{
+		Shard *s = shard.get();
+		s->thread = thread( [this, s]() { run( s ); } );
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::~AsyncWriter
+//---------------------------------------------------------------------------
+AsyncWriter::~AsyncWriter()
+{
+	stopping = true;
+
+	for( auto &shard : shards )
+	{
+		{
+			lock_guard<std::mutex> lock( shard->mutex );
+			shard->wake.notify_one();
+		}
+		shard->thread.join();
+	}
+
+	if( stalls > 0 )
+	{
+		fprintf( stderr,
+				 "Logging waited %zu times for a log writer thread; consider a larger LogWriterQueueSize or more LogWriterThreads.\n",
+				 stalls.load() );
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::push
+//
+// Called by the thread writing stream.
+//---------------------------------------------------------------------------
+void AsyncWriter::push( AsyncStream *stream, OpKind kind, char *data, size_t length )
+{
+	Shard *shard = stream->shard;
+	Op op = { stream, kind, data, length };
+
+	stream->pushed++;
+
+	if( !shard->ring.push(op) )
+	{
+		stalls++;
+		do
+		{
+			if( shard->sleeping )
+			{
+				lock_guard<std::mutex> lock( shard->mutex );
+				shard->wake.notify_one();
+			}
+			this_thread::yield();
+		} while( !shard->ring.push(op) );
+	}
+
+	shard->pushed++;
+
+	if( shard->sleeping )
+	{
+		lock_guard<std::mutex> lock( shard->mutex );
+		shard->wake.notify_one();
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::run
+//
+// A writer thread.
+//---------------------------------------------------------------------------
+void AsyncWriter::run( Shard *shard )
+{
+	Op op;
+
+	for( ;; )
+	{
+		if( shard->ring.pop(op) )
+		{
+			execute( op );
+			shard->done++;
+			continue;
+		}
+
+		unique_lock<std::mutex> lock( shard->mutex );
+		shard->idle.notify_all();
+
+		if( stopping && shard->ring.empty() )
+			break;
+
+		shard->sleeping = true;
+		shard->wake.wait_for( lock,
+							  ASYNC_IDLE_WAIT,
+							  [this, shard]() { return !shard->ring.empty() || stopping; } );
+		shard->sleeping = false;
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::execute
+//---------------------------------------------------------------------------
+void AsyncWriter::execute( const Op &op )
+{
+	AsyncStream *stream = op.stream;
+
+	switch( op.kind )
+	{
+	case OP_WRITE:
+		if( stream->sink->write(op.data, 1, op.length) != op.length )
+		{
+			fprintf( stderr, "Failed writing %s\n", stream->path.c_str() );
+			perror( stream->path.c_str() );
+			exit( 1 );
+		}
+		free( op.data );
+		break;
+	case OP_FLUSH:
+		stream->sink->flush();
+		break;
+	case OP_FULL_FLUSH:
+		stream->sink->flush( true );
+		break;
+	case OP_CLOSE:
+		delete stream->sink;
+		stream->sink = NULL;
+		break;
+	default:
+		assert( false );
+	}
+
+	stream->done++;
+
+	if( op.kind == OP_CLOSE )
+	{
+		{
+			lock_guard<std::mutex> lock( mutex );
+
+			auto range = streams.equal_range( stream->path );
+			for( auto it = range.first; it != range.second; ++it )
+			{
+				if( it->second == stream )
+				{
+					streams.erase( it );
+					break;
+				}
+			}
+			synced.notify_all();
+		}
+		delete stream;
+	}
+	else if( syncWaiters > 0 )
+	{
+		lock_guard<std::mutex> lock( mutex );
+		synced.notify_all();
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::flushAll
+//
+// Called with no file being written by another thread.
+//---------------------------------------------------------------------------
+void AsyncWriter::flushAll()
+{
+	{
+		vector<AsyncStream *> open;
+		{
+			lock_guard<std::mutex> lock( mutex );
+			for( auto &entry : streams )
+				if( !entry.second->closed )
+					open.push_back( entry.second );
+		}
+
+		for( AsyncStream *stream : open )
+			stream->flush( true );
+	}
+
+	for( auto &shard : shards )
+	{
+		size_t target = shard->pushed;
+
+		unique_lock<std::mutex> lock( shard->mutex );
+		while( shard->done < target )
+		{
+			shard->wake.notify_one();
+			shard->idle.wait_for( lock, ASYNC_IDLE_WAIT );
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// AsyncWriter::syncPath
+//---------------------------------------------------------------------------
+void AsyncWriter::syncPath( const string &path )
+{
+	unique_lock<std::mutex> lock( mutex );
+
+	// What's been handed over so far, by stream
+	vector< pair<unsigned long, size_t> > targets;
+	auto range = streams.equal_range( path );
+	for( auto it = range.first; it != range.second; ++it )
+		targets.push_back( make_pair(it->second->id, it->second->pushed.load()) );
+
+	if( targets.empty() )
+		return;
+
+	syncWaiters++;
+
+	for( ;; )
+	{
+		bool pending = false;
+
+		range = streams.equal_range( path );
+		for( auto it = range.first; it != range.second && !pending; ++it )
+		{
+			for( auto &target : targets )
+			{
+				if( it->second->id == target.first && it->second->done < target.second )
+				{
+					pending = true;
+					break;
+				}
+			}
+		}
+
+		if( !pending )
+			break;
+
+		synced.wait_for( lock, ASYNC_IDLE_WAIT );
+	}
+
+	syncWaiters--;
+}
+
+
+//===========================================================================
+// AsyncStream
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// AsyncStream::AsyncStream
+//---------------------------------------------------------------------------
+AsyncStream::AsyncStream( AbstractFile *sink_ )
+: sink( sink_ )
+, path( sink_->getAbstractPath() )
+, closed( false )
+, buf( NULL )
+, length( 0 )
+, pos( sink_->tell() )
+, pushed( 0 )
+, done( 0 )
+{
+	AsyncWriter *writer = AsyncWriter::instance;
+	assert( writer );
+
+	shard = writer->shards[ writer->nextShard++ % writer->shards.size() ].get();
+	id = writer->nextId++;
+
+	lock_guard<std::mutex> lock( writer->mutex );
+	writer->streams.insert( make_pair(path, this) );
+}
+
+//---------------------------------------------------------------------------
+// AsyncStream::write
+//---------------------------------------------------------------------------
+size_t AsyncStream::write( const void *data, size_t n )
+{
+	assert( !closed );
+
+	if( !AsyncWriter::instance )
+	{
+		pos += n;
+		return sink->write( data, 1, n );
+	}
+
+	const char *p = (const char *)data;
+	size_t remaining = n;
+
+	while( remaining > 0 )
+	{
+		if( buf == NULL )
+		{
+			buf = (char *)malloc( ASYNC_CHUNK_SIZE );
+			assert( buf );
+		}
+
+		size_t m = min( remaining, ASYNC_CHUNK_SIZE - length );
+		memcpy( buf + length, p, m );
+		length += m;
+		p += m;
+		remaining -= m;
+
+		if( length == ASYNC_CHUNK_SIZE )
+			pushBuffer();
+	}
+
+	pos += n;
+
+	return n;
+}
+
+//---------------------------------------------------------------------------
+// AsyncStream::flush
+//---------------------------------------------------------------------------
+void AsyncStream::flush( bool full )
+{
+	assert( !closed );
+
+	if( !AsyncWriter::instance )
+	{
+		sink->flush( full );
+		return;
+	}
+
+	pushBuffer();
+	AsyncWriter::instance->push( this, full ? AsyncWriter::OP_FULL_FLUSH : AsyncWriter::OP_FLUSH );
+}
+
+//---------------------------------------------------------------------------
+// AsyncStream::close
+//---------------------------------------------------------------------------
+void AsyncStream::close()
+{
+	assert( !closed );
+
+	if( !AsyncWriter::instance )
+	{
+		delete sink;
+		delete this;
+		return;
+	}
+
+	pushBuffer();
+	closed = true;
+	AsyncWriter::instance->push( this, AsyncWriter::OP_CLOSE );
+}
+
+//---------------------------------------------------------------------------
+// AsyncStream::pushBuffer
+//---------------------------------------------------------------------------
+void AsyncStream::pushBuffer()
+{
+	if( length > 0 )
+	{
+		AsyncWriter::instance->push( this, AsyncWriter::OP_WRITE, buf, length );
+		buf = NULL;
+		length = 0;
+	}
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AbstractFile;
+class AsyncStream;
+
+//===========================================================================
+// AsyncWriter
+//
+// Moves the writing (and compressing) of files opened for writing through
+// AbstractFile::open() onto background threads, so the simulation doesn't
+// wait on the disk or on zlib.
+//
+// What's written to such a file is buffered by the caller's thread and
+// handed over in chunks of up to ASYNC_CHUNK_SIZE. Each chunk is a small
+// record (file, data, length) in a bounded lock-free ring; there is one ring
+// and one writer thread per shard, and a file always goes to the same shard,
+// so its chunks are written in order.
+//
+// Backpressure: when a ring is full the caller waits (yielding) for the
+// writer, and the wait is counted and reported at stop().
+//
+// Consistency: flush() writes out everything open files have buffered and
+// waits until it has been written, as at the end of the simulation or before
+// a checkpoint. Opening a file for reading first waits until what's been
+// handed over for that path has been written (see sync()).
+//===========================================================================
+class AsyncWriter
+{
+ public:
+	// numThreads writer threads, each with a ring of queueSize records.
+	static void start( int numThreads, int queueSize );
+	// Flushes and stops the threads. Files closed afterwards are written in
+	// place.
+	static void stop();
+	static bool isRunning() { return instance != NULL; }
+
+	static void flush();
+	// Waits until what's been handed over for abstractPath has been written,
+	// including its closing if it's been closed.
+	static void sync( const char *abstractPath );
+	// The file at oldAbstractPath, perhaps still being written, was renamed.
+	static void rename( const char *oldAbstractPath, const char *newAbstractPath );
+
+ private:
+	friend class AsyncStream;
+
+	enum OpKind
+	{
+		OP_WRITE,
+		OP_FLUSH,
+		OP_FULL_FLUSH,
+		OP_CLOSE
+	};
+
+	struct Op
+	{
+		AsyncStream *stream;
+		OpKind kind;
+		char *data;
+		size_t length;
+	};
+
+	// Bounded multi-producer queue (after Vyukov). Each cell's sequence says
+	// whether it's free for the producer holding ticket pos (== pos) or full
+	// for the consumer (== pos + 1).
+	class Ring
+	{
+	 public:
+		Ring( size_t size );
+
+		bool push( const Op &op );
+		bool pop( Op &op );
+		bool empty();
+
+	 private:
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			Op op;
+		};
+
+		std::unique_ptr<Cell[]> cells;
+		size_t mask;
+		std::atomic<size_t> enqueuePos;
+		std::atomic<size_t> dequeuePos;
+	};
+
+	struct Shard
+	{
+		Shard( size_t queueSize ) : ring( queueSize ), pushed( 0 ), done( 0 ), sleeping( false ) {}
+
+		Ring ring;
+		std::atomic<size_t> pushed;
+		std::atomic<size_t> done;
+		std::atomic<bool> sleeping;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable idle;
+		std::thread thread;
+	};
+
+	AsyncWriter( int numThreads, int queueSize );
+	~AsyncWriter();
+
+	void push( AsyncStream *stream, OpKind kind, char *data = NULL, size_t length = 0 );
+	void run( Shard *shard );
+	void execute( const Op &op );
+	void flushAll();
+	void syncPath( const std::string &path );
+
+	static AsyncWriter *instance;
+
+	std::vector< std::unique_ptr<Shard> > shards;
+	std::atomic<bool> stopping;
+	std::atomic<size_t> stalls;
+	std::atomic<size_t> nextShard;
+	std::atomic<unsigned long> nextId;
+
+	// Streams not yet closed by their writer thread, by path.
+	std::multimap<std::string, AsyncStream *> streams;
+	std::atomic<int> syncWaiters;
+	std::mutex mutex;
+	std::condition_variable synced;
+};
+
+//===========================================================================
+// AsyncStream
+//
+// The writing end of an AbstractFile whose writes go through AsyncWriter.
+// Used only by the thread writing the file; sink, the AbstractFile that
+// really writes it, is used only by the writer thread.
+//===========================================================================
+class AsyncStream
+{
+ public:
+	AsyncStream( AbstractFile *sink );
+
+	size_t write( const void *data, size_t length );
+	void flush( bool full );
+	// Hands over the rest and closes; the stream deletes itself once written.
+	void close();
+	long tell() { return pos; }
+
+ private:
+	friend class AsyncWriter;
+
+	void pushBuffer();
+
+	AbstractFile *sink;
+	std::string path;
+	AsyncWriter::Shard *shard;
+	unsigned long id;
+	bool closed;
+	char *buf;
+	size_t length;
+	long pos;
+	std::atomic<size_t> pushed;
+	std::atomic<size_t> done;
+};
@@ -0,0 +1,257 @@
+#include "CheckPoint.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+
+#include "AbstractFile.h"
+
+using namespace std;
+
+#define GZIP_EXT ".gz"
+
+static const char Magic[8] = { 'P', 'W', 'C', 'H', 'K', 'P', 'T', '\0' };
+static const char EndTag[4] = { 'E', 'N', 'D', ' ' };
+
+
+//===========================================================================
+// CheckPointWriter
+//===========================================================================
+
+const uint32_t CheckPointWriter::Version;
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::CheckPointWriter
+//---------------------------------------------------------------------------
+CheckPointWriter::CheckPointWriter( const string &path, bool compress )
+: path( path )
+, partialPath( path + ".partial" )
+, inSection( false )
+{
+	file = AbstractFile::open( compress ? AbstractFile::TYPE_GZIP_FILE : AbstractFile::TYPE_FILE,
+							   partialPath.c_str(),
+							   "w" );
+
+	write( Magic, sizeof(Magic) );
+	write( &Version, sizeof(Version) );
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::~CheckPointWriter
+//---------------------------------------------------------------------------
+CheckPointWriter::~CheckPointWriter()
+{
+	close();
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::close
+//---------------------------------------------------------------------------
+void CheckPointWriter::close()
+{
+	if( !file )
+		return;
+
+	assert( !inSection );
+
+	uint64_t length = 0;
+	write( EndTag, sizeof(EndTag) );
+	write( &length, sizeof(length) );
+
+	delete file;
+	file = NULL;
+
+	AbstractFile::unlink( path.c_str() );
+	if( AbstractFile::rename(partialPath.c_str(), path.c_str()) != 0 )
+	{
+		cerr << "Failed renaming checkpoint " << partialPath << " to " << path << endl;
+		exit( 1 );
+	}
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::beginSection
+//---------------------------------------------------------------------------
+void CheckPointWriter::beginSection( const char *tag )
+{
+	assert( !inSection && strlen(tag) == sizeof(this->tag) );
+
+	memcpy( this->tag, tag, sizeof(this->tag) );
+	buf.clear();
+	inSection = true;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::endSection
+//---------------------------------------------------------------------------
+void CheckPointWriter::endSection()
+{
+	assert( inSection );
+
+	uint64_t length = buf.size();
+	write( tag, sizeof(tag) );
+	write( &length, sizeof(length) );
+	write( buf.data(), buf.size() );
+
+	inSection = false;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::putBytes
+//---------------------------------------------------------------------------
+void CheckPointWriter::putBytes( const void *data, size_t n )
+{
+	assert( inSection );
+
+	const unsigned char *bytes = (const unsigned char *)data;
+	buf.insert( buf.end(), bytes, bytes + n );
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::putString
+//---------------------------------------------------------------------------
+void CheckPointWriter::putString( const string &s )
+{
+	put( (uint64_t)s.size() );
+	putBytes( s.data(), s.size() );
+}
+
+//---------------------------------------------------------------------------
+// CheckPointWriter::write
+//---------------------------------------------------------------------------
+void CheckPointWriter::write( const void *data, size_t n )
+{
+	if( n && (file->write(data, 1, n) != n) )
+	{
+		cerr << "Failed writing checkpoint " << partialPath << endl;
+		exit( 1 );
+	}
+}
+
+
+//===========================================================================
+// CheckPointReader
+//===========================================================================
+
+//---------------------------------------------------------------------------
+// CheckPointReader::CheckPointReader
+//---------------------------------------------------------------------------
+CheckPointReader::CheckPointReader( const string &path )
+: path( path )
+, file( NULL )
+, ended( false )
+, pos( 0 )
+{
+	string abstractPath = path;
+	size_t extLen = strlen( GZIP_EXT );
+	if( (abstractPath.size() > extLen)
+		&& (abstractPath.compare(abstractPath.size() - extLen, extLen, GZIP_EXT) == 0) )
+	{
+		abstractPath.erase( abstractPath.size() - extLen );
+	}
+
+	bool isAmbiguous;
+	if( !AbstractFile::exists(abstractPath.c_str(), &isAmbiguous) )
+		fail( "no such file" );
+	if( isAmbiguous )
+		fail( "both plain and gzipped versions exist" );
+
+	file = AbstractFile::open( abstractPath.c_str(), "r" );
+
+	char magic[sizeof(Magic)];
+	read( magic, sizeof(magic) );
+	if( memcmp(magic, Magic, sizeof(Magic)) != 0 )
+		fail( "not a checkpoint" );
+
+	read( &version, sizeof(version) );
+	if( version > CheckPointWriter::Version )
+		fail( "written by a newer version" );
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::~CheckPointReader
+//---------------------------------------------------------------------------
+CheckPointReader::~CheckPointReader()
+{
+	delete file;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::nextSection
+//---------------------------------------------------------------------------
+bool CheckPointReader::nextSection( string &tag )
+{
+	buf.clear();
+	pos = 0;
+
+	if( ended )
+		return false;
+
+	char tagbuf[4];
+	uint64_t length;
+	read( tagbuf, sizeof(tagbuf) );
+	read( &length, sizeof(length) );
+
+	this->tag.assign( tagbuf, sizeof(tagbuf) );
+	if( memcmp(tagbuf, EndTag, sizeof(EndTag)) == 0 )
+	{
+		ended = true;
+		return false;
+	}
+
+	buf.resize( length );
+	read( buf.data(), length );
+
+	tag = this->tag;
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::getBytes
+//---------------------------------------------------------------------------
+void CheckPointReader::getBytes( void *data, size_t n )
+{
+	if( n > buf.size() - pos )
+		fail( "read past end of section" );
+
+	memcpy( data, buf.data() + pos, n );
+	pos += n;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::getString
+//---------------------------------------------------------------------------
+string CheckPointReader::getString()
+{
+	uint64_t n = get<uint64_t>();
+	if( n > buf.size() - pos )
+		fail( "read past end of section" );
+
+	string s( (const char *)buf.data() + pos, n );
+	pos += n;
+
+	return s;
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::fail
+//---------------------------------------------------------------------------
+void CheckPointReader::fail( const string &message )
+{
+	cerr << "Invalid checkpoint " << path;
+	if( !tag.empty() )
+		cerr << " (section '" << tag << "')";
+	cerr << ": " << message << endl;
+	exit( 1 );
+}
+
+//---------------------------------------------------------------------------
+// CheckPointReader::read
+//---------------------------------------------------------------------------
+void CheckPointReader::read( void *data, size_t n )
+{
+	if( n && (file->read(data, 1, n) != n) )
+		fail( "unexpected end of file" );
+}
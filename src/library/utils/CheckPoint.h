@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+class AbstractFile;
+
+//===========================================================================
+// CheckPoint files
+//
+// A checkpoint is a header (magic + format version) followed by tagged
+// sections, each a four-character tag, a 64-bit payload length and the
+// payload, and ends with an "END " section. Sections are built in memory one
+// at a time, so a writer never holds more than one object's state. Readers
+// skip sections they don't recognize, so sections may be added without
+// changing the version; it only changes when an existing section's layout
+// does.
+//
+// Values are stored in native byte order and size, so a checkpoint is meant
+// to be restored by the same build, on the same kind of machine, that wrote
+// it.
+//===========================================================================
+
+//===========================================================================
+// CheckPointWriter
+//===========================================================================
+class CheckPointWriter
+{
+ public:
+	static const uint32_t Version = 1;
+
+	// The file is written under a temporary name and only renamed to path by
+	// close(), so an interrupted write never leaves a truncated checkpoint.
+	CheckPointWriter( const std::string &path, bool compress );
+	~CheckPointWriter();
+
+	void close();
+
+	void beginSection( const char *tag );
+	void endSection();
+
+	// T must be plain data (no pointers or heap members).
+	template<typename T>
+	void put( const T &value ) { putBytes( &value, sizeof(T) ); }
+	template<typename T>
+	void putArray( const T *values, size_t n ) { putBytes( values, n * sizeof(T) ); }
+	void putBytes( const void *data, size_t n );
+	void putString( const std::string &s );
+
+ private:
+	void write( const void *data, size_t n );
+
+	std::string path;
+	std::string partialPath;
+	AbstractFile *file;
+	char tag[4];
+	bool inSection;
+	std::vector<unsigned char> buf;
+};
+
+//===========================================================================
+// CheckPointReader
+//
+// Any error (missing file, bad header, reading past the end of a section)
+// is fatal.
+//===========================================================================
+class CheckPointReader
+{
+ public:
+	// path may name either the plain or the gzipped file.
+	CheckPointReader( const std::string &path );
+	~CheckPointReader();
+
+	const std::string &getPath() { return path; }
+	uint32_t getVersion() { return version; }
+
+	// Moves to the next section, discarding whatever is left of the current
+	// one. Returns false at the end of the checkpoint.
+	bool nextSection( std::string &tag );
+	bool endOfSection() { return pos == buf.size(); }
+
+	template<typename T>
+	T get() { T value; getBytes( &value, sizeof(T) ); return value; }
+	template<typename T>
+	void get( T &value ) { getBytes( &value, sizeof(T) ); }
+	template<typename T>
+	void getArray( T *values, size_t n ) { getBytes( values, n * sizeof(T) ); }
+	void getBytes( void *data, size_t n );
+	std::string getString();
+
+	void fail( const std::string &message );
+
+ private:
+	void read( void *data, size_t n );
+
+	std::string path;
+	AbstractFile *file;
+	uint32_t version;
+	bool ended;
+	std::string tag;
+	std::vector<unsigned char> buf;
+	size_t pos;
+};
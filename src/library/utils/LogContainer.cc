@@ -0,0 +1,382 @@
+#include "LogContainer.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "misc.h"
+
+using namespace std;
+
+#define CONTAINER_EXT ".pwlog"
+#define INDEX_EXT ".index"
+#define INDEX_VERSION 1
+
+LogContainer::Registry LogContainer::registry;
+std::mutex LogContainer::registryMutex;
+
+//---------------------------------------------------------------------------
+// LogContainer::create
+//---------------------------------------------------------------------------
+LogContainer *LogContainer::create( const string &path, bool compress )
+{
+	makeParentDir( path );
+
+	LogContainer *container = new LogContainer( path, true, compress );
+
+	lock_guard<std::mutex> lock( registryMutex );
+	registry[path] = container;
+
+	return container;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::get
+//---------------------------------------------------------------------------
+LogContainer *LogContainer::get( const string &path )
+{
+	lock_guard<std::mutex> lock( registryMutex );
+
+	Registry::iterator it = registry.find( path );
+	if( it != registry.end() )
+		return it->second;
+
+	LogContainer *container = new LogContainer( path, false, false );
+	if( !container->data || !container->loadIndex() )
+	{
+		delete container;
+		return NULL;
+	}
+
+	registry[path] = container;
+
+	return container;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::LogContainer
+//---------------------------------------------------------------------------
+LogContainer::LogContainer( const string &path_, bool writing_, bool compress_ )
+: path( path_ )
+, writing( writing_ )
+, compress( compress_ )
+, index( NULL )
+{
+	string indexPath = path + INDEX_EXT;
+
+	if( writing )
+	{
+		// w+ so records can be read back while they're being written
+		data = fopen( path.c_str(), "w+b" );
+		index = fopen( indexPath.c_str(), "w" );
+		if( !data || !index )
+		{
+			perror( path.c_str() );
+			exit( 1 );
+		}
+
+		fprintf( index, "pwlog %d %s\n", INDEX_VERSION, compress ? "zlib" : "raw" );
+		fflush( index );
+	}
+	else
+	{
+		data = fopen( path.c_str(), "rb" );
+	}
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::~LogContainer
+//---------------------------------------------------------------------------
+LogContainer::~LogContainer()
+{
+	{
+		lock_guard<std::mutex> lock( registryMutex );
+		Registry::iterator it = registry.find( path );
+		if( it != registry.end() && it->second == this )
+			registry.erase( it );
+	}
+
+	if( data )
+		fclose( data );
+	if( index )
+		fclose( index );
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::recordPath
+//---------------------------------------------------------------------------
+string LogContainer::recordPath( const string &path, const string &key )
+{
+	return path + "#" + key;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::splitRecordPath
+//
+// Returns false if recordPath isn't of the form <path>.pwlog#<key>.
+//---------------------------------------------------------------------------
+bool LogContainer::splitRecordPath( const char *recordPath, string &path, string &key )
+{
+	const char *hash = strrchr( recordPath, '#' );
+	if( hash == NULL || hash[1] == '\0' )
+		return false;
+
+	size_t extlen = strlen( CONTAINER_EXT );
+	if( size_t(hash - recordPath) < extlen || strncmp(hash - extlen, CONTAINER_EXT, extlen) != 0 )
+		return false;
+
+	path.assign( recordPath, hash - recordPath );
+	key = hash + 1;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::begin
+//---------------------------------------------------------------------------
+void LogContainer::begin( const string &key )
+{
+	assert( writing );
+
+	lock_guard<std::mutex> lock( mutex );
+
+	records[key];
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::append
+//
+// Adds a segment to key's record.
+//---------------------------------------------------------------------------
+void LogContainer::append( const string &key, const void *buf, size_t length )
+{
+	assert( writing );
+
+	if( length == 0 )
+		return;
+
+	const Bytef *out = (const Bytef *)buf;
+	uLongf outLength = length;
+	Bytef *compressed = NULL;
+
+	if( compress )
+	{
+		outLength = compressBound( length );
+		compressed = (Bytef *)malloc( outLength );
+		if( compress2(compressed, &outLength, (const Bytef *)buf, length, Z_DEFAULT_COMPRESSION) != Z_OK )
+		{
+			fprintf( stderr, "Failed compressing segment of %s in %s\n", key.c_str(), path.c_str() );
+			exit( 1 );
+		}
+		out = compressed;
+	}
+
+	{
+		lock_guard<std::mutex> lock( mutex );
+
+		Segment segment;
+		SYS( fseek(data, 0, SEEK_END) );
+		segment.offset = ftell( data );
+		segment.length = outLength;
+		segment.rawLength = length;
+
+		if( fwrite(out, 1, outLength, data) != outLength )
+		{
+			perror( path.c_str() );
+			exit( 1 );
+		}
+		fflush( data );
+
+		records[key].segments.push_back( segment );
+
+		fprintf( index, "S %s %ld %ld %ld\n", key.c_str(), segment.offset, segment.length, segment.rawLength );
+		fflush( index );
+	}
+
+	if( compressed )
+		free( compressed );
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::end
+//---------------------------------------------------------------------------
+void LogContainer::end( const string &key )
+{
+	assert( writing );
+
+	lock_guard<std::mutex> lock( mutex );
+
+	records[key].complete = true;
+
+	fprintf( index, "E %s\n", key.c_str() );
+	fflush( index );
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::addView
+//---------------------------------------------------------------------------
+void LogContainer::addView( const string &view, const string &key )
+{
+	assert( writing );
+
+	lock_guard<std::mutex> lock( mutex );
+
+	views[view].push_back( key );
+
+	fprintf( index, "V %s %s\n", view.c_str(), key.c_str() );
+	fflush( index );
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::exists
+//---------------------------------------------------------------------------
+bool LogContainer::exists( const string &key )
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	return records.find( key ) != records.end();
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::isComplete
+//---------------------------------------------------------------------------
+bool LogContainer::isComplete( const string &key )
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	map<string, Record>::iterator it = records.find( key );
+
+	return it != records.end() && it->second.complete;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::read
+//
+// Sets buf to the contents of key's record, as written so far.
+//---------------------------------------------------------------------------
+bool LogContainer::read( const string &key, string &buf )
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	map<string, Record>::iterator it = records.find( key );
+	if( it == records.end() )
+		return false;
+
+	buf.clear();
+
+	vector<Bytef> segmentData;
+	for( size_t i = 0; i < it->second.segments.size(); i++ )
+	{
+		Segment &segment = it->second.segments[i];
+
+		segmentData.resize( segment.length );
+		SYS( fseek(data, segment.offset, SEEK_SET) );
+		if( fread(segmentData.data(), 1, segment.length, data) != (size_t)segment.length )
+		{
+			fprintf( stderr, "Truncated segment of %s in %s\n", key.c_str(), path.c_str() );
+			return false;
+		}
+
+		size_t start = buf.size();
+		buf.resize( start + segment.rawLength );
+
+		if( compress )
+		{
+			uLongf rawLength = segment.rawLength;
+			if( uncompress((Bytef *)&buf[start], &rawLength, segmentData.data(), segment.length) != Z_OK
+				|| rawLength != (uLongf)segment.rawLength )
+			{
+				fprintf( stderr, "Corrupt segment of %s in %s\n", key.c_str(), path.c_str() );
+				return false;
+			}
+		}
+		else
+		{
+			memcpy( &buf[start], segmentData.data(), segment.length );
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::getView
+//---------------------------------------------------------------------------
+vector<string> LogContainer::getView( const string &view )
+{
+	lock_guard<std::mutex> lock( mutex );
+
+	map< string, vector<string> >::iterator it = views.find( view );
+	if( it == views.end() )
+		return vector<string>();
+
+	return it->second;
+}
+
+//---------------------------------------------------------------------------
+// LogContainer::loadIndex
+//
+// A line cut short because the run was interrupted is ignored, as are
+// segments past the end of the data.
+//---------------------------------------------------------------------------
+bool LogContainer::loadIndex()
+{
+	string indexPath = path + INDEX_EXT;
+	FILE *in = fopen( indexPath.c_str(), "r" );
+	if( !in )
+		return false;
+
+	SYS( fseek(data, 0, SEEK_END) );
+	long dataLength = ftell( data );
+
+	char line[1024];
+	int version = 0;
+	char compression[32];
+	if( !fgets(line, sizeof(line), in)
+		|| sscanf(line, "pwlog %d %31s", &version, compression) != 2
+		|| version != INDEX_VERSION )
+	{
+		fprintf( stderr, "%s%s is not a log container index\n", path.c_str(), INDEX_EXT );
+		fclose( in );
+		return false;
+	}
+	compress = strcmp( compression, "zlib" ) == 0;
+
+	while( fgets(line, sizeof(line), in) )
+	{
+		size_t n = strlen( line );
+		if( n == 0 || line[n - 1] != '\n' )
+			break;
+
+		char key[512];
+		char view[512];
+		Segment segment;
+
+		switch( line[0] )
+		{
+		case 'S':
+			if( sscanf(line, "S %511s %ld %ld %ld", key, &segment.offset, &segment.length, &segment.rawLength) == 4
+				&& segment.offset + segment.length <= dataLength )
+			{
+				records[key].segments.push_back( segment );
+			}
+			break;
+		case 'E':
+			if( sscanf(line, "E %511s", key) == 1 )
+				records[key].complete = true;
+			break;
+		case 'V':
+			if( sscanf(line, "V %511s %511s", view, key) == 2 )
+				views[view].push_back( key );
+			break;
+		default:
+			break;
+		}
+	}
+
+	fclose( in );
+
+	return true;
+}
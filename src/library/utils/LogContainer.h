@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//===========================================================================
+// LogContainer
+//
+// Holds what would otherwise be one small file per agent (e.g. the
+// brainFunction, anatomy, or position logs) in a single append-only file,
+// so a run doesn't create hundreds of thousands of files.
+//
+// Each record (e.g. an agent's brainFunction log) is named by a key without
+// spaces, and is written as one or more segments, possibly interleaved with
+// other records' segments, so many agents can be logged at once. Segments are
+// zlib compressed if the container was created with compress.
+//
+// <path> holds the segments, and <path>.index, a text file, where they are:
+//
+//   S <key> <offset> <length> <rawLength>   a segment
+//   E <key>                                 the record is complete
+//   V <view> <key>                          key is in view, e.g. Recent/3
+//
+// Views stand in for the Recent/, bestRecent/ and bestSoFar/ directories of
+// links; their keys are in the order they were added.
+//
+// Records are opened through AbstractFile with a path of the form
+// <path>#<key>, e.g. run/brain/function.pwlog#42.
+//===========================================================================
+class LogContainer
+{
+ public:
+	// Creates path, replacing any earlier container there, and registers it so
+	// records can be read back while it's being written.
+	static LogContainer *create( const std::string &path, bool compress );
+	// The registered container at path, or else path opened for reading (and
+	// then registered). NULL if there's none.
+	static LogContainer *get( const std::string &path );
+
+	~LogContainer();
+
+	// path#key
+	static std::string recordPath( const std::string &path, const std::string &key );
+	static bool splitRecordPath( const char *recordPath, std::string &path, std::string &key );
+	std::string getRecordPath( const std::string &key ) { return recordPath( path, key ); }
+
+	// Whether it was created, rather than opened for reading.
+	bool isWritable() { return writing; }
+
+	// Adds key's record, empty, so it exists while its segments are pending.
+	void begin( const std::string &key );
+	void append( const std::string &key, const void *data, size_t length );
+	void end( const std::string &key );
+	void addView( const std::string &view, const std::string &key );
+
+	bool exists( const std::string &key );
+	bool isComplete( const std::string &key );
+	bool read( const std::string &key, std::string &data );
+	std::vector<std::string> getView( const std::string &view );
+
+ private:
+	struct Segment
+	{
+		long offset;
+		long length;
+		long rawLength;
+	};
+	struct Record
+	{
+		Record() : complete( false ) {}
+
+		std::vector<Segment> segments;
+		bool complete;
+	};
+
+	LogContainer( const std::string &path, bool write, bool compress );
+	bool loadIndex();
+
+	typedef std::map<std::string, LogContainer *> Registry;
+	static Registry registry;
+	static std::mutex registryMutex;
+
+	std::string path;
+	bool writing;
+	bool compress;
+	FILE *data;
+	FILE *index;
+	std::map<std::string, Record> records;
+	std::map< std::string, std::vector<std::string> > views;
+	std::mutex mutex;
+};
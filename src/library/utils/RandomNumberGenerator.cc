@@ -5,6 +5,7 @@
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_rng.h>
 
+#include "CheckPoint.h"
 #include "misc.h"
 
 RandomNumberGenerator::Type RandomNumberGenerator::types[];
@@ -106,7 +107,7 @@ double RandomNumberGenerator::drand()
 	case LOCAL:
 		return gsl_rng_uniform( (gsl_rng *)state );
 	case GLOBAL:
-		return drand48();
+		return randpw();
 	default:
 		assert( false );
 	}
@@ -132,3 +133,29 @@ double RandomNumberGenerator::range( double lo,
 				   lo,
 				   hi );
 }
+
+void RandomNumberGenerator::dump( CheckPointWriter &out )
+{
+	out.put( (int32_t)type );
+
+	if( type == LOCAL )
+	{
+		gsl_rng *rng = (gsl_rng *)state;
+		out.put( (uint64_t)gsl_rng_size(rng) );
+		out.putBytes( gsl_rng_state(rng), gsl_rng_size(rng) );
+	}
+}
+
+void RandomNumberGenerator::load( CheckPointReader &in )
+{
+	if( in.get<int32_t>() != type )
+		in.fail( "random number generator type mismatch" );
+
+	if( type == LOCAL )
+	{
+		gsl_rng *rng = (gsl_rng *)state;
+		if( in.get<uint64_t>() != gsl_rng_size(rng) )
+			in.fail( "random number generator size mismatch" );
+		in.getBytes( gsl_rng_state(rng), gsl_rng_size(rng) );
+	}
+}
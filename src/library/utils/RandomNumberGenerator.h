@@ -1,5 +1,8 @@
 #pragma once
 
+class CheckPointReader;
+class CheckPointWriter;
+
 namespace __RandomNumberGenerator
 {
 	class ModuleInit;
@@ -58,6 +61,11 @@ class RandomNumberGenerator
 	double range( double lo,
 				  double hi );
 
+	// Only LOCAL generators have state of their own; the GLOBAL stream is
+	// saved with getGlobalRandomState().
+	void dump( CheckPointWriter &out );
+	void load( CheckPointReader &in );
+
  private:
 	Type type;
 	void *state;
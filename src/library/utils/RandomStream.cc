@@ -0,0 +1,153 @@
+#include "RandomStream.h"
+
+#include <math.h>
+
+bool RandomStream::enabled = false;
+uint64_t RandomStream::seed = 0;
+thread_local RandomStream *RandomStream::currentStream = NULL;
+
+//---------------------------------------------------------------------------
+// philox4x32_10
+//
+// Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC '11).
+//---------------------------------------------------------------------------
+static void philox4x32_10( const uint32_t in[4], const uint32_t inKey[2], uint32_t out[4] )
+{
+	const uint32_t M0 = 0xD2511F53;
+	const uint32_t M1 = 0xCD9E8D57;
+	const uint32_t W0 = 0x9E3779B9;
+	const uint32_t W1 = 0xBB67AE85;
+
+	uint32_t c0 = in[0], c1 = in[1], c2 = in[2], c3 = in[3];
+	uint32_t k0 = inKey[0], k1 = inKey[1];
+
+	for( int round = 0; round < 10; round++ )
+	{
+		uint64_t p0 = (uint64_t)M0 * c0;
+		uint64_t p1 = (uint64_t)M1 * c2;
+
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t)p1;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t)p0;
+
+		k0 += W0;
+		k1 += W1;
+	}
+
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::setEnabled
+//---------------------------------------------------------------------------
+void RandomStream::setEnabled( bool enabled_ )
+{
+	enabled = enabled_;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::setSeed
+//---------------------------------------------------------------------------
+void RandomStream::setSeed( uint64_t seed_ )
+{
+	seed = seed_;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::RandomStream
+//
+// The mate's number selects the key, since the counter has no room left. An
+// odd multiplier maps each number to a different key, and no mate (0) leaves
+// the seed's key.
+//---------------------------------------------------------------------------
+RandomStream::RandomStream( long agentNumber, long step, Purpose purpose, long mateNumber )
+{
+	counter[0] = 0;	// block index
+	counter[1] = (uint32_t)agentNumber;
+	counter[2] = (uint32_t)step;
+	counter[3] = (uint32_t)purpose;
+
+	key[0] = (uint32_t)seed;
+	key[1] = (uint32_t)(seed >> 32) ^ ((uint32_t)mateNumber * 0x9E3779B9);
+
+	nused = 4;
+	haveSpare = false;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::drand
+//---------------------------------------------------------------------------
+double RandomStream::drand()
+{
+	if( nused == 4 )
+		generate();
+
+	// 53 random bits, as for a double in [0,1)
+	uint32_t hi = block[nused++] >> 5;
+	uint32_t lo = block[nused++] >> 6;
+
+	return (hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0);
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::nrand
+//
+// Marsaglia polar method, as for the global nrand().
+//---------------------------------------------------------------------------
+double RandomStream::nrand()
+{
+	if( haveSpare )
+	{
+		haveSpare = false;
+		return spare;
+	}
+
+	double u, v, s;
+	do
+	{
+		u = 2.0 * drand() - 1.0;
+		v = 2.0 * drand() - 1.0;
+		s = u * u + v * v;
+	} while( s == 0.0 || s >= 1.0 );
+
+	double c = sqrt( -2.0 * log(s) / s );
+	spare = c * v;
+	haveSpare = true;
+
+	return c * u;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::generate
+//---------------------------------------------------------------------------
+void RandomStream::generate()
+{
+	philox4x32_10( counter, key, block );
+	counter[0]++;
+	nused = 0;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::Scope::Scope
+//---------------------------------------------------------------------------
+RandomStream::Scope::Scope( long agentNumber, long step, Purpose purpose, long mateNumber )
+: stream( agentNumber, step, purpose, mateNumber )
+, prev( currentStream )
+, installed( enabled )
+{
+	if( installed )
+		currentStream = &stream;
+}
+
+//---------------------------------------------------------------------------
+// RandomStream::Scope::~Scope
+//---------------------------------------------------------------------------
+RandomStream::Scope::~Scope()
+{
+	if( installed )
+		currentStream = prev;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+//===========================================================================
+// RandomStream
+//
+// A counter-based (Philox4x32-10) stream of random numbers identified by
+// (simulation seed, agent number, step, purpose), plus the mate's number for
+// what two agents do together. Each stream is independent of all others and
+// of the order in which they are used, so work done in parallel draws the same
+// numbers however it happens to be scheduled.
+//
+// While a Scope is alive, randpw() and nrand() on its thread draw from the
+// Scope's stream instead of the global drand48() stream.
+//===========================================================================
+class RandomStream
+{
+ public:
+	enum Purpose
+	{
+		GROW = 1,
+		BRAIN,
+		BRAIN_ANALYSIS,
+		GENOME,		// crossover, mutation, random or seed genomes
+		BIRTH		// where a new agent is placed
+	};
+
+	class Scope;
+
+	// Scopes have no effect unless enabled.
+	static void setEnabled( bool enabled );
+	static void setSeed( uint64_t seed );
+	static RandomStream *current() { return currentStream; }
+
+	RandomStream( long agentNumber, long step, Purpose purpose, long mateNumber = 0 );
+
+	double drand();	// uniform in [0,1)
+	double nrand();	// standard normal
+
+ private:
+	void generate();
+
+	uint32_t counter[4];
+	uint32_t key[2];
+	uint32_t block[4];
+	int nused;
+	bool haveSpare;
+	double spare;
+
+	static bool enabled;
+	static uint64_t seed;
+	static thread_local RandomStream *currentStream;
+};
+
+class RandomStream::Scope
+{
+ public:
+	Scope( long agentNumber, long step, Purpose purpose, long mateNumber = 0 );
+	~Scope();
+
+ private:
+	RandomStream stream;
+	RandomStream *prev;
+	bool installed;
+};
@@ -0,0 +1,298 @@
+#include "SpatialGrid.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "graphics/gobject.h"
+
+using namespace std;
+
+
+//---------------------------------------------------------------------------
+// SpatialGrid::SpatialGrid
+//---------------------------------------------------------------------------
+SpatialGrid::SpatialGrid()
+: fWorldSize( 0.0f )
+, fCellSize( 0.0f )
+, fMaxRadius( 0.0f )
+, fNumCells( 0 )
+, fVersion( 1 )
+{
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::init
+//
+// Discards all entries.
+//---------------------------------------------------------------------------
+void SpatialGrid::init( float worldsize, float cellSize, float maxRadius )
+{
+	assert( worldsize > 0.0f && cellSize > 0.0f );
+
+	fWorldSize = worldsize;
+	fCellSize = cellSize;
+	fMaxRadius = maxRadius;
+	fNumCells = max( 1, (int)ceil(worldsize / cellSize) );
+
+	clear();
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::clear
+//---------------------------------------------------------------------------
+void SpatialGrid::clear()
+{
+	for( Entry &e : fEntries )
+		if( e.obj )
+			e.obj->gridSlot = -1;
+
+	fCells.assign( fNumCells * fNumCells, -1 );
+	fEntries.clear();
+	fFreeSlots.clear();
+	fVersion++;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::add
+//---------------------------------------------------------------------------
+void SpatialGrid::add( gobject *obj, double order )
+{
+	assert( isInitialized() && obj->gridSlot < 0 );
+
+	int slot;
+	if( fFreeSlots.empty() )
+	{
+		slot = (int)fEntries.size();
+		fEntries.push_back( Entry() );
+	}
+	else
+	{
+		slot = fFreeSlots.back();
+		fFreeSlots.pop_back();
+	}
+
+	Entry &e = fEntries[slot];
+	e.obj = obj;
+	e.order = order;
+	e.type = obj->getType();
+	obj->gridSlot = slot;
+
+	link( slot, cellIndex(obj->x(), obj->z()) );
+
+	growMaxRadius( obj->radius() );
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::remove
+//---------------------------------------------------------------------------
+void SpatialGrid::remove( gobject *obj )
+{
+	int slot = obj->gridSlot;
+	if( slot < 0 )
+		return;
+
+	unlink( slot );
+
+	Entry &e = fEntries[slot];
+	e.obj = NULL;
+	e.type = 0;
+	obj->gridSlot = -1;
+	fFreeSlots.push_back( slot );
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::update
+//---------------------------------------------------------------------------
+void SpatialGrid::update( gobject *obj )
+{
+	int slot = obj->gridSlot;
+	if( slot < 0 )
+		return;
+
+	int cell = cellIndex( obj->x(), obj->z() );
+	if( cell != fEntries[slot].cell )
+	{
+		unlink( slot );
+		link( slot, cell );
+	}
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::growMaxRadius
+//---------------------------------------------------------------------------
+void SpatialGrid::growMaxRadius( float radius )
+{
+	if( radius > fMaxRadius )
+		fMaxRadius = radius;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::getOrder
+//---------------------------------------------------------------------------
+double SpatialGrid::getOrder( gobject *obj )
+{
+	assert( obj->gridSlot >= 0 );
+
+	return fEntries[obj->gridSlot].order;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::find
+//---------------------------------------------------------------------------
+bool SpatialGrid::find( Query &query, bool forward, gobject **obj )
+{
+	float xmin = query.xmin - fMaxRadius;
+	float xmax = query.xmax + fMaxRadius;
+	float zmin = query.zmin - fMaxRadius;
+	float zmax = query.zmax + fMaxRadius;
+
+	int col0, col1, row0, row1;
+	cellRange( xmin, xmax, &col0, &col1 );
+	cellRange( -zmax, -zmin, &row0, &row1 );
+
+	if( (query.version != fVersion) || (query.candidateType != query.objType)
+		|| (query.col0 != col0) || (query.col1 != col1) || (query.row0 != row0) || (query.row1 != row1) )
+	{
+		findCandidates( query, col0, col1, row0, row1 );
+	}
+
+	// Positions are checked now rather than when the candidates were found,
+	// since objects may move within their cells between calls.
+	auto isNear = [=]( const Query::Candidate &cand )
+	{
+		float x = cand.obj->x();
+		float z = cand.obj->z();
+		return (x >= xmin) && (x <= xmax) && (z >= zmin) && (z <= zmax);
+	};
+	auto byOrder = []( const Query::Candidate &cand, double order ) { return cand.order < order; };
+	auto orderBefore = []( double order, const Query::Candidate &cand ) { return order < cand.order; };
+
+	const Query::Candidate *best = NULL;
+	const Query::Candidate *begin = query.candidates.data();
+	const Query::Candidate *end = begin + query.candidates.size();
+
+	if( forward )
+	{
+		for( const Query::Candidate *cand = upper_bound(begin, end, query.order, orderBefore); cand < end; cand++ )
+		{
+			if( isNear(*cand) )
+			{
+				best = cand;
+				break;
+			}
+		}
+	}
+	else
+	{
+		for( const Query::Candidate *cand = lower_bound(begin, end, query.order, byOrder); cand > begin; cand-- )
+		{
+			if( isNear(cand[-1]) )
+			{
+				best = cand - 1;
+				break;
+			}
+		}
+	}
+
+	if( !best )
+		return false;
+
+	query.order = best->order;
+	*obj = best->obj;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::findCandidates
+//---------------------------------------------------------------------------
+void SpatialGrid::findCandidates( Query &query, int col0, int col1, int row0, int row1 )
+{
+	query.candidates.clear();
+
+	for( int row = row0; row <= row1; row++ )
+	{
+		for( int col = col0; col <= col1; col++ )
+		{
+			for( int slot = fCells[row * fNumCells + col]; slot >= 0; slot = fEntries[slot].next )
+			{
+				const Entry &e = fEntries[slot];
+
+				if( e.type & query.objType )
+					query.candidates.push_back( {e.order, e.obj} );
+			}
+		}
+	}
+
+	sort( query.candidates.begin(), query.candidates.end(),
+		  []( const Query::Candidate &a, const Query::Candidate &b ) { return a.order < b.order; } );
+
+	query.version = fVersion;
+	query.candidateType = query.objType;
+	query.col0 = col0;
+	query.col1 = col1;
+	query.row0 = row0;
+	query.row1 = row1;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::cellIndex
+//---------------------------------------------------------------------------
+int SpatialGrid::cellIndex( float x, float z )
+{
+	int col, row, unused;
+	cellRange( x, x, &col, &unused );
+	cellRange( -z, -z, &row, &unused );
+
+	return row * fNumCells + col;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::cellRange
+//
+// Cells spanned by [min,max] along one axis, clamped to the grid.
+//---------------------------------------------------------------------------
+void SpatialGrid::cellRange( float min, float max, int *lo, int *hi )
+{
+	float last = fNumCells - 1;
+
+	*lo = (int)fmin( last, fmax(0.0f, floorf(min / fCellSize)) );
+	*hi = (int)fmin( last, fmax(0.0f, floorf(max / fCellSize)) );
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::link
+//---------------------------------------------------------------------------
+void SpatialGrid::link( int slot, int cell )
+{
+	Entry &e = fEntries[slot];
+	int head = fCells[cell];
+
+	e.cell = cell;
+	e.prev = -1;
+	e.next = head;
+	if( head >= 0 )
+		fEntries[head].prev = slot;
+	fCells[cell] = slot;
+
+	fVersion++;
+}
+
+//---------------------------------------------------------------------------
+// SpatialGrid::unlink
+//---------------------------------------------------------------------------
+void SpatialGrid::unlink( int slot )
+{
+	Entry &e = fEntries[slot];
+
+	if( e.prev >= 0 )
+		fEntries[e.prev].next = e.next;
+	else
+		fCells[e.cell] = e.next;
+	if( e.next >= 0 )
+		fEntries[e.next].prev = e.prev;
+
+	fVersion++;
+}
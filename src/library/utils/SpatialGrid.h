@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+class gobject;
+
+//===========================================================================
+// SpatialGrid
+//
+// A uniform grid of square cells covering the world (x in [0,worldsize],
+// z in [-worldsize,0]). Each cell holds a linked list of the objects whose
+// centers lie in it; objects outside the world are kept in the edge cells.
+//
+// Every object also carries an order key supplied by the owner (see
+// objectxsortedlist), so a query can visit its neighbors in the same order
+// that a scan of the owning list would.
+//===========================================================================
+class SpatialGrid
+{
+ public:
+	struct Query
+	{
+		Query() : version( 0 ) {}
+
+		int objType;
+		float xmin, xmax;
+		float zmin, zmax;
+		double order;	// position in the owner's list; advanced by find()
+
+	 private:
+		friend class SpatialGrid;
+
+		struct Candidate
+		{
+			double order;
+			gobject *obj;
+		};
+
+		// The objects of type objType in the cells searched, sorted by order,
+		// as of the grid's version. find() rebuilds them when either changes.
+		std::vector<Candidate> candidates;
+		unsigned long version;
+		int candidateType;
+		int col0, col1, row0, row1;
+	};
+
+	SpatialGrid();
+
+	void init( float worldsize, float cellSize, float maxRadius );
+	bool isInitialized() { return fCellSize > 0.0f; }
+	float getCellSize() { return fCellSize; }
+
+	void clear();
+	void add( gobject *obj, double order );
+	void remove( gobject *obj );
+	void update( gobject *obj );	// object may have moved to another cell
+	void growMaxRadius( float radius );
+
+	double getOrder( gobject *obj );
+
+	// Finds the object of type query.objType with the nearest order key after
+	// (forward) or before (!forward) query.order that may overlap the query
+	// box, and advances query.order to it. Objects added or removed between
+	// calls are taken into account, so this may be used like a list cursor.
+	// The query keeps its candidates sorted between calls, so walking k
+	// objects costs O(k log k) rather than a rescan of the cells per call.
+	bool find( Query &query, bool forward, gobject **obj );
+
+ private:
+	struct Entry
+	{
+		gobject *obj;
+		double order;
+		int type;
+		int cell;
+		int prev;
+		int next;
+	};
+
+	int cellIndex( float x, float z );
+	void cellRange( float min, float max, int *lo, int *hi );
+	void link( int slot, int cell );
+	void unlink( int slot );
+	void findCandidates( Query &query, int col0, int col1, int row0, int row1 );
+
+	float fWorldSize;
+	float fCellSize;
+	float fMaxRadius;
+	int fNumCells;	// per side
+	std::vector<int> fCells;	// head slot of each cell, or -1
+	std::vector<Entry> fEntries;
+	std::vector<int> fFreeSlots;
+	unsigned long fVersion;	// bumped whenever a cell's objects change
+};
@@ -1,151 +1,389 @@
 #include "ThreadPool.h"
 
+#include <assert.h>
+
 using namespace std;
 
 ThreadPool::ThreadPool(unsigned max_threads)
     : _max_threads(max_threads)
-    , _waiting_threads(0)
+    , _started(false)
     , _destructing(false)
-    , _joining(false)
+    , _next_queue(0)
+    , _queued(0)
+    , _unfinished(0)
+    , _sleeping(0)
+    , _timing(false)
+    , _wait_nanos(0)
 {
+    alloc_times();
 }
 
 ThreadPool::~ThreadPool()
 {
     join();
+    stop();
+}
 
+void ThreadPool::set_max_threads(unsigned max_threads)
+{
+    assert(_unfinished == 0);
+
+    if(max_threads != _max_threads)
     {
-        unique_lock<mutex> lock(_mutex);
+        stop();
+        _max_threads = max_threads;
+        alloc_times();
+    }
+}
 
-        _destructing = true;
-        _cv_tasks.notify_all(); // wake up threads
+void ThreadPool::schedule(Task task)
+{
+    push(move(task));
+    notify(1);
+}
+
+void ThreadPool::schedule_range(size_t n, size_t grain, RangeTask task)
+{
+    if(n == 0)
+    {
+        return;
     }
 
-    for(unsigned i = 0; i < _threads.size(); i++)
+    if(grain == 0)
     {
-        _threads[i]->wait_exit();
+        grain = default_grain(n);
     }
+
+    auto shared_task = make_shared<RangeTask>(move(task));
+    size_t nchunks = 0;
+    for(size_t begin = 0; begin < n; begin += grain)
+    {
+        size_t end = min(n, begin + grain);
+        push([shared_task, begin, end]() { (*shared_task)(begin, end); });
+        nchunks++;
+    }
+    notify(nchunks);
 }
 
-void ThreadPool::join()
+void ThreadPool::run_range(size_t n, size_t grain, RangeTask task)
 {
-    // Help clear the queue
-    while(true)
+    if(n == 0)
+    {
+        return;
+    }
+
+    if(grain == 0)
+    {
+        grain = default_grain(n);
+    }
+
+    // Chunks are claimed from a shared counter rather than queued, so the
+    // calling thread can't end up waiting on a chunk that no thread has
+    // started. Helpers that arrive after everything is claimed do nothing.
+    struct Batch
     {
-        Task task;
-        bool have_task = false;
+        RangeTask task;
+        size_t n;
+        size_t grain;
+        size_t nchunks;
+        atomic<size_t> next;
+        atomic<size_t> done;
+        std::mutex done_mutex;
+        condition_variable done_cv;
+
+        void work()
         {
-            unique_lock<mutex> lock(_mutex);
-            if(_tasks.size() > 0)
+            size_t chunk;
+            while((chunk = next++) < nchunks)
             {
-                task = _tasks.front();
-                _tasks.pop_front();
-                have_task = true;
-            }
-            else
-            {
-                if(_waiting_threads < _threads.size()) {
-                    _joining = true;
+                size_t begin = chunk * grain;
+                task(begin, min(n, begin + grain));
+
+                if(++done == nchunks)
+                {
+                    lock_guard<std::mutex> lock(done_mutex);
+                    done_cv.notify_all();
                 }
             }
         }
+    };
 
-        if(have_task)
-        {
-            task();
-        }
-        else
-        {
-            break;
-        }
+    auto batch = make_shared<Batch>();
+    batch->task = move(task);
+    batch->n = n;
+    batch->grain = grain;
+    batch->nchunks = (n + grain - 1) / grain;
+    batch->next = 0;
+    batch->done = 0;
+
+    size_t nhelpers = min<size_t>(_max_threads, batch->nchunks - 1);
+    for(size_t i = 0; i < nhelpers; i++)
+    {
+        push([batch]() { batch->work(); });
     }
+    notify(nhelpers);
+
+    batch->work();
 
-    if(_joining)
+    Clock::time_point wait_start;
+    if(_timing)
     {
-        unique_lock<mutex> lock(_mutex);
+        wait_start = Clock::now();
+    }
+
+    {
+        unique_lock<std::mutex> lock(batch->done_mutex);
+        batch->done_cv.wait(lock, [&batch]() {
+                return batch->done == batch->nchunks;
+            });
+    }
+
+    if(_timing)
+    {
+        _wait_nanos += elapsed_nanos(wait_start);
+    }
+}
+
+void ThreadPool::join()
+{
+    // Help clear the queues
+    Task task;
+    while(_started && steal(_max_threads, task))
+    {
+        task();
+        task = nullptr;
+        finish();
+    }
 
+    Clock::time_point wait_start;
+    if(_timing)
+    {
+        wait_start = Clock::now();
+    }
+
+    {
+        unique_lock<mutex> lock(_mutex);
         _cv_join.wait(lock, [=]() {
-                return (_waiting_threads == _threads.size()) && (_tasks.size() == 0);
+                return _unfinished == 0;
             });
+    }
 
-        _joining = false;
+    if(_timing)
+    {
+        _wait_nanos += elapsed_nanos(wait_start);
     }
 }
 
-void ThreadPool::schedule(Task task)
+size_t ThreadPool::default_grain(size_t n) const
 {
+    // A few chunks per thread, so stealing can even out the load.
+    return max<size_t>(1, n / (4 * (_max_threads + 1)));
+}
+
+vector<double> ThreadPool::busy_times() const
+{
+    vector<double> times(_max_threads);
+    for(unsigned i = 0; i < _max_threads; i++)
+    {
+        times[i] = _busy_nanos[i] * 1e-9;
+    }
+    return times;
+}
+
+double ThreadPool::wait_time() const
+{
+    return _wait_nanos * 1e-9;
+}
+
+void ThreadPool::reset_times()
+{
+    assert(_unfinished == 0);
+
+    for(unsigned i = 0; i < _max_threads; i++)
+    {
+        _busy_nanos[i] = 0;
+    }
+    _wait_nanos = 0;
+}
+
+void ThreadPool::start()
+{
+    _queues.clear();
+    for(unsigned i = 0; i <= _max_threads; i++)
+    {
+        _queues.emplace_back(unique_ptr<Queue>(new Queue()));
+    }
+
+    _destructing = false;
+    for(unsigned i = 0; i < _max_threads; i++)
+    {
+        _threads.emplace_back([this, i]() { run(i); });
+    }
+
+    _started = true;
+}
+
+void ThreadPool::stop()
+{
+    if(!_started)
+    {
+        return;
+    }
+
     {
         unique_lock<mutex> lock(_mutex);
 
-        _tasks.emplace_back(task);
+        _destructing = true;
+        _cv_tasks.notify_all(); // wake up threads
+    }
+
+    for(thread &t: _threads)
+    {
+        t.join();
+    }
+    _threads.clear();
+
+    _started = false;
+}
 
-        if(_waiting_threads == 0)
+void ThreadPool::push(Task &&task)
+{
+    if(!_started)
+    {
+        start();
+    }
+
+    // Deal tasks out to the helper threads' deques. With no helpers, they
+    // wait in join()'s deque.
+    unsigned index = _max_threads;
+    if(_max_threads > 0)
+    {
+        index = _next_queue;
+        _next_queue = (_next_queue + 1) % _max_threads;
+    }
+
+    // Count the task first, so it can't be finished before it's counted.
+    ++_unfinished;
+    ++_queued;
+
+    Queue &queue = *_queues[index];
+    lock_guard<mutex> lock(queue.mutex);
+    queue.tasks.emplace_back(move(task));
+}
+
+void ThreadPool::notify(size_t ntasks)
+{
+    // A thread going to sleep increments _sleeping before it checks _queued,
+    // so if it is missed here it will see the new tasks.
+    if(_sleeping > 0)
+    {
+        lock_guard<mutex> lock(_mutex);
+
+        if(ntasks == 1)
         {
-            if(_threads.size() < _max_threads)
-            {
-                // Spawn a new thread.
-                _threads.emplace_back(unique_ptr<Thread>(new Thread(*this)));
-            }
+            _cv_tasks.notify_one();
         }
         else
         {
-            _cv_tasks.notify_one();
+            _cv_tasks.notify_all();
         }
     }
 }
 
-ThreadPool::Thread::Thread(ThreadPool &pool)
-    : _pool(pool)
-    , _systhread([this](){ run(); })
+bool ThreadPool::pop(unsigned index, Task &task)
 {
+    Queue &queue = *_queues[index];
+    lock_guard<mutex> lock(queue.mutex);
+
+    if(queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --_queued;
+    return true;
 }
 
-void ThreadPool::Thread::wait_exit()
+bool ThreadPool::steal(unsigned thief, Task &task)
 {
-    _systhread.join();
+    unsigned nqueues = _queues.size();
+    for(unsigned i = 0; (i < nqueues) && (_queued > 0); i++)
+    {
+        Queue &queue = *_queues[(thief + i) % nqueues];
+        lock_guard<mutex> lock(queue.mutex);
+
+        if(!queue.tasks.empty())
+        {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --_queued;
+            return true;
+        }
+    }
+
+    return false;
 }
 
-bool ThreadPool::Thread::wait_for_task(Task &task)
+void ThreadPool::finish()
 {
+    if(--_unfinished == 0)
     {
-        unique_lock<mutex> lock(_pool._mutex);
+        lock_guard<mutex> lock(_mutex);
+        _cv_join.notify_all();
+    }
+}
 
-        while(true)
+void ThreadPool::run(unsigned index)
+{
+    Task task;
+
+    while(true)
+    {
+        if(pop(index, task) || steal(index + 1, task))
         {
-            if(_pool._tasks.size() > 0)
-            {
-                task = _pool._tasks.front();
-                _pool._tasks.pop_front();
-                return true;
-            }
-            else if(_pool._destructing)
+            if(_timing)
             {
-                return false;
+                Clock::time_point start = Clock::now();
+                task();
+                _busy_nanos[index] += elapsed_nanos(start);
             }
             else
             {
-                ++_pool._waiting_threads;
+                task();
+            }
+            task = nullptr;
+            finish();
+            continue;
+        }
 
-                if( _pool._joining && (_pool._waiting_threads == _pool._threads.size()) )
-                {
-                    _pool._cv_join.notify_one();
-                }
+        unique_lock<mutex> lock(_mutex);
 
-                _pool._cv_tasks.wait( lock, [=]() {
-                        return _pool._destructing || (_pool._tasks.size() > 0);
-                    } );
+        ++_sleeping;
+        _cv_tasks.wait(lock, [=]() {
+                return _destructing || (_queued > 0);
+            });
+        --_sleeping;
 
-                --_pool._waiting_threads;
-            }
+        if(_destructing)
+        {
+            return;
         }
     }
 }
 
-void ThreadPool::Thread::run()
+void ThreadPool::alloc_times()
 {
-    Task task;
-    while( wait_for_task(task) )
+    _busy_nanos.reset(new atomic<uint64_t>[_max_threads]);
+    for(unsigned i = 0; i < _max_threads; i++)
     {
-        task();
+        _busy_nanos[i] = 0;
     }
+    _wait_nanos = 0;
+}
+
+uint64_t ThreadPool::elapsed_nanos(Clock::time_point start)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
 }
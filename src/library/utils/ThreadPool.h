@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
@@ -8,40 +10,84 @@
 #include <thread>
 #include <vector>
 
+// Each helper thread owns a deque of tasks. Scheduled tasks are dealt out
+// among the deques; a thread works from the back of its own deque and, when
+// that is empty, steals from the front of the others'. The thread calling
+// join() helps out the same way until all tasks are done.
+//
+// schedule() and schedule_range() must all be called from one thread (in
+// practice, the thread that calls join()).
 class ThreadPool
 {
 public:
     typedef std::function<void()> Task;
+    typedef std::function<void(size_t begin, size_t end)> RangeTask;
 
     ThreadPool(unsigned max_threads);
     ~ThreadPool();
 
+    // May only be called while no tasks are pending.
+    void set_max_threads(unsigned max_threads);
+    unsigned get_max_threads() const { return _max_threads; }
+
     void schedule(Task task);
+    // Split [0, n) into chunks of at most grain items (0 to pick a size from
+    // the thread count) and schedule task once per chunk.
+    void schedule_range(size_t n, size_t grain, RangeTask task);
+    // Like schedule_range(), but the calling thread works on the chunks too,
+    // and returns as soon as they (and only they) are all done.
+    void run_range(size_t n, size_t grain, RangeTask task);
     void join();
 
-private:
-    unsigned _max_threads;
-    unsigned _waiting_threads;
-    bool _destructing;
-    bool _joining;
+    // The chunk size schedule_range() and run_range() use for grain 0.
+    size_t default_grain(size_t n) const;
+
+    // Thread timing, off by default. busy_times() has one entry per helper
+    // thread: the seconds it spent running tasks. wait_time() is the seconds
+    // the calling thread spent blocked in join() or run_range() waiting for
+    // the helpers. Both accumulate until reset_times(), which may only be
+    // called while no tasks are pending.
+    void set_timing(bool timing) { _timing = timing; }
+    std::vector<double> busy_times() const;
+    double wait_time() const;
+    void reset_times();
 
-    class Thread
+private:
+    struct Queue
     {
-    public:
-        Thread(ThreadPool &pool);
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
 
-        void wait_exit();
+    void start();
+    void stop();
+    void push(Task &&task);
+    void notify(size_t ntasks);
+    bool pop(unsigned queue, Task &task);
+    bool steal(unsigned thief, Task &task);
+    void finish();
+    void run(unsigned index);
+    void alloc_times();
 
-    private:
-        void run();
-        bool wait_for_task(Task &task);
+    typedef std::chrono::steady_clock Clock;
+    static uint64_t elapsed_nanos(Clock::time_point start);
 
-        ThreadPool &_pool;
-        std::thread _systhread;
-    };
+    unsigned _max_threads;
+    bool _started;
+    bool _destructing;
+    unsigned _next_queue;
+
+    std::atomic<size_t> _queued;        // tasks waiting in a deque
+    std::atomic<size_t> _unfinished;    // tasks queued or running
+    std::atomic<unsigned> _sleeping;
+
+    bool _timing;
+    std::unique_ptr<std::atomic<uint64_t>[]> _busy_nanos; // one per helper thread
+    std::atomic<uint64_t> _wait_nanos;
 
-    std::deque<Task> _tasks;
-    std::vector<std::unique_ptr<Thread>> _threads;
+    // One per thread, plus one (the last) for the thread calling join().
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
     std::mutex _mutex;
     std::condition_variable _cv_tasks;
     std::condition_variable _cv_join;
@@ -20,6 +20,7 @@
 #include "sim/globals.h"
 #include "utils/AbstractFile.h"
 #include "utils/datalib.h"
+#include "utils/LogContainer.h"
 #include "utils/misc.h"
 
 void analysis::Vector::add(Vector& addend1, Vector& addend2, Vector& sum) {
@@ -130,7 +131,16 @@ genome::Genome* analysis::getGenome(const std::string& run, int agent) {
 }
 
 AbstractFile* analysis::getSynapses(const std::string& run, int agent, const std::string& stage) {
-    std::string path = run + "/brain/synapses/synapses_" + std::to_string(agent) + "_" + stage + ".txt";
+    std::string key = std::to_string(agent) + "_" + stage;
+    LogContainer* container = LogContainer::get(run + "/brain/synapses.pwlog");
+    if (container != NULL) {
+        if (container->exists(key)) {
+            return AbstractFile::open(container->getRecordPath(key).c_str(), "r");
+        } else {
+            return NULL;
+        }
+    }
+    std::string path = run + "/brain/synapses/synapses_" + key + ".txt";
     if (AbstractFile::exists(path.c_str())) {
         return AbstractFile::open(globals::recordFileType, path.c_str(), "r");
     } else {
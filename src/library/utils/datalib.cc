@@ -2,6 +2,8 @@
 
 #include <stdlib.h>
 
+#include "AbstractFile.h"
+
 using namespace datalib;
 using namespace std;
 #if __cplusplus >= 201103L
@@ -111,12 +113,19 @@ DataLibWriter::DataLibWriter( const char *path,
 : randomAccess( _randomAccess )
 , singleSchema( _singleSchema )
 {
-	f = fopen( path, "wb" );
-	if( ! f )
+	// AbstractFile waits forever on a failed open, so fail here instead.
+	if( !AbstractFile::isRecordPath(path) )
 	{
-		perror( path );
-		assert( f );
+		FILE *fp = fopen( path, "wb" );
+		if( ! fp )
+		{
+			perror( path );
+			assert( fp );
+			exit( 1 );
+		}
+		fclose( fp );
 	}
+	f = AbstractFile::open( AbstractFile::TYPE_FILE, path, "wb" );
 
 	table = NULL;
 
@@ -135,7 +144,7 @@ DataLibWriter::~DataLibWriter()
 
 	fileFooter();
 
-	fclose( f );
+	delete f;
 	f = NULL;
 }
 
@@ -181,7 +190,7 @@ void DataLibWriter::beginTable( const char *name,
 	tables.push_back( __Table(name) );
 	table = &tables.back();
 
-	table->offset = ftell( f );
+	table->offset = f->tell();
 
 	cols.clear();
 
@@ -203,7 +212,7 @@ void DataLibWriter::beginTable( const char *name,
 
 	tableHeader();
 
-	table->data = ftell( f );
+	table->data = f->tell();
 }
 
 // ------------------------------------------------------------
@@ -340,7 +349,7 @@ void DataLibWriter::addRow( Variant *colsdata )
 			assert( nwrite == table->rowlen );
 		}
 	}
-	size_t n = fwrite( buf, 1, nwrite, f );
+	size_t n = f->write( buf, 1, nwrite );
 	assert( n == nwrite );
 }
 
@@ -361,7 +370,7 @@ void DataLibWriter::endTable()
 // ------------------------------------------------------------
 void DataLibWriter::flush()
 {
-	fflush( f );
+	f->flush();
 }
 
 // ------------------------------------------------------------
@@ -369,10 +378,10 @@ void DataLibWriter::flush()
 // ------------------------------------------------------------
 void DataLibWriter::fileHeader()
 {
-	fprintf( f, SIGNATURE );
-	fprintf( f, VERSION_STR "%d\n", VERSION_WRITE );
-	fprintf( f, SCHEMA_STR "%s\n", singleSchema ? "single" : "table" );
-	fprintf( f, COLFORMAT_STR "%s\n", randomAccess ? "fixed" : "none" );
+	f->printf( SIGNATURE );
+	f->printf( VERSION_STR "%d\n", VERSION_WRITE );
+	f->printf( SCHEMA_STR "%s\n", singleSchema ? "single" : "table" );
+	f->printf( COLFORMAT_STR "%s\n", randomAccess ? "fixed" : "none" );
 }
 
 // ------------------------------------------------------------
@@ -380,27 +389,24 @@ void DataLibWriter::fileHeader()
 // ------------------------------------------------------------
 void DataLibWriter::fileFooter()
 {
-	size_t digest_start = ftell( f );
+	size_t digest_start = f->tell();
 
-	fprintf( f, "\n" );
-	fprintf( f, "#TABLES %zu\n", tables.size() );
+	f->printf( "\n" );
+	f->printf( "#TABLES %zu\n", tables.size() );
 
 	itfor( __TableVector, tables, it )
 	{
-		fprintf( f,
-				 "# %s %zu %zu %zu %zu\n",
-				 it->name.c_str(), it->offset, it->data, it->nrows, it->rowlen );
+		f->printf( "# %s %zu %zu %zu %zu\n",
+				   it->name.c_str(), it->offset, it->data, it->nrows, it->rowlen );
 	}
 
-	size_t digest_end = ftell( f );
+	size_t digest_end = f->tell();
 
-	fprintf( f,
-			 "#START %zu\n",
-			 digest_start );
+	f->printf( "#START %zu\n",
+			   digest_start );
 
-	fprintf( f,
-			 "#SIZE %zu",
-			 digest_end - digest_start );
+	f->printf( "#SIZE %zu",
+			   digest_end - digest_start );
 }
 
 // ------------------------------------------------------------
@@ -413,7 +419,7 @@ void DataLibWriter::tableHeader()
 		colMetaData();
 	}
 
-	fprintf( f, "\n#<%s>\n", table->name.c_str() );
+	f->printf( "\n#<%s>\n", table->name.c_str() );
 
 	if( !singleSchema )
 	{
@@ -426,7 +432,7 @@ void DataLibWriter::tableHeader()
 // ------------------------------------------------------------
 void DataLibWriter::tableFooter()
 {
-	fprintf( f, "#</%s>\n", table->name.c_str() );
+	f->printf( "#</%s>\n", table->name.c_str() );
 }
 
 // ------------------------------------------------------------
@@ -436,39 +442,39 @@ void DataLibWriter::colMetaData()
 {
 	if( singleSchema )
 	{
-		fprintf( f, "\n" );
+		f->printf( "\n" );
 	}
 
 	// ---
 	// --- colnames
 	// ---
-	fprintf( f, "#@L " );
+	f->printf( "#@L " );
 
 	itfor( __ColVector, cols, it )
 	{
-		fprintf( f, "%-20s", it->name.c_str() );
+		f->printf( "%-20s", it->name.c_str() );
 	}
-	fprintf( f, "\n" );
+	f->printf( "\n" );
 
 	if( !singleSchema )
 	{
-		fprintf( f, "#\n" );
+		f->printf( "#\n" );
 	}
 
 	// ---
 	// --- coltypes
 	// ---
-	fprintf( f, "#@T " );
+	f->printf( "#@T " );
 
 	itfor( __ColVector, cols, it )
 	{
-		fprintf( f, "%-20s", it->tname );
+		f->printf( "%-20s", it->tname );
 	}
-	fprintf( f, "\n" );
+	f->printf( "\n" );
 
 	if( !singleSchema )
 	{
-		fprintf( f, "#\n" );
+		f->printf( "#\n" );
 	}
 }
 
@@ -483,8 +489,12 @@ void DataLibWriter::colMetaData()
 // ------------------------------------------------------------
 DataLibReader::DataLibReader( const char *path )
 {
-	f = fopen( path, "rb" );
-	assert( f );
+	if( !AbstractFile::exists(path) )
+	{
+		fprintf( stderr, "No such datalib file: %s\n", path );
+		assert( false );
+	}
+	f = AbstractFile::open( AbstractFile::TYPE_FILE, path, "rb" );
 
 	table = NULL;
 	this->path = path;
@@ -498,7 +508,7 @@ DataLibReader::DataLibReader( const char *path )
 // ------------------------------------------------------------
 DataLibReader::~DataLibReader()
 {
-	fclose( f );
+	delete f;
 }
 
 // ------------------------------------------------------------
@@ -564,25 +574,22 @@ void DataLibReader::seekRow( int index )
 	char rowbuf[4096];
 	if( randomAccess )
 	{
-		SYS( fseek(f,
+		SYS( f->seek(
 				   table->data + ( index * table->rowlen ),
 				   SEEK_SET) );
-		size_t n = fread( rowbuf,
-						  1,
-						  table->rowlen,
-						  f );
+		size_t n = f->read( rowbuf, 1, table->rowlen );
 		assert( n == table->rowlen );
 	}
 	else
 	{
 		if( !next || index == 0 )
 		{
-			SYS( fseek( f, table->data, SEEK_SET ) );
+			SYS( f->seek( table->data, SEEK_SET ) );
 		}
 		int start = next ? index : 0;
 		for( int i = start; i <= index; i++ )
 		{
-			assert( fgets( rowbuf, sizeof(rowbuf), f ) != NULL );
+			assert( f->gets( rowbuf, sizeof(rowbuf) ) != NULL );
 			size_t n = strlen( rowbuf );
 			assert( rowbuf[n - 1] == '\n' );
 		}
@@ -677,7 +684,7 @@ void DataLibReader::parseHeader()
 {
 	char buf[128];
 
-	size_t n = fread( buf, 1, sizeof(buf) - 1, f );
+	size_t n = f->read( buf, 1, sizeof(buf) - 1 );
 	assert( n > 0 );
 
 	buf[n] = '\0';
@@ -727,12 +734,9 @@ void DataLibReader::parseDigest()
 	char buf[64];
 	size_t n = sizeof(buf) - 1;
 
-	SYS( fseek(f, -n, SEEK_END) );
+	SYS( f->seek( -n, SEEK_END) );
 
-	n = fread( buf,
-			   1,
-			   n,
-			   f );
+	n = f->read( buf, 1, n );
 	assert( n > 0 );
 	buf[n] = '\0';
 
@@ -756,12 +760,9 @@ void DataLibReader::parseDigest()
 	// --- Read digest
 	// ---
 	char digest[size + 1];
-	SYS( fseek(f, start, SEEK_SET) );
+	SYS( f->seek( start, SEEK_SET) );
 
-	n = fread( digest,
-			   1,
-			   size,
-			   f );
+	n = f->read( digest, 1, size );
 	assert( n == size );
 	digest[size] = '\0';
 
@@ -800,15 +801,12 @@ void DataLibReader::parseDigest()
 // ------------------------------------------------------------
 void DataLibReader::parseTableHeader()
 {
-	SYS( fseek(f,
+	SYS( f->seek(
 			   table->offset,
 			   SEEK_SET) );
 
 	char buf[1025];
-	size_t n = fread( buf,
-					  1,
-					  sizeof(buf) - 1,
-					  f );
+	size_t n = f->read( buf, 1, sizeof(buf) - 1 );
 	buf[n] = '\0';
 
 	char *line = buf;
@@ -125,7 +125,7 @@ class DataLibWriter
 	void colMetaData();
 
  private:
-	FILE *f;
+	class AbstractFile *f;
 	bool randomAccess;
 	bool singleSchema;
 	datalib::__TableVector tables;
@@ -167,7 +167,7 @@ class DataLibReader
 											 const char *end)> callback);
 
  private:
-	FILE *f;
+	class AbstractFile *f;
 	bool randomAccess;
 	bool singleSchema;
 	int row;
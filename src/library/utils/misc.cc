@@ -9,6 +9,9 @@
 // Self
 #include "misc.h"
 
+// Local
+#include "RandomStream.h"
+
 // System
 
 #ifdef __APPLE__
@@ -31,15 +34,52 @@
 
 using namespace std;
 
+double randpw()
+{
+	RandomStream *stream = RandomStream::current();
+	if( stream )
+		return stream->drand();
+
+	return drand48();
+}
+
+// The second of each pair of normals drawn by the global nrand()
+static bool nrandHaveSpare = false;
+static double nrandSpare;
+
+void getGlobalRandomState( GlobalRandomState *state )
+{
+	unsigned short current[3] = { 0, 0, 0 };
+	unsigned short *prev = seed48( current );
+	memcpy( state->xsubi, prev, sizeof(state->xsubi) );
+	seed48( state->xsubi );
+
+	state->haveSpare = nrandHaveSpare;
+	state->spare = nrandSpare;
+}
+
+void setGlobalRandomState( const GlobalRandomState &state )
+{
+	unsigned short xsubi[3];
+	memcpy( xsubi, state.xsubi, sizeof(xsubi) );
+	seed48( xsubi );
+
+	nrandHaveSpare = state.haveSpare;
+	nrandSpare = state.spare;
+}
+
 // https://en.wikipedia.org/wiki/Marsaglia_polar_method
 double nrand()
 {
-    static bool spare = false;
-    static double u, v, s, c;
-    if (spare)
+	RandomStream *stream = RandomStream::current();
+	if( stream )
+		return stream->nrand();
+
+    double u, v, s, c;
+    if (nrandHaveSpare)
     {
-        spare = false;
-        return c * v;
+        nrandHaveSpare = false;
+        return nrandSpare;
     }
     do
     {
@@ -48,7 +88,8 @@ double nrand()
         s = u * u + v * v;
     } while (s == 0.0 || s >= 1.0);
     c = sqrt(-2.0 * log(s) / s);
-    spare = true;
+    nrandSpare = c * v;
+    nrandHaveSpare = true;
     return c * u;
 }
 
@@ -37,7 +37,18 @@
 
 #define interp(x,ylo,yhi) ((ylo)+(x)*((yhi)-(ylo)))
 
-#define randpw() drand48()
+// Draws from the calling thread's RandomStream, if it has one, and otherwise
+// from the global drand48() stream.
+double randpw();
+// State of the global stream, for checkpoints
+struct GlobalRandomState
+{
+	unsigned short xsubi[3];	// drand48()
+	bool haveSpare;				// nrand()
+	double spare;
+};
+void getGlobalRandomState( GlobalRandomState *state );
+void setGlobalRandomState( const GlobalRandomState &state );
 #define rrand(lo,hi) (interp(randpw(),(lo),(hi)))
 double nrand();
 double nrand(double mean, double stdev);
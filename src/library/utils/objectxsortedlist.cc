@@ -10,6 +10,7 @@
 
 #include "objectxsortedlist.h"
 #include "agent/agent.h"
+#include "sim/globals.h"
 
 #define DebugCounts 0
 
@@ -163,7 +164,36 @@ void objectxsortedlist::add( gobject* a )
 
     if( !inserted )
 		a->listLink = this->append( a );
-    
+
+	added( a );
+
+#ifdef DEBUGCALLS
+    popproc();
+#endif // DEBUGCALLS
+
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::addLast
+//---------------------------------------------------------------------------
+// Add an object at the end of the list, wherever it is.  Used to rebuild a
+// list in an order that was saved (the list is only re-sorted once a step,
+// so that order needn't be sorted).
+void objectxsortedlist::addLast( gobject* a )
+{
+	a->listLink = this->append( a );
+
+	added( a );
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::added
+//---------------------------------------------------------------------------
+// Bookkeeping for an object just linked into the list
+void objectxsortedlist::added( gobject* a )
+{
     // Increase object type count based on added object's type
     switch( a->getType() )
 	{
@@ -184,10 +214,8 @@ void objectxsortedlist::add( gobject* a )
 			break;
     }
 
-#ifdef DEBUGCALLS
-    popproc();
-#endif // DEBUGCALLS
-
+	if( hasGrid() )
+		addToGrid( a );
 }
 
 
@@ -267,6 +295,9 @@ void objectxsortedlist::removeCurrentObject()
 				break;
 		}
 
+		if( hasGrid() )
+			grid.remove( o );
+
 		// Actually remove the object from the list
 		this->remove();
 		
@@ -354,6 +385,11 @@ void objectxsortedlist::sort()
 		p = o;
 		savecurr = currItem;
     }
+
+	// Rebuilding renumbers the grid in the new list order
+	if( hasGrid() )
+		initGrid();
+
 #ifdef DEBUGCALLS
     popproc();
 #endif // DEBUGCALLS
@@ -527,4 +563,150 @@ void objectxsortedlist::getMark( int objType, gobject* gob )
 }
 
 
+//---------------------------------------------------------------------------
+// objectxsortedlist::setSpatialIndex
+//---------------------------------------------------------------------------
+// A cellSize of 0 picks one from the largest possible object radius.
+// Must be called before any objects are added.
+void objectxsortedlist::setSpatialIndex( SpatialIndex index, float cellSize )
+{
+	assert( kount == 0 );
+
+	spatialIndex = index;
+	gridCellSize = cellSize;
+}
 
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::moved
+//---------------------------------------------------------------------------
+// Must be called after changing the position of an object in the list
+void objectxsortedlist::moved( gobject* o )
+{
+	if( hasGrid() )
+		grid.update( o );
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::nearQuery
+//---------------------------------------------------------------------------
+// Prepare a query for objects of the given type(s) that may overlap the box,
+// starting from object "from", which must be in the list.
+SpatialGrid::Query objectxsortedlist::nearQuery( gobject* from, int objType, float xmin, float xmax, float zmin, float zmax )
+{
+	assert( hasGrid() );
+
+	SpatialGrid::Query query;
+	query.objType = objType;
+	query.xmin = xmin;
+	query.xmax = xmax;
+	query.zmin = zmin;
+	query.zmax = zmax;
+	query.order = grid.getOrder( from );
+
+	return query;
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::nearObj
+//---------------------------------------------------------------------------
+// The grid counterpart of anotherObj(): gets the next (or previous) object in
+// list order that may overlap the query box, skipping everything that can't.
+// Does not move the list's current pointer or marks.
+int objectxsortedlist::nearObj( int direction, SpatialGrid::Query& query, gobject** g )
+{
+	if( direction == NEXT )
+		return grid.find( query, true, g );
+	else if( direction == PREV )
+		return grid.find( query, false, g );
+
+    // Error!  Should not get here.
+    printf( "%s: ERROR--Unknown direction (%d)\n", __func__, direction );
+    exit( 1 );
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::verifyNeighbors
+//---------------------------------------------------------------------------
+// Report it if the list and the grid disagree about the neighbors of o
+void objectxsortedlist::verifyNeighbors( const char* phase, long step, agent* o,
+										 const vector<gobject*>& listNeighbors,
+										 const vector<gobject*>& gridNeighbors )
+{
+	if( listNeighbors == gridNeighbors )
+		return;
+
+	auto print = []( const char* name, const vector<gobject*>& neighbors )
+		{
+			fprintf( stderr, "  %s:", name );
+			for( gobject* n : neighbors )
+			{
+				if( n->getType() == AGENTTYPE )
+					fprintf( stderr, " agent#%ld", ((agent*)n)->Number() );
+				else
+					fprintf( stderr, " %s@(%g,%g)", n->getType() == FOODTYPE ? "food" : "brick", n->x(), n->z() );
+			}
+			fprintf( stderr, "\n" );
+		};
+
+	fprintf( stderr, "SpatialIndex mismatch in %s at step %ld for agent #%ld at (%g,%g):\n",
+			 phase, step, ((agent*)o)->Number(), o->x(), o->z() );
+	print( "list", listNeighbors );
+	print( "grid", gridNeighbors );
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::initGrid
+//---------------------------------------------------------------------------
+// (Re)build the grid from scratch, numbering the objects in list order
+void objectxsortedlist::initGrid()
+{
+	float maxRadius = max( max( food::gMaxFoodRadius, agent::config.maxRadius ), brick::gBrickRadius );
+	float cellSize = gridCellSize;
+	if( cellSize <= 0.0 )
+		cellSize = maxRadius > 0.0 ? 2.0 * maxRadius : globals::worldsize / 16.0;
+
+	grid.init( globals::worldsize, cellSize, maxRadius );
+
+	gdlink<gobject*> *savecurr = currItem;
+	gobject* o;
+	double order = 0.0;
+	this->reset();
+	while( this->next( o ) )
+		grid.add( o, order++ );
+	currItem = savecurr;
+}
+
+
+//---------------------------------------------------------------------------
+// objectxsortedlist::addToGrid
+//---------------------------------------------------------------------------
+// Called once a has been linked into the list.  Its order is taken halfway
+// between its neighbors, so it needn't renumber anything until the next sort.
+void objectxsortedlist::addToGrid( gobject* a )
+{
+	if( !grid.isInitialized() )
+	{
+		initGrid();
+		return;
+	}
+
+	gdlink<gobject*> *link = a->listLink;
+	gdlink<gobject*> *head = lastItem->nextItem;
+	double order;
+
+	if( kount == 1 )
+		order = 0.0;
+	else if( link == lastItem )
+		order = grid.getOrder( link->prevItem->e ) + 1.0;
+	else if( link == head )
+		order = grid.getOrder( link->nextItem->e ) - 1.0;
+	else
+		order = 0.5 * (grid.getOrder( link->prevItem->e ) + grid.getOrder( link->nextItem->e ));
+
+	grid.add( a, order );
+}
@@ -4,7 +4,10 @@
 #define NEXT 1
 #define PREV 2
 
+#include <vector>
+
 #include "gdlink.h"
+#include "SpatialGrid.h"
 #include "agent/agent.h"
 #include "environment/brick.h"
 #include "environment/food.h"
@@ -16,12 +19,23 @@ using namespace std;
 
 //===========================================================================
 // Sorted list of all objects: agents, food, bricks, other.
+//
+// Optionally also maintains a SpatialGrid of the same objects, so neighbors
+// can be found without scanning the list (see nearObj()).
 //===========================================================================
 
 class objectxsortedlist : public gdlist<gobject*>
 {
 	PROPLIB_CPP_PROPERTIES
 
+ public:
+	enum SpatialIndex
+	{
+		XSortedList,	// neighbors are found by scanning the list
+		Grid,			// neighbors are found with the grid
+		Verify			// use the list, but check that the grid finds the same neighbors
+	};
+
  private:
     int agentCount;
     int foodCount;
@@ -29,11 +43,19 @@ class objectxsortedlist : public gdlist<gobject*>
     gdlink<gobject*> *markedAgent;	
     gdlink<gobject*> *markedFood;	
     gdlink<gobject*> *markedBrick;	
+    SpatialIndex spatialIndex;
+    float gridCellSize;
+    SpatialGrid grid;
+
+    void added( gobject* a );
+    void initGrid();
+    void addToGrid( gobject* a );
 
  public:
-    objectxsortedlist() { markedAgent = 0; markedFood = 0; markedBrick = 0; }
+    objectxsortedlist() { markedAgent = 0; markedFood = 0; markedBrick = 0; spatialIndex = XSortedList; gridCellSize = 0.0; }
     ~objectxsortedlist() { }
     void add( gobject* a );
+    void addLast( gobject* a );
     void removeCurrentObject();
 	void removeObjectWithLink( gobject* o );
     void sort();
@@ -50,6 +72,16 @@ class objectxsortedlist : public gdlist<gobject*>
     void toMark( int objType );
     void getMark( int objType, gobject* gob );
 
+    void setSpatialIndex( SpatialIndex index, float cellSize );
+    SpatialIndex getSpatialIndex() { return spatialIndex; }
+    bool hasGrid() { return spatialIndex != XSortedList; }
+    void moved( gobject* o );
+    SpatialGrid::Query nearQuery( gobject* from, int objType, float xmin, float xmax, float zmin, float zmax );
+    int nearObj( int direction, SpatialGrid::Query& query, gobject** gob );
+    void verifyNeighbors( const char* phase, long step, agent* o,
+                          const vector<gobject*>& listNeighbors,
+                          const vector<gobject*>& gridNeighbors );
+
     static objectxsortedlist gXSortedObjects;
 };
 
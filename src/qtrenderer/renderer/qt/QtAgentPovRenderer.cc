@@ -6,18 +6,34 @@
 #include <QGLWidget>
 
 #include "agent/agent.h"
+#include "agent/RayCastAgentPovRenderer.h"
 #include "agent/Retina.h"
+#include "agent/SoftwareAgentPovRenderer.h"
 
 #define CELL_PAD 2
 
 //---------------------------------------------------------------------------
-// AgentPovRenderer::AgentPovRenderer
+// AgentPovRenderer::create
 //---------------------------------------------------------------------------
-AgentPovRenderer *AgentPovRenderer::create( int maxAgents,
+AgentPovRenderer *AgentPovRenderer::create( Type type,
+                                            gstage *stage,
+                                            bool staticTimestepGeometry,
+                                            int maxAgents,
                                             int retinaWidth,
                                             int retinaHeight )
 {
-    return new QtAgentPovRenderer( maxAgents, retinaWidth, retinaHeight );
+	switch( type )
+	{
+	case OpenGL:
+		return new QtAgentPovRenderer( maxAgents, retinaWidth, retinaHeight );
+	case Software:
+		return new SoftwareAgentPovRenderer( stage, staticTimestepGeometry, retinaWidth, retinaHeight );
+	case RayCast:
+		return new RayCastAgentPovRenderer( stage, staticTimestepGeometry, retinaWidth, retinaHeight );
+	default:
+		assert( false );
+		return NULL;
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <string.h>
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <string>
@@ -13,7 +14,10 @@
 
 #include "brainfunction.h"
 #include "main.h"
+#include "utils/AbstractFile.h"
+#include "utils/datalib.h"
 #include "utils/Events.h"
+#include "utils/misc.h"
 
 using namespace std;
 
@@ -45,6 +49,7 @@ void find_filter_files( string brain_function_path,	// input
 						string& worldfile_path,  	// outputs...
 						string& births_deaths_path,
 						string& energy_log_path );
+bool find_container_view( string directory, string& run, string& view );
 long get_max_steps( ifstream& worldfile );
 void parse_mate_events( ifstream& births_deaths, Events* events );
 void parse_eat_events( ifstream& energy_log, Events* events );
@@ -55,10 +60,11 @@ void parse_eat_events( ifstream& energy_log, Events* events );
 //---------------------------------------------------------------------------
 void usage_brainfunction()
 {
-	cerr << "CalcComplexity brainfunction [--bare] [--tile] (<func_file> | --list <func_file>... --) [N] [[APIBH]+[me]*\\d*]..." << endl;
+	cerr << "CalcComplexity brainfunction [--bare] [--tile] [--resume <datalib_file>] (<func_file> | --list <func_file>... -- | --dir <directory>) [N] [[APIBH]+[me]*\\d*]..." << endl;
 	cerr << "\t--bare :  If set, CalcComplexity will output bare numerical values, with no labels.\n\t\tUsed by CalcComplexity.py, but normally not used from the command line." << endl;
 	cerr << "\t--tile :  If set, CalcComplexity will tile shorter brainFunction files to produce N timesteps (if given)." << endl;
-	cerr << "\t<func_file> | --list <func_file>... -- :  The brainFunction file to compute complexity for.\n\t\tIf --list is used, provide a list of files followed by '--'.\n\t\tBoth complete and incomplete brainFunction files are supported." << endl;
+	cerr << "\t--resume :  If set, each result is also written to the given datalib file as soon as it's calculated,\n\t\tand results already in it (from an earlier, possibly interrupted, run) aren't recalculated." << endl;
+	cerr << "\t<func_file> | --list <func_file>... -- | --dir <directory> :  The brainFunction file to compute complexity for.\n\t\tIf --list is used, provide a list of files followed by '--'.\n\t\tIf --dir is used, all the brainFunction files in the directory are used,\n\t\tor in its view of brain/function.pwlog if the run used RecordLogContainers.\n\t\tBoth complete and incomplete brainFunction files are supported." << endl;
 	cerr << "\tN :  Optional length of the agent's life (in timesteps) over which Complexity is to be computed.\n\t\tEx: a value of 100 will compute Complexity across the first 100 steps of the agent's life." << endl;
 	cerr << "\t[[APIBH]+[me]*\\d*]... :  Optional space-separated list of complexity types to calculate.\n\t\tThis can be (uppercase only) 'A', 'P', 'I', 'B', 'H' or any meaningful combination thereof.\n\t\tIt specifies whether you want to compute the Complexity of All, Processing, Input, Behavior,\n\t\tor Health+Behavior neurons. By default it computes the Complexity for A, P, I, B, and HB.\n\t\tAny of the complexity types may have one or more lowercase letters appendeded to indicate \n\t\tthat neural activity should be filtered based on behavioral events prior to the\n\t\tcalculation of Complexity. Currently acceptable values are 'm'ate and 'e'at. Warning:\n\t\tFilter order uniquely identifies datalib entries, but doesn't alter what is calculated.\n\t\tAny of the complexity types may have one or more digits appended to specify the number of\n\t\tpoints to use in integrating the area between the (k/N)I(X) and <I(X_k)> curves. If not\n\t\tspecified, the default is effectively 1 (one), which yields the traditional 'simplified\n\t\tTSE complexity'. A value of 0 (zero) will use all points (all values of k) thus yielding\n\t\tfull TSE complexity (though <I(X_k)> will be approximated for large values of N_choose_k)." << endl;
 }
@@ -112,9 +118,55 @@ int process_brainfunction(int argc, char *argv[])
 		arg = argv[argi];
 	}
 
+	ComplexityCache *cache = NULL;
+
+	if(arg == "--resume")
+	{
+		consume_arg(argc, argv, argi);
+		if(argc < 3)
+		{
+			show_usage("expecting datalib file and brain function file after --resume");
+		}
+		cache = new ComplexityCache(consume_arg(argc, argv, argi));
+		arg = argv[argi];
+	}
+
 	list<string> files;
 
-	if(arg == "--list")
+	if(arg == "--dir")
+	{
+		consume_arg(argc, argv, argi);
+		if(argc < 2)
+		{
+			show_usage("expecting directory after --dir");
+		}
+
+		string dir = consume_arg(argc, argv, argi);
+		if(dir[dir.size() - 1] != '/')
+		{
+			dir += '/';
+		}
+
+		// Scanned once for the whole batch
+		vector<string> paths;
+		string run, view;
+		if(find_container_view(dir, run, view))
+		{
+			paths = get_list_of_brainfunction_records(run, view);
+		}
+		else
+		{
+			paths = get_list_of_brainfunction_logfiles(dir);
+		}
+		sort(paths.begin(), paths.end());
+		files.insert(files.end(), paths.begin(), paths.end());
+
+		if(files.size() == 0)
+		{
+			show_usage("No brain function files in " + dir);
+		}
+	}
+	else if(arg == "--list")
 	{
 		bool eol = false;
 
@@ -275,13 +327,15 @@ int process_brainfunction(int argc, char *argv[])
 
 	Callback_bf callback(bare,
 			  part_combos,
-			  ncombos);
+			  ncombos,
+			  cache);
 
 	// --- perform calculations
 	CalcComplexity_brainfunction_result *result = CalcComplexity_brainfunction(parms,
 										   nparms,
 										   &callback);
 	delete result;
+	delete cache;
 
 	if( filter_events )
 		free( filter_events );
@@ -359,7 +413,14 @@ void find_filter_files( string brain_function_path,	// input
 	// Try to determine the directory layout
 	found = brain_function_path.find( "Recent" );
 	bool run;
-	if( found != string::npos )
+	if( AbstractFile::isRecordPath(brain_function_path.c_str()) )
+	{
+		// A record of .../<run>/brain/function.pwlog
+		found = brain_function_path.rfind( "brain/function.pwlog#" );
+		root = brain_function_path.substr( 0, found );
+		run = true;
+	}
+	else if( found != string::npos )
 	{
 		// "Recent" is in the file path, so assume path is
 		// .../<run>/brain/Recent/<#>/<brainFunction_file>
@@ -389,6 +450,30 @@ void find_filter_files( string brain_function_path,	// input
 }
 
 
+//---------------------------------------------------------------------------
+// find_container_view
+//
+// With RecordLogContainers, a run has no brain/Recent/<#> directories; they
+// are views of brain/function.pwlog instead. If directory is one of those,
+// e.g. run/brain/Recent/3/, gets its run and view ("Recent/3").
+//---------------------------------------------------------------------------
+bool find_container_view( string directory, string& run, string& view )
+{
+	if( exists(directory) )
+		return false;
+
+	string path = directory.substr( 0, directory.find_last_not_of('/') + 1 );
+	size_t found = path.rfind( "brain/" );
+	if( found == string::npos || (found > 0 && path[found-1] != '/') )
+		return false;
+
+	run = found > 0 ? path.substr( 0, found - 1 ) : ".";
+	view = path.substr( found + strlen("brain/") );
+
+	return exists( run + "/brain/function.pwlog" );
+}
+
+
 //---------------------------------------------------------------------------
 // get_max_steps
 //---------------------------------------------------------------------------
@@ -503,9 +588,11 @@ void Callback_bf::begin(CalcComplexity_brainfunction_parms *parms,
 		     int nparms)
 {
 	reported = new bool[nparms];
+	cached = new bool[nparms];
 	for(int i = 0; i < nparms; i++)
 	{
 		reported[i] = false;
+		cached[i] = false;
 	}
 
 	if(!bare)
@@ -525,6 +612,26 @@ void Callback_bf::begin(CalcComplexity_brainfunction_parms *parms,
 	last_displayed = -1;
 }
 
+//---------------------------------------------------------------------------
+// Callback_bf::parms_cached
+//---------------------------------------------------------------------------
+bool Callback_bf::parms_cached(CalcComplexity_brainfunction_result *result,
+			    int parms_index)
+{
+	if(!cache)
+	{
+		return false;
+	}
+
+	cached[parms_index] = cache->find(result->parms + parms_index,
+					  result->agent_number + parms_index,
+					  result->lifespan + parms_index,
+					  result->num_neurons + parms_index,
+					  result->complexity + parms_index);
+
+	return cached[parms_index];
+}
+
 //---------------------------------------------------------------------------
 // Callback_bf::parms_result
 //---------------------------------------------------------------------------
@@ -535,6 +642,15 @@ void Callback_bf::parms_result(CalcComplexity_brainfunction_result *result,
 	{
 		reported[parms_index] = true;
 
+		if(cache && !cached[parms_index])
+		{
+			cache->add(result->parms + parms_index,
+				   result->agent_number[parms_index],
+				   result->lifespan[parms_index],
+				   result->num_neurons[parms_index],
+				   result->complexity[parms_index]);
+		}
+
 		if(last_displayed == parms_index - 1)
 		{
 			display(result);
@@ -594,6 +710,187 @@ void Callback_bf::end(CalcComplexity_brainfunction_result *result)
 {
 	delete[] reported;
 	reported = NULL;
+	delete[] cached;
+	cached = NULL;
+}
+
+
+//===========================================================================
+// ComplexityCache
+//===========================================================================
+
+#define CACHE_TABLE "Complexity"
+
+static const char *CACHE_COLNAMES[] = {"Path", "Parts", "Timesteps", "Tile", "AgentNumber", "Lifespan", "NumNeurons", "Complexity", NULL};
+static const datalib::Type CACHE_COLTYPES[] = {datalib::STRING, datalib::STRING, datalib::INT, datalib::INT, datalib::INT, datalib::INT, datalib::INT, datalib::FLOAT};
+static const char *CACHE_COLFORMATS[] = {"%s", "%s", "%d", "%d", "%d", "%d", "%d", "%.9g"};
+
+//---------------------------------------------------------------------------
+// ComplexityCache::ComplexityCache
+//
+// The table is rewritten under a temporary name with what was loaded, and
+// only then replaces the old one, so nothing is lost if it's interrupted.
+//---------------------------------------------------------------------------
+ComplexityCache::ComplexityCache(const char *path)
+{
+	load(path);
+
+	string tmp = string(path) + ".tmp";
+	writer = new DataLibWriter(tmp.c_str());
+	writer->beginTable(CACHE_TABLE, CACHE_COLNAMES, CACHE_COLTYPES, CACHE_COLFORMATS);
+
+	for(map<string, Entry>::iterator it = entries.begin(); it != entries.end(); it++)
+	{
+		write(it->second);
+	}
+	writer->flush();
+
+	if(rename(tmp.c_str(), path) != 0)
+	{
+		perror(path);
+		exit(1);
+	}
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::~ComplexityCache
+//---------------------------------------------------------------------------
+ComplexityCache::~ComplexityCache()
+{
+	delete writer;
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::find
+//---------------------------------------------------------------------------
+bool ComplexityCache::find(CalcComplexity_brainfunction_parms *parms,
+			   long *agent_number,
+			   long *lifespan,
+			   long *num_neurons,
+			   double *complexity)
+{
+	map<string, Entry>::iterator it = entries.find(key(parms->path, parms->parts, parms->num_timesteps, parms->tile));
+	if(it == entries.end())
+	{
+		return false;
+	}
+
+	*agent_number = it->second.agent_number;
+	*lifespan = it->second.lifespan;
+	*num_neurons = it->second.num_neurons;
+	*complexity = it->second.complexity;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::add
+//
+// Only written to the table, as entries is being searched by other threads.
+//---------------------------------------------------------------------------
+void ComplexityCache::add(CalcComplexity_brainfunction_parms *parms,
+			  long agent_number,
+			  long lifespan,
+			  long num_neurons,
+			  double complexity)
+{
+	Entry entry;
+	entry.path = parms->path;
+	entry.parts = parms->parts;
+	entry.num_timesteps = parms->num_timesteps;
+	entry.tile = parms->tile;
+	entry.agent_number = agent_number;
+	entry.lifespan = lifespan;
+	entry.num_neurons = num_neurons;
+	entry.complexity = complexity;
+
+	write(entry);
+	writer->flush();
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::key
+//---------------------------------------------------------------------------
+string ComplexityCache::key(const string &path,
+			    const string &parts,
+			    int num_timesteps,
+			    bool tile)
+{
+	char buf[32];
+	sprintf(buf, "\t%d\t%d", num_timesteps, (int)tile);
+
+	return path + "\t" + parts + buf;
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::load
+//
+// Parsed here rather than with DataLibReader, which needs the footer that an
+// interrupted run doesn't write. A row cut short by the interruption is
+// dropped.
+//---------------------------------------------------------------------------
+void ComplexityCache::load(const char *path)
+{
+	ifstream in(path);
+	if(!in.is_open())
+	{
+		return;
+	}
+
+	map<string, int> colindex;
+	string line;
+
+	while(getline(in, line))
+	{
+		if(line.compare(0, 4, "#@L ") == 0)
+		{
+			vector<string> names = split(line.substr(4), " \t");
+			colindex.clear();
+			for(size_t i = 0; i < names.size(); i++)
+			{
+				colindex[names[i]] = i;
+			}
+			continue;
+		}
+
+		if(line.empty() || line[0] == '#' || in.eof())
+		{
+			continue;
+		}
+
+		vector<string> fields = split(line, "\t");
+		if(fields.size() != colindex.size())
+		{
+			continue;
+		}
+
+		Entry entry;
+		entry.path = fields[colindex["Path"]];
+		entry.parts = fields[colindex["Parts"]];
+		entry.num_timesteps = atoi(fields[colindex["Timesteps"]].c_str());
+		entry.tile = atoi(fields[colindex["Tile"]].c_str()) != 0;
+		entry.agent_number = atol(fields[colindex["AgentNumber"]].c_str());
+		entry.lifespan = atol(fields[colindex["Lifespan"]].c_str());
+		entry.num_neurons = atol(fields[colindex["NumNeurons"]].c_str());
+		entry.complexity = atof(fields[colindex["Complexity"]].c_str());
+
+		entries[key(entry.path, entry.parts, entry.num_timesteps, entry.tile)] = entry;
+	}
+}
+
+//---------------------------------------------------------------------------
+// ComplexityCache::write
+//---------------------------------------------------------------------------
+void ComplexityCache::write(const Entry &entry)
+{
+	writer->addRow(entry.path.c_str(),
+				   entry.parts.c_str(),
+				   entry.num_timesteps,
+				   (int)entry.tile,
+				   (int)entry.agent_number,
+				   (int)entry.lifespan,
+				   (int)entry.num_neurons,
+				   entry.complexity);
 }
 
 // eof
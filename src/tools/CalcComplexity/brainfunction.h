@@ -6,18 +6,75 @@ int process_brainfunction(int argc, char *argv[]);
 
 #ifdef BRAINFUNCTION_CPP
 
+#include <map>
+#include <string>
+
 #include "complexity/complexity.h"
 
+class DataLibWriter;
+
+//===========================================================================
+// ComplexityCache
+//
+// Results of earlier runs, kept in a datalib table that each new result is
+// added to as soon as it's calculated, so an interrupted run can be resumed
+// and a run with more parts only calculates the new ones. A file left
+// without its datalib footer by an interrupted run is still read.
+//===========================================================================
+class ComplexityCache
+{
+public:
+	ComplexityCache(const char *path);
+	~ComplexityCache();
+
+	bool find(CalcComplexity_brainfunction_parms *parms,
+			  long *agent_number,
+			  long *lifespan,
+			  long *num_neurons,
+			  double *complexity);
+	void add(CalcComplexity_brainfunction_parms *parms,
+			 long agent_number,
+			 long lifespan,
+			 long num_neurons,
+			 double complexity);
+
+private:
+	struct Entry
+	{
+		std::string path;
+		std::string parts;
+		int num_timesteps;
+		bool tile;
+		long agent_number;
+		long lifespan;
+		long num_neurons;
+		double complexity;
+	};
+
+	static std::string key(const std::string &path,
+						   const std::string &parts,
+						   int num_timesteps,
+						   bool tile);
+	void load(const char *path);
+	void write(const Entry &entry);
+
+	std::map<std::string, Entry> entries;
+	DataLibWriter *writer;
+};
+
 class Callback_bf : public CalcComplexity_brainfunction_callback
 {
 public:
 Callback_bf(bool _bare,
 		    const char **_parts_combos,
-		    int _nparts_combos) : bare(_bare), parts_combos(_parts_combos), nparts_combos(_nparts_combos), reported(NULL) {}
+		    int _nparts_combos,
+		    ComplexityCache *_cache = NULL) : bare(_bare), parts_combos(_parts_combos), nparts_combos(_nparts_combos), cache(_cache), reported(NULL), cached(NULL) {}
 	virtual ~Callback_bf() {}
 
 	virtual void begin(CalcComplexity_brainfunction_parms *parms,
                        int nparms);
+	virtual bool parms_cached(CalcComplexity_brainfunction_result *result,
+                              int parms_index);
 	virtual void parms_result(CalcComplexity_brainfunction_result *result,
                               int parms_index);
 	void display(CalcComplexity_brainfunction_result *result);
@@ -27,7 +84,9 @@ private:
 	bool bare;
 	const char **parts_combos;
 	int nparts_combos;
+	ComplexityCache *cache;
 	bool *reported;
+	bool *cached;
 	int last_displayed;
 };
 
@@ -0,0 +1,293 @@
+// checkpointcheck: checks that a run restored from a checkpoint goes on as
+// the uninterrupted run does.
+//
+// Runs each worldfile for 2N steps with a checkpoint every N steps, then runs
+// it again restored from the checkpoint at step N, and compares the two
+// checkpoints at step 2N byte for byte. Each run gets its own child process
+// (the simulation keeps global state, so it can only be constructed once per
+// process). Exits with status 1 if any pair differs, naming the first
+// section that does.
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "proplib/proplib.h"
+#include "sim/Simulation.h"
+#include "utils/misc.h"
+
+using namespace std;
+
+void usage( const string &msg = "" )
+{
+	cerr << "usage: checkpointcheck [--dir path] [--steps n] worldfile..." << endl;
+	cerr << endl;
+	cerr << "  Must be run from the Polyworld home directory. Each worldfile is run in" << endl;
+	cerr << "  <dir>/<worldfile name>/uninterrupted and .../resumed (default dir:" << endl;
+	cerr << "  checkpointcheck), for 2 x <steps> steps (default steps: 100)." << endl;
+
+	if( !msg.empty() )
+	{
+		cerr << "--------------------------------------------------------------------------------" << endl;
+		cerr << msg << endl;
+	}
+
+	exit( 1 );
+}
+
+//---------------------------------------------------------------------------
+// runWorldfile
+//
+// Runs in the child process. Doesn't return.
+//---------------------------------------------------------------------------
+void runWorldfile( const string &worldfilePath,
+				   const string &workDir,
+				   const string &pwhome,
+				   proplib::ParameterMap parameters,
+				   const string &restorePath )
+{
+	makeDirs( workDir );
+	if( chdir(workDir.c_str()) != 0 )
+	{
+		cerr << "Failed changing to " << workDir << ": " << strerror(errno) << endl;
+		_exit( 1 );
+	}
+
+	// The simulation reads the schema and such from ./etc
+	unlink( "etc" );
+	if( symlink((pwhome + "/etc").c_str(), "etc") != 0 )
+	{
+		cerr << "Failed linking etc in " << workDir << ": " << strerror(errno) << endl;
+		_exit( 1 );
+	}
+
+	if( !freopen("checkpointcheck.log", "w", stdout) || !freopen("checkpointcheck.log", "a", stderr) )
+		_exit( 1 );
+
+	proplib::Interpreter::init();
+	TSimulation *simulation = new TSimulation( worldfilePath, parameters, restorePath );
+	proplib::Interpreter::dispose();
+
+	bool ended = false;
+	simulation->ended += [&ended]() { ended = true; };
+
+	while( !ended )
+		simulation->Step();
+
+	delete simulation;
+
+	fflush( stdout );
+	fflush( stderr );
+	_exit( 0 );
+}
+
+//---------------------------------------------------------------------------
+// run
+//
+// Runs a worldfile in a child process, returning whether it succeeded.
+//---------------------------------------------------------------------------
+bool run( const string &worldfilePath,
+		  const string &workDir,
+		  const string &pwhome,
+		  proplib::ParameterMap parameters,
+		  const string &restorePath = "" )
+{
+	fflush( stdout );
+	fflush( stderr );
+
+	pid_t pid = fork();
+	if( pid < 0 )
+	{
+		perror( "fork" );
+		exit( 1 );
+	}
+	else if( pid == 0 )
+	{
+		runWorldfile( worldfilePath, workDir, pwhome, parameters, restorePath );
+	}
+
+	int status;
+	if( waitpid(pid, &status, 0) != pid )
+	{
+		perror( "waitpid" );
+		exit( 1 );
+	}
+
+	if( !WIFEXITED(status) || (WEXITSTATUS(status) != 0) )
+	{
+		cerr << "  FAILED running in " << workDir << " (see " << workDir << "/checkpointcheck.log)" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// readFile
+//---------------------------------------------------------------------------
+bool readFile( const string &path, vector<char> &contents )
+{
+	ifstream in( path.c_str(), ios::binary );
+	if( !in )
+	{
+		cerr << "  Can't read " << path << endl;
+		return false;
+	}
+
+	contents.assign( istreambuf_iterator<char>(in), istreambuf_iterator<char>() );
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// findSection
+//
+// The tag of the checkpoint section containing offset, walking the section
+// headers that follow the magic and version (see utils/CheckPoint.h).
+//---------------------------------------------------------------------------
+string findSection( const vector<char> &contents, size_t offset )
+{
+	size_t pos = 8 + sizeof(uint32_t);
+	if( offset < pos )
+		return "header";
+
+	while( pos + 4 + sizeof(uint64_t) <= contents.size() )
+	{
+		string tag( &contents[pos], 4 );
+		uint64_t length;
+		memcpy( &length, &contents[pos + 4], sizeof(length) );
+
+		size_t end = pos + 4 + sizeof(uint64_t) + length;
+		if( offset < end )
+			return tag;
+		pos = end;
+	}
+
+	return "end of file";
+}
+
+//---------------------------------------------------------------------------
+// compare
+//---------------------------------------------------------------------------
+bool compare( const string &expectedPath, const string &actualPath )
+{
+	vector<char> expected, actual;
+	if( !readFile(expectedPath, expected) || !readFile(actualPath, actual) )
+		return false;
+
+	if( expected == actual )
+		return true;
+
+	size_t offset = 0;
+	while( (offset < expected.size()) && (offset < actual.size()) && (expected[offset] == actual[offset]) )
+		offset++;
+
+	cerr << "  " << actualPath << " differs from " << expectedPath
+		 << " at offset " << offset << ", in section '" << findSection(expected, offset) << "'" << endl;
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+	string dir = "checkpointcheck";
+	long steps = 100;
+	vector<string> worldfiles;
+
+	for( int argi = 1; argi < argc; argi++ )
+	{
+		string arg = argv[argi];
+
+		if( (arg.size() > 2) && (arg.compare(0, 2, "--") == 0) )
+		{
+			if( ++argi >= argc )
+				usage( "Missing " + arg + " arg" );
+			string value = argv[argi];
+
+			if( arg == "--dir" )
+				dir = value;
+			else if( arg == "--steps" )
+				steps = atol( value.c_str() );
+			else
+				usage( "Unknown argument: " + arg );
+		}
+		else
+		{
+			worldfiles.push_back( arg );
+		}
+	}
+
+	if( worldfiles.empty() )
+		usage( "No worldfiles specified" );
+	if( steps <= 0 )
+		usage( "--steps must be > 0" );
+	if( !exists("./etc/worldfile.wfs") )
+		usage( "Can't find ./etc/worldfile.wfs" );
+
+	char pwhome[PATH_MAX];
+	if( !getcwd(pwhome, sizeof(pwhome)) )
+		usage( "Can't determine current directory" );
+
+	makeDirs( dir );
+
+	// Both runs checkpoint at steps and 2 x steps, uncompressed so the files
+	// can be compared directly.
+	proplib::ParameterMap parameters;
+	parameters["MaxSteps"] = to_string( 2 * steps );
+	parameters["CheckPointFrequency"] = to_string( steps );
+	parameters["CheckPointCompress"] = "False";
+
+	string checkpointName = "run/checkpoints/step_" + to_string( 2 * steps ) + ".pwc";
+	int nfailed = 0;
+
+	for( const string &worldfile : worldfiles )
+	{
+		char worldfilePath[PATH_MAX];
+		if( !realpath(worldfile.c_str(), worldfilePath) )
+		{
+			cerr << worldfile << ": " << strerror(errno) << endl;
+			nfailed++;
+			continue;
+		}
+
+		string name = worldfile.substr( worldfile.rfind('/') + 1 );
+		if( name.size() > 3 && name.compare(name.size() - 3, 3, ".wf") == 0 )
+			name.erase( name.size() - 3 );
+
+		cout << name << ":" << endl;
+
+		string uninterruptedDir = dir + "/" + name + "/uninterrupted";
+		string resumedDir = dir + "/" + name + "/resumed";
+		string restorePath = string( pwhome ) + "/" + uninterruptedDir + "/run/checkpoints/step_" + to_string( steps ) + ".pwc";
+
+		bool ok = run( worldfilePath, uninterruptedDir, pwhome, parameters )
+			&& run( worldfilePath, resumedDir, pwhome, parameters, restorePath )
+			&& compare( uninterruptedDir + "/" + checkpointName, resumedDir + "/" + checkpointName );
+
+		if( ok )
+		{
+			cout << "  OK: resumed at step " << steps << ", matched at step " << 2 * steps << endl;
+		}
+		else
+		{
+			cout << "  FAILED" << endl;
+			nfailed++;
+		}
+	}
+
+	return nfailed == 0 ? 0 : 1;
+}
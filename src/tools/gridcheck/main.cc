@@ -0,0 +1,276 @@
+// gridcheck: checks SpatialGrid::find() against a brute-force search.
+//
+// Scatters objects of random types and radii over a world (some of them
+// outside it, or piled into a few crowded spots), then walks the neighbors
+// of random query boxes forward and backward the way objectxsortedlist does,
+// moving, adding and removing objects mid-walk. Every object the grid
+// returns must be the one a scan of all the objects in order would return.
+// Exits with status 1 at the first mismatch.
+//
+// usage: gridcheck [layouts]
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "graphics/gobject.h"
+#include "utils/SpatialGrid.h"
+
+using namespace std;
+
+static const float WorldSize = 100.0f;
+static const float MaxRadius = 1.0f;
+
+//===========================================================================
+// Point
+//===========================================================================
+class Point : public gobject
+{
+ public:
+	Point() {}
+	virtual ~Point() {}
+};
+
+//===========================================================================
+// Layout
+//
+// The objects in the grid and their order keys, which stand in for their
+// positions in the x-sorted list.
+//===========================================================================
+struct Layout
+{
+	SpatialGrid grid;
+	vector<Point *> objects;
+	vector<double> orders;
+	long added;
+	bool crowded;
+};
+
+//---------------------------------------------------------------------------
+// randf
+//---------------------------------------------------------------------------
+static float randf( float lo, float hi )
+{
+	return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+//---------------------------------------------------------------------------
+// place
+//
+// Mostly within the world, sometimes just outside it, and in a crowded layout
+// mostly around a few spots.
+//---------------------------------------------------------------------------
+static void place( Layout &layout, Point *obj )
+{
+	float x, z;
+
+	if( layout.crowded && (rand() % 4 != 0) )
+	{
+		float spot = 10.0f + 40.0f * (rand() % 3);
+		x = spot + randf( -3.0f, 3.0f );
+		z = -spot + randf( -3.0f, 3.0f );
+	}
+	else
+	{
+		x = randf( -5.0f, WorldSize + 5.0f );
+		z = randf( -WorldSize - 5.0f, 5.0f );
+	}
+
+	obj->setx( x );
+	obj->setz( z );
+}
+
+//---------------------------------------------------------------------------
+// add
+//---------------------------------------------------------------------------
+static void add( Layout &layout, double order )
+{
+	Point *obj = new Point();
+	obj->setType( 1 << (rand() % 3) );
+	obj->setradius( randf(0.1f, MaxRadius) );
+	place( layout, obj );
+
+	layout.objects.push_back( obj );
+	layout.orders.push_back( order );
+	layout.grid.add( obj, order );
+}
+
+//---------------------------------------------------------------------------
+// remove
+//---------------------------------------------------------------------------
+static void remove( Layout &layout, size_t i )
+{
+	layout.grid.remove( layout.objects[i] );
+	delete layout.objects[i];
+
+	layout.objects.erase( layout.objects.begin() + i );
+	layout.orders.erase( layout.orders.begin() + i );
+}
+
+//---------------------------------------------------------------------------
+// bruteForceFind
+//
+// What SpatialGrid::find() should return: the object of the query's type with
+// the nearest order after (forward) or before (!forward) query.order whose
+// center lies within the query box grown by the largest radius.
+//---------------------------------------------------------------------------
+static bool bruteForceFind( Layout &layout, const SpatialGrid::Query &query, bool forward, size_t *found )
+{
+	bool any = false;
+
+	for( size_t i = 0; i < layout.objects.size(); i++ )
+	{
+		Point *obj = layout.objects[i];
+		double order = layout.orders[i];
+
+		if( !(obj->getType() & query.objType) )
+			continue;
+		if( forward ? (order <= query.order) : (order >= query.order) )
+			continue;
+		if( (obj->x() < query.xmin - MaxRadius) || (obj->x() > query.xmax + MaxRadius)
+			|| (obj->z() < query.zmin - MaxRadius) || (obj->z() > query.zmax + MaxRadius) )
+			continue;
+
+		if( !any || (forward ? (order < layout.orders[*found]) : (order > layout.orders[*found])) )
+		{
+			*found = i;
+			any = true;
+		}
+	}
+
+	return any;
+}
+
+//---------------------------------------------------------------------------
+// check
+//
+// Walks the neighbors of one query box, changing the layout as it goes.
+// Returns the number of neighbors visited, or -1 on a mismatch.
+//---------------------------------------------------------------------------
+static long check( Layout &layout, long id )
+{
+	Point *center = layout.objects[rand() % layout.objects.size()];
+	float reach = randf( 0.5f, 4.0f );
+	bool forward = rand() % 2;
+
+	SpatialGrid::Query query;
+	query.objType = 1 + rand() % 7;
+	query.xmin = center->x() - reach;
+	query.xmax = center->x() + reach;
+	query.zmin = center->z() - reach;
+	query.zmax = center->z() + reach;
+	query.order = layout.grid.getOrder( center );
+
+	long visited = 0;
+
+	while( true )
+	{
+		SpatialGrid::Query expected = query;
+		size_t found = 0;
+		bool shouldFind = bruteForceFind( layout, expected, forward, &found );
+
+		gobject *obj;
+		bool didFind = layout.grid.find( query, forward, &obj );
+
+		if( (didFind != shouldFind) || (didFind && (obj != layout.objects[found])) )
+		{
+			fprintf( stderr, "Mismatch in walk %ld after %ld neighbors (%s from order %g, type 0x%x, box x [%g,%g] z [%g,%g]):\n",
+					 id, visited, forward ? "forward" : "backward", expected.order, expected.objType,
+					 expected.xmin, expected.xmax, expected.zmin, expected.zmax );
+			if( shouldFind )
+				fprintf( stderr, "  brute force: order %g at (%g,%g)\n",
+						 layout.orders[found], layout.objects[found]->x(), layout.objects[found]->z() );
+			else
+				fprintf( stderr, "  brute force: none\n" );
+			if( didFind )
+				fprintf( stderr, "  grid: order %g at (%g,%g)\n", query.order, obj->x(), obj->z() );
+			else
+				fprintf( stderr, "  grid: none\n" );
+			return -1;
+		}
+		if( !didFind )
+			break;
+
+		visited++;
+
+		// Change the layout under the walk, as agents moving, dying and being
+		// born during Interact() do.
+		switch( rand() % 10 )
+		{
+		case 0:
+			{
+				Point *moved = layout.objects[rand() % layout.objects.size()];
+				place( layout, moved );
+				layout.grid.update( moved );
+			}
+			break;
+		case 1:
+			{
+				if( layout.objects.size() > 10 )
+					remove( layout, rand() % layout.objects.size() );
+			}
+			break;
+		case 2:
+			// Between two objects, as objectxsortedlist::addToGrid() does, and
+			// never equal to another object's order.
+			add( layout, (rand() % layout.objects.size()) + 1.0 / (2 + layout.added++) );
+			break;
+		default:
+			break;
+		}
+
+		if( rand() % 8 == 0 )
+			forward = !forward;
+	}
+
+	return visited;
+}
+
+//---------------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+	int nlayouts = argc > 1 ? atoi( argv[1] ) : 20;
+	long nwalks = 0;
+	long nvisited = 0;
+
+	for( int seed = 1; seed <= nlayouts; seed++ )
+	{
+		srand( seed );
+
+		Layout layout;
+		layout.added = 0;
+		layout.crowded = seed % 2 == 0;
+
+		// Cells from smaller than an object to a sixteenth of the world.
+		float cellSizes[] = { 0.5f, 2.0f * MaxRadius, 5.0f, WorldSize / 16.0f };
+		layout.grid.init( WorldSize, cellSizes[seed % 4], MaxRadius );
+
+		int nobjects = 200 + rand() % 1800;
+		for( int i = 0; i < nobjects; i++ )
+			add( layout, i );
+
+		for( int walk = 0; walk < 100; walk++ )
+		{
+			long visited = check( layout, nwalks++ );
+			if( visited < 0 )
+			{
+				fprintf( stderr, "FAILED: layout %d (%s, cell size %g)\n",
+						 seed, layout.crowded ? "crowded" : "uniform", layout.grid.getCellSize() );
+				return 1;
+			}
+			nvisited += visited;
+		}
+
+		layout.grid.clear();
+		for( Point *obj : layout.objects )
+			delete obj;
+	}
+
+	printf( "OK: %d layouts, %ld walks, %ld neighbors agreed\n", nlayouts, nwalks, nvisited );
+
+	return 0;
+}
@@ -0,0 +1,306 @@
+// pwbench: headless simulation throughput benchmark.
+//
+// Runs each worldfile in its own child process (the simulation keeps global
+// state, so it can only be constructed once per process), without a display
+// or any UI, and reports steps/sec, the StepProfiler phase times, peak RSS
+// and the number of heap allocations per step. Results are printed and also
+// written as a datalib table.
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "proplib/proplib.h"
+#include "sim/Simulation.h"
+#include "sim/StepProfiler.h"
+#include "utils/datalib.h"
+#include "utils/misc.h"
+
+using namespace datalib;
+using namespace std;
+
+//===========================================================================
+// Allocation counting
+//
+// Replacing the global operator new counts the allocations made by the
+// library too. Allocations made directly with malloc() aren't counted.
+//===========================================================================
+static atomic<unsigned long> allocations( 0 );
+
+void *operator new( size_t n )
+{
+	allocations++;
+	void *p = malloc( n ? n : 1 );
+	if( p == NULL )
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete( void *p ) noexcept
+{
+	free( p );
+}
+
+//===========================================================================
+// Result
+//
+// Sent from the child running a worldfile to the parent through a pipe.
+//===========================================================================
+struct Result
+{
+	long steps;
+	double seconds;
+	unsigned long allocations;
+	double phases[StepProfiler::__NPHASES];
+	double logs;
+};
+
+void usage( const string &msg = "" )
+{
+	cerr << "usage: pwbench [--out path] [--dir path] [--threads n] worldfile..." << endl;
+	cerr << endl;
+	cerr << "  Must be run from the Polyworld home directory. Each worldfile is run in" << endl;
+	cerr << "  <dir>/<worldfile name> (default dir: bench), and the results are written" << endl;
+	cerr << "  to <out> (default: <dir>/results.txt)." << endl;
+
+	if( !msg.empty() )
+	{
+		cerr << "--------------------------------------------------------------------------------" << endl;
+		cerr << msg << endl;
+	}
+
+	exit( 1 );
+}
+
+//---------------------------------------------------------------------------
+// runWorldfile
+//
+// Runs in the child process. Doesn't return.
+//---------------------------------------------------------------------------
+void runWorldfile( const string &worldfilePath,
+				   const string &workDir,
+				   const string &pwhome,
+				   proplib::ParameterMap parameters,
+				   int fd )
+{
+	makeDirs( workDir );
+	if( chdir(workDir.c_str()) != 0 )
+	{
+		cerr << "Failed changing to " << workDir << ": " << strerror(errno) << endl;
+		_exit( 1 );
+	}
+
+	// The simulation reads the schema and such from ./etc
+	unlink( "etc" );
+	if( symlink((pwhome + "/etc").c_str(), "etc") != 0 )
+	{
+		cerr << "Failed linking etc in " << workDir << ": " << strerror(errno) << endl;
+		_exit( 1 );
+	}
+
+	if( !freopen("pwbench.log", "w", stdout) || !freopen("pwbench.log", "a", stderr) )
+		_exit( 1 );
+
+	proplib::Interpreter::init();
+	TSimulation *simulation = new TSimulation( worldfilePath, parameters );
+	proplib::Interpreter::dispose();
+
+	bool ended = false;
+	simulation->ended += [&ended]() { ended = true; };
+
+	Result result;
+	unsigned long allocationsStart = allocations;
+	auto start = chrono::steady_clock::now();
+
+	while( !ended )
+		simulation->Step();
+
+	result.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+	result.allocations = allocations - allocationsStart;
+
+	StepProfiler &profiler = simulation->getProfiler();
+	result.steps = profiler.isEnabled() ? profiler.getTotalSteps() : simulation->getStep();
+	for( int i = 0; i < StepProfiler::__NPHASES; i++ )
+		result.phases[i] = profiler.getTotalTime( i );
+	result.logs = 0.0;
+	for( int i = StepProfiler::__NPHASES; i < profiler.getNumSlots(); i++ )
+		result.logs += profiler.getTotalTime( i );
+
+	if( write(fd, &result, sizeof(result)) != sizeof(result) )
+		_exit( 1 );
+	close( fd );
+
+	delete simulation;
+
+	fflush( stdout );
+	fflush( stderr );
+	_exit( 0 );
+}
+
+//---------------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+	string outPath;
+	string dir = "bench";
+	proplib::ParameterMap parameters;
+	vector<string> worldfiles;
+
+	for( int argi = 1; argi < argc; argi++ )
+	{
+		string arg = argv[argi];
+
+		if( (arg.size() > 2) && (arg.compare(0, 2, "--") == 0) )
+		{
+			if( ++argi >= argc )
+				usage( "Missing " + arg + " arg" );
+			string value = argv[argi];
+
+			if( arg == "--out" )
+				outPath = value;
+			else if( arg == "--dir" )
+				dir = value;
+			else if( arg == "--threads" )
+				parameters["NumThreads"] = value;
+			else
+				usage( "Unknown argument: " + arg );
+		}
+		else
+		{
+			worldfiles.push_back( arg );
+		}
+	}
+
+	if( worldfiles.empty() )
+		usage( "No worldfiles specified" );
+	if( !exists("./etc/worldfile.wfs") )
+		usage( "Can't find ./etc/worldfile.wfs" );
+	if( outPath.empty() )
+		outPath = dir + "/results.txt";
+
+	char pwhome[PATH_MAX];
+	if( !getcwd(pwhome, sizeof(pwhome)) )
+		usage( "Can't determine current directory" );
+
+	makeDirs( dir );
+
+	vector<string> colnames = { "Worldfile", "Steps", "StepsPerSec", "PeakRssMB", "AllocsPerStep" };
+	vector<Type> coltypes = { STRING, INT, FLOAT, FLOAT, FLOAT };
+	for( int i = 0; i < StepProfiler::__NPHASES; i++ )
+	{
+		colnames.push_back( string(StepProfiler::getName((StepProfiler::Phase)i)) + "Ms" );
+		coltypes.push_back( FLOAT );
+	}
+	colnames.push_back( "LogsMs" );
+	coltypes.push_back( FLOAT );
+
+	DataLibWriter writer( outPath.c_str() );
+	writer.beginTable( "Bench", colnames, coltypes );
+
+	int nfailed = 0;
+
+	for( const string &worldfile : worldfiles )
+	{
+		char worldfilePath[PATH_MAX];
+		if( !realpath(worldfile.c_str(), worldfilePath) )
+		{
+			cerr << worldfile << ": " << strerror(errno) << endl;
+			nfailed++;
+			continue;
+		}
+
+		string name = worldfile.substr( worldfile.rfind('/') + 1 );
+		if( name.size() > 3 && name.compare(name.size() - 3, 3, ".wf") == 0 )
+			name.erase( name.size() - 3 );
+
+		int fds[2];
+		if( pipe(fds) != 0 )
+		{
+			perror( "pipe" );
+			exit( 1 );
+		}
+
+		fflush( stdout );
+		fflush( stderr );
+
+		pid_t pid = fork();
+		if( pid < 0 )
+		{
+			perror( "fork" );
+			exit( 1 );
+		}
+		else if( pid == 0 )
+		{
+			close( fds[0] );
+			runWorldfile( worldfilePath, dir + "/" + name, pwhome, parameters, fds[1] );
+		}
+		close( fds[1] );
+
+		Result result;
+		bool ok = read( fds[0], &result, sizeof(result) ) == sizeof(result);
+		close( fds[0] );
+
+		int status;
+		struct rusage usage;
+		if( wait4(pid, &status, 0, &usage) != pid )
+		{
+			perror( "wait4" );
+			exit( 1 );
+		}
+
+		if( !ok || !WIFEXITED(status) || (WEXITSTATUS(status) != 0) )
+		{
+			cerr << name << ": FAILED (see " << dir << "/" << name << "/pwbench.log)" << endl;
+			nfailed++;
+			continue;
+		}
+
+#ifdef __APPLE__
+		double peakRssMB = usage.ru_maxrss / (1024.0 * 1024.0);	// bytes
+#else
+		double peakRssMB = usage.ru_maxrss / 1024.0;	// kilobytes
+#endif
+		double steps = result.steps > 0 ? result.steps : 1;
+		double stepsPerSec = result.seconds > 0.0 ? result.steps / result.seconds : 0.0;
+
+		vector<Variant> coldata;
+		coldata.push_back( name.c_str() );
+		coldata.push_back( (int)result.steps );
+		coldata.push_back( (float)stepsPerSec );
+		coldata.push_back( (float)peakRssMB );
+		coldata.push_back( (float)(result.allocations / steps) );
+		for( int i = 0; i < StepProfiler::__NPHASES; i++ )
+			coldata.push_back( (float)(result.phases[i] * 1000.0 / steps) );
+		coldata.push_back( (float)(result.logs * 1000.0 / steps) );
+
+		writer.addRow( coldata.data() );
+		writer.flush();
+
+		printf( "%-24s %6ld steps %9.2f steps/s %8.1f MB %10.1f allocs/step\n",
+				name.c_str(), result.steps, stepsPerSec, peakRssMB, result.allocations / steps );
+		for( int i = 0; i < StepProfiler::__NPHASES; i++ )
+			printf( "    %-16s %9.3f ms/step\n",
+					StepProfiler::getName((StepProfiler::Phase)i), result.phases[i] * 1000.0 / steps );
+		printf( "    %-16s %9.3f ms/step\n", "Logs", result.logs * 1000.0 / steps );
+	}
+
+	writer.endTable();
+
+	return nfailed == 0 ? 0 : 1;
+}
@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include "brain/Brain.h"
+#include "brain/BrainFunctionFile.h"
 #include "brain/Nerve.h"
 #include "brain/NeuronModel.h"
 #include "brain/RqNervousSystem.h"
@@ -265,6 +266,20 @@ void printTimeSeries(RqNervousSystem* cns, int transient, int steps) {
 
 void printActual(AbstractFile* file, int neuronCount) {
     std::cout << "# BEGIN TIME SERIES";
+    if (BrainFunctionFile::isBinary(file)) {
+        BrainFunctionFile::Reader reader;
+        if (reader.read(file, "actual")) {
+            int count = reader.header.numNeurons;
+            for (long frame = 0; frame < reader.numFrames; frame++) {
+                for (int neuron = 0; neuron < count; neuron++) {
+                    std::cout << (neuron == 0 ? "\n" : " ") << reader.frames[frame * count + neuron];
+                }
+            }
+        }
+        std::cout << std::endl;
+        std::cout << "# END TIME SERIES" << std::endl;
+        return;
+    }
     char line[256];
     file->gets(line, sizeof(line));
     file->gets(line, sizeof(line));